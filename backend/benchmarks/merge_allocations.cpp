@@ -0,0 +1,131 @@
+/**
+ * @file merge_allocations.cpp
+ * @brief Counts heap allocations made by a conflict-heavy merge
+ *
+ * Replaces the global operator new to count calls, then merges a
+ * generated file where every block conflicts, once with the default
+ * (heap) allocator and once with a per-merge monotonic arena.
+ */
+
+#include "wizardmerge/merge/three_way_merge.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace wizardmerge::merge;
+
+namespace {
+
+size_t g_allocations = 0;
+size_t g_bytes = 0;
+
+struct Inputs {
+  std::vector<std::string> base;
+  std::vector<std::string> ours;
+  std::vector<std::string> theirs;
+};
+
+/**
+ * @brief Builds a file of small classes whose method bodies both sides edit.
+ */
+Inputs make_conflicting_inputs(size_t blocks) {
+  Inputs in;
+  for (size_t b = 0; b < blocks; ++b) {
+    std::string suffix = std::to_string(b);
+    for (auto *side : {&in.base, &in.ours, &in.theirs}) {
+      side->push_back("struct Handler" + suffix + " {");
+      side->push_back("int handle" + suffix + "(int value) {");
+      side->push_back("  int result = value * " + suffix + ";");
+    }
+    in.base.push_back("  return result + 1; // original implementation");
+    in.ours.push_back("  return result + 2; // changed on our branch");
+    in.theirs.push_back("  return result + 3; // changed on their branch");
+    for (auto *side : {&in.base, &in.ours, &in.theirs}) {
+      side->push_back("}");
+      side->push_back("};");
+      side->push_back("");
+    }
+  }
+  return in;
+}
+
+struct Sample {
+  size_t allocations;
+  size_t bytes;
+  double millis;
+  size_t conflicts;
+};
+
+template <typename Merge> Sample measure(Merge merge) {
+  size_t allocations = g_allocations;
+  size_t bytes = g_bytes;
+  auto start = std::chrono::steady_clock::now();
+  size_t conflicts = merge();
+  auto end = std::chrono::steady_clock::now();
+  return {g_allocations - allocations, g_bytes - bytes,
+          std::chrono::duration<double, std::milli>(end - start).count(),
+          conflicts};
+}
+
+void report(const char *mode, const Sample &s) {
+  std::printf("%-8s %8zu conflicts %10zu allocations %12zu bytes %9.2f ms\n",
+              mode, s.conflicts, s.allocations, s.bytes, s.millis);
+}
+
+} // namespace
+
+void *operator new(size_t size) {
+  ++g_allocations;
+  g_bytes += size;
+  if (void *p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+// std::pmr::new_delete_resource() allocates through the aligned overloads
+void *operator new(size_t size, std::align_val_t align) {
+  ++g_allocations;
+  g_bytes += size;
+  size_t alignment = static_cast<size_t>(align);
+  size_t rounded = (size + alignment - 1) / alignment * alignment;
+  if (void *p = std::aligned_alloc(alignment, rounded ? rounded : alignment)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+int main(int argc, char **argv) {
+  size_t blocks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+  Inputs in = make_conflicting_inputs(blocks);
+
+  // Warm up static regex tables so both modes measure steady state
+  three_way_merge(in.base, in.ours, in.theirs);
+
+  Sample heap = measure([&] {
+    MergeResult result = three_way_merge(in.base, in.ours, in.theirs);
+    return result.conflicts.size();
+  });
+
+  Sample arena = measure([&] {
+    std::pmr::monotonic_buffer_resource resource(1 << 20);
+    MergeResult result = three_way_merge(in.base, in.ours, in.theirs,
+                                         MergeOptions(), &resource);
+    return result.conflicts.size();
+  });
+
+  report("heap", heap);
+  report("arena", arena);
+  return 0;
+}
@@ -10,7 +10,9 @@
 #define WIZARDMERGE_ANALYSIS_CONTEXT_ANALYZER_H
 
 #include <map>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace wizardmerge {
@@ -18,15 +20,48 @@ namespace analysis {
 
 /**
  * @brief Represents code context information for a specific line or region.
+ *
+ * Allocator-aware: every string and container draws from the memory
+ * resource the context was constructed with, so a merge can place all of
+ * its analysis results in one arena.
  */
 struct CodeContext {
+  using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+  CodeContext() : CodeContext(allocator_type()) {}
+  explicit CodeContext(const allocator_type &alloc)
+      : start_line(0), end_line(0), surrounding_lines(alloc),
+        function_name(alloc), class_name(alloc), imports(alloc),
+        metadata(alloc) {}
+  CodeContext(const CodeContext &other, const allocator_type &alloc)
+      : start_line(other.start_line), end_line(other.end_line),
+        surrounding_lines(other.surrounding_lines, alloc),
+        function_name(other.function_name, alloc),
+        class_name(other.class_name, alloc), imports(other.imports, alloc),
+        metadata(other.metadata, alloc) {}
+  CodeContext(CodeContext &&other, const allocator_type &alloc)
+      : start_line(other.start_line), end_line(other.end_line),
+        surrounding_lines(std::move(other.surrounding_lines), alloc),
+        function_name(std::move(other.function_name), alloc),
+        class_name(std::move(other.class_name), alloc),
+        imports(std::move(other.imports), alloc),
+        metadata(std::move(other.metadata), alloc) {}
+  CodeContext(const CodeContext &) = default;
+  CodeContext(CodeContext &&) = default;
+  CodeContext &operator=(const CodeContext &) = default;
+  CodeContext &operator=(CodeContext &&) = default;
+
+  allocator_type get_allocator() const {
+    return function_name.get_allocator();
+  }
+
   size_t start_line;
   size_t end_line;
-  std::vector<std::string> surrounding_lines;
-  std::string function_name;
-  std::string class_name;
-  std::vector<std::string> imports;
-  std::map<std::string, std::string> metadata;
+  std::pmr::vector<std::pmr::string> surrounding_lines;
+  std::pmr::string function_name;
+  std::pmr::string class_name;
+  std::pmr::vector<std::pmr::string> imports;
+  std::pmr::map<std::pmr::string, std::pmr::string> metadata;
 };
 
 /**
@@ -40,11 +75,23 @@ struct CodeContext {
  * @param start_line Starting line of the region of interest
  * @param end_line Ending line of the region of interest
  * @param context_window Number of lines before/after to include (default: 5)
+ * @param alloc Allocator for the returned context
  * @return CodeContext containing analyzed context information
  */
 CodeContext analyze_context(const std::vector<std::string> &lines,
                             size_t start_line, size_t end_line,
-                            size_t context_window = 5);
+                            size_t context_window = 5,
+                            const CodeContext::allocator_type &alloc = {});
+
+/**
+ * @brief Analyzes context from views of the file's lines.
+ *
+ * Same as above, for lines held in a text::TextBuffer.
+ */
+CodeContext analyze_context(const std::vector<std::string_view> &lines,
+                            size_t start_line, size_t end_line,
+                            size_t context_window = 5,
+                            const CodeContext::allocator_type &alloc = {});
 
 /**
  * @brief Extracts function or method name from context.
@@ -58,6 +105,8 @@ CodeContext analyze_context(const std::vector<std::string> &lines,
  */
 std::string extract_function_name(const std::vector<std::string> &lines,
                                   size_t line_number);
+std::string extract_function_name(const std::vector<std::string_view> &lines,
+                                  size_t line_number);
 
 /**
  * @brief Extracts class name from context.
@@ -71,6 +120,8 @@ std::string extract_function_name(const std::vector<std::string> &lines,
  */
 std::string extract_class_name(const std::vector<std::string> &lines,
                                size_t line_number);
+std::string extract_class_name(const std::vector<std::string_view> &lines,
+                               size_t line_number);
 
 /**
  * @brief Extracts import/include statements from the file.
@@ -82,6 +133,8 @@ std::string extract_class_name(const std::vector<std::string> &lines,
  * @return Vector of import statements
  */
 std::vector<std::string> extract_imports(const std::vector<std::string> &lines);
+std::vector<std::string>
+extract_imports(const std::vector<std::string_view> &lines);
 
 } // namespace analysis
 } // namespace wizardmerge
@@ -3,13 +3,16 @@
  * @brief Risk analysis for merge conflict resolutions
  *
  * Assesses the risk level of different resolution choices to help
- * developers make safer merge decisions.
+ * developers make safer merge decisions. Functions taking lines also accept
+ * views, so callers holding a text::TextBuffer do not copy.
  */
 
 #ifndef WIZARDMERGE_ANALYSIS_RISK_ANALYZER_H
 #define WIZARDMERGE_ANALYSIS_RISK_ANALYZER_H
 
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace wizardmerge {
@@ -27,12 +30,49 @@ enum class RiskLevel {
 
 /**
  * @brief Detailed risk assessment for a merge resolution.
+ *
+ * Allocator-aware like analysis::CodeContext.
  */
 struct RiskAssessment {
+  using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+  RiskAssessment() : RiskAssessment(allocator_type()) {}
+  explicit RiskAssessment(const allocator_type &alloc)
+      : level(RiskLevel::LOW), confidence_score(0.0), risk_factors(alloc),
+        recommendations(alloc), has_syntax_changes(false),
+        has_logic_changes(false), has_api_changes(false),
+        affects_multiple_functions(false), affects_critical_section(false) {}
+  RiskAssessment(const RiskAssessment &other, const allocator_type &alloc)
+      : level(other.level), confidence_score(other.confidence_score),
+        risk_factors(other.risk_factors, alloc),
+        recommendations(other.recommendations, alloc),
+        has_syntax_changes(other.has_syntax_changes),
+        has_logic_changes(other.has_logic_changes),
+        has_api_changes(other.has_api_changes),
+        affects_multiple_functions(other.affects_multiple_functions),
+        affects_critical_section(other.affects_critical_section) {}
+  RiskAssessment(RiskAssessment &&other, const allocator_type &alloc)
+      : level(other.level), confidence_score(other.confidence_score),
+        risk_factors(std::move(other.risk_factors), alloc),
+        recommendations(std::move(other.recommendations), alloc),
+        has_syntax_changes(other.has_syntax_changes),
+        has_logic_changes(other.has_logic_changes),
+        has_api_changes(other.has_api_changes),
+        affects_multiple_functions(other.affects_multiple_functions),
+        affects_critical_section(other.affects_critical_section) {}
+  RiskAssessment(const RiskAssessment &) = default;
+  RiskAssessment(RiskAssessment &&) = default;
+  RiskAssessment &operator=(const RiskAssessment &) = default;
+  RiskAssessment &operator=(RiskAssessment &&) = default;
+
+  allocator_type get_allocator() const {
+    return risk_factors.get_allocator();
+  }
+
   RiskLevel level;
   double confidence_score; // 0.0 to 1.0
-  std::vector<std::string> risk_factors;
-  std::vector<std::string> recommendations;
+  std::pmr::vector<std::pmr::string> risk_factors;
+  std::pmr::vector<std::pmr::string> recommendations;
 
   // Specific risk indicators
   bool has_syntax_changes;
@@ -48,11 +88,19 @@ struct RiskAssessment {
  * @param base Base version lines
  * @param ours Our version lines
  * @param theirs Their version lines
+ * @param alloc Allocator for the returned assessment
  * @return RiskAssessment for accepting ours
  */
-RiskAssessment analyze_risk_ours(const std::vector<std::string> &base,
-                                 const std::vector<std::string> &ours,
-                                 const std::vector<std::string> &theirs);
+RiskAssessment
+analyze_risk_ours(const std::vector<std::string> &base,
+                  const std::vector<std::string> &ours,
+                  const std::vector<std::string> &theirs,
+                  const RiskAssessment::allocator_type &alloc = {});
+RiskAssessment
+analyze_risk_ours(const std::vector<std::string_view> &base,
+                  const std::vector<std::string_view> &ours,
+                  const std::vector<std::string_view> &theirs,
+                  const RiskAssessment::allocator_type &alloc = {});
 
 /**
  * @brief Analyzes risk of accepting "theirs" version.
@@ -60,11 +108,19 @@ RiskAssessment analyze_risk_ours(const std::vector<std::string> &base,
  * @param base Base version lines
  * @param ours Our version lines
  * @param theirs Their version lines
+ * @param alloc Allocator for the returned assessment
  * @return RiskAssessment for accepting theirs
  */
-RiskAssessment analyze_risk_theirs(const std::vector<std::string> &base,
-                                   const std::vector<std::string> &ours,
-                                   const std::vector<std::string> &theirs);
+RiskAssessment
+analyze_risk_theirs(const std::vector<std::string> &base,
+                    const std::vector<std::string> &ours,
+                    const std::vector<std::string> &theirs,
+                    const RiskAssessment::allocator_type &alloc = {});
+RiskAssessment
+analyze_risk_theirs(const std::vector<std::string_view> &base,
+                    const std::vector<std::string_view> &ours,
+                    const std::vector<std::string_view> &theirs,
+                    const RiskAssessment::allocator_type &alloc = {});
 
 /**
  * @brief Analyzes risk of accepting both versions (concatenation).
@@ -72,11 +128,19 @@ RiskAssessment analyze_risk_theirs(const std::vector<std::string> &base,
  * @param base Base version lines
  * @param ours Our version lines
  * @param theirs Their version lines
+ * @param alloc Allocator for the returned assessment
  * @return RiskAssessment for accepting both
  */
-RiskAssessment analyze_risk_both(const std::vector<std::string> &base,
-                                 const std::vector<std::string> &ours,
-                                 const std::vector<std::string> &theirs);
+RiskAssessment
+analyze_risk_both(const std::vector<std::string> &base,
+                  const std::vector<std::string> &ours,
+                  const std::vector<std::string> &theirs,
+                  const RiskAssessment::allocator_type &alloc = {});
+RiskAssessment
+analyze_risk_both(const std::vector<std::string_view> &base,
+                  const std::vector<std::string_view> &ours,
+                  const std::vector<std::string_view> &theirs,
+                  const RiskAssessment::allocator_type &alloc = {});
 
 /**
  * @brief Converts RiskLevel to string representation.
@@ -93,6 +157,7 @@ std::string risk_level_to_string(RiskLevel level);
  * @return true if critical patterns detected
  */
 bool contains_critical_patterns(const std::vector<std::string> &lines);
+bool contains_critical_patterns(const std::vector<std::string_view> &lines);
 
 /**
  * @brief Detects if changes affect API signatures.
@@ -103,6 +168,8 @@ bool contains_critical_patterns(const std::vector<std::string> &lines);
  */
 bool has_api_signature_changes(const std::vector<std::string> &base,
                                const std::vector<std::string> &modified);
+bool has_api_signature_changes(const std::vector<std::string_view> &base,
+                               const std::vector<std::string_view> &modified);
 
 /**
  * @brief Detects if TypeScript interface or type definitions changed.
@@ -113,6 +180,9 @@ bool has_api_signature_changes(const std::vector<std::string> &base,
  */
 bool has_typescript_interface_changes(const std::vector<std::string> &base,
                                       const std::vector<std::string> &modified);
+bool has_typescript_interface_changes(
+    const std::vector<std::string_view> &base,
+    const std::vector<std::string_view> &modified);
 
 /**
  * @brief Checks if file is a package-lock.json file.
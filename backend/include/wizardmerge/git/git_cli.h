@@ -131,6 +131,16 @@ bool branch_exists(const std::string &repo_path,
  */
 GitResult status(const std::string &repo_path);
 
+/**
+ * @brief List the files with unresolved merge conflicts
+ *
+ * @param repo_path Path inside the Git repository (empty for the current
+ *        directory); only files below it are listed
+ * @return Paths relative to @p repo_path, or std::nullopt if git fails
+ */
+std::optional<std::vector<std::string>>
+list_conflicted_files(const std::string &repo_path);
+
 /**
  * @brief Check if Git is available in system PATH
  *
@@ -95,13 +95,27 @@ std::optional<PullRequest> fetch_pull_request(GitPlatform platform,
  * @param sha Commit SHA
  * @param path File path
  * @param token Optional API token
- * @return File content as vector of lines, or empty optional on error
+ * @return File content as vector of lines, normalized to UTF-8 without a
+ *         BOM or carriage returns, or empty optional on error
  */
 std::optional<std::vector<std::string>>
 fetch_file_content(GitPlatform platform, const std::string &owner,
                    const std::string &repo, const std::string &sha,
                    const std::string &path, const std::string &token = "");
 
+/**
+ * @brief Fetch the raw bytes of a file at a specific commit
+ *
+ * Same as fetch_file_content, without splitting the content into lines,
+ * so that binary files can be told apart before they are split.
+ *
+ * @return File content, or empty optional on error
+ */
+std::optional<std::string>
+fetch_file_bytes(GitPlatform platform, const std::string &owner,
+                 const std::string &repo, const std::string &sha,
+                 const std::string &path, const std::string &token = "");
+
 } // namespace git
 } // namespace wizardmerge
 
@@ -0,0 +1,51 @@
+/**
+ * @file anchors.h
+ * @brief Lines that align all three versions of a merge
+ *
+ * An anchor is a line occurring exactly once in base, ours and theirs, in
+ * an order consistent with the other anchors. The three versions can be
+ * cut at an anchor and the pieces merged independently: the streaming
+ * merge uses them as sync points, the parallel merge as partition bounds.
+ */
+
+#ifndef WIZARDMERGE_MERGE_ANCHORS_H
+#define WIZARDMERGE_MERGE_ANCHORS_H
+
+#include "wizardmerge/merge/line_table.h"
+#include <cstddef>
+#include <vector>
+
+namespace wizardmerge {
+namespace merge {
+
+/**
+ * @brief Positions of one anchor line in the three versions.
+ */
+struct Anchor {
+  size_t base;
+  size_t ours;
+  size_t theirs;
+};
+
+/**
+ * @brief Finds the anchors of three interned versions.
+ *
+ * Lines unique in all three versions are reduced to their longest chain
+ * increasing in ours, then in theirs (as in patience diff), so the result
+ * is strictly increasing in every version.
+ *
+ * @param base Base line IDs
+ * @param ours Our line IDs
+ * @param theirs Their line IDs
+ * @param id_count Number of distinct IDs (LineTable::size())
+ * @return Anchors in ascending order
+ */
+std::vector<Anchor> find_anchors(const std::vector<LineId> &base,
+                                 const std::vector<LineId> &ours,
+                                 const std::vector<LineId> &theirs,
+                                 size_t id_count);
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_ANCHORS_H
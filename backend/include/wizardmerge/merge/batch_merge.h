@@ -0,0 +1,137 @@
+/**
+ * @file batch_merge.h
+ * @brief Merging many file triples on a shared thread pool
+ *
+ * A pull request or directory merge is a set of independent three-way
+ * merges. merge_batch runs them as tasks of one work-stealing pool,
+ * largest first so that a big file does not start last and stretch the
+ * whole batch, and hands each result to a callback as soon as it is done.
+ */
+
+#ifndef WIZARDMERGE_MERGE_BATCH_MERGE_H
+#define WIZARDMERGE_MERGE_BATCH_MERGE_H
+
+#include "wizardmerge/merge/thread_pool.h"
+#include "wizardmerge/merge/three_way_merge.h"
+#include "wizardmerge/text/text_buffer.h"
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wizardmerge {
+namespace merge {
+
+/**
+ * @brief One three-way merge of a batch.
+ *
+ * The lines are views; the text they point to must outlive the batch.
+ * The batch already runs files in parallel, so options.threads is best
+ * left at 1; a job that asks for more runs its parallel work on the
+ * batch's pool unless options.pool names another.
+ */
+struct MergeJob {
+  std::vector<std::string_view> base;
+  std::vector<std::string_view> ours;
+  std::vector<std::string_view> theirs;
+  MergeOptions options;
+};
+
+/**
+ * @brief Receives the result of one job.
+ *
+ * Called from the thread that merged the job, possibly concurrently with
+ * other calls. The result is valid only during the call; it may be moved
+ * from or modified.
+ *
+ * @param index Index of the job in the batch
+ * @param result Merge result of the job
+ */
+using MergeCallback = std::function<void(size_t index, MergeResult &result)>;
+
+/**
+ * @brief Merges all jobs on @p pool, largest first.
+ *
+ * Returns once every job was merged and delivered. If a merge or callback
+ * throws, the other jobs still run and the first exception is rethrown.
+ *
+ * @param jobs Merges to run
+ * @param on_result Receives each result as it completes
+ * @param pool Pool running the jobs
+ */
+void merge_batch(const std::vector<MergeJob> &jobs,
+                 const MergeCallback &on_result, ThreadPool &pool);
+
+/**
+ * @brief Merges all jobs on a pool of its own, largest first.
+ *
+ * @param jobs Merges to run
+ * @param on_result Receives each result as it completes
+ * @param threads Total threads; 0 means one per hardware thread
+ */
+void merge_batch(const std::vector<MergeJob> &jobs,
+                 const MergeCallback &on_result, size_t threads = 0);
+
+/**
+ * @brief The versions of one file of a batch, normalized for merging.
+ *
+ * Each version is normalized (text::TextBuffer::normalize), so versions
+ * that differ only in line endings, a byte order mark or UTF-16 encoding
+ * merge cleanly; content that is not text is kept as it is. Moving the
+ * file keeps the views of its jobs valid.
+ */
+struct NormalizedFile {
+  text::TextBuffer base;
+  text::TextBuffer ours;
+  text::TextBuffer theirs;
+  // Format the merged file is written back in: ours', or theirs' if ours
+  // is empty
+  text::TextFormat format;
+
+  /**
+   * @brief A job merging the normalized versions.
+   */
+  MergeJob job(const MergeOptions &options = MergeOptions()) const;
+};
+
+/**
+ * @brief Normalizes the three versions of a file.
+ *
+ * @param base Content of the common ancestor, as stored
+ * @param ours Our content, as stored
+ * @param theirs Their content, as stored
+ */
+NormalizedFile normalize_file(text::TextBuffer base, text::TextBuffer ours,
+                              text::TextBuffer theirs);
+
+/**
+ * @brief The merged lines of a result in a stored format.
+ *
+ * Every line is followed by a newline, then the text is converted with
+ * text::restore_text().
+ */
+std::string restore_merged(const MergeResult &result,
+                           const text::TextFormat &format);
+
+/**
+ * @brief Checks whether a tree merge deletes a file.
+ *
+ * A file in base is deleted when one side removed it and the other left
+ * it unchanged, or when both removed it. A file not in base was added and
+ * is kept, even if empty; a file one side removed and the other changed
+ * is merged against an empty version.
+ *
+ * @param base Content in base, or nullopt if base does not have the file
+ * @param ours Our content, or nullopt if we do not have the file
+ * @param theirs Their content, or nullopt if they do not have the file
+ */
+bool is_deleted_file(std::optional<std::string_view> base,
+                     std::optional<std::string_view> ours,
+                     std::optional<std::string_view> theirs);
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_BATCH_MERGE_H
@@ -0,0 +1,85 @@
+/**
+ * @file binary_merge.h
+ * @brief Whole-file merge for binary content
+ *
+ * Images, archives and compiled assets have no meaningful lines, so
+ * splitting them and running the line diff and the analyzers over them
+ * only wastes time and memory. Binary files are detected up front (see
+ * text::looks_binary) and merged as opaque blobs instead: a side that did
+ * not change gives way to the one that did, and two different changes
+ * are one whole-file conflict.
+ */
+
+#ifndef WIZARDMERGE_MERGE_BINARY_MERGE_H
+#define WIZARDMERGE_MERGE_BINARY_MERGE_H
+
+#include "wizardmerge/text/text_kernels.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wizardmerge {
+namespace merge {
+
+/**
+ * @brief Outcome of a whole-file merge.
+ */
+enum class BinaryResolution {
+  OURS,    // Take our version (theirs is unchanged, or both are equal)
+  THEIRS,  // Take their version (ours is unchanged)
+  CONFLICT // Both sides changed the file differently
+};
+
+/**
+ * @brief Checks whether any of the three versions is binary.
+ *
+ * @param scan_bytes Bytes inspected at the start of each version
+ */
+bool is_binary_merge(std::string_view base, std::string_view ours,
+                     std::string_view theirs,
+                     size_t scan_bytes = text::BINARY_SCAN_BYTES);
+
+/**
+ * @brief Same as above, for content already split into lines.
+ *
+ * The lines are scanned in order, each followed by its newline, until
+ * @p scan_bytes have been inspected.
+ */
+bool is_binary_merge(const std::vector<std::string_view> &base,
+                     const std::vector<std::string_view> &ours,
+                     const std::vector<std::string_view> &theirs,
+                     size_t scan_bytes = text::BINARY_SCAN_BYTES);
+
+/**
+ * @brief Merges three versions of a file as opaque byte strings.
+ *
+ * Each version is hashed once (text::hash_bytes) and equal hashes are
+ * confirmed byte by byte, so the cost is one pass over each version.
+ *
+ * @param base The common ancestor version
+ * @param ours Our version
+ * @param theirs Their version
+ * @return Which version the merge takes, or CONFLICT
+ */
+BinaryResolution merge_binary(std::string_view base, std::string_view ours,
+                              std::string_view theirs);
+
+/**
+ * @brief Same as above, for content already split into lines.
+ */
+BinaryResolution merge_binary(const std::vector<std::string_view> &base,
+                              const std::vector<std::string_view> &ours,
+                              const std::vector<std::string_view> &theirs);
+
+/**
+ * @brief Converts BinaryResolution to string representation.
+ *
+ * @param resolution Resolution to convert
+ * @return "ours", "theirs" or "conflict"
+ */
+std::string binary_resolution_to_string(BinaryResolution resolution);
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_BINARY_MERGE_H
@@ -0,0 +1,78 @@
+/**
+ * @file bit_lcs.h
+ * @brief Bit-parallel longest common subsequence for short hunks
+ *
+ * Hyyrö's bit-vector formulation of the LCS dynamic program: one row of
+ * the DP table is a bit vector over the columns, and a whole row is
+ * advanced with a few word operations (an AND, an add with carry and an
+ * OR), so 64 cells are computed per machine word. Rows spanning several
+ * words are advanced four words at a time with AVX2 where the CPU has it
+ * (see text::active_simd_level()); all variants give identical results.
+ *
+ * The cost is O(N * M / 64) whatever the edit distance, which beats the
+ * O((N + M) * D) of Myers on the small, mostly different ranges left
+ * inside conflicting hunks.
+ */
+
+#ifndef WIZARDMERGE_MERGE_BIT_LCS_H
+#define WIZARDMERGE_MERGE_BIT_LCS_H
+
+#include "wizardmerge/merge/diff.h"
+#include "wizardmerge/merge/line_table.h"
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace wizardmerge {
+namespace merge {
+
+// Largest DP table (N * M cells) handled by the bit-parallel kernel; the
+// diff and the risk analyzer pick it automatically below this size
+constexpr size_t BIT_LCS_MAX_CELLS = size_t(1) << 22;
+
+/**
+ * @brief Length of the longest common subsequence of two sequences.
+ *
+ * Memory is O(min(N, M)^2 / 64) words for the match masks, so keep the
+ * inputs hunk-sized (N * M <= BIT_LCS_MAX_CELLS).
+ *
+ * @param a First sequence
+ * @param b Second sequence
+ * @return Number of elements in a longest common subsequence
+ */
+size_t lcs_length(const std::vector<LineId> &a, const std::vector<LineId> &b);
+size_t lcs_length(const std::vector<std::string_view> &a,
+                  const std::vector<std::string_view> &b);
+
+/**
+ * @brief Aligns a[0, n) and b[0, m) along a longest common subsequence.
+ *
+ * Keeps every DP row for the traceback: O(N * M / 64) words.
+ *
+ * @param a First sequence
+ * @param n Length of @p a
+ * @param b Second sequence
+ * @param m Length of @p b
+ * @param matches Receives the matched (a index, b index) pairs, ascending
+ */
+void lcs_matches(const LineId *a, size_t n, const LineId *b, size_t m,
+                 std::vector<std::pair<size_t, size_t>> &matches);
+
+/**
+ * @brief Computes a minimal diff with the bit-parallel kernel.
+ *
+ * Same hunks format as myers_diff(); ties between equally short edit
+ * scripts may be broken differently.
+ *
+ * @param base Base sequence
+ * @param other Modified sequence
+ * @return Hunks describing how to transform base into other
+ */
+std::vector<DiffHunk> bit_lcs_diff(const std::vector<LineId> &base,
+                                   const std::vector<LineId> &other);
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_BIT_LCS_H
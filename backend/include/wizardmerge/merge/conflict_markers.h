@@ -0,0 +1,100 @@
+/**
+ * @file conflict_markers.h
+ * @brief Parsing of files git left with conflict markers
+ *
+ * A conflicted working-tree file holds, for every conflict, our lines
+ * after "<<<<<<<", base lines after "|||||||" (diff3 style only), their
+ * lines after "=======" and a closing ">>>>>>>". Parsing it rebuilds the
+ * three versions as line views into the file, ready for three_way_merge()
+ * and analyze_conflict(); lines outside the markers belong to all three.
+ */
+
+#ifndef WIZARDMERGE_MERGE_CONFLICT_MARKERS_H
+#define WIZARDMERGE_MERGE_CONFLICT_MARKERS_H
+
+#include "wizardmerge/merge/three_way_merge.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wizardmerge {
+namespace merge {
+
+// Length of a conflict marker, git's default conflict-marker-size
+constexpr size_t CONFLICT_MARKER_SIZE = 7;
+
+/**
+ * @brief One conflict of a conflicted file.
+ */
+struct MarkerHunk {
+  // Lines of the file, from the "<<<<<<<" line to the ">>>>>>>" line
+  LineRange file_range;
+  // Where the sections went in the rebuilt versions
+  LineRange base_range;
+  LineRange our_range;
+  LineRange their_range;
+  // Whether the hunk had a "|||||||" base section; without one the base
+  // is unknown and rebuilt as empty
+  bool has_base = false;
+  // Text after the markers, e.g. "HEAD" and a branch name
+  std::string_view our_label;
+  std::string_view base_label;
+  std::string_view their_label;
+};
+
+/**
+ * @brief The three versions rebuilt from a conflicted file.
+ *
+ * All views point into the parsed data, which must outlive them.
+ */
+struct ConflictedFile {
+  std::vector<std::string_view> base;
+  std::vector<std::string_view> ours;
+  std::vector<std::string_view> theirs;
+  std::vector<MarkerHunk> hunks;
+
+  bool has_conflicts() const { return !hunks.empty(); }
+};
+
+/**
+ * @brief Checks whether a line is a conflict marker.
+ *
+ * A marker is exactly @p marker_size copies of @p marker_char at the start
+ * of the line, followed by a space, a carriage return or the end of the
+ * line; longer runs (the markers of nested conflicts) do not match.
+ */
+bool is_conflict_marker(std::string_view line, char marker_char,
+                        size_t marker_size = CONFLICT_MARKER_SIZE);
+
+/**
+ * @brief Builds a conflict marker line, e.g. "<<<<<<< HEAD".
+ *
+ * @param marker_char '<', '|', '=' or '>'
+ * @param label Text after the marker; none if empty
+ * @param marker_size Length of the marker
+ */
+std::string conflict_marker(char marker_char, std::string_view label,
+                            size_t marker_size = CONFLICT_MARKER_SIZE);
+
+/**
+ * @brief Rebuilds base, ours and theirs from a file with conflict markers.
+ *
+ * Conflicts are found with the vectorized find_line_start(), which only
+ * stops at lines starting with '<', so the text between conflicts is
+ * split into lines but never inspected line by line. Lines follow
+ * std::getline: split on '\n', carriage returns kept.
+ *
+ * @param data Content of the file, e.g. TextBuffer::data() of a mapping
+ * @param file Receives the versions and the hunks
+ * @param marker_size Length of the markers
+ * @return false if a conflict is not closed, its markers are out of order
+ *         or a "<<<<<<<" appears inside it; @p file is then unspecified
+ */
+bool parse_conflict_markers(std::string_view data, ConflictedFile &file,
+                            size_t marker_size = CONFLICT_MARKER_SIZE);
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_CONFLICT_MARKERS_H
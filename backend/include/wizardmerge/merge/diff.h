@@ -0,0 +1,203 @@
+/**
+ * @file diff.h
+ * @brief Line-level diff algorithms used by the merge engine
+ *
+ * Computes the edit script between two versions of a file as a list of
+ * hunks. The three-way merge aligns the base→ours and base→theirs scripts
+ * to find stable and unstable regions.
+ *
+ * The algorithms run on interned line IDs (see LineTable); the overloads
+ * taking strings intern both inputs into a temporary table first.
+ */
+
+#ifndef WIZARDMERGE_MERGE_DIFF_H
+#define WIZARDMERGE_MERGE_DIFF_H
+
+#include "wizardmerge/merge/line_table.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace wizardmerge {
+namespace merge {
+
+/**
+ * @brief Line diff algorithm used to align two versions.
+ */
+enum class DiffAlgorithm {
+  AUTO,      // Myers for small inputs, histogram for large ones
+  MYERS,     // Minimal edit script, O(ND)
+  PATIENCE,  // Anchors on lines unique to both sides
+  HISTOGRAM  // Anchors on the lowest-occurrence common lines (git-style)
+};
+
+/**
+ * @brief Inputs with at least this many lines on either side use the
+ *        histogram algorithm under DiffAlgorithm::AUTO.
+ */
+constexpr size_t HISTOGRAM_AUTO_THRESHOLD = 1000;
+
+/**
+ * @brief Lines occurring more often than this are never histogram anchors.
+ */
+constexpr size_t HISTOGRAM_MAX_CHAIN = 64;
+
+/**
+ * @brief Default bytes a Myers search may spend on its trace.
+ *
+ * The trace that recovers the optimal path grows with the square of the
+ * edit distance. A search that would exceed the budget is abandoned and
+ * its range is bisected at the middle snake instead (linear space, see
+ * myers_linear_diff); each half gets a fresh search under the same
+ * budget.
+ */
+constexpr size_t DIFF_MEMORY_BUDGET = size_t(64) << 20;
+
+/**
+ * @brief A contiguous region where two sequences differ.
+ *
+ * Lines [base_start, base_start + base_count) of the first sequence are
+ * replaced by lines [other_start, other_start + other_count) of the second.
+ * A zero base_count is a pure insertion, a zero other_count a pure deletion.
+ */
+struct DiffHunk {
+  size_t base_start;
+  size_t base_count;
+  size_t other_start;
+  size_t other_count;
+
+  size_t base_end() const { return base_start + base_count; }
+  size_t other_end() const { return other_start + other_count; }
+};
+
+/**
+ * @brief Computes a minimal line diff using Myers' O(ND) algorithm.
+ *
+ * Common leading and trailing lines are stripped before the search, so the
+ * cost is O(N + D²) where D is the size of the edit script. Ranges whose
+ * trace would exceed DIFF_MEMORY_BUDGET are split in linear space first.
+ *
+ * @param base The original sequence
+ * @param other The modified sequence
+ * @return Hunks in ascending order, describing how to turn base into other
+ */
+std::vector<DiffHunk> myers_diff(const std::vector<std::string> &base,
+                                 const std::vector<std::string> &other);
+
+/**
+ * @brief Computes a minimal line diff in linear space.
+ *
+ * Same edit distance as myers_diff, but the range is split recursively at
+ * the middle snake of the optimal path instead of storing every round of
+ * the search: O((N + M) * D) time, O(N + M) memory. Suited to inputs with
+ * long edit scripts, such as the token sequences of conflict hunks.
+ *
+ * @param base The original sequence
+ * @param other The modified sequence
+ * @return Hunks in ascending order, describing how to turn base into other
+ */
+std::vector<DiffHunk> myers_linear_diff(const std::vector<std::string> &base,
+                                        const std::vector<std::string> &other);
+
+/**
+ * @brief Computes a line diff using the patience algorithm.
+ *
+ * Lines that occur exactly once on both sides are matched through their
+ * longest increasing subsequence and used as anchors; the gaps between
+ * anchors are diffed recursively, falling back to Myers when a gap has no
+ * unique lines. Repeated lines such as braces and blank lines therefore
+ * never pull the alignment away from the real edits.
+ *
+ * @param base The original sequence
+ * @param other The modified sequence
+ * @return Hunks in ascending order, describing how to turn base into other
+ */
+std::vector<DiffHunk> patience_diff(const std::vector<std::string> &base,
+                                    const std::vector<std::string> &other);
+
+/**
+ * @brief Computes a line diff using the histogram algorithm.
+ *
+ * Extends patience diff to lines that are not unique: the common region
+ * anchored on the lowest-occurrence line is chosen as the split point and
+ * both sides of it are diffed recursively. Lines occurring more than
+ * HISTOGRAM_MAX_CHAIN times are never used as anchors, which keeps the
+ * search space small on large files.
+ *
+ * @param base The original sequence
+ * @param other The modified sequence
+ * @return Hunks in ascending order, describing how to turn base into other
+ */
+std::vector<DiffHunk> histogram_diff(const std::vector<std::string> &base,
+                                     const std::vector<std::string> &other);
+
+/**
+ * @brief Computes a line diff with the requested algorithm.
+ *
+ * @param base The original sequence
+ * @param other The modified sequence
+ * @param algorithm Algorithm to use; AUTO picks by input size
+ * @param memory_budget Bytes any single Myers search may use for its
+ *                      trace before falling back to linear space
+ * @return Hunks in ascending order, describing how to turn base into other
+ */
+std::vector<DiffHunk>
+compute_diff(const std::vector<std::string> &base,
+             const std::vector<std::string> &other, DiffAlgorithm algorithm,
+             size_t memory_budget = DIFF_MEMORY_BUDGET);
+
+/**
+ * @brief Computes a Myers diff over interned line IDs.
+ */
+std::vector<DiffHunk> myers_diff(const std::vector<LineId> &base,
+                                 const std::vector<LineId> &other);
+
+/**
+ * @brief Computes a linear-space Myers diff over interned line IDs.
+ */
+std::vector<DiffHunk> myers_linear_diff(const std::vector<LineId> &base,
+                                        const std::vector<LineId> &other);
+
+/**
+ * @brief Computes a patience diff over interned line IDs.
+ */
+std::vector<DiffHunk> patience_diff(const std::vector<LineId> &base,
+                                    const std::vector<LineId> &other);
+
+/**
+ * @brief Computes a histogram diff over interned line IDs.
+ */
+std::vector<DiffHunk> histogram_diff(const std::vector<LineId> &base,
+                                     const std::vector<LineId> &other);
+
+/**
+ * @brief Computes a diff over interned line IDs with the given algorithm.
+ *
+ * Both sequences must come from the same LineTable.
+ */
+std::vector<DiffHunk>
+compute_diff(const std::vector<LineId> &base, const std::vector<LineId> &other,
+             DiffAlgorithm algorithm,
+             size_t memory_budget = DIFF_MEMORY_BUDGET);
+
+/**
+ * @brief Converts DiffAlgorithm to string representation.
+ *
+ * @param algorithm Algorithm to convert
+ * @return "auto", "myers", "patience" or "histogram"
+ */
+std::string diff_algorithm_to_string(DiffAlgorithm algorithm);
+
+/**
+ * @brief Parses a diff algorithm name.
+ *
+ * @param name Algorithm name ("auto", "myers", "patience", "histogram")
+ * @param algorithm Output algorithm
+ * @return true if the name is recognized, false otherwise
+ */
+bool parse_diff_algorithm(const std::string &name, DiffAlgorithm &algorithm);
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_DIFF_H
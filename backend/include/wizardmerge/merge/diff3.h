@@ -0,0 +1,65 @@
+/**
+ * @file diff3.h
+ * @brief Alignment of two edit scripts against a common base
+ *
+ * Walks the base→ours and base→theirs hunks together and groups them into
+ * regions. Everything between two regions is unchanged on both sides.
+ * Works on any interned sequence: the merge engine runs it on lines, and
+ * conflict refinement on the tokens of a conflicting hunk.
+ */
+
+#ifndef WIZARDMERGE_MERGE_DIFF3_H
+#define WIZARDMERGE_MERGE_DIFF3_H
+
+#include "wizardmerge/merge/diff.h"
+#include <cstddef>
+#include <vector>
+
+namespace wizardmerge {
+namespace merge {
+
+/**
+ * @brief A base range changed by at least one side, with the matching
+ *        ranges of ours and theirs.
+ *
+ * Ranges are half-open: [base_begin, base_end) and so on.
+ */
+struct Diff3Region {
+  enum Kind {
+    OURS,     // Only ours changed it
+    THEIRS,   // Only theirs changed it
+    SAME,     // Both sides made the same change
+    CONFLICT  // Both sides changed it differently
+  };
+
+  Kind kind;
+  size_t base_begin;
+  size_t base_end;
+  size_t ours_begin;
+  size_t ours_end;
+  size_t theirs_begin;
+  size_t theirs_end;
+};
+
+/**
+ * @brief Groups two edit scripts into diff3 regions.
+ *
+ * Hunks of either script that overlap in base, or insert at the same base
+ * position, end up in one region.
+ *
+ * @param our_ids Our sequence
+ * @param their_ids Their sequence
+ * @param our_hunks Diff of base against ours
+ * @param their_hunks Diff of base against theirs
+ * @return Regions in ascending base order
+ */
+std::vector<Diff3Region>
+diff3_regions(const std::vector<LineId> &our_ids,
+              const std::vector<LineId> &their_ids,
+              const std::vector<DiffHunk> &our_hunks,
+              const std::vector<DiffHunk> &their_hunks);
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_DIFF3_H
@@ -0,0 +1,174 @@
+/**
+ * @file line_table.h
+ * @brief Per-merge line interning table
+ *
+ * Maps every distinct line of the merge inputs to a dense integer ID so
+ * the diff algorithms compare and index integers instead of strings.
+ * Under a CompareOptions equivalence (git's whitespace options) lines are
+ * interned by their normalized form, so equivalent lines share an ID and
+ * the diff runs in that equivalence at no extra cost.
+ */
+
+#ifndef WIZARDMERGE_MERGE_LINE_TABLE_H
+#define WIZARDMERGE_MERGE_LINE_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wizardmerge {
+namespace merge {
+
+/**
+ * @brief Dense identifier of an interned line.
+ */
+using LineId = uint32_t;
+
+/**
+ * @brief Computes a 64-bit hash of a line.
+ *
+ * Delegates to text::hash_bytes (wyhash/xxh3 family, SIMD-dispatched
+ * for long lines).
+ *
+ * @param line Line content
+ * @return 64-bit hash value
+ */
+uint64_t hash_line(std::string_view line);
+
+/**
+ * @brief Equivalences applied when comparing lines, as in git's
+ *        whitespace options. Any combination may be set.
+ */
+struct CompareOptions {
+  // Whitespace is ignored entirely (git -w)
+  bool ignore_all_space = false;
+  // Runs of whitespace compare equal and trailing whitespace is ignored
+  // (git -b)
+  bool ignore_space_change = false;
+  // A carriage return at the end of a line is ignored
+  bool ignore_eol = false;
+  // ASCII letters compare case-insensitively
+  bool ignore_case = false;
+  // Inserting or deleting whitespace-only lines is not a change
+  bool ignore_blank_lines = false;
+
+  /**
+   * @brief Whether lines are compared byte for byte (blank lines aside).
+   */
+  bool exact() const {
+    return !ignore_all_space && !ignore_space_change && !ignore_eol &&
+           !ignore_case;
+  }
+};
+
+/**
+ * @brief Returns the form of a line that equivalent lines share.
+ *
+ * @param line Line content
+ * @param compare Equivalences to apply
+ * @param scratch Storage for the normalized form, reused between calls
+ * @return @p line itself when compare.exact(), else a view of @p scratch
+ */
+std::string_view normalize_line(std::string_view line,
+                                const CompareOptions &compare,
+                                std::string &scratch);
+
+/**
+ * @brief Checks whether two lines are equal under @p compare.
+ */
+bool lines_equivalent(std::string_view a, std::string_view b,
+                      const CompareOptions &compare);
+
+/**
+ * @brief Enables one equivalence by name.
+ *
+ * @param name "all-space", "space-change", "eol", "case" or "blank-lines"
+ * @param compare Options to update
+ * @return true if the name is recognized, false otherwise
+ */
+bool parse_ignore_option(const std::string &name, CompareOptions &compare);
+
+/**
+ * @brief Interns lines into dense IDs.
+ *
+ * Every distinct line is hashed once; equal hashes are verified byte by
+ * byte, so two lines get the same ID exactly when their contents are
+ * equal (or equivalent, under a CompareOptions equivalence). The table
+ * stores views: the interned strings must outlive it.
+ */
+class LineTable {
+public:
+  /**
+   * @brief Creates a table sized for the expected number of lines.
+   *
+   * @param expected_lines Total number of lines that will be interned
+   */
+  explicit LineTable(size_t expected_lines = 0);
+
+  /**
+   * @brief Creates a table that interns lines up to an equivalence.
+   *
+   * compare.ignore_blank_lines does not affect the IDs.
+   *
+   * @param expected_lines Total number of lines that will be interned
+   * @param compare Equivalences under which lines share an ID
+   */
+  LineTable(size_t expected_lines, const CompareOptions &compare);
+
+  /**
+   * @brief Returns the ID of a line, assigning a new one if unseen.
+   *
+   * @param line Line content (must outlive the table)
+   * @return Dense line ID, in order of first appearance
+   */
+  LineId intern(std::string_view line);
+
+  /**
+   * @brief Interns every line of a file.
+   *
+   * @param lines File content as lines (must outlive the table)
+   * @return One ID per input line
+   */
+  std::vector<LineId> intern_lines(const std::vector<std::string> &lines);
+  std::vector<LineId>
+  intern_lines(const std::vector<std::string_view> &lines);
+
+  /**
+   * @brief Returns the content of an interned line (the first one seen,
+   *        among equivalent lines).
+   */
+  std::string_view text(LineId id) const { return texts_[id]; }
+
+  /**
+   * @brief Returns the hash of an interned line (of its normalized form).
+   */
+  uint64_t hash(LineId id) const { return hashes_[id]; }
+
+  /**
+   * @brief Number of distinct lines interned so far.
+   */
+  size_t size() const { return texts_.size(); }
+
+private:
+  static constexpr LineId EMPTY_SLOT = UINT32_MAX;
+
+  void grow();
+  std::string_view key(LineId id) const;
+
+  std::vector<LineId> slots_; // Open addressing, linear probing
+  std::vector<std::string_view> texts_;
+  std::vector<uint64_t> hashes_;
+  size_t mask_;
+  CompareOptions compare_;
+  // Normalized forms, back to back, when the comparison is not exact
+  std::string keys_;
+  std::vector<size_t> key_ends_;
+  std::string scratch_;
+};
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_LINE_TABLE_H
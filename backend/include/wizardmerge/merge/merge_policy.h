@@ -0,0 +1,327 @@
+/**
+ * @file merge_policy.h
+ * @brief Compile-time policies for the three-way merge pipeline
+ *
+ * three_way_merge() decides at run time how lines compare, which diff
+ * runs, how far conflicts are analyzed and where the output goes. Callers
+ * that know some of these up front can fix them in a MergePolicy instead:
+ * merge_with_policy<Policy>() is compiled per policy, so the line
+ * comparisons of the hot loops are inlined, disabled stages are compiled
+ * out and lines are written straight to the sink.
+ *
+ * A policy combines four parts:
+ * - Comparator: ExactLines or EquivalentLines (options.compare)
+ * - Diff: FixedDiff<Algorithm> or OptionsDiff (options.algorithm)
+ * - Analysis: FixedAnalysis<Level> or OptionsAnalysis (options.analysis)
+ * - Sink: ResultSink (a MergeResult) or StreamSink (a MergeSink)
+ *
+ * The pipeline is defined in three_way_merge.cpp and instantiated for the
+ * policies declared below; three_way_merge() and the streaming merge are
+ * thin wrappers over them, and take the text policies whenever the
+ * options only ask for merged text (is_text_merge()).
+ */
+
+#ifndef WIZARDMERGE_MERGE_MERGE_POLICY_H
+#define WIZARDMERGE_MERGE_MERGE_POLICY_H
+
+#include "wizardmerge/merge/line_table.h"
+#include "wizardmerge/merge/streaming_merge.h"
+#include "wizardmerge/merge/three_way_merge.h"
+#include "wizardmerge/text/text_kernels.h"
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace wizardmerge {
+namespace merge {
+
+/**
+ * @brief Lines are equal when their bytes are (options.compare ignored).
+ */
+struct ExactLines {
+  explicit ExactLines(const CompareOptions & = {}) {}
+
+  CompareOptions options() const { return {}; }
+  static constexpr bool ignores_blank_lines() { return false; }
+
+  bool equal(std::string_view a, std::string_view b) const {
+    // Views of the same storage (e.g. ours aliasing base) skip the compare
+    return a.size() == b.size() &&
+           (a.data() == b.data() || text::bytes_equal(a, b));
+  }
+};
+
+/**
+ * @brief Lines are equal when equivalent under options.compare.
+ */
+struct EquivalentLines {
+  explicit EquivalentLines(const CompareOptions &compare)
+      : compare_(compare) {}
+
+  CompareOptions options() const { return compare_; }
+  bool ignores_blank_lines() const { return compare_.ignore_blank_lines; }
+
+  bool equal(std::string_view a, std::string_view b) const {
+    return lines_equivalent(a, b, compare_);
+  }
+
+private:
+  CompareOptions compare_;
+};
+
+/**
+ * @brief Lines at the start and end that the versions of a merge share.
+ */
+struct CommonEnds {
+  size_t prefix = 0;
+  size_t suffix = 0;
+};
+
+/**
+ * @brief Common prefix and suffix of base with one other version, as the
+ *        diff strips them (prefix first, suffix from what is left).
+ */
+template <typename Comparator>
+CommonEnds common_ends(const std::vector<std::string_view> &base,
+                       const std::vector<std::string_view> &other,
+                       const Comparator &comparator) {
+  CommonEnds ends;
+  size_t shorter = std::min(base.size(), other.size());
+  while (ends.prefix < shorter &&
+         comparator.equal(base[ends.prefix], other[ends.prefix])) {
+    ++ends.prefix;
+  }
+  while (ends.suffix < shorter - ends.prefix &&
+         comparator.equal(base[base.size() - 1 - ends.suffix],
+                          other[other.size() - 1 - ends.suffix])) {
+    ++ends.suffix;
+  }
+  return ends;
+}
+
+/**
+ * @brief Diffs with a fixed algorithm (options.algorithm ignored).
+ */
+template <DiffAlgorithm Algorithm> struct FixedDiff {
+  static constexpr DiffAlgorithm algorithm(const MergeOptions &) {
+    return Algorithm;
+  }
+};
+
+/**
+ * @brief Diffs with options.algorithm.
+ */
+struct OptionsDiff {
+  static DiffAlgorithm algorithm(const MergeOptions &options) {
+    return options.algorithm;
+  }
+};
+
+/**
+ * @brief Analyzes conflicts to a fixed level (options.analysis ignored).
+ */
+template <AnalysisLevel Level> struct FixedAnalysis {
+  static constexpr bool enabled = Level != AnalysisLevel::NONE;
+  static constexpr AnalysisLevel level(const MergeOptions &) { return Level; }
+};
+
+/**
+ * @brief Analyzes conflicts to options.analysis.
+ */
+struct OptionsAnalysis {
+  static constexpr bool enabled = true;
+  static AnalysisLevel level(const MergeOptions &options) {
+    return options.analysis;
+  }
+};
+
+/**
+ * @brief Collects the output into a MergeResult.
+ */
+class ResultSink {
+public:
+  explicit ResultSink(MergeResult &result) : result_(result) {}
+
+  Conflict::allocator_type allocator() const {
+    return result_.get_allocator();
+  }
+
+  /**
+   * @brief Output lines written so far.
+   */
+  size_t line_count() const { return result_.merged_lines.size(); }
+
+  void write_lines(const std::vector<std::string_view> &lines, size_t begin,
+                   size_t end, Line::Origin origin) {
+    for (size_t i = begin; i < end; ++i) {
+      result_.merged_lines.emplace_back(lines[i], origin);
+    }
+  }
+
+  void write_line(std::string_view content, Line::Origin origin) {
+    result_.merged_lines.emplace_back(content, origin);
+  }
+
+  /**
+   * @brief Conflicts written so far; the pipeline analyzes them in place
+   *        before finish().
+   */
+  std::pmr::vector<Conflict> &conflicts() { return result_.conflicts; }
+
+  void finish() {}
+
+private:
+  MergeResult &result_;
+};
+
+/**
+ * @brief Forwards the output to a MergeSink as it is produced.
+ *
+ * Lines are forwarded at once; conflicts are held until finish() so that
+ * they can be analyzed first. Line numbers continue from @p first_line.
+ */
+class StreamSink {
+public:
+  StreamSink(MergeSink &sink, size_t first_line,
+             const Conflict::allocator_type &alloc = {})
+      : sink_(sink), line_count_(first_line), conflicts_(alloc) {}
+
+  Conflict::allocator_type allocator() const {
+    return conflicts_.get_allocator();
+  }
+
+  size_t line_count() const { return line_count_; }
+
+  void write_lines(const std::vector<std::string_view> &lines, size_t begin,
+                   size_t end, Line::Origin origin) {
+    for (size_t i = begin; i < end; ++i) {
+      sink_.write_line(lines[i], origin);
+    }
+    line_count_ += end - begin;
+  }
+
+  void write_line(std::string_view content, Line::Origin origin) {
+    sink_.write_line(content, origin);
+    ++line_count_;
+  }
+
+  std::pmr::vector<Conflict> &conflicts() { return conflicts_; }
+
+  /**
+   * @brief Forwards the held conflicts.
+   */
+  void finish() {
+    for (const auto &conflict : conflicts_) {
+      sink_.write_conflict(conflict);
+    }
+    conflicts_forwarded_ += conflicts_.size();
+    conflicts_.clear();
+  }
+
+  size_t conflicts_forwarded() const { return conflicts_forwarded_; }
+
+private:
+  MergeSink &sink_;
+  size_t line_count_;
+  std::pmr::vector<Conflict> conflicts_;
+  size_t conflicts_forwarded_ = 0;
+};
+
+/**
+ * @brief A combination of the four pipeline policies.
+ */
+template <typename Comparator, typename Diff, typename Analysis,
+          typename Sink>
+struct MergePolicy {
+  using comparator_type = Comparator;
+  using diff_type = Diff;
+  using analysis_type = Analysis;
+  using sink_type = Sink;
+};
+
+// Byte-exact merges, the common case behind three_way_merge()
+using ExactMergePolicy =
+    MergePolicy<ExactLines, OptionsDiff, OptionsAnalysis, ResultSink>;
+// Merges under options.compare
+using EquivalentMergePolicy =
+    MergePolicy<EquivalentLines, OptionsDiff, OptionsAnalysis, ResultSink>;
+// Merged text only: AUTO diff, no analysis
+using TextMergePolicy =
+    MergePolicy<ExactLines, FixedDiff<DiffAlgorithm::AUTO>,
+                FixedAnalysis<AnalysisLevel::NONE>, ResultSink>;
+// Chunks of a streaming merge
+using ExactStreamPolicy =
+    MergePolicy<ExactLines, OptionsDiff, OptionsAnalysis, StreamSink>;
+using EquivalentStreamPolicy =
+    MergePolicy<EquivalentLines, OptionsDiff, OptionsAnalysis, StreamSink>;
+using TextStreamPolicy =
+    MergePolicy<ExactLines, FixedDiff<DiffAlgorithm::AUTO>,
+                FixedAnalysis<AnalysisLevel::NONE>, StreamSink>;
+
+/**
+ * @brief Checks whether options fix what the text policies do: exact
+ *        comparison, the AUTO diff and no analysis.
+ */
+inline bool is_text_merge(const MergeOptions &options) {
+  return options.compare.exact() && !options.compare.ignore_blank_lines &&
+         options.algorithm == DiffAlgorithm::AUTO &&
+         options.analysis == AnalysisLevel::NONE;
+}
+
+/**
+ * @brief Three-way merge specialized for a policy.
+ *
+ * Same algorithm and output as three_way_merge(), with the comparison,
+ * diff algorithm and analysis level taken from the policy where it fixes
+ * them and from @p options otherwise.
+ *
+ * @param base The common ancestor version
+ * @param ours Our version
+ * @param theirs Their version
+ * @param options Merge options
+ * @param sink Receives the merged lines and the conflicts
+ */
+template <typename Policy>
+void merge_with_policy(const std::vector<std::string_view> &base,
+                       const std::vector<std::string_view> &ours,
+                       const std::vector<std::string_view> &theirs,
+                       const MergeOptions &options,
+                       typename Policy::sink_type &sink);
+
+extern template void merge_with_policy<ExactMergePolicy>(
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &, const MergeOptions &,
+    ResultSink &);
+extern template void merge_with_policy<EquivalentMergePolicy>(
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &, const MergeOptions &,
+    ResultSink &);
+extern template void merge_with_policy<TextMergePolicy>(
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &, const MergeOptions &,
+    ResultSink &);
+extern template void merge_with_policy<ExactStreamPolicy>(
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &, const MergeOptions &,
+    StreamSink &);
+extern template void merge_with_policy<EquivalentStreamPolicy>(
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &, const MergeOptions &,
+    StreamSink &);
+extern template void merge_with_policy<TextStreamPolicy>(
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &, const MergeOptions &,
+    StreamSink &);
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_MERGE_POLICY_H
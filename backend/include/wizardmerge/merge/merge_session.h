@@ -0,0 +1,130 @@
+/**
+ * @file merge_session.h
+ * @brief Incremental three-way merge for interactive editing
+ *
+ * A MergeSession keeps the three versions of a file and their merge, cut
+ * into chunks at anchor lines (see anchors.h) that merge independently.
+ * An edit to ours, theirs or a conflict of the result re-merges and
+ * re-analyzes only the chunks it touches; every other chunk keeps its
+ * merged lines and conflict analysis, so the cost of an edit depends on
+ * the size of the chunks involved rather than on the file length.
+ */
+
+#ifndef WIZARDMERGE_MERGE_MERGE_SESSION_H
+#define WIZARDMERGE_MERGE_MERGE_SESSION_H
+
+#include "wizardmerge/merge/three_way_merge.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace wizardmerge {
+namespace merge {
+
+// Minimum number of base lines per chunk; chunks are cut at the first
+// anchor past it
+constexpr size_t SESSION_CHUNK_LINES = 256;
+
+/**
+ * @brief Which text an edit applies to.
+ */
+enum class EditTarget {
+  OURS,   // Lines of our version
+  THEIRS, // Lines of their version
+  RESULT  // Lines of the merged result
+};
+
+/**
+ * @brief Three-way merge kept up to date under edits.
+ */
+class MergeSession {
+public:
+  /**
+   * @brief Merges the three versions.
+   *
+   * Chunks are merged in parallel (on options.pool, if given) when
+   * options.threads is not 1.
+   * Conflicts are analyzed up to options.analysis.
+   *
+   * @param base The common ancestor version
+   * @param ours Our version
+   * @param theirs Their version
+   * @param options Merge options used for the whole session
+   */
+  MergeSession(std::vector<std::string> base, std::vector<std::string> ours,
+               std::vector<std::string> theirs,
+               const MergeOptions &options = MergeOptions());
+
+  /**
+   * @brief Replaces lines [begin, end) of a text and updates the merge.
+   *
+   * Edits to ours or theirs may cover any valid range. A RESULT edit
+   * resolves a conflict: the range must be exactly the lines of one
+   * conflict in result() (markers included), and both sides take the new
+   * lines there so that the region merges cleanly to them.
+   *
+   * @param target Text the range refers to
+   * @param begin First line replaced
+   * @param end One past the last line replaced (begin == end inserts)
+   * @param lines Replacement lines
+   * @return false if the range is invalid; nothing is changed then
+   */
+  bool apply_edit(EditTarget target, size_t begin, size_t end,
+                  const std::vector<std::string> &lines);
+
+  /**
+   * @brief Assembles the current merge result.
+   *
+   * Line numbers and ranges are absolute. This copies every chunk, so it
+   * is linear in the file length.
+   *
+   * @param alloc Memory resource for the result
+   */
+  MergeResult
+  result(const MergeResult::allocator_type &alloc = {}) const;
+
+  const std::vector<std::string> &base() const { return base_; }
+  const std::vector<std::string> &ours() const { return ours_; }
+  const std::vector<std::string> &theirs() const { return theirs_; }
+
+  /**
+   * @brief Number of chunks the merge is cut into.
+   */
+  size_t chunk_count() const { return chunks_.size(); }
+
+  /**
+   * @brief Input lines (base + ours + theirs) merged again by the last
+   *        edit, or by the constructor.
+   */
+  size_t remerged_lines() const { return remerged_lines_; }
+
+private:
+  struct Chunk {
+    LineRange base;
+    LineRange ours;
+    LineRange theirs;
+    // ours.begin when the conflicts were analyzed, to rebase the line
+    // numbers of the context after edits above the chunk
+    size_t analyzed_ours_begin = 0;
+    // Merge of the chunk alone; lines and ranges relative to the chunk
+    MergeResult result;
+  };
+
+  std::vector<Chunk> build_chunks(const Chunk &span) const;
+  void merge_chunk(Chunk &chunk) const;
+  void remerge(size_t first, size_t last, std::ptrdiff_t ours_delta,
+               std::ptrdiff_t theirs_delta);
+  size_t chunk_at(LineRange Chunk::*side, size_t line) const;
+
+  std::vector<std::string> base_;
+  std::vector<std::string> ours_;
+  std::vector<std::string> theirs_;
+  MergeOptions options_;
+  std::vector<Chunk> chunks_;
+  size_t remerged_lines_;
+};
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_MERGE_SESSION_H
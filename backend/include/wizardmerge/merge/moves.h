@@ -0,0 +1,64 @@
+/**
+ * @file moves.h
+ * @brief Detection of blocks of lines moved between base and one side
+ *
+ * A line diff sees a moved block as a deletion at the old place and an
+ * insertion at the new one. Pairing the two lets the merge carry the
+ * other side's edits to the block along to its new place, instead of
+ * reporting a delete/modify conflict and keeping a stale copy.
+ */
+
+#ifndef WIZARDMERGE_MERGE_MOVES_H
+#define WIZARDMERGE_MERGE_MOVES_H
+
+#include "wizardmerge/merge/diff.h"
+#include <cstddef>
+#include <vector>
+
+namespace wizardmerge {
+namespace merge {
+
+// Shortest block reported as moved; also the shingle length of the index
+constexpr size_t MOVE_MIN_LINES = 3;
+
+/**
+ * @brief A block of base lines that one side deleted and inserted again,
+ *        unchanged, elsewhere.
+ */
+struct BlockMove {
+  size_t base_begin;
+  size_t base_end;
+  // Where the block starts in the other version
+  size_t other_begin;
+
+  size_t size() const { return base_end - base_begin; }
+};
+
+/**
+ * @brief Finds the blocks a diff deleted in one place and inserted in
+ *        another.
+ *
+ * The k-line shingles of the deleted base lines (k = @p min_lines) are
+ * indexed by a rolling hash; the inserted lines are then scanned with the
+ * same rolling hash, and every verified hit is extended to the longest
+ * block still inside both the deletion and the insertion. Both passes are
+ * linear in the changed lines. A base line is part of at most one move.
+ * Pure insertions and deletions are first slid down as far as the diff
+ * allows, so the blocks do not depend on where the diff placed them
+ * among repeated lines.
+ *
+ * @param base_ids Base line IDs
+ * @param other_ids Other line IDs
+ * @param hunks Diff of base against other
+ * @param min_lines Shortest block reported
+ * @return Moves in ascending order of other_begin
+ */
+std::vector<BlockMove> find_moves(const std::vector<LineId> &base_ids,
+                                  const std::vector<LineId> &other_ids,
+                                  const std::vector<DiffHunk> &hunks,
+                                  size_t min_lines = MOVE_MIN_LINES);
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_MOVES_H
@@ -0,0 +1,107 @@
+/**
+ * @file nway_merge.h
+ * @brief Merging several branches into a common base at once (octopus)
+ *
+ * Chaining three_way_merge() over N branches diffs the base N - 1 times
+ * and feeds each intermediate result, conflict markers included, into the
+ * next merge. nway_merge() interns the base once, diffs every branch
+ * against it and aligns the N edit scripts in a single sweep, so a region
+ * is resolved or reported once with all the branches that touched it.
+ */
+
+#ifndef WIZARDMERGE_MERGE_NWAY_MERGE_H
+#define WIZARDMERGE_MERGE_NWAY_MERGE_H
+
+#include "wizardmerge/merge/three_way_merge.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wizardmerge {
+namespace merge {
+
+/**
+ * @brief One distinct version of a conflicting region.
+ *
+ * Branches that made the same change share a side.
+ */
+struct NWaySide {
+  // Indices of the branches with this content, ascending
+  std::vector<size_t> branches;
+  // Lines of the first of them
+  LineRange range;
+  std::vector<Line> lines;
+};
+
+/**
+ * @brief A region two or more branches changed differently.
+ */
+struct NWayConflict {
+  // Lines of the merged result, from the "<<<<<<<" line to the ">>>>>>>"
+  // line (inclusive)
+  size_t start_line = 0;
+  size_t end_line = 0;
+  LineRange base_range;
+  std::vector<Line> base_lines;
+  // One side per distinct change, in order of the first branch; branches
+  // that left the region unchanged take no part
+  std::vector<NWaySide> sides;
+};
+
+/**
+ * @brief Result of an N-way merge.
+ */
+struct NWayMergeResult {
+  std::vector<Line> merged_lines;
+  std::vector<NWayConflict> conflicts;
+  bool has_conflicts() const { return !conflicts.empty(); }
+};
+
+/**
+ * @brief Merges any number of branches of a common base.
+ *
+ * Lines every version shares at the start and end of the file are copied
+ * without being interned. The rest of the base is interned once, each
+ * branch is diffed against it (on options.pool, or a pool of its own, when
+ * options.threads asks for more than one thread), and the hunks of all
+ * branches are walked together in base order through a heap of per-branch
+ * cursors: hunks that overlap in base, or insert at the same base
+ * position, form one region, as in diff3_regions(). The sweep thus costs
+ * O(H log N) for H hunks in total, independent of the file size.
+ *
+ * A region changed by one branch, or identically by all branches that
+ * changed it, takes that change. Otherwise it becomes a conflict with one
+ * side per distinct change; conflicts at most CONFLICT_MERGE_GAP lines
+ * apart are combined. Unchanged regions are copied from the first branch,
+ * so under options.compare they keep its form of equivalent lines.
+ *
+ * Markers follow git's: "<<<<<<< name" opens the first side, "|||||||"
+ * and options.base_label the base lines (options.show_base), "=======" each
+ * further side and ">>>>>>> name" closes the last one. With more than two
+ * sides the separators carry the names of their side as well; a side
+ * several branches share is named "a, b". Lines take the origin OURS from
+ * the first branch and THEIRS from the others.
+ *
+ * options.algorithm, compare, show_base, base_label, threads and
+ * diff_memory_budget apply; compare.ignore_blank_lines, refinement,
+ * analysis and move detection are three-way only.
+ *
+ * @param base Common ancestor
+ * @param branches Versions to merge; with two, named "OURS" and "THEIRS",
+ *        the merged lines match three_way_merge() without refinement
+ * @param names Branch names for the markers; missing ones are replaced by
+ *        "branch <index>"
+ * @param options Merge options
+ * @return Merged lines and conflicts
+ */
+NWayMergeResult
+nway_merge(const std::vector<std::string_view> &base,
+           const std::vector<std::vector<std::string_view>> &branches,
+           const std::vector<std::string> &names,
+           const MergeOptions &options = MergeOptions());
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_NWAY_MERGE_H
@@ -0,0 +1,80 @@
+/**
+ * @file recursive_merge.h
+ * @brief Recursive merges over histories with several merge bases
+ *
+ * In a criss-cross history ours and theirs have more than one merge base,
+ * and merging against any one of them reports the changes of the others
+ * as conflicts. The recursive strategy (git's "recursive" and "ort")
+ * merges the bases into a virtual ancestor first, recursing when the
+ * bases themselves have several merge bases, and then merges ours and
+ * theirs against it.
+ */
+
+#ifndef WIZARDMERGE_MERGE_RECURSIVE_MERGE_H
+#define WIZARDMERGE_MERGE_RECURSIVE_MERGE_H
+
+#include "wizardmerge/merge/three_way_merge.h"
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace wizardmerge {
+namespace merge {
+
+/**
+ * @brief One revision of a file in a history.
+ *
+ * A history is a vector of revisions that refer to their parents by
+ * index; it must be acyclic. The lines are views whose text must outlive
+ * the merge.
+ */
+struct Revision {
+  std::vector<std::string_view> lines;
+  std::vector<size_t> parents;
+};
+
+/**
+ * @brief Finds the merge bases of two revisions.
+ *
+ * Merge bases are the common ancestors (a revision counts as its own
+ * ancestor) that are not ancestors of another common ancestor.
+ *
+ * @param history Revisions and their parents
+ * @param a Index of one revision
+ * @param b Index of the other
+ * @return Indices of the merge bases, ascending; empty if the revisions
+ *         share no history
+ */
+std::vector<size_t> merge_bases(const std::vector<Revision> &history,
+                                size_t a, size_t b);
+
+/**
+ * @brief Merges two revisions with the recursive strategy.
+ *
+ * With one merge base this is three_way_merge() against it. With several,
+ * they are merged pairwise into a virtual ancestor, each pair against its
+ * own merge bases (recursively; an empty file when there are none), and
+ * ours and theirs are merged against that. Conflicts inside the virtual
+ * ancestor stay in it with markers two characters longer per level, as in
+ * git, so they conflict again only where ours or theirs touch them.
+ *
+ * Every revision is interned once into a table shared by the whole
+ * recursion; virtual ancestors take the IDs of the lines they copy, and
+ * each base→revision diff is computed once and reused wherever the
+ * recursion needs it again. The merges of the bases skip refinement and
+ * analysis; options apply in full to the final merge.
+ *
+ * @param history Revisions and their parents
+ * @param ours Index of our revision
+ * @param theirs Index of their revision
+ * @param options Merge options
+ * @return Result of the final merge
+ */
+MergeResult recursive_merge(const std::vector<Revision> &history, size_t ours,
+                            size_t theirs,
+                            const MergeOptions &options = MergeOptions());
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_RECURSIVE_MERGE_H
@@ -0,0 +1,83 @@
+/**
+ * @file refine.h
+ * @brief Token-level refinement of conflicting hunks
+ *
+ * A line-level conflict often hides edits that do not overlap at all,
+ * such as two sides renaming different arguments of one call. Refinement
+ * splits the hunk into tokens, diffs the tokens with the linear-space
+ * Myers algorithm and runs diff3 on them: the hunk is merged when no token
+ * region conflicts, and otherwise the changed tokens of each side are
+ * reported for highlighting. Only conflicting hunks are tokenized, so the
+ * cost follows the size of the conflicts, not of the file.
+ */
+
+#ifndef WIZARDMERGE_MERGE_REFINE_H
+#define WIZARDMERGE_MERGE_REFINE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wizardmerge {
+namespace merge {
+
+/**
+ * @brief Hunks with more tokens than this on any side are not refined.
+ */
+constexpr size_t REFINE_MAX_TOKENS = 65536;
+
+/**
+ * @brief Byte range [begin, end) within one line of a conflict side.
+ */
+struct TokenSpan {
+  size_t line; // Index into the side's lines
+  size_t begin;
+  size_t end;
+};
+
+/**
+ * @brief Outcome of refining one conflicting hunk.
+ */
+struct Refinement {
+  bool resolved = false;
+  // Merged hunk, when resolved
+  std::vector<std::string> merged_lines;
+  // Tokens each side changed relative to base (insertions and
+  // replacements; pure deletions have no span on that side)
+  std::vector<TokenSpan> our_changes;
+  std::vector<TokenSpan> their_changes;
+};
+
+/**
+ * @brief Splits a line into tokens.
+ *
+ * Tokens are maximal runs of word characters (letters, digits, '_' and
+ * non-ASCII bytes), maximal runs of spaces, tabs and '\r', and single
+ * punctuation characters. Concatenating the tokens gives the line back.
+ *
+ * @param line Line to split
+ * @return Views into @p line
+ */
+std::vector<std::string_view> tokenize(std::string_view line);
+
+/**
+ * @brief Refines a conflicting hunk at token level.
+ *
+ * Line breaks are tokens too, so edits that join or split lines merge
+ * like any other.
+ *
+ * @param base Base lines of the hunk
+ * @param ours Our lines of the hunk
+ * @param theirs Their lines of the hunk
+ * @return The merged hunk, or the spans of each side's changes; an
+ *         unresolved, span-less result for hunks over REFINE_MAX_TOKENS
+ */
+Refinement refine_conflict(const std::vector<std::string_view> &base,
+                           const std::vector<std::string_view> &ours,
+                           const std::vector<std::string_view> &theirs);
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_REFINE_H
@@ -0,0 +1,186 @@
+/**
+ * @file result_codec.h
+ * @brief Compact binary encoding of MergeResult
+ *
+ * A merge result is encoded as one flat, versioned buffer that the server,
+ * the CLI and any cache can pass around as-is. Every section is sized up
+ * front and 8-byte aligned, so encoding is one allocation plus memcpys and
+ * a MergeResultView reads lines and conflicts straight out of the buffer
+ * (or a memory-mapped file) without copying.
+ *
+ * Layout (integers are little-endian u64 unless noted):
+ * - Header: "WZMR", u32 version, total size, line count, conflict count,
+ *   string count, token span count
+ * - String offsets: string count + 1 byte offsets into the string blob
+ * - Conflict records: CONFLICT_RECORD_FIELDS integers per conflict; lines,
+ *   token spans and analysis strings are (first, count) runs into the
+ *   string and span tables
+ * - Token spans: (line, begin, end) per span
+ * - Origins: one byte per string, padded to 8 bytes
+ * - String blob: the bytes of every string, padded to 8 bytes
+ *
+ * Strings 0 .. line count - 1 are the merged lines; conflict lines and
+ * analysis strings follow.
+ */
+
+#ifndef WIZARDMERGE_MERGE_RESULT_CODEC_H
+#define WIZARDMERGE_MERGE_RESULT_CODEC_H
+
+#include "wizardmerge/merge/three_way_merge.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace wizardmerge {
+namespace merge {
+
+// Bumped whenever the layout changes; older versions are rejected
+constexpr uint32_t RESULT_FORMAT_VERSION = 1;
+
+// Media type the server answers with when a client accepts it
+constexpr const char *RESULT_MEDIA_TYPE =
+    "application/vnd.wizardmerge.merge-result";
+
+// Integers per encoded conflict
+constexpr size_t CONFLICT_RECORD_FIELDS = 50;
+
+/**
+ * @brief Encodes a merge result.
+ *
+ * @param result Result to encode, analysis included
+ * @param out Receives the encoding; its capacity is reused
+ */
+void encode_merge_result(const MergeResult &result, std::string &out);
+
+/**
+ * @brief Encodes a merge result into a new buffer.
+ */
+std::string encode_merge_result(const MergeResult &result);
+
+class MergeResultView;
+
+/**
+ * @brief Consecutive strings of an encoded result, e.g. a conflict side.
+ */
+class LineRun {
+public:
+  LineRun() = default;
+  LineRun(const MergeResultView *view, size_t first, size_t count)
+      : view_(view), first_(first), count_(count) {}
+
+  size_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+  std::string_view operator[](size_t i) const;
+  Line::Origin origin(size_t i) const;
+
+private:
+  const MergeResultView *view_ = nullptr;
+  size_t first_ = 0;
+  size_t count_ = 0;
+};
+
+/**
+ * @brief One conflict of an encoded result.
+ *
+ * Lines and token spans are read in place; decode() materializes the
+ * whole conflict, analysis included.
+ */
+class ConflictView {
+public:
+  ConflictView(const MergeResultView *view, const unsigned char *record)
+      : view_(view), record_(record) {}
+
+  size_t start_line() const;
+  size_t end_line() const;
+  LineRange base_range() const;
+  LineRange our_range() const;
+  LineRange their_range() const;
+  AnalysisLevel analysis() const;
+
+  LineRun base_lines() const;
+  LineRun our_lines() const;
+  LineRun their_lines() const;
+
+  size_t our_change_count() const;
+  TokenSpan our_change(size_t i) const;
+  size_t their_change_count() const;
+  TokenSpan their_change(size_t i) const;
+
+  /**
+   * @brief Copies the conflict out of the buffer.
+   *
+   * @param conflict Overwritten; keeps its allocator
+   */
+  void decode(Conflict &conflict) const;
+
+private:
+  uint64_t field(size_t index) const;
+  LineRun run(size_t index) const;
+
+  const MergeResultView *view_;
+  const unsigned char *record_;
+};
+
+/**
+ * @brief Read-only view of an encoded merge result.
+ *
+ * open() checks the header, the section bounds and every offset and run
+ * once; the accessors then read without further checks. The view does
+ * not own the buffer, which must outlive it.
+ */
+class MergeResultView {
+public:
+  /**
+   * @brief Validates @p data and points the view at it.
+   *
+   * @return false if the buffer is truncated, corrupt or of another
+   *         format version; the view is then empty
+   */
+  bool open(std::string_view data);
+
+  size_t line_count() const { return line_count_; }
+  std::string_view line(size_t i) const { return string(i); }
+  Line::Origin origin(size_t i) const {
+    return static_cast<Line::Origin>(origins_[i]);
+  }
+  LineRun lines() const { return LineRun(this, 0, line_count_); }
+
+  size_t conflict_count() const { return conflict_count_; }
+  ConflictView conflict(size_t i) const;
+  bool has_conflicts() const { return conflict_count_ != 0; }
+
+  /**
+   * @brief Copies the whole result out of the buffer.
+   *
+   * @param result Overwritten; keeps its allocator
+   */
+  void decode(MergeResult &result) const;
+
+  // Raw tables, for LineRun and ConflictView
+  std::string_view string(size_t i) const;
+  TokenSpan span(size_t i) const;
+
+private:
+  size_t line_count_ = 0;
+  size_t conflict_count_ = 0;
+  const unsigned char *offsets_ = nullptr;
+  const unsigned char *conflicts_ = nullptr;
+  const unsigned char *spans_ = nullptr;
+  const unsigned char *origins_ = nullptr;
+  const char *blob_ = nullptr;
+};
+
+/**
+ * @brief Decodes an encoded merge result.
+ *
+ * @param data Encoded result
+ * @param result Overwritten on success; keeps its allocator
+ * @return false if @p data does not hold a valid encoding
+ */
+bool decode_merge_result(std::string_view data, MergeResult &result);
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_RESULT_CODEC_H
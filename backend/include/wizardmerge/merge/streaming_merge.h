@@ -0,0 +1,100 @@
+/**
+ * @file streaming_merge.h
+ * @brief Bounded-memory three-way merge over input streams
+ *
+ * Reads base, ours and theirs in windows of lines, cuts all three at a
+ * sync point (a line unique in each window, consistent with the other
+ * anchors) and merges the chunk before it with three_way_merge. Merged
+ * lines and conflicts are handed to a sink as each chunk completes, so
+ * memory is bounded by the window and hunk size, not the file size.
+ */
+
+#ifndef WIZARDMERGE_MERGE_STREAMING_MERGE_H
+#define WIZARDMERGE_MERGE_STREAMING_MERGE_H
+
+#include "wizardmerge/merge/three_way_merge.h"
+#include <cstddef>
+#include <istream>
+#include <string_view>
+
+namespace wizardmerge {
+namespace merge {
+
+/**
+ * @brief Receives the output of a streaming merge incrementally.
+ */
+class MergeSink {
+public:
+  virtual ~MergeSink() = default;
+
+  /**
+   * @brief Receives the next line of merged output.
+   *
+   * Conflict markers are delivered as MERGED lines, as in MergeResult.
+   *
+   * @param content Line content (valid only during the call)
+   * @param origin Where the line came from
+   */
+  virtual void write_line(std::string_view content, Line::Origin origin) = 0;
+
+  /**
+   * @brief Receives a conflict after all of its lines were written.
+   *
+   * start_line and end_line are absolute output line numbers. The input
+   * chunk is gone afterwards, so any analysis must be requested up front
+   * through MergeOptions::analysis.
+   *
+   * @param conflict The conflict (valid only during the call)
+   */
+  virtual void write_conflict(const Conflict &conflict) = 0;
+};
+
+/**
+ * @brief Tuning knobs for a streaming merge.
+ */
+struct StreamingOptions {
+  MergeOptions merge;
+  // Lines read ahead from each input before looking for a sync point
+  size_t window_lines = 16384;
+  // Largest window grown to when no sync point is found; past it the
+  // windows are merged as they are
+  size_t max_window_lines = 4194304;
+};
+
+/**
+ * @brief Counters describing a finished streaming merge.
+ */
+struct StreamingStats {
+  size_t lines_written = 0;
+  size_t conflicts = 0;
+  size_t chunks = 0;
+  size_t peak_window_lines = 0;
+};
+
+/**
+ * @brief Merges three input streams into a sink with bounded memory.
+ *
+ * Lines are read with std::getline semantics. The output equals that of
+ * three_way_merge on the whole files whenever the chosen sync points are
+ * stable in the whole-file merge, which holds for lines that are unique
+ * in the files; conflict analysis only sees the surrounding chunk, and
+ * conflicts on either side of a sync point are never combined.
+ * Reading stops at end of stream or on a stream error; check the streams
+ * afterwards to tell the two apart.
+ *
+ * @param base The common ancestor version
+ * @param ours Our version (current branch)
+ * @param theirs Their version (branch being merged)
+ * @param sink Receives merged lines and conflicts
+ * @param options Window sizes and merge options
+ * @return Counters for the merge
+ */
+StreamingStats
+streaming_three_way_merge(std::istream &base, std::istream &ours,
+                          std::istream &theirs, MergeSink &sink,
+                          const StreamingOptions &options = StreamingOptions());
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_STREAMING_MERGE_H
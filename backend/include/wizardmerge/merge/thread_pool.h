@@ -0,0 +1,107 @@
+/**
+ * @file thread_pool.h
+ * @brief Work-stealing thread pool for the parallel merge
+ *
+ * Each worker owns a task deque: it pops its own newest task and, when
+ * empty, steals the oldest task of another worker. Threads waiting for a
+ * batch run queued tasks themselves, so batches may be nested (a task can
+ * start its own parallel_for) without deadlocking.
+ */
+
+#ifndef WIZARDMERGE_MERGE_THREAD_POOL_H
+#define WIZARDMERGE_MERGE_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wizardmerge {
+namespace merge {
+
+/**
+ * @brief Resolves a requested thread count.
+ *
+ * @param threads Requested count; 0 means one per hardware thread
+ * @return Number of threads to use (at least 1)
+ */
+size_t resolve_thread_count(size_t threads);
+
+/**
+ * @brief Fixed-size pool of worker threads with work stealing.
+ */
+class ThreadPool {
+public:
+  /**
+   * @brief Starts the pool.
+   *
+   * The thread calling parallel_for takes part in the work, so a pool of
+   * N threads starts N - 1 workers; a pool of 1 runs everything inline.
+   *
+   * @param threads Total threads; 0 means one per hardware thread
+   */
+  explicit ThreadPool(size_t threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * @brief Total threads running tasks, including the caller.
+   */
+  size_t size() const { return workers_.size() + 1; }
+
+  /**
+   * @brief Runs fn(0) ... fn(count - 1) in parallel and waits for them.
+   *
+   * If any call throws, the remaining calls still run and the first
+   * exception is rethrown once all have finished.
+   *
+   * @param count Number of indices
+   * @param fn Callable invoked with each index
+   */
+  template <typename Fn> void parallel_for(size_t count, Fn &&fn) {
+    std::function<void(size_t)> body(std::forward<Fn>(fn));
+    run_batch(count, body);
+  }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  void run_batch(size_t count, const std::function<void(size_t)> &body);
+  void push(std::function<void()> task);
+  bool pop(std::function<void()> &task);
+  void worker_loop(size_t index);
+
+  std::vector<std::unique_ptr<Queue>> queues_; // One per worker
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> next_queue_;
+
+  std::mutex mutex_;
+  std::condition_variable work_cv_; // Signalled when tasks are queued
+  std::condition_variable done_cv_; // Signalled when a task finishes
+  size_t queued_;
+  bool stopping_;
+};
+
+/**
+ * @brief Process-wide pool with one thread per hardware thread.
+ *
+ * Started on first use and shared by callers that merge repeatedly, such
+ * as the server's request handlers, so that each request does not start
+ * and join threads of its own. Concurrent parallel_for calls are safe.
+ */
+ThreadPool &shared_thread_pool();
+
+} // namespace merge
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_MERGE_THREAD_POOL_H
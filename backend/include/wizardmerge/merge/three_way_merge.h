@@ -12,31 +12,230 @@
 
 #include "wizardmerge/analysis/context_analyzer.h"
 #include "wizardmerge/analysis/risk_analyzer.h"
+#include "wizardmerge/merge/diff.h"
+#include "wizardmerge/merge/refine.h"
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace wizardmerge {
 namespace merge {
 
+/**
+ * @brief Text of a merged line.
+ *
+ * A std::pmr::string that also converts to, is assigned from and compares
+ * with std::string, so that code written when Line::content was a
+ * std::string keeps compiling.
+ */
+class LineText : public std::pmr::string {
+public:
+  using std::pmr::string::basic_string;
+  using std::pmr::string::operator=;
+
+  LineText() = default;
+  LineText(const LineText &) = default;
+  LineText(LineText &&) = default;
+  LineText(const LineText &other, const allocator_type &alloc)
+      : std::pmr::string(other, alloc) {}
+  LineText(LineText &&other, const allocator_type &alloc)
+      : std::pmr::string(std::move(other), alloc) {}
+  LineText(const std::string &text,
+           const allocator_type &alloc = allocator_type())
+      : std::pmr::string(text.data(), text.size(), alloc) {}
+  LineText &operator=(const LineText &) = default;
+  LineText &operator=(LineText &&) = default;
+  LineText &operator=(const std::string &text) {
+    assign(text.data(), text.size());
+    return *this;
+  }
+
+  operator std::string() const { return std::string(data(), size()); }
+};
+
+template <typename T, typename = std::enable_if_t<
+                          std::is_convertible_v<const T &, std::string_view>>>
+bool operator==(const LineText &a, const T &b) {
+  return std::string_view(a) == std::string_view(b);
+}
+
+template <typename T, typename = std::enable_if_t<
+                          std::is_convertible_v<const T &, std::string_view> &&
+                          !std::is_same_v<T, LineText>>>
+bool operator==(const T &a, const LineText &b) {
+  return b == a;
+}
+
+template <typename T, typename = std::enable_if_t<
+                          std::is_convertible_v<const T &, std::string_view>>>
+bool operator!=(const LineText &a, const T &b) {
+  return !(a == b);
+}
+
+template <typename T, typename = std::enable_if_t<
+                          std::is_convertible_v<const T &, std::string_view> &&
+                          !std::is_same_v<T, LineText>>>
+bool operator!=(const T &a, const LineText &b) {
+  return !(b == a);
+}
+
+/**
+ * @brief Lines or conflicts of a merge result.
+ *
+ * A std::pmr::vector that also converts to and is assigned from
+ * std::vector, as the members were before. Converted lines are copied to
+ * the default resource, so they outlive an arena the result lived in.
+ */
+template <typename T> class ResultVector : public std::pmr::vector<T> {
+  using Base = std::pmr::vector<T>;
+
+public:
+  using allocator_type = typename Base::allocator_type;
+  using Base::Base;
+  using Base::operator=;
+
+  ResultVector() = default;
+  ResultVector(const ResultVector &) = default;
+  ResultVector(ResultVector &&) = default;
+  ResultVector(const ResultVector &other, const allocator_type &alloc)
+      : Base(other, alloc) {}
+  ResultVector(ResultVector &&other, const allocator_type &alloc)
+      : Base(std::move(other), alloc) {}
+  ResultVector(const std::vector<T> &other,
+               const allocator_type &alloc = allocator_type())
+      : Base(other.begin(), other.end(), alloc) {}
+  ResultVector &operator=(const ResultVector &) = default;
+  ResultVector &operator=(ResultVector &&) = default;
+  ResultVector &operator=(const std::vector<T> &other) {
+    this->assign(other.begin(), other.end());
+    return *this;
+  }
+
+  operator std::vector<T>() const {
+    return std::vector<T>(this->begin(), this->end());
+  }
+};
+
 /**
  * @brief Represents a single line in a file with its origin.
+ *
+ * Line, Conflict and MergeResult are allocator-aware (std::pmr): a result
+ * built with an allocator places every line, conflict and analysis string
+ * in that allocator's memory resource, so a per-request arena can release
+ * a whole merge at once.
  */
 struct Line {
-  std::string content;
-  enum Origin { BASE, OURS, THEIRS, MERGED } origin;
+  using allocator_type = std::pmr::polymorphic_allocator<char>;
+  enum Origin { BASE, OURS, THEIRS, MERGED };
+
+  Line() : Line(allocator_type()) {}
+  explicit Line(const allocator_type &alloc) : content(alloc), origin(BASE) {}
+  Line(std::string_view content, Origin origin,
+       const allocator_type &alloc = allocator_type())
+      : content(content, alloc), origin(origin) {}
+  Line(const Line &other, const allocator_type &alloc)
+      : content(other.content, alloc), origin(other.origin) {}
+  Line(Line &&other, const allocator_type &alloc)
+      : content(std::move(other.content), alloc), origin(other.origin) {}
+  Line(const Line &) = default;
+  Line(Line &&) = default;
+  Line &operator=(const Line &) = default;
+  Line &operator=(Line &&) = default;
+
+  allocator_type get_allocator() const { return content.get_allocator(); }
+
+  LineText content;
+  Origin origin;
+};
+
+/**
+ * @brief How much analysis a conflict carries.
+ *
+ * Levels are cumulative: FULL includes the context.
+ */
+enum class AnalysisLevel {
+  NONE,    // Conflict lines only
+  CONTEXT, // Plus the code context (Conflict::context)
+  FULL     // Plus the three risk assessments
+};
+
+/**
+ * @brief Half-open line range [begin, end) in one of the merge inputs.
+ */
+struct LineRange {
+  size_t begin = 0;
+  size_t end = 0;
 };
 
 /**
  * @brief Represents a conflict region in the merge result.
+ *
+ * The ranges and analysis level form a handle for deferred analysis:
+ * analyze_conflict() fills in context and risks on demand from the merge
+ * inputs and remembers what it computed.
  */
 struct Conflict {
+  using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+  Conflict() : Conflict(allocator_type()) {}
+  explicit Conflict(const allocator_type &alloc)
+      : start_line(0), end_line(0), base_lines(alloc), our_lines(alloc),
+        their_lines(alloc), our_changes(alloc), their_changes(alloc),
+        analysis(AnalysisLevel::NONE), context(alloc), risk_ours(alloc),
+        risk_theirs(alloc), risk_both(alloc) {}
+  Conflict(const Conflict &other, const allocator_type &alloc)
+      : start_line(other.start_line), end_line(other.end_line),
+        base_lines(other.base_lines, alloc),
+        our_lines(other.our_lines, alloc),
+        their_lines(other.their_lines, alloc),
+        our_changes(other.our_changes, alloc),
+        their_changes(other.their_changes, alloc),
+        base_range(other.base_range), our_range(other.our_range),
+        their_range(other.their_range), analysis(other.analysis),
+        context(other.context, alloc),
+        risk_ours(other.risk_ours, alloc),
+        risk_theirs(other.risk_theirs, alloc),
+        risk_both(other.risk_both, alloc) {}
+  Conflict(Conflict &&other, const allocator_type &alloc)
+      : start_line(other.start_line), end_line(other.end_line),
+        base_lines(std::move(other.base_lines), alloc),
+        our_lines(std::move(other.our_lines), alloc),
+        their_lines(std::move(other.their_lines), alloc),
+        our_changes(std::move(other.our_changes), alloc),
+        their_changes(std::move(other.their_changes), alloc),
+        base_range(other.base_range), our_range(other.our_range),
+        their_range(other.their_range), analysis(other.analysis),
+        context(std::move(other.context), alloc),
+        risk_ours(std::move(other.risk_ours), alloc),
+        risk_theirs(std::move(other.risk_theirs), alloc),
+        risk_both(std::move(other.risk_both), alloc) {}
+  Conflict(const Conflict &) = default;
+  Conflict(Conflict &&) = default;
+  Conflict &operator=(const Conflict &) = default;
+  Conflict &operator=(Conflict &&) = default;
+
+  allocator_type get_allocator() const { return base_lines.get_allocator(); }
+
   size_t start_line;
   size_t end_line;
-  std::vector<Line> base_lines;
-  std::vector<Line> our_lines;
-  std::vector<Line> their_lines;
+  ResultVector<Line> base_lines;
+  ResultVector<Line> our_lines;
+  ResultVector<Line> their_lines;
+
+  // Tokens each side changed relative to base, indexed into our_lines and
+  // their_lines (filled when MergeOptions::refine_conflicts is set)
+  std::pmr::vector<TokenSpan> our_changes;
+  std::pmr::vector<TokenSpan> their_changes;
 
-  // Context and risk analysis
+  // Lines of the merge inputs the conflict was built from
+  LineRange base_range;
+  LineRange our_range;
+  LineRange their_range;
+
+  // Context and risk analysis, valid up to the given level
+  AnalysisLevel analysis;
   analysis::CodeContext context;
   analysis::RiskAssessment risk_ours;
   analysis::RiskAssessment risk_theirs;
@@ -47,11 +246,85 @@ struct Conflict {
  * @brief Result of a three-way merge operation.
  */
 struct MergeResult {
-  std::vector<Line> merged_lines;
-  std::vector<Conflict> conflicts;
+  using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+  MergeResult() : MergeResult(allocator_type()) {}
+  explicit MergeResult(const allocator_type &alloc)
+      : merged_lines(alloc), conflicts(alloc) {}
+  MergeResult(const MergeResult &other, const allocator_type &alloc)
+      : merged_lines(other.merged_lines, alloc),
+        conflicts(other.conflicts, alloc) {}
+  MergeResult(MergeResult &&other, const allocator_type &alloc)
+      : merged_lines(std::move(other.merged_lines), alloc),
+        conflicts(std::move(other.conflicts), alloc) {}
+  MergeResult(const MergeResult &) = default;
+  MergeResult(MergeResult &&) = default;
+  MergeResult &operator=(const MergeResult &) = default;
+  MergeResult &operator=(MergeResult &&) = default;
+
+  allocator_type get_allocator() const {
+    return merged_lines.get_allocator();
+  }
+
+  ResultVector<Line> merged_lines;
+  ResultVector<Conflict> conflicts;
   bool has_conflicts() const { return !conflicts.empty(); }
 };
 
+/**
+ * @brief Base lines per partition of a parallel merge.
+ *
+ * Partitions end at the first anchor (see find_anchors) at least this many
+ * base lines after the previous cut. The cuts do not depend on the thread
+ * count, so every parallel merge of the same inputs gives the same result.
+ */
+constexpr size_t PARALLEL_PARTITION_LINES = 4096;
+
+/**
+ * @brief Conflicts separated by at most this many unchanged lines are
+ *        reported as one conflict (as git does).
+ */
+constexpr size_t CONFLICT_MERGE_GAP = 3;
+
+/**
+ * @brief Tuning knobs for a three-way merge.
+ */
+class ThreadPool;
+
+struct MergeOptions {
+  DiffAlgorithm algorithm = DiffAlgorithm::AUTO;
+  // Threads used for diffing and conflict analysis: 1 runs serially,
+  // 0 uses one per hardware thread
+  size_t threads = 1;
+  // Pool the parallel work runs on (its size then replaces threads), e.g.
+  // shared_thread_pool(); without one, each merge that needs a pool
+  // starts and joins its own
+  ThreadPool *pool = nullptr;
+  // Re-diff conflicting hunks token by token (see refine_conflict):
+  // non-overlapping intra-line edits are merged, other conflicts get
+  // token spans
+  bool refine_conflicts = false;
+  // Show the base lines between "||||||| BASE" and "=======" in conflict
+  // markers (git's diff3 conflict style)
+  bool show_base = false;
+  // Text after the conflict markers, e.g. git's "HEAD" and a branch name
+  std::string our_label = "OURS";
+  std::string base_label = "BASE";
+  std::string their_label = "THEIRS";
+  // Analysis run for every conflict during the merge; anything beyond it
+  // can still be requested per conflict with analyze_conflict()
+  AnalysisLevel analysis = AnalysisLevel::FULL;
+  // Bytes each Myers search may spend on its trace before the range is
+  // split in linear space (see DIFF_MEMORY_BUDGET)
+  size_t diff_memory_budget = DIFF_MEMORY_BUDGET;
+  // Line equivalences the diff runs under (git's -Xignore-* options).
+  // Regions where the sides differ only by them are stable and keep ours.
+  CompareOptions compare;
+  // Detect blocks one side moved (see find_moves) and carry the other
+  // side's edits to them along to the new place
+  bool detect_moves = false;
+};
+
 /**
  * @brief Performs a three-way merge on three versions of content.
  *
@@ -60,14 +333,114 @@ struct MergeResult {
  * merged result with conflict markers where automatic resolution is
  * not possible.
  *
+ * Both variants are diffed against the base (diff3). Regions touched by
+ * only one side take that side's lines; regions where the two edit
+ * scripts overlap become a single conflict unless both sides made the
+ * same change.
+ *
+ * Lines all three versions share at the start and end of the file are
+ * emitted as stable without being interned or diffed, so a small edit to
+ * a large file costs little more than copying it to the result.
+ *
+ * Conflicts follow git's hunk layout: conflicts separated by no more than
+ * CONFLICT_MERGE_GAP unchanged lines are reported as one, and lines both
+ * sides agree on at the start or end of a conflict are moved out of it
+ * (unless options.show_base is set, since the base section still covers
+ * them). Each conflict is analyzed once, up to options.analysis.
+ *
+ * With options.refine_conflicts, a conflict whose edits do not overlap at
+ * token level is merged instead (its lines are MERGED).
+ *
+ * With options.compare, lines are interned by their normalized form, so
+ * both diffs run in that equivalence: a side that only reindented a
+ * region, say, leaves it stable, and stable lines are taken from ours.
+ * Under compare.ignore_blank_lines blank lines are left out of the diffs
+ * and follow ours wherever they fall between changes.
+ *
+ * With options.detect_moves, a block one side moved and the other edited
+ * is merged at its new place with the edits applied, rather than as a
+ * delete/modify conflict next to a stale copy. The conflict ranges still
+ * refer to the inputs.
+ *
+ * With options.threads != 1 the inputs are cut into partitions at anchor
+ * lines, the partitions are diffed on a work-stealing thread pool
+ * (options.pool, if given) and the conflicts are analyzed in parallel. The result differs from the serial
+ * merge only where the whole-file diff would not have aligned the anchors.
+ *
  * @param base The common ancestor version
  * @param ours Our version (current branch)
  * @param theirs Their version (branch being merged)
+ * @param options Merge options (diff algorithm, threads, refinement)
+ * @param alloc Allocator for the result, e.g. a per-request
+ *              std::pmr::monotonic_buffer_resource
  * @return MergeResult containing the merged content and any conflicts
  */
 MergeResult three_way_merge(const std::vector<std::string> &base,
                             const std::vector<std::string> &ours,
-                            const std::vector<std::string> &theirs);
+                            const std::vector<std::string> &theirs,
+                            const MergeOptions &options = MergeOptions(),
+                            const MergeResult::allocator_type &alloc = {});
+
+/**
+ * @brief Performs a three-way merge on views of the three versions.
+ *
+ * The input lines are never copied; only the lines written to the result
+ * are. Pair with text::TextBuffer to merge files without materializing
+ * a string per line.
+ *
+ * @param base The common ancestor version
+ * @param ours Our version (current branch)
+ * @param theirs Their version (branch being merged)
+ * @param options Merge options (diff algorithm, threads, refinement)
+ * @param alloc Allocator for the result
+ * @return MergeResult containing the merged content and any conflicts
+ */
+MergeResult three_way_merge(const std::vector<std::string_view> &base,
+                            const std::vector<std::string_view> &ours,
+                            const std::vector<std::string_view> &theirs,
+                            const MergeOptions &options = MergeOptions(),
+                            const MergeResult::allocator_type &alloc = {});
+
+/**
+ * @brief Runs the analysis of a conflict up to @p level, on demand.
+ *
+ * Only the parts not computed yet run, so repeated calls are free. The
+ * inputs must be the ones the conflict was merged from. Results use the
+ * conflict's allocator. Not thread-safe for a single conflict.
+ *
+ * @param conflict Conflict from a three_way_merge of these inputs
+ * @param base The common ancestor version
+ * @param ours Our version
+ * @param theirs Their version
+ * @param level Analysis wanted
+ */
+void analyze_conflict(Conflict &conflict,
+                      const std::vector<std::string> &base,
+                      const std::vector<std::string> &ours,
+                      const std::vector<std::string> &theirs,
+                      AnalysisLevel level = AnalysisLevel::FULL);
+void analyze_conflict(Conflict &conflict,
+                      const std::vector<std::string_view> &base,
+                      const std::vector<std::string_view> &ours,
+                      const std::vector<std::string_view> &theirs,
+                      AnalysisLevel level = AnalysisLevel::FULL);
+
+/**
+ * @brief Converts AnalysisLevel to string representation.
+ *
+ * @param level Level to convert
+ * @return "none", "context" or "full"
+ */
+std::string analysis_level_to_string(AnalysisLevel level);
+
+/**
+ * @brief Parses an analysis level name.
+ *
+ * @param name Level name ("none", "context", "full")
+ * @param level Output level
+ * @return true if the name is recognized, false otherwise
+ */
+bool parse_analysis_level(const std::string &name, AnalysisLevel &level);
 
 /**
  * @brief Auto-resolves simple non-conflicting patterns.
@@ -78,7 +451,8 @@ MergeResult three_way_merge(const std::vector<std::string> &base,
  * - Whitespace-only differences
  *
  * @param result The merge result to auto-resolve
- * @return Updated merge result with resolved conflicts
+ * @return Updated merge result with resolved conflicts, using the same
+ *         allocator as @p result
  */
 MergeResult auto_resolve(const MergeResult &result);
 
@@ -0,0 +1,103 @@
+/**
+ * @file normalize.h
+ * @brief Encoding and line-ending normalization of merge inputs
+ *
+ * Versions of a file that differ only in their line endings (CRLF vs LF),
+ * their byte order mark or their Unicode encoding would otherwise differ
+ * on every line. Inputs are normalized to UTF-8 with LF line endings and
+ * no BOM before merging, and the merged text is converted back to the
+ * format of the version it replaces.
+ */
+
+#ifndef WIZARDMERGE_TEXT_NORMALIZE_H
+#define WIZARDMERGE_TEXT_NORMALIZE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wizardmerge {
+namespace text {
+
+/**
+ * @brief Unicode encoding of a text file.
+ */
+enum class TextEncoding { UTF8, UTF16LE, UTF16BE };
+
+/**
+ * @brief Line separator of a text file.
+ */
+enum class LineEnding { LF, CRLF };
+
+/**
+ * @brief How a file was stored before normalization.
+ */
+struct TextFormat {
+  TextEncoding encoding = TextEncoding::UTF8;
+  bool bom = false;
+  // Ending of the first line; files that mix endings are restored with it
+  LineEnding line_ending = LineEnding::LF;
+  // Whether the normalized text differs from the stored bytes
+  bool converted = false;
+};
+
+/**
+ * @brief Converts text to UTF-8 with LF line endings and no BOM.
+ *
+ * The encoding comes from the BOM or, without one, from the NUL bytes
+ * UTF-16 has in every other position. The content is then converted in a
+ * single pass: UTF-8 runs of ASCII without carriage returns are skipped a
+ * vector register at a time (skip_plain_ascii()), everything else is
+ * validated as it is copied, and a carriage return before a line feed is
+ * dropped. A lone carriage return is content.
+ *
+ * @param data Stored bytes of the file
+ * @param out Receives the normalized text if @p format says it was
+ *        converted; otherwise @p data already is the normalized text and
+ *        @p out is left empty
+ * @param format Receives the stored format
+ * @return false if the content is not well-formed text in its encoding
+ *         (including NUL characters); @p out and @p format are then
+ *         unspecified
+ */
+bool normalize_text(std::string_view data, std::string &out,
+                    TextFormat &format);
+
+/**
+ * @brief Normalizes UTF-8 text that arrives already split into lines.
+ *
+ * For lines without their text, e.g. the arrays of a JSON request: a
+ * UTF-8 BOM is cut from the first line and a carriage return ending a
+ * line is taken as its line ending and cut too, in place on the views.
+ *
+ * @param lines Lines to normalize
+ * @param format Receives the stored format; the encoding is UTF-8
+ */
+void normalize_lines(std::vector<std::string_view> &lines,
+                     TextFormat &format);
+
+/**
+ * @brief Converts normalized text back to a stored format.
+ *
+ * Line feeds become the format's line ending, and the text is encoded and
+ * given a BOM as the format says. Malformed UTF-8 in @p text is encoded
+ * as U+FFFD when converting to UTF-16.
+ *
+ * @param text UTF-8 text with LF line endings
+ * @param format Format to restore
+ * @param out Receives the stored bytes
+ */
+void restore_text(std::string_view text, const TextFormat &format,
+                  std::string &out);
+
+/**
+ * @brief Converts TextEncoding to string representation.
+ *
+ * @return "utf-8", "utf-16le" or "utf-16be"
+ */
+const char *text_encoding_to_string(TextEncoding encoding);
+
+} // namespace text
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_TEXT_NORMALIZE_H
@@ -0,0 +1,126 @@
+/**
+ * @file text_buffer.h
+ * @brief Zero-copy file representation for merge inputs
+ *
+ * A TextBuffer owns the bytes of one file in a single contiguous block,
+ * either memory-mapped from disk or moved in from a received string, plus
+ * an index of line start offsets. Lines are handed out as string views,
+ * so loading a file costs one pass and no per-line allocation.
+ */
+
+#ifndef WIZARDMERGE_TEXT_TEXT_BUFFER_H
+#define WIZARDMERGE_TEXT_TEXT_BUFFER_H
+
+#include "wizardmerge/text/normalize.h"
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wizardmerge {
+namespace text {
+
+/**
+ * @brief One file's content plus a line-offset index.
+ *
+ * Line splitting follows std::getline: lines are separated by '\n', the
+ * newline is not part of the line, and a trailing newline does not start
+ * an extra empty line. Views returned by a buffer stay valid for the
+ * lifetime of the buffer (moving the buffer keeps them valid).
+ */
+class TextBuffer {
+public:
+  TextBuffer();
+  ~TextBuffer();
+
+  TextBuffer(TextBuffer &&other) noexcept;
+  TextBuffer &operator=(TextBuffer &&other) noexcept;
+  TextBuffer(const TextBuffer &) = delete;
+  TextBuffer &operator=(const TextBuffer &) = delete;
+
+  /**
+   * @brief Loads a file, memory-mapping it where the platform allows.
+   *
+   * @param path Path to the file
+   * @return The buffer, or std::nullopt if the file cannot be read
+   */
+  static std::optional<TextBuffer> from_file(const std::string &path);
+
+  /**
+   * @brief Takes ownership of already received content.
+   *
+   * @param content File content (moved, not copied)
+   * @return The indexed buffer
+   */
+  static TextBuffer from_string(std::string content);
+
+  /**
+   * @brief Normalizes the content to UTF-8 with LF line endings.
+   *
+   * See normalize_text(). Content that is already normalized keeps its
+   * memory mapping; anything else is replaced by an owned, converted copy
+   * and re-indexed, which invalidates earlier views.
+   *
+   * @param format Receives the stored format, for restore_text()
+   * @return false if the content is not text; it is then left unchanged
+   */
+  bool normalize(TextFormat &format);
+
+  /**
+   * @brief Raw bytes of the file.
+   */
+  std::string_view data() const { return std::string_view(data_, size_); }
+
+  /**
+   * @brief Number of lines in the file.
+   */
+  size_t line_count() const {
+    return offsets_.empty() ? 0 : offsets_.size() - 1;
+  }
+
+  /**
+   * @brief Returns one line, without its newline.
+   *
+   * @param index Zero-based line number (must be < line_count())
+   */
+  std::string_view line(size_t index) const {
+    return std::string_view(data_ + offsets_[index],
+                            offsets_[index + 1] - offsets_[index] - 1);
+  }
+
+  /**
+   * @brief Returns views of all lines, for the string_view merge APIs.
+   */
+  std::vector<std::string_view> lines() const;
+
+  /**
+   * @brief Whether the content is a memory mapping rather than owned heap.
+   */
+  bool is_mapped() const { return mapping_ != nullptr; }
+
+private:
+  void index_lines();
+  void release();
+
+  std::string owned_;
+  const char *data_;
+  size_t size_;
+  void *mapping_;
+  // Start of every line plus a sentinel one past the final newline
+  std::vector<size_t> offsets_;
+};
+
+/**
+ * @brief Views a vector of owned lines without copying them.
+ *
+ * @param lines Lines to view (must outlive the result)
+ * @return One view per line
+ */
+std::vector<std::string_view>
+to_line_views(const std::vector<std::string> &lines);
+
+} // namespace text
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_TEXT_TEXT_BUFFER_H
@@ -0,0 +1,194 @@
+/**
+ * @file text_kernels.h
+ * @brief Vectorized text kernels with runtime CPU dispatch
+ *
+ * Low-level routines used by the merge engine and the analyzers for line
+ * splitting, hashing and (whitespace-insensitive) comparison. Each kernel
+ * has a scalar implementation and, on x86, SSE4.2 and AVX2 variants that
+ * are selected once at runtime from the CPU's capabilities. All variants
+ * return identical results.
+ */
+
+#ifndef WIZARDMERGE_TEXT_TEXT_KERNELS_H
+#define WIZARDMERGE_TEXT_TEXT_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace wizardmerge {
+namespace text {
+
+/**
+ * @brief Instruction set used by the kernels.
+ */
+enum class SimdLevel {
+  SCALAR, // Portable fallback
+  SSE42,  // 16-byte SSE4.2 kernels
+  AVX2    // 32-byte AVX2 kernels
+};
+
+/**
+ * @brief Returns the best instruction set supported by this CPU.
+ */
+SimdLevel detect_simd_level();
+
+/**
+ * @brief Returns the instruction set the kernels currently dispatch to.
+ */
+SimdLevel active_simd_level();
+
+/**
+ * @brief Forces the kernels onto a given instruction set.
+ *
+ * Levels the CPU does not support are clamped to the detected level.
+ * Intended for tests and benchmarks.
+ *
+ * @param level Requested instruction set
+ * @return The level actually selected
+ */
+SimdLevel set_simd_level(SimdLevel level);
+
+/**
+ * @brief Converts SimdLevel to string representation.
+ *
+ * @param level Level to convert
+ * @return "scalar", "sse4.2" or "avx2"
+ */
+const char *simd_level_to_string(SimdLevel level);
+
+/**
+ * @brief Finds the first occurrence of a byte.
+ *
+ * @param data Bytes to scan
+ * @param byte Byte to look for
+ * @param from Position to start scanning at
+ * @return Position of the byte, or data.size() if absent
+ */
+size_t find_byte(std::string_view data, char byte, size_t from = 0);
+
+/**
+ * @brief Finds the first occurrence of a byte that starts a line.
+ *
+ * A line starts at offset 0 and after every '\n'. The vector variants test
+ * a register of bytes against @p byte and the preceding bytes against
+ * '\n' at once, so a byte that is common mid-line costs nothing extra.
+ *
+ * @param data Bytes to scan
+ * @param byte Byte to look for
+ * @param from Position to start scanning at
+ * @return Position of the byte, or data.size() if absent
+ */
+size_t find_line_start(std::string_view data, char byte, size_t from = 0);
+
+/**
+ * @brief Splits text into lines without copying.
+ *
+ * Lines are separated by '\n'; a trailing newline does not start an extra
+ * empty line, matching std::getline. Carriage returns are kept.
+ *
+ * @param data Text to split
+ * @return Views into @p data, one per line
+ */
+std::vector<std::string_view> split_lines(std::string_view data);
+
+/**
+ * @brief Computes a 64-bit hash of a byte string.
+ *
+ * Short inputs use a multiply-mix hash (wyhash family); long inputs are
+ * accumulated over 32-byte stripes in four lanes (xxh3 family), which the
+ * SIMD variants process in parallel.
+ *
+ * @param data Bytes to hash
+ * @return 64-bit hash value
+ */
+uint64_t hash_bytes(std::string_view data);
+
+/**
+ * @brief Compares two byte strings for exact equality.
+ */
+bool bytes_equal(std::string_view a, std::string_view b);
+
+/**
+ * @brief Bytes looks_binary() inspects by default, as git does.
+ */
+constexpr size_t BINARY_SCAN_BYTES = 8000;
+
+/**
+ * @brief Checks whether content is binary rather than UTF-8 text.
+ *
+ * Only the first @p scan_bytes are inspected. Content is binary if that
+ * prefix has a NUL byte or is not well-formed UTF-8 (overlong forms,
+ * surrogates and code points past U+10FFFF are malformed). A multi-byte
+ * sequence cut off by the end of the scan window is not an error. ASCII
+ * runs are skipped a vector register at a time.
+ *
+ * @param data Content to inspect
+ * @param scan_bytes Length of the prefix to inspect
+ * @return true if the content should not be merged as text
+ */
+bool looks_binary(std::string_view data,
+                  size_t scan_bytes = BINARY_SCAN_BYTES);
+
+/**
+ * @brief Skips plain ASCII text, stopping where text normalization has
+ *        work to do.
+ *
+ * @param data Bytes to scan
+ * @param from Position to start scanning at
+ * @return Position of the first NUL, carriage return or non-ASCII byte,
+ *         or data.size() if there is none
+ */
+size_t skip_plain_ascii(std::string_view data, size_t from = 0);
+
+/**
+ * @brief Returns the length of the UTF-8 sequence starting at a position.
+ *
+ * Applies the same rules as looks_binary(): NUL bytes, overlong forms,
+ * surrogates and code points past U+10FFFF are malformed.
+ *
+ * @param data Bytes holding the sequence
+ * @param pos Position of its lead byte (must be < data.size())
+ * @return 1 to 4, or 0 if the sequence is malformed or cut off by the end
+ *         of @p data
+ */
+size_t utf8_sequence_length(std::string_view data, size_t pos);
+
+/**
+ * @brief Checks if a byte is whitespace (space, tab, CR or LF).
+ */
+inline bool is_whitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/**
+ * @brief Returns the view without leading and trailing whitespace.
+ */
+std::string_view trim_whitespace(std::string_view data);
+
+/**
+ * @brief Checks if a line consists only of whitespace.
+ */
+bool is_blank(std::string_view data);
+
+/**
+ * @brief Compares two lines ignoring leading and trailing whitespace.
+ *
+ * Equivalent to comparing the trimmed strings, without allocating them.
+ */
+bool equal_ignore_surrounding_whitespace(std::string_view a,
+                                         std::string_view b);
+
+/**
+ * @brief Compares two lines ignoring all whitespace.
+ *
+ * Whitespace is skipped in place; blocks without whitespace are compared
+ * a full vector register at a time.
+ */
+bool equal_ignore_all_whitespace(std::string_view a, std::string_view b);
+
+} // namespace text
+} // namespace wizardmerge
+
+#endif // WIZARDMERGE_TEXT_TEXT_KERNELS_H
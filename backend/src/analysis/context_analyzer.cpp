@@ -4,8 +4,10 @@
  */
 
 #include "wizardmerge/analysis/context_analyzer.h"
+#include "wizardmerge/text/text_kernels.h"
 #include <algorithm>
 #include <regex>
+#include <string_view>
 
 namespace wizardmerge {
 namespace analysis {
@@ -15,25 +17,39 @@ namespace {
 // Maximum number of lines to scan for imports (imports typically at file top)
 constexpr size_t IMPORT_SCAN_LIMIT = 50;
 
+using text::trim_whitespace;
+
 /**
- * @brief Trim whitespace from string.
+ * @brief Run a regex search over a string view without copying it.
  */
-std::string trim(const std::string &str) {
-  size_t start = str.find_first_not_of(" \t\n\r");
-  size_t end = str.find_last_not_of(" \t\n\r");
-  if (start == std::string::npos)
-    return "";
-  return str.substr(start, end - start + 1);
+bool regex_search_view(std::string_view str, const std::regex &pattern) {
+  return std::regex_search(str.data(), str.data() + str.size(), pattern);
+}
+
+/**
+ * @brief Run a regex search over a string view, capturing groups.
+ */
+bool regex_search_view(std::string_view str, std::cmatch &match,
+                       const std::regex &pattern) {
+  return std::regex_search(str.data(), str.data() + str.size(), match,
+                           pattern);
 }
 
 /**
  * @brief Check if a line is a function definition.
  */
-bool is_function_definition(const std::string &line) {
-  std::string trimmed = trim(line);
+bool is_function_definition(std::string_view line) {
+  std::string_view trimmed = trim_whitespace(line);
+
+  // Every pattern needs a parameter list or the function keyword; skip
+  // the regex engine (which allocates per search) on all other lines
+  if (trimmed.find('(') == std::string_view::npos &&
+      trimmed.find("function") == std::string_view::npos) {
+    return false;
+  }
 
-  // Common function patterns across languages
-  std::vector<std::regex> patterns = {
+  // Common function patterns across languages, compiled once
+  static const std::vector<std::regex> patterns = {
       std::regex(
           R"(^\w+\s+\w+\s*\([^)]*\)\s*\{?)"),   // C/C++/Java: type name(params)
       std::regex(R"(^def\s+\w+\s*\([^)]*\):)"), // Python: def name(params):
@@ -54,7 +70,7 @@ bool is_function_definition(const std::string &line) {
   };
 
   for (const auto &pattern : patterns) {
-    if (std::regex_search(trimmed, pattern)) {
+    if (regex_search_view(trimmed, pattern)) {
       return true;
     }
   }
@@ -62,39 +78,47 @@ bool is_function_definition(const std::string &line) {
   return false;
 }
 
+/**
+ * @brief View a regex capture group; it points into the searched line.
+ */
+std::string_view capture_view(const std::csub_match &group) {
+  return std::string_view(group.first, static_cast<size_t>(group.length()));
+}
+
 /**
  * @brief Extract function name from a function definition line.
  */
-std::string get_function_name_from_line(const std::string &line) {
-  std::string trimmed = trim(line);
+std::string_view get_function_name_from_line(std::string_view line) {
+  std::string_view trimmed = trim_whitespace(line);
 
   // Try to extract function name using regex
-  std::smatch match;
+  std::cmatch match;
 
   // Python: def function_name(
-  std::regex py_pattern(R"(def\s+(\w+)\s*\()");
-  if (std::regex_search(trimmed, match, py_pattern)) {
-    return match[1].str();
+  static const std::regex py_pattern(R"(def\s+(\w+)\s*\()");
+  if (regex_search_view(trimmed, match, py_pattern)) {
+    return capture_view(match[1]);
   }
 
   // JavaScript/TypeScript: function function_name( or export function
   // function_name(
-  std::regex js_pattern(R"((?:export\s+)?(?:async\s+)?function\s+(\w+)\s*\()");
-  if (std::regex_search(trimmed, match, js_pattern)) {
-    return match[1].str();
+  static const std::regex js_pattern(
+      R"((?:export\s+)?(?:async\s+)?function\s+(\w+)\s*\()");
+  if (regex_search_view(trimmed, match, js_pattern)) {
+    return capture_view(match[1]);
   }
 
   // TypeScript: const/let/var function_name = (params) =>
-  std::regex arrow_pattern(
+  static const std::regex arrow_pattern(
       R"((?:const|let|var)\s+(\w+)\s*=\s*(?:async\s+)?\([^)]*\)\s*=>)");
-  if (std::regex_search(trimmed, match, arrow_pattern)) {
-    return match[1].str();
+  if (regex_search_view(trimmed, match, arrow_pattern)) {
+    return capture_view(match[1]);
   }
 
   // C/C++/Java: type function_name(
-  std::regex cpp_pattern(R"(\w+\s+(\w+)\s*\()");
-  if (std::regex_search(trimmed, match, cpp_pattern)) {
-    return match[1].str();
+  static const std::regex cpp_pattern(R"(\w+\s+(\w+)\s*\()");
+  if (regex_search_view(trimmed, match, cpp_pattern)) {
+    return capture_view(match[1]);
   }
 
   return "";
@@ -103,10 +127,19 @@ std::string get_function_name_from_line(const std::string &line) {
 /**
  * @brief Check if a line is a class definition.
  */
-bool is_class_definition(const std::string &line) {
-  std::string trimmed = trim(line);
+bool is_class_definition(std::string_view line) {
+  std::string_view trimmed = trim_whitespace(line);
+
+  // Every pattern needs one of these keywords
+  if (trimmed.find("class") == std::string_view::npos &&
+      trimmed.find("struct") == std::string_view::npos &&
+      trimmed.find("interface") == std::string_view::npos &&
+      trimmed.find("type") == std::string_view::npos &&
+      trimmed.find("enum") == std::string_view::npos) {
+    return false;
+  }
 
-  std::vector<std::regex> patterns = {
+  static const std::vector<std::regex> patterns = {
       std::regex(R"(^class\s+\w+)"), // Python/C++/Java: class Name
       std::regex(R"(^(public|private)?\s*class\s+\w+)"), // Java/C#: visibility
                                                          // class Name
@@ -120,7 +153,7 @@ bool is_class_definition(const std::string &line) {
   };
 
   for (const auto &pattern : patterns) {
-    if (std::regex_search(trimmed, pattern)) {
+    if (regex_search_view(trimmed, pattern)) {
       return true;
     }
   }
@@ -131,59 +164,30 @@ bool is_class_definition(const std::string &line) {
 /**
  * @brief Extract class name from a class definition line.
  */
-std::string get_class_name_from_line(const std::string &line) {
-  std::string trimmed = trim(line);
+std::string_view get_class_name_from_line(std::string_view line) {
+  std::string_view trimmed = trim_whitespace(line);
 
-  std::smatch match;
+  std::cmatch match;
 
   // Match class, struct, interface, type, or enum
-  std::regex pattern(
+  static const std::regex pattern(
       R"((?:export\s+)?(?:abstract\s+)?(class|struct|interface|type|enum)\s+(\w+))");
 
-  if (std::regex_search(trimmed, match, pattern)) {
-    return match[2].str();
+  if (regex_search_view(trimmed, match, pattern)) {
+    return capture_view(match[2]);
   }
 
   return "";
 }
 
-} // anonymous namespace
-
-CodeContext analyze_context(const std::vector<std::string> &lines,
-                            size_t start_line, size_t end_line,
-                            size_t context_window) {
-  CodeContext context;
-  context.start_line = start_line;
-  context.end_line = end_line;
-
-  // Extract surrounding lines
-  size_t window_start =
-      (start_line >= context_window) ? (start_line - context_window) : 0;
-  size_t window_end = std::min(end_line + context_window, lines.size());
-
-  for (size_t i = window_start; i < window_end; ++i) {
-    context.surrounding_lines.push_back(lines[i]);
-  }
-
-  // Extract function name
-  context.function_name = extract_function_name(lines, start_line);
-
-  // Extract class name
-  context.class_name = extract_class_name(lines, start_line);
-
-  // Extract imports
-  context.imports = extract_imports(lines);
-
-  // Add metadata
-  context.metadata["context_window_start"] = std::to_string(window_start);
-  context.metadata["context_window_end"] = std::to_string(window_end);
-  context.metadata["total_lines"] = std::to_string(lines.size());
-
-  return context;
-}
+/*
+ * The public entry points accept both owned lines and views into a
+ * TextBuffer; they share one implementation templated on the container.
+ */
 
-std::string extract_function_name(const std::vector<std::string> &lines,
-                                  size_t line_number) {
+template <typename Lines>
+std::string_view extract_function_name_impl(const Lines &lines,
+                                           size_t line_number) {
   if (line_number >= lines.size()) {
     return "";
   }
@@ -200,7 +204,7 @@ std::string extract_function_name(const std::vector<std::string> &lines,
     }
 
     // Stop searching if we hit a class definition or another function
-    std::string trimmed = trim(lines[i]);
+    std::string_view trimmed = trim_whitespace(lines[i]);
     if (trimmed.find("class ") == 0 || trimmed.find("struct ") == 0) {
       break;
     }
@@ -209,8 +213,9 @@ std::string extract_function_name(const std::vector<std::string> &lines,
   return "";
 }
 
-std::string extract_class_name(const std::vector<std::string> &lines,
-                               size_t line_number) {
+template <typename Lines>
+std::string_view extract_class_name_impl(const Lines &lines,
+                                        size_t line_number) {
   if (line_number >= lines.size()) {
     return "";
   }
@@ -218,7 +223,7 @@ std::string extract_class_name(const std::vector<std::string> &lines,
   // Search backwards for class definition
   int brace_count = 0;
   for (int i = static_cast<int>(line_number); i >= 0; --i) {
-    std::string line = lines[i];
+    std::string_view line = lines[i];
 
     // Count braces to track scope
     brace_count += std::count(line.begin(), line.end(), '}');
@@ -232,28 +237,113 @@ std::string extract_class_name(const std::vector<std::string> &lines,
   return "";
 }
 
-std::vector<std::string>
-extract_imports(const std::vector<std::string> &lines) {
-  std::vector<std::string> imports;
-
+template <typename Lines, typename Out>
+void extract_imports_impl(const Lines &lines, Out &imports) {
   // Scan first lines for imports (imports are typically at the top)
   size_t scan_limit = std::min(lines.size(), IMPORT_SCAN_LIMIT);
 
   for (size_t i = 0; i < scan_limit; ++i) {
-    std::string line = trim(lines[i]);
+    std::string_view line = trim_whitespace(lines[i]);
 
     // Check for various import patterns
     if (line.find("#include") == 0 || line.find("import ") == 0 ||
         line.find("import{") == 0 || // Support both "import{" and "import {"
-        line.find("from ") == 0 || line.find("require(") != std::string::npos ||
+        line.find("from ") == 0 ||
+        line.find("require(") != std::string_view::npos ||
         line.find("using ") == 0 ||
         // TypeScript/ES6 specific patterns
         line.find("import *") == 0 || line.find("import type") == 0 ||
         line.find("export {") == 0 || line.find("export *") == 0) {
-      imports.push_back(line);
+      imports.emplace_back(line);
     }
   }
+}
+
+template <typename Lines>
+CodeContext analyze_context_impl(const Lines &lines, size_t start_line,
+                                 size_t end_line, size_t context_window,
+                                 const CodeContext::allocator_type &alloc) {
+  CodeContext context(alloc);
+  context.start_line = start_line;
+  context.end_line = end_line;
+
+  // Extract surrounding lines
+  size_t window_start =
+      (start_line >= context_window) ? (start_line - context_window) : 0;
+  size_t window_end = std::min(end_line + context_window, lines.size());
+
+  context.surrounding_lines.reserve(window_end - window_start);
+  for (size_t i = window_start; i < window_end; ++i) {
+    context.surrounding_lines.emplace_back(lines[i]);
+  }
+
+  // Extract function name
+  context.function_name = extract_function_name_impl(lines, start_line);
+
+  // Extract class name
+  context.class_name = extract_class_name_impl(lines, start_line);
+
+  // Extract imports
+  extract_imports_impl(lines, context.imports);
+
+  // Add metadata
+  context.metadata.emplace("context_window_start",
+                           std::to_string(window_start));
+  context.metadata.emplace("context_window_end", std::to_string(window_end));
+  context.metadata.emplace("total_lines", std::to_string(lines.size()));
+
+  return context;
+}
+
+} // anonymous namespace
+
+CodeContext analyze_context(const std::vector<std::string> &lines,
+                            size_t start_line, size_t end_line,
+                            size_t context_window,
+                            const CodeContext::allocator_type &alloc) {
+  return analyze_context_impl(lines, start_line, end_line, context_window,
+                              alloc);
+}
 
+CodeContext analyze_context(const std::vector<std::string_view> &lines,
+                            size_t start_line, size_t end_line,
+                            size_t context_window,
+                            const CodeContext::allocator_type &alloc) {
+  return analyze_context_impl(lines, start_line, end_line, context_window,
+                              alloc);
+}
+
+std::string extract_function_name(const std::vector<std::string> &lines,
+                                  size_t line_number) {
+  return std::string(extract_function_name_impl(lines, line_number));
+}
+
+std::string extract_function_name(const std::vector<std::string_view> &lines,
+                                  size_t line_number) {
+  return std::string(extract_function_name_impl(lines, line_number));
+}
+
+std::string extract_class_name(const std::vector<std::string> &lines,
+                               size_t line_number) {
+  return std::string(extract_class_name_impl(lines, line_number));
+}
+
+std::string extract_class_name(const std::vector<std::string_view> &lines,
+                               size_t line_number) {
+  return std::string(extract_class_name_impl(lines, line_number));
+}
+
+std::vector<std::string>
+extract_imports(const std::vector<std::string> &lines) {
+  std::vector<std::string> imports;
+  extract_imports_impl(lines, imports);
+  return imports;
+}
+
+std::vector<std::string>
+extract_imports(const std::vector<std::string_view> &lines) {
+  std::vector<std::string> imports;
+  extract_imports_impl(lines, imports);
   return imports;
 }
 
@@ -4,9 +4,13 @@
  */
 
 #include "wizardmerge/analysis/risk_analyzer.h"
+#include "wizardmerge/merge/bit_lcs.h"
+#include "wizardmerge/text/text_buffer.h"
+#include "wizardmerge/text/text_kernels.h"
 #include <algorithm>
 #include <cmath>
 #include <regex>
+#include <string_view>
 
 namespace wizardmerge {
 namespace analysis {
@@ -18,22 +22,31 @@ constexpr double BASE_CONFIDENCE = 0.5;     // Base confidence level
 constexpr double SIMILARITY_WEIGHT = 0.3;   // Weight for code similarity
 constexpr double CHANGE_RATIO_WEIGHT = 0.2; // Weight for change ratio
 
+using text::trim_whitespace;
+
 /**
- * @brief Trim whitespace from string.
+ * @brief Run a regex search over a string view without copying it.
  */
-std::string trim(const std::string &str) {
-  size_t start = str.find_first_not_of(" \t\n\r");
-  size_t end = str.find_last_not_of(" \t\n\r");
-  if (start == std::string::npos)
-    return "";
-  return str.substr(start, end - start + 1);
+bool regex_search_view(std::string_view str, const std::regex &pattern) {
+  return std::regex_search(str.data(), str.data() + str.size(), pattern);
 }
 
+/**
+ * @brief A regex plus a literal every match contains.
+ *
+ * std::regex allocates on each search; checking the literal first keeps
+ * the engine off lines that cannot match.
+ */
+struct GuardedPattern {
+  std::string_view literal;
+  std::regex regex;
+};
+
 /**
  * @brief Calculate similarity score between two sets of lines (0.0 to 1.0).
  */
-double calculate_similarity(const std::vector<std::string> &lines1,
-                            const std::vector<std::string> &lines2) {
+double calculate_similarity(const std::vector<std::string_view> &lines1,
+                            const std::vector<std::string_view> &lines2) {
   if (lines1.empty() && lines2.empty())
     return 1.0;
   if (lines1.empty() || lines2.empty())
@@ -54,15 +67,24 @@ double calculate_similarity(const std::vector<std::string> &lines1,
 
 /**
  * @brief Count number of changed lines between two versions.
+ *
+ * Lines outside a longest common subsequence, so an inserted line does not
+ * count every line after it as changed. Inputs too large for the
+ * bit-parallel LCS are compared line by line instead.
  */
-size_t count_changes(const std::vector<std::string> &base,
-                     const std::vector<std::string> &modified) {
+size_t count_changes(const std::vector<std::string_view> &base,
+                     const std::vector<std::string_view> &modified) {
+  if (base.size() * modified.size() <= merge::BIT_LCS_MAX_CELLS) {
+    return std::max(base.size(), modified.size()) -
+           merge::lcs_length(base, modified);
+  }
+
   size_t changes = 0;
   size_t max_len = std::max(base.size(), modified.size());
 
   for (size_t i = 0; i < max_len; ++i) {
-    std::string base_line = (i < base.size()) ? base[i] : "";
-    std::string mod_line = (i < modified.size()) ? modified[i] : "";
+    std::string_view base_line = (i < base.size()) ? base[i] : "";
+    std::string_view mod_line = (i < modified.size()) ? modified[i] : "";
 
     if (base_line != mod_line) {
       changes++;
@@ -75,10 +97,16 @@ size_t count_changes(const std::vector<std::string> &base,
 /**
  * @brief Check if line contains function or method definition.
  */
-bool is_function_signature(const std::string &line) {
-  std::string trimmed = trim(line);
+bool is_function_signature(std::string_view line) {
+  std::string_view trimmed = trim_whitespace(line);
+
+  // Every pattern needs a parameter list; skip the regex engine otherwise
+  if (trimmed.find('(') == std::string_view::npos) {
+    return false;
+  }
 
-  std::vector<std::regex> patterns = {
+  // Compiled once; matching through a const regex is thread-safe
+  static const std::vector<std::regex> patterns = {
       std::regex(R"(^\w+\s+\w+\s*\([^)]*\))"),      // C/C++/Java
       std::regex(R"(^def\s+\w+\s*\([^)]*\):)"),     // Python
       std::regex(R"(^function\s+\w+\s*\([^)]*\))"), // JavaScript
@@ -93,7 +121,7 @@ bool is_function_signature(const std::string &line) {
   };
 
   for (const auto &pattern : patterns) {
-    if (std::regex_search(trimmed, pattern)) {
+    if (regex_search_view(trimmed, pattern)) {
       return true;
     }
   }
@@ -103,6 +131,8 @@ bool is_function_signature(const std::string &line) {
 
 } // anonymous namespace
 
+using text::to_line_views;
+
 std::string risk_level_to_string(RiskLevel level) {
   switch (level) {
   case RiskLevel::LOW:
@@ -118,32 +148,38 @@ std::string risk_level_to_string(RiskLevel level) {
   }
 }
 
-bool contains_critical_patterns(const std::vector<std::string> &lines) {
-  std::vector<std::regex> critical_patterns = {
-      std::regex(R"(delete\s+\w+)"),            // Delete operations
-      std::regex(R"(drop\s+(table|database))"), // Database drops
-      std::regex(R"(rm\s+-rf)"),                // Destructive file operations
-      std::regex(R"(eval\s*\()"),               // Eval (security risk)
-      std::regex(R"(exec\s*\()"),               // Exec (security risk)
-      std::regex(R"(system\s*\()"),             // System calls
-      std::regex(R"(\.password\s*=)"),          // Password assignments
-      std::regex(R"(\.secret\s*=)"),            // Secret assignments
-      std::regex(R"(sudo\s+)"),                 // Sudo usage
-      std::regex(R"(chmod\s+777)"),             // Overly permissive permissions
-      // TypeScript specific critical patterns
-      std::regex(R"(dangerouslySetInnerHTML)"), // React XSS risk
-      std::regex(R"(\bas\s+any\b)"), // TypeScript: type safety bypass
-      std::regex(R"(@ts-ignore)"),   // TypeScript: error suppression
-      std::regex(R"(@ts-nocheck)"),  // TypeScript: file-level error suppression
-      std::regex(R"(localStorage\.setItem.*password)"), // Storing passwords in
-                                                        // localStorage
-      std::regex(R"(innerHTML\s*=)"),                   // XSS risk
+bool contains_critical_patterns(const std::vector<std::string_view> &lines) {
+  // Each pattern is paired with a literal it cannot match without
+  static const std::vector<GuardedPattern> critical_patterns = {
+      // Delete operations, database drops, destructive file operations
+      {"delete", std::regex(R"(delete\s+\w+)")},
+      {"drop", std::regex(R"(drop\s+(table|database))")},
+      {"rm", std::regex(R"(rm\s+-rf)")},
+      // Eval, exec and system calls (security risk)
+      {"eval", std::regex(R"(eval\s*\()")},
+      {"exec", std::regex(R"(exec\s*\()")},
+      {"system", std::regex(R"(system\s*\()")},
+      // Password and secret assignments
+      {".password", std::regex(R"(\.password\s*=)")},
+      {".secret", std::regex(R"(\.secret\s*=)")},
+      // Sudo usage and overly permissive permissions
+      {"sudo", std::regex(R"(sudo\s+)")},
+      {"chmod", std::regex(R"(chmod\s+777)")},
+      // TypeScript specific critical patterns: React XSS risk, type safety
+      // bypass, error suppression, passwords in localStorage, XSS risk
+      {"dangerouslySetInnerHTML", std::regex(R"(dangerouslySetInnerHTML)")},
+      {"as", std::regex(R"(\bas\s+any\b)")},
+      {"@ts-ignore", std::regex(R"(@ts-ignore)")},
+      {"@ts-nocheck", std::regex(R"(@ts-nocheck)")},
+      {"localStorage", std::regex(R"(localStorage\.setItem.*password)")},
+      {"innerHTML", std::regex(R"(innerHTML\s*=)")},
   };
 
   for (const auto &line : lines) {
-    std::string trimmed = trim(line);
+    std::string_view trimmed = trim_whitespace(line);
     for (const auto &pattern : critical_patterns) {
-      if (std::regex_search(trimmed, pattern)) {
+      if (trimmed.find(pattern.literal) != std::string_view::npos &&
+          regex_search_view(trimmed, pattern.regex)) {
         return true;
       }
     }
@@ -152,8 +188,8 @@ bool contains_critical_patterns(const std::vector<std::string> &lines) {
   return false;
 }
 
-bool has_api_signature_changes(const std::vector<std::string> &base,
-                               const std::vector<std::string> &modified) {
+bool has_api_signature_changes(const std::vector<std::string_view> &base,
+                               const std::vector<std::string_view> &modified) {
   // Check if function signatures changed
   for (size_t i = 0; i < base.size() && i < modified.size(); ++i) {
     bool base_is_sig = is_function_signature(base[i]);
@@ -168,21 +204,22 @@ bool has_api_signature_changes(const std::vector<std::string> &base,
 }
 
 bool has_typescript_interface_changes(
-    const std::vector<std::string> &base,
-    const std::vector<std::string> &modified) {
+    const std::vector<std::string_view> &base,
+    const std::vector<std::string_view> &modified) {
   // Use static regex patterns to avoid recompilation
-  static const std::vector<std::regex> ts_definition_patterns = {
-      std::regex(R"(\binterface\s+\w+)"),
-      std::regex(R"(\btype\s+\w+\s*=)"),
-      std::regex(R"(\benum\s+\w+)"),
+  static const std::vector<GuardedPattern> ts_definition_patterns = {
+      {"interface", std::regex(R"(\binterface\s+\w+)")},
+      {"type", std::regex(R"(\btype\s+\w+\s*=)")},
+      {"enum", std::regex(R"(\benum\s+\w+)")},
   };
 
   // Check if any TypeScript definition exists in base
   bool base_has_ts_def = false;
   for (const auto &line : base) {
-    std::string trimmed = trim(line);
+    std::string_view trimmed = trim_whitespace(line);
     for (const auto &pattern : ts_definition_patterns) {
-      if (std::regex_search(trimmed, pattern)) {
+      if (trimmed.find(pattern.literal) != std::string_view::npos &&
+          regex_search_view(trimmed, pattern.regex)) {
         base_has_ts_def = true;
         break;
       }
@@ -194,9 +231,10 @@ bool has_typescript_interface_changes(
   // Check if any TypeScript definition exists in modified
   bool modified_has_ts_def = false;
   for (const auto &line : modified) {
-    std::string trimmed = trim(line);
+    std::string_view trimmed = trim_whitespace(line);
     for (const auto &pattern : ts_definition_patterns) {
-      if (std::regex_search(trimmed, pattern)) {
+      if (trimmed.find(pattern.literal) != std::string_view::npos &&
+          regex_search_view(trimmed, pattern.regex)) {
         modified_has_ts_def = true;
         break;
       }
@@ -211,11 +249,9 @@ bool has_typescript_interface_changes(
     if (base.size() != modified.size()) {
       return true;
     }
-    // Cache trimmed lines to avoid repeated trim() calls
+    // Compare trimmed lines in place, without allocating
     for (size_t i = 0; i < base.size(); ++i) {
-      std::string base_trimmed = trim(base[i]);
-      std::string mod_trimmed = trim(modified[i]);
-      if (base_trimmed != mod_trimmed) {
+      if (!text::equal_ignore_surrounding_whitespace(base[i], modified[i])) {
         return true;
       }
     }
@@ -232,10 +268,12 @@ bool is_package_lock_file(const std::string &filename) {
          filename.find("bun.lockb") != std::string::npos;
 }
 
-RiskAssessment analyze_risk_ours(const std::vector<std::string> &base,
-                                 const std::vector<std::string> &ours,
-                                 const std::vector<std::string> &theirs) {
-  RiskAssessment assessment;
+RiskAssessment
+analyze_risk_ours(const std::vector<std::string_view> &base,
+                  const std::vector<std::string_view> &ours,
+                  const std::vector<std::string_view> &theirs,
+                  const RiskAssessment::allocator_type &alloc) {
+  RiskAssessment assessment(alloc);
   assessment.level = RiskLevel::LOW;
   assessment.confidence_score = 0.5;
   assessment.has_syntax_changes = false;
@@ -252,7 +290,7 @@ RiskAssessment analyze_risk_ours(const std::vector<std::string> &base,
   // Check for critical patterns
   if (contains_critical_patterns(ours)) {
     assessment.affects_critical_section = true;
-    assessment.risk_factors.push_back(
+    assessment.risk_factors.emplace_back(
         "Contains critical code patterns (security/data operations)");
     assessment.level = RiskLevel::HIGH;
   }
@@ -260,7 +298,7 @@ RiskAssessment analyze_risk_ours(const std::vector<std::string> &base,
   // Check for API changes
   if (has_api_signature_changes(base, ours)) {
     assessment.has_api_changes = true;
-    assessment.risk_factors.push_back("Function/method signatures changed");
+    assessment.risk_factors.emplace_back("Function/method signatures changed");
     if (assessment.level < RiskLevel::MEDIUM) {
       assessment.level = RiskLevel::MEDIUM;
     }
@@ -269,7 +307,7 @@ RiskAssessment analyze_risk_ours(const std::vector<std::string> &base,
   // Check for TypeScript interface/type changes
   if (has_typescript_interface_changes(base, ours)) {
     assessment.has_api_changes = true;
-    assessment.risk_factors.push_back(
+    assessment.risk_factors.emplace_back(
         "TypeScript interface or type definitions changed");
     if (assessment.level < RiskLevel::MEDIUM) {
       assessment.level = RiskLevel::MEDIUM;
@@ -279,7 +317,7 @@ RiskAssessment analyze_risk_ours(const std::vector<std::string> &base,
   // Assess based on amount of change
   if (our_changes > 10) {
     assessment.has_logic_changes = true;
-    assessment.risk_factors.push_back("Large number of changes (" +
+    assessment.risk_factors.emplace_back("Large number of changes (" +
                                       std::to_string(our_changes) + " lines)");
     if (assessment.level < RiskLevel::MEDIUM) {
       assessment.level = RiskLevel::MEDIUM;
@@ -288,7 +326,7 @@ RiskAssessment analyze_risk_ours(const std::vector<std::string> &base,
 
   // Check if we're discarding significant changes from theirs
   if (their_changes > 5 && similarity_to_theirs < 0.3) {
-    assessment.risk_factors.push_back(
+    assessment.risk_factors.emplace_back(
         "Discarding significant changes from other branch (" +
         std::to_string(their_changes) + " lines)");
     if (assessment.level < RiskLevel::MEDIUM) {
@@ -307,28 +345,30 @@ RiskAssessment analyze_risk_ours(const std::vector<std::string> &base,
 
   // Add recommendations
   if (assessment.level >= RiskLevel::MEDIUM) {
-    assessment.recommendations.push_back(
+    assessment.recommendations.emplace_back(
         "Review changes carefully before accepting");
   }
   if (assessment.has_api_changes) {
-    assessment.recommendations.push_back(
+    assessment.recommendations.emplace_back(
         "Verify API compatibility with dependent code");
   }
   if (assessment.affects_critical_section) {
-    assessment.recommendations.push_back(
+    assessment.recommendations.emplace_back(
         "Test thoroughly, especially security and data operations");
   }
   if (assessment.risk_factors.empty()) {
-    assessment.recommendations.push_back("Changes appear safe to accept");
+    assessment.recommendations.emplace_back("Changes appear safe to accept");
   }
 
   return assessment;
 }
 
-RiskAssessment analyze_risk_theirs(const std::vector<std::string> &base,
-                                   const std::vector<std::string> &ours,
-                                   const std::vector<std::string> &theirs) {
-  RiskAssessment assessment;
+RiskAssessment
+analyze_risk_theirs(const std::vector<std::string_view> &base,
+                    const std::vector<std::string_view> &ours,
+                    const std::vector<std::string_view> &theirs,
+                    const RiskAssessment::allocator_type &alloc) {
+  RiskAssessment assessment(alloc);
   assessment.level = RiskLevel::LOW;
   assessment.confidence_score = 0.5;
   assessment.has_syntax_changes = false;
@@ -345,7 +385,7 @@ RiskAssessment analyze_risk_theirs(const std::vector<std::string> &base,
   // Check for critical patterns
   if (contains_critical_patterns(theirs)) {
     assessment.affects_critical_section = true;
-    assessment.risk_factors.push_back(
+    assessment.risk_factors.emplace_back(
         "Contains critical code patterns (security/data operations)");
     assessment.level = RiskLevel::HIGH;
   }
@@ -353,7 +393,7 @@ RiskAssessment analyze_risk_theirs(const std::vector<std::string> &base,
   // Check for API changes
   if (has_api_signature_changes(base, theirs)) {
     assessment.has_api_changes = true;
-    assessment.risk_factors.push_back("Function/method signatures changed");
+    assessment.risk_factors.emplace_back("Function/method signatures changed");
     if (assessment.level < RiskLevel::MEDIUM) {
       assessment.level = RiskLevel::MEDIUM;
     }
@@ -362,7 +402,7 @@ RiskAssessment analyze_risk_theirs(const std::vector<std::string> &base,
   // Check for TypeScript interface/type changes
   if (has_typescript_interface_changes(base, theirs)) {
     assessment.has_api_changes = true;
-    assessment.risk_factors.push_back(
+    assessment.risk_factors.emplace_back(
         "TypeScript interface or type definitions changed");
     if (assessment.level < RiskLevel::MEDIUM) {
       assessment.level = RiskLevel::MEDIUM;
@@ -372,7 +412,7 @@ RiskAssessment analyze_risk_theirs(const std::vector<std::string> &base,
   // Assess based on amount of change
   if (their_changes > 10) {
     assessment.has_logic_changes = true;
-    assessment.risk_factors.push_back("Large number of changes (" +
+    assessment.risk_factors.emplace_back("Large number of changes (" +
                                       std::to_string(their_changes) +
                                       " lines)");
     if (assessment.level < RiskLevel::MEDIUM) {
@@ -382,7 +422,7 @@ RiskAssessment analyze_risk_theirs(const std::vector<std::string> &base,
 
   // Check if we're discarding our changes
   if (our_changes > 5 && similarity_to_ours < 0.3) {
-    assessment.risk_factors.push_back("Discarding our local changes (" +
+    assessment.risk_factors.emplace_back("Discarding our local changes (" +
                                       std::to_string(our_changes) + " lines)");
     if (assessment.level < RiskLevel::MEDIUM) {
       assessment.level = RiskLevel::MEDIUM;
@@ -400,28 +440,30 @@ RiskAssessment analyze_risk_theirs(const std::vector<std::string> &base,
 
   // Add recommendations
   if (assessment.level >= RiskLevel::MEDIUM) {
-    assessment.recommendations.push_back(
+    assessment.recommendations.emplace_back(
         "Review changes carefully before accepting");
   }
   if (assessment.has_api_changes) {
-    assessment.recommendations.push_back(
+    assessment.recommendations.emplace_back(
         "Verify API compatibility with dependent code");
   }
   if (assessment.affects_critical_section) {
-    assessment.recommendations.push_back(
+    assessment.recommendations.emplace_back(
         "Test thoroughly, especially security and data operations");
   }
   if (assessment.risk_factors.empty()) {
-    assessment.recommendations.push_back("Changes appear safe to accept");
+    assessment.recommendations.emplace_back("Changes appear safe to accept");
   }
 
   return assessment;
 }
 
-RiskAssessment analyze_risk_both(const std::vector<std::string> &base,
-                                 const std::vector<std::string> &ours,
-                                 const std::vector<std::string> &theirs) {
-  RiskAssessment assessment;
+RiskAssessment
+analyze_risk_both(const std::vector<std::string_view> &base,
+                  const std::vector<std::string_view> &ours,
+                  const std::vector<std::string_view> &theirs,
+                  const RiskAssessment::allocator_type &alloc) {
+  RiskAssessment assessment(alloc);
   assessment.level = RiskLevel::MEDIUM; // Default to medium for concatenation
   assessment.confidence_score = 0.3;    // Lower confidence for concatenation
   assessment.has_syntax_changes = true;
@@ -431,13 +473,13 @@ RiskAssessment analyze_risk_both(const std::vector<std::string> &base,
   assessment.affects_critical_section = false;
 
   // Concatenating both versions is generally risky
-  assessment.risk_factors.push_back(
+  assessment.risk_factors.emplace_back(
       "Concatenating both versions may cause duplicates or conflicts");
 
   // Check if either contains critical patterns
   if (contains_critical_patterns(ours) || contains_critical_patterns(theirs)) {
     assessment.affects_critical_section = true;
-    assessment.risk_factors.push_back(
+    assessment.risk_factors.emplace_back(
         "Contains critical code patterns that may conflict");
     assessment.level = RiskLevel::HIGH;
   }
@@ -445,7 +487,7 @@ RiskAssessment analyze_risk_both(const std::vector<std::string> &base,
   // Check for duplicate logic
   double similarity = calculate_similarity(ours, theirs);
   if (similarity > 0.5) {
-    assessment.risk_factors.push_back(
+    assessment.risk_factors.emplace_back(
         "High similarity may result in duplicate code");
     assessment.level = RiskLevel::HIGH;
   }
@@ -454,7 +496,7 @@ RiskAssessment analyze_risk_both(const std::vector<std::string> &base,
   if (has_api_signature_changes(base, ours) ||
       has_api_signature_changes(base, theirs)) {
     assessment.has_api_changes = true;
-    assessment.risk_factors.push_back(
+    assessment.risk_factors.emplace_back(
         "Multiple API changes may cause conflicts");
     assessment.level = RiskLevel::HIGH;
   }
@@ -463,21 +505,67 @@ RiskAssessment analyze_risk_both(const std::vector<std::string> &base,
   if (has_typescript_interface_changes(base, ours) ||
       has_typescript_interface_changes(base, theirs)) {
     assessment.has_api_changes = true;
-    assessment.risk_factors.push_back(
+    assessment.risk_factors.emplace_back(
         "Multiple TypeScript interface/type changes may cause conflicts");
     assessment.level = RiskLevel::HIGH;
   }
 
   // Recommendations for concatenation
-  assessment.recommendations.push_back(
+  assessment.recommendations.emplace_back(
       "Manual review required - automatic concatenation is risky");
-  assessment.recommendations.push_back(
+  assessment.recommendations.emplace_back(
       "Consider merging logic manually instead of concatenating");
-  assessment.recommendations.push_back(
+  assessment.recommendations.emplace_back(
       "Test thoroughly for duplicate or conflicting code");
 
   return assessment;
 }
 
+// Overloads for owned lines view them and share the implementation above
+
+bool contains_critical_patterns(const std::vector<std::string> &lines) {
+  return contains_critical_patterns(to_line_views(lines));
+}
+
+bool has_api_signature_changes(const std::vector<std::string> &base,
+                               const std::vector<std::string> &modified) {
+  return has_api_signature_changes(to_line_views(base),
+                                   to_line_views(modified));
+}
+
+bool has_typescript_interface_changes(
+    const std::vector<std::string> &base,
+    const std::vector<std::string> &modified) {
+  return has_typescript_interface_changes(to_line_views(base),
+                                          to_line_views(modified));
+}
+
+RiskAssessment
+analyze_risk_ours(const std::vector<std::string> &base,
+                  const std::vector<std::string> &ours,
+                  const std::vector<std::string> &theirs,
+                  const RiskAssessment::allocator_type &alloc) {
+  return analyze_risk_ours(to_line_views(base), to_line_views(ours),
+                  to_line_views(theirs), alloc);
+}
+
+RiskAssessment
+analyze_risk_theirs(const std::vector<std::string> &base,
+                    const std::vector<std::string> &ours,
+                    const std::vector<std::string> &theirs,
+                    const RiskAssessment::allocator_type &alloc) {
+  return analyze_risk_theirs(to_line_views(base), to_line_views(ours),
+                    to_line_views(theirs), alloc);
+}
+
+RiskAssessment
+analyze_risk_both(const std::vector<std::string> &base,
+                  const std::vector<std::string> &ours,
+                  const std::vector<std::string> &theirs,
+                  const RiskAssessment::allocator_type &alloc) {
+  return analyze_risk_both(to_line_views(base), to_line_views(ours),
+                  to_line_views(theirs), alloc);
+}
+
 } // namespace analysis
 } // namespace wizardmerge
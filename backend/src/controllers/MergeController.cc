@@ -4,12 +4,91 @@
  */
 
 #include "MergeController.h"
+#include "wizardmerge/merge/binary_merge.h"
+#include "wizardmerge/merge/result_codec.h"
+#include "wizardmerge/merge/thread_pool.h"
 #include "wizardmerge/merge/three_way_merge.h"
+#include "wizardmerge/text/normalize.h"
+#include <deque>
 #include <json/json.h>
+#include <memory_resource>
+#include <string_view>
 
 using namespace wizardmerge::controllers;
 using namespace wizardmerge::merge;
 
+namespace {
+
+/**
+ * @brief Collects views of a JSON array of lines without copying them.
+ *
+ * String elements are viewed in place inside the parsed request. Other
+ * scalars keep the old asString() conversion; their text is owned by
+ * @p converted, which must outlive the views.
+ */
+void collectLineViews(const Json::Value &array,
+                      std::vector<std::string_view> &lines,
+                      std::deque<std::string> &converted) {
+    lines.reserve(array.size());
+    for (const auto &line : array) {
+        const char *begin = nullptr;
+        const char *end = nullptr;
+        if (line.isString() && line.getString(&begin, &end)) {
+            lines.emplace_back(begin, static_cast<size_t>(end - begin));
+        } else {
+            converted.push_back(line.asString());
+            lines.emplace_back(converted.back());
+        }
+    }
+}
+
+/**
+ * @brief Converts a (pmr) string to a JSON string value.
+ */
+Json::Value toJson(std::string_view text) {
+    return Json::Value(text.data(), text.data() + text.size());
+}
+
+/**
+ * @brief Converts a merged line to JSON in the format of the input lines
+ *        (see normalize_lines).
+ */
+Json::Value toJson(std::string_view line, bool first,
+                   const wizardmerge::text::TextFormat &format) {
+    if (!format.converted) {
+        return toJson(line);
+    }
+    std::string stored;
+    if (first && format.bom) {
+        stored = "\xEF\xBB\xBF";
+    }
+    stored.append(line);
+    if (format.line_ending == wizardmerge::text::LineEnding::CRLF) {
+        stored.push_back('\r');
+    }
+    return toJson(stored);
+}
+
+/**
+ * @brief Converts token spans to a JSON array of {line, begin, end}.
+ */
+Json::Value toJson(const std::pmr::vector<TokenSpan> &spans) {
+    Json::Value array(Json::arrayValue);
+    for (const auto &span : spans) {
+        Json::Value spanObj;
+        spanObj["line"] = static_cast<Json::UInt64>(span.line);
+        spanObj["begin"] = static_cast<Json::UInt64>(span.begin);
+        spanObj["end"] = static_cast<Json::UInt64>(span.end);
+        array.append(spanObj);
+    }
+    return array;
+}
+
+// Initial arena block; large merges grow it geometrically
+constexpr size_t MERGE_ARENA_BYTES = 64 * 1024;
+
+} // namespace
+
 void MergeController::merge(
     const HttpRequestPtr &req,
     std::function<void(const HttpResponsePtr &)> &&callback) {
@@ -37,21 +116,16 @@ void MergeController::merge(
         return;
     }
 
-    // Convert JSON arrays to std::vector<std::string>
-    std::vector<std::string> base;
-    std::vector<std::string> ours;
-    std::vector<std::string> theirs;
+    // View the JSON arrays in place; the request outlives the merge
+    std::vector<std::string_view> base;
+    std::vector<std::string_view> ours;
+    std::vector<std::string_view> theirs;
+    std::deque<std::string> converted;
 
     try {
-        for (const auto &line : json["base"]) {
-            base.push_back(line.asString());
-        }
-        for (const auto &line : json["ours"]) {
-            ours.push_back(line.asString());
-        }
-        for (const auto &line : json["theirs"]) {
-            theirs.push_back(line.asString());
-        }
+        collectLineViews(json["base"], base, converted);
+        collectLineViews(json["ours"], ours, converted);
+        collectLineViews(json["theirs"], theirs, converted);
     } catch (const std::exception &e) {
         Json::Value error;
         error["error"] = "Invalid array format in request";
@@ -61,17 +135,168 @@ void MergeController::merge(
         return;
     }
 
+    // Large files are diffed and analyzed in parallel on the pool all
+    // requests share, so no request starts threads of its own
+    MergeOptions options;
+    options.threads = 0;
+    options.pool = &shared_thread_pool();
+
+    // Optional diff algorithm selection
+    if (json.isMember("algorithm")) {
+        if (!json["algorithm"].isString() ||
+            !parse_diff_algorithm(json["algorithm"].asString(), options.algorithm)) {
+            Json::Value error;
+            error["error"] = "Invalid algorithm: expected auto, myers, patience or histogram";
+            auto resp = HttpResponse::newHttpJsonResponse(error);
+            resp->setStatusCode(k400BadRequest);
+            callback(resp);
+            return;
+        }
+    }
+
+    // Optional token-level refinement of conflicting hunks
+    if (json.isMember("refine")) {
+        if (!json["refine"].isBool()) {
+            Json::Value error;
+            error["error"] = "Invalid refine: expected a boolean";
+            auto resp = HttpResponse::newHttpJsonResponse(error);
+            resp->setStatusCode(k400BadRequest);
+            callback(resp);
+            return;
+        }
+        options.refine_conflicts = json["refine"].asBool();
+    }
+
+    // Optional conflict marker style, as in git's merge.conflictStyle
+    if (json.isMember("conflict_style")) {
+        std::string style = json["conflict_style"].isString()
+                                ? json["conflict_style"].asString()
+                                : std::string();
+        if (style != "merge" && style != "diff3") {
+            Json::Value error;
+            error["error"] = "Invalid conflict_style: expected merge or diff3";
+            auto resp = HttpResponse::newHttpJsonResponse(error);
+            resp->setStatusCode(k400BadRequest);
+            callback(resp);
+            return;
+        }
+        options.show_base = style == "diff3";
+    }
+
+    // Optional moved-block detection
+    if (json.isMember("detect_moves")) {
+        if (!json["detect_moves"].isBool()) {
+            Json::Value error;
+            error["error"] = "Invalid detect_moves: expected a boolean";
+            auto resp = HttpResponse::newHttpJsonResponse(error);
+            resp->setStatusCode(k400BadRequest);
+            callback(resp);
+            return;
+        }
+        options.detect_moves = json["detect_moves"].asBool();
+    }
+
+    // Optional line equivalences, as in git's -Xignore-* options
+    if (json.isMember("ignore")) {
+        bool valid = json["ignore"].isArray();
+        if (valid) {
+            for (const auto &name : json["ignore"]) {
+                valid = valid && name.isString() &&
+                        parse_ignore_option(name.asString(), options.compare);
+            }
+        }
+        if (!valid) {
+            Json::Value error;
+            error["error"] = "Invalid ignore: expected an array of all-space, "
+                             "space-change, eol, case or blank-lines";
+            auto resp = HttpResponse::newHttpJsonResponse(error);
+            resp->setStatusCode(k400BadRequest);
+            callback(resp);
+            return;
+        }
+    }
+
+    // Optional conflict analysis; clients that only want the merged text
+    // skip it entirely
+    AnalysisLevel analysis = AnalysisLevel::FULL;
+    if (json.isMember("analysis")) {
+        if (!json["analysis"].isString() ||
+            !parse_analysis_level(json["analysis"].asString(), analysis)) {
+            Json::Value error;
+            error["error"] = "Invalid analysis: expected none, context or full";
+            auto resp = HttpResponse::newHttpJsonResponse(error);
+            resp->setStatusCode(k400BadRequest);
+            callback(resp);
+            return;
+        }
+    }
+    // Analyzed below, once auto-resolved conflicts are gone
+    options.analysis = AnalysisLevel::NONE;
+
+    // Binary content is merged whole: no line diff, no analysis
+    if (is_binary_merge(base, ours, theirs)) {
+        BinaryResolution resolution = merge_binary(base, ours, theirs);
+        Json::Value response;
+        Json::Value mergedArray(Json::arrayValue);
+        if (resolution != BinaryResolution::CONFLICT) {
+            for (auto line : resolution == BinaryResolution::OURS ? ours : theirs) {
+                mergedArray.append(toJson(line));
+            }
+        }
+        response["merged"] = mergedArray;
+        response["conflicts"] = Json::Value(Json::arrayValue);
+        response["has_conflicts"] = resolution == BinaryResolution::CONFLICT;
+        response["binary"] = true;
+        response["resolution"] = binary_resolution_to_string(resolution);
+        auto resp = HttpResponse::newHttpJsonResponse(response);
+        resp->setStatusCode(k200OK);
+        callback(resp);
+        return;
+    }
+
+    // Versions that differ only in line endings or a BOM merge line by
+    // line; the merged lines come back in the format of ours (of theirs
+    // if ours is empty)
+    wizardmerge::text::TextFormat format;
+    wizardmerge::text::TextFormat theirFormat;
+    wizardmerge::text::TextFormat baseFormat;
+    wizardmerge::text::normalize_lines(base, baseFormat);
+    wizardmerge::text::normalize_lines(ours, format);
+    wizardmerge::text::normalize_lines(theirs, theirFormat);
+    if (ours.empty()) {
+        format = theirFormat;
+    }
+
+    // Every line, conflict and analysis string of this merge is carved out
+    // of one per-request arena and released at once when it goes away
+    std::pmr::monotonic_buffer_resource arena(MERGE_ARENA_BYTES);
+
     // Perform merge
-    auto result = three_way_merge(base, ours, theirs);
+    auto result = three_way_merge(base, ours, theirs, options, &arena);
     
     // Auto-resolve simple conflicts
     result = auto_resolve(result);
+    for (auto &conflict : result.conflicts) {
+        analyze_conflict(conflict, base, ours, theirs, analysis);
+    }
+
+    // Clients that accept it get the binary encoding, ready to be cached
+    // or memory-mapped as-is
+    if (req->getHeader("Accept").find(RESULT_MEDIA_TYPE) != std::string::npos) {
+        auto resp = HttpResponse::newHttpResponse();
+        resp->setStatusCode(k200OK);
+        resp->setContentTypeString(RESULT_MEDIA_TYPE);
+        resp->setBody(encode_merge_result(result));
+        callback(resp);
+        return;
+    }
 
     // Build response JSON
     Json::Value response;
     Json::Value mergedArray(Json::arrayValue);
-    for (const auto &line : result.merged_lines) {
-        mergedArray.append(line.content);
+    for (size_t i = 0; i < result.merged_lines.size(); ++i) {
+        mergedArray.append(
+            toJson(result.merged_lines[i].content, i == 0, format));
     }
     response["merged"] = mergedArray;
 
@@ -85,45 +310,59 @@ void MergeController::merge(
         
         Json::Value baseLines(Json::arrayValue);
         for (const auto &line : conflict.base_lines) {
-            baseLines.append(line.content);
+            baseLines.append(toJson(line.content));
         }
         conflictObj["base_lines"] = baseLines;
         
         Json::Value ourLines(Json::arrayValue);
         for (const auto &line : conflict.our_lines) {
-            ourLines.append(line.content);
+            ourLines.append(toJson(line.content));
         }
         conflictObj["our_lines"] = ourLines;
         
         Json::Value theirLines(Json::arrayValue);
         for (const auto &line : conflict.their_lines) {
-            theirLines.append(line.content);
+            theirLines.append(toJson(line.content));
         }
         conflictObj["their_lines"] = theirLines;
+
+        // Changed tokens, empty unless refinement was requested
+        conflictObj["our_changes"] = toJson(conflict.our_changes);
+        conflictObj["their_changes"] = toJson(conflict.their_changes);
         
+        if (conflict.analysis < AnalysisLevel::CONTEXT) {
+            conflictsArray.append(conflictObj);
+            continue;
+        }
+
         // Add context analysis
         Json::Value contextObj;
-        contextObj["function_name"] = conflict.context.function_name;
-        contextObj["class_name"] = conflict.context.class_name;
+        contextObj["function_name"] = toJson(conflict.context.function_name);
+        contextObj["class_name"] = toJson(conflict.context.class_name);
         Json::Value importsArray(Json::arrayValue);
         for (const auto& import : conflict.context.imports) {
-            importsArray.append(import);
+            importsArray.append(toJson(import));
         }
         contextObj["imports"] = importsArray;
         conflictObj["context"] = contextObj;
-        
+
+        if (conflict.analysis < AnalysisLevel::FULL) {
+            conflictsArray.append(conflictObj);
+            continue;
+        }
+
         // Add risk analysis for "ours" resolution
         Json::Value riskOursObj;
         riskOursObj["level"] = wizardmerge::analysis::risk_level_to_string(conflict.risk_ours.level);
         riskOursObj["confidence_score"] = conflict.risk_ours.confidence_score;
         Json::Value riskFactorsOurs(Json::arrayValue);
         for (const auto& factor : conflict.risk_ours.risk_factors) {
-            riskFactorsOurs.append(factor);
+            riskFactorsOurs.append(toJson(factor));
         }
         riskOursObj["risk_factors"] = riskFactorsOurs;
         Json::Value recommendationsOurs(Json::arrayValue);
         for (const auto& rec : conflict.risk_ours.recommendations) {
-            recommendationsOurs.append(rec);
+            recommendationsOurs.append(toJson(rec));
         }
         riskOursObj["recommendations"] = recommendationsOurs;
         conflictObj["risk_ours"] = riskOursObj;
@@ -134,12 +373,12 @@ void MergeController::merge(
         riskTheirsObj["confidence_score"] = conflict.risk_theirs.confidence_score;
         Json::Value riskFactorsTheirs(Json::arrayValue);
         for (const auto& factor : conflict.risk_theirs.risk_factors) {
-            riskFactorsTheirs.append(factor);
+            riskFactorsTheirs.append(toJson(factor));
         }
         riskTheirsObj["risk_factors"] = riskFactorsTheirs;
         Json::Value recommendationsTheirs(Json::arrayValue);
         for (const auto& rec : conflict.risk_theirs.recommendations) {
-            recommendationsTheirs.append(rec);
+            recommendationsTheirs.append(toJson(rec));
         }
         riskTheirsObj["recommendations"] = recommendationsTheirs;
         conflictObj["risk_theirs"] = riskTheirsObj;
@@ -150,12 +389,12 @@ void MergeController::merge(
         riskBothObj["confidence_score"] = conflict.risk_both.confidence_score;
         Json::Value riskFactorsBoth(Json::arrayValue);
         for (const auto& factor : conflict.risk_both.risk_factors) {
-            riskFactorsBoth.append(factor);
+            riskFactorsBoth.append(toJson(factor));
         }
         riskBothObj["risk_factors"] = riskFactorsBoth;
         Json::Value recommendationsBoth(Json::arrayValue);
         for (const auto& rec : conflict.risk_both.recommendations) {
-            recommendationsBoth.append(rec);
+            recommendationsBoth.append(toJson(rec));
         }
         riskBothObj["recommendations"] = recommendationsBoth;
         conflictObj["risk_both"] = riskBothObj;
@@ -30,7 +30,14 @@ public:
    * {
    *   "base": ["line1", "line2", ...],
    *   "ours": ["line1", "line2", ...],
-   *   "theirs": ["line1", "line2", ...]
+   *   "theirs": ["line1", "line2", ...],
+   *   "algorithm": "auto" | "myers" | "patience" | "histogram"  (optional)
+   *   "refine": true | false                                    (optional)
+   *   "conflict_style": "merge" | "diff3"                       (optional)
+   *   "analysis": "none" | "context" | "full"                   (optional)
+   *   "ignore": ["all-space" | "space-change" | "eol" | "case" |
+   *              "blank-lines", ...]                            (optional)
+   *   "detect_moves": true | false                              (optional)
    * }
    *
    * Response:
@@ -38,6 +45,16 @@ public:
    *   "merged": ["line1", "line2", ...],
    *   "conflicts": [...]
    * }
+   *
+   * Binary content (a NUL byte or invalid UTF-8 near the start of any
+   * version) is merged as a whole file: "binary" is true, "resolution"
+   * is "ours", "theirs" or "conflict", and "merged" is the chosen version
+   * (empty on conflict).
+   *
+   * A request whose Accept header names RESULT_MEDIA_TYPE
+   * ("application/vnd.wizardmerge.merge-result") gets the merge result in
+   * the binary encoding of result_codec.h instead of JSON; binary content
+   * is still answered in JSON.
    */
   void merge(const HttpRequestPtr &req,
              std::function<void(const HttpResponsePtr &)> &&callback);
@@ -6,10 +6,15 @@
 #include "PRController.h"
 #include "wizardmerge/git/git_platform_client.h"
 #include "wizardmerge/git/git_cli.h"
+#include "wizardmerge/merge/batch_merge.h"
+#include "wizardmerge/merge/binary_merge.h"
 #include "wizardmerge/merge/three_way_merge.h"
+#include "wizardmerge/text/text_buffer.h"
 #include <json/json.h>
+#include <atomic>
 #include <iostream>
 #include <filesystem>
+#include <fstream>
 
 using namespace wizardmerge::controllers;
 using namespace wizardmerge::git;
@@ -81,12 +86,18 @@ void PRController::resolvePR(
 
     PullRequest pr = pr_opt.value();
 
-    // Process each file in the PR
-    Json::Value resolved_files_array(Json::arrayValue);
+    // Fetch the versions of each file in the PR, then merge them all at
+    // once on a shared thread pool
+    std::vector<Json::Value> file_results;
+    struct PendingMerge {
+        size_t file_result;
+        NormalizedFile file;
+    };
+    std::vector<PendingMerge> pending;
     int total_files = 0;
-    int resolved_files = 0;
+    std::atomic<int> resolved_files(0);
     int failed_files = 0;
-
+    
     for (const auto& file : pr.files) {
         total_files++;
         
@@ -98,66 +109,117 @@ void PRController::resolvePR(
         if (file.status == "removed") {
             file_result["skipped"] = true;
             file_result["reason"] = "File was deleted";
-            resolved_files_array.append(file_result);
+            file_results.push_back(file_result);
             continue;
         }
 
         // For modified files, fetch base and head versions
         if (file.status == "modified" || file.status == "added") {
             // Fetch base version (empty for added files)
-            std::vector<std::string> base_content;
+            std::string base_content;
             if (file.status == "modified") {
-                auto base_opt = fetch_file_content(platform, owner, repo, pr.base_sha, file.filename, api_token);
+                auto base_opt = fetch_file_bytes(platform, owner, repo, pr.base_sha, file.filename, api_token);
                 if (!base_opt) {
                     file_result["error"] = "Failed to fetch base version";
                     file_result["had_conflicts"] = false;
                     failed_files++;
-                    resolved_files_array.append(file_result);
+                    file_results.push_back(file_result);
                     continue;
                 }
-                base_content = base_opt.value();
+                base_content = std::move(base_opt.value());
             }
 
             // Fetch head version
-            auto head_opt = fetch_file_content(platform, owner, repo, pr.head_sha, file.filename, api_token);
+            auto head_opt = fetch_file_bytes(platform, owner, repo, pr.head_sha, file.filename, api_token);
             if (!head_opt) {
                 file_result["error"] = "Failed to fetch head version";
                 file_result["had_conflicts"] = false;
                 failed_files++;
-                resolved_files_array.append(file_result);
+                file_results.push_back(file_result);
                 continue;
             }
-            std::vector<std::string> head_content = head_opt.value();
 
-            // For added files or when there might be a conflict with existing file
-            // Note: This is a simplified merge for PR review purposes.
-            // In a real merge scenario with conflicts, you'd need the merge-base commit.
-            // Here we're showing what changes if we accept the head version:
-            //   - base: common ancestor (PR base)
-            //   - ours: current state (PR base)  
-            //   - theirs: proposed changes (PR head)
-            // This effectively shows all changes from the PR head.
-            
-            // Perform three-way merge: base, ours (base), theirs (head)
-            auto merge_result = three_way_merge(base_content, base_content, head_content);
-            merge_result = auto_resolve(merge_result);
+            // Binary files are merged whole, never split into lines
+            if (is_binary_merge(base_content, base_content, head_opt.value())) {
+                BinaryResolution resolution =
+                    merge_binary(base_content, base_content, head_opt.value());
+                file_result["binary"] = true;
+                file_result["resolution"] = binary_resolution_to_string(resolution);
+                file_result["had_conflicts"] = resolution == BinaryResolution::CONFLICT;
+                file_result["auto_resolved"] = resolution != BinaryResolution::CONFLICT;
+                if (resolution != BinaryResolution::CONFLICT) {
+                    resolved_files++;
+                }
+                file_results.push_back(file_result);
+                continue;
+            }
 
-            file_result["had_conflicts"] = merge_result.has_conflicts();
-            file_result["auto_resolved"] = !merge_result.has_conflicts();
+            // Versions that differ only in line endings, BOM or encoding
+            // merge line by line
+            std::string ours_content = base_content;
+            pending.push_back(
+                {file_results.size(),
+                 normalize_file(
+                     wizardmerge::text::TextBuffer::from_string(std::move(base_content)),
+                     wizardmerge::text::TextBuffer::from_string(std::move(ours_content)),
+                     wizardmerge::text::TextBuffer::from_string(std::move(head_opt.value())))});
+        }
 
-            // Extract merged content
-            Json::Value merged_content(Json::arrayValue);
-            for (const auto& line : merge_result.merged_lines) {
-                merged_content.append(line.content);
-            }
-            file_result["merged_content"] = merged_content;
+        file_results.push_back(file_result);
+    }
 
-            if (!merge_result.has_conflicts()) {
-                resolved_files++;
-            }
+    // For added files or when there might be a conflict with existing file
+    // Note: This is a simplified merge for PR review purposes.
+    // In a real merge scenario with conflicts, you'd need the merge-base commit.
+    // Here we're showing what changes if we accept the head version:
+    //   - base: common ancestor (PR base)
+    //   - ours: current state (PR base)  
+    //   - theirs: proposed changes (PR head)
+    // This effectively shows all changes from the PR head.
+    //
+    // Only the conflict status is reported, so skip the analysis.
+    MergeOptions options;
+    options.analysis = AnalysisLevel::NONE;
+    std::vector<MergeJob> jobs;
+    jobs.reserve(pending.size());
+    for (const auto &merge : pending) {
+        jobs.push_back(merge.file.job(options));
+    }
+
+    // Merged files as they are written to a branch, in their recorded format
+    std::vector<std::string> stored_files(file_results.size());
+
+    // Perform three-way merges: base, ours (base), theirs (head), on the
+    // pool all requests share. Each result lives in a per-file arena, so
+    // the JSON is built as it arrives; every callback fills a different
+    // file result.
+    merge_batch(jobs, [&](size_t index, MergeResult &merge_result) {
+        merge_result = auto_resolve(merge_result);
+
+        Json::Value &file_result = file_results[pending[index].file_result];
+        file_result["had_conflicts"] = merge_result.has_conflicts();
+        file_result["auto_resolved"] = !merge_result.has_conflicts();
+
+        // Extract merged content
+        Json::Value merged_content(Json::arrayValue);
+        for (const auto& line : merge_result.merged_lines) {
+            merged_content.append(Json::Value(line.content.data(),
+                                              line.content.data() + line.content.size()));
+        }
+        file_result["merged_content"] = merged_content;
+        if (create_branch) {
+            stored_files[pending[index].file_result] =
+                restore_merged(merge_result, pending[index].file.format);
         }
 
-        resolved_files_array.append(file_result);
+        if (!merge_result.has_conflicts()) {
+            resolved_files++;
+        }
+    }, shared_thread_pool());
+
+    Json::Value resolved_files_array(Json::arrayValue);
+    for (auto& file_result : file_results) {
+        resolved_files_array.append(std::move(file_result));
     }
 
     // Build response
@@ -179,7 +241,7 @@ void PRController::resolvePR(
 
     response["resolved_files"] = resolved_files_array;
     response["total_files"] = total_files;
-    response["resolved_count"] = resolved_files;
+    response["resolved_count"] = resolved_files.load();
     response["failed_count"] = failed_files;
     
     // Branch creation with Git CLI
@@ -226,7 +288,9 @@ void PRController::resolvePR(
                 } else {
                     // Write resolved files
                     bool all_files_written = true;
+                    size_t index = 0;
                     for (const auto& file : resolved_files_array) {
+                        const std::string &stored = stored_files[index++];
                         if (file.isMember("merged_content") && file["merged_content"].isArray()) {
                             std::string file_path = temp_dir + "/" + file["filename"].asString();
                             
@@ -235,11 +299,9 @@ void PRController::resolvePR(
                             std::filesystem::create_directories(file_path_obj.parent_path());
                             
                             // Write merged content
-                            std::ofstream out_file(file_path);
+                            std::ofstream out_file(file_path, std::ios::binary);
                             if (out_file.is_open()) {
-                                for (const auto& line : file["merged_content"]) {
-                                    out_file << line.asString() << "\n";
-                                }
+                                out_file.write(stored.data(), static_cast<std::streamsize>(stored.size()));
                                 out_file.close();
                             } else {
                                 all_files_written = false;
@@ -223,5 +223,26 @@ GitResult status(const std::string &repo_path) {
   return execute_command(git_command(repo_path, "status"));
 }
 
+std::optional<std::vector<std::string>>
+list_conflicted_files(const std::string &repo_path) {
+  GitResult result = execute_command(
+      git_command(repo_path, "diff --name-only --diff-filter=U --relative"));
+
+  if (!result.success) {
+    return std::nullopt;
+  }
+
+  std::vector<std::string> files;
+  std::istringstream lines(result.output);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (!line.empty()) {
+      files.push_back(line);
+    }
+  }
+
+  return files;
+}
+
 } // namespace git
 } // namespace wizardmerge
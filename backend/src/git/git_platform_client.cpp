@@ -4,6 +4,8 @@
  */
 
 #include "wizardmerge/git/git_platform_client.h"
+#include "wizardmerge/text/normalize.h"
+#include "wizardmerge/text/text_kernels.h"
 #include <algorithm>
 #include <curl/curl.h>
 #include <iostream>
@@ -105,17 +107,21 @@ bool http_get(const std::string &url, const std::string &token,
 
 /**
  * @brief Split string by newlines
+ *
+ * The lines are normalized as the merge expects them: UTF-8 without a BOM
+ * or carriage returns. Content that is not text is split as it is.
  */
 std::vector<std::string> split_lines(const std::string &content) {
-  std::vector<std::string> lines;
-  std::istringstream stream(content);
-  std::string line;
-
-  while (std::getline(stream, line)) {
-    lines.push_back(line);
+  std::string normalized;
+  text::TextFormat format;
+  std::string_view data = content;
+  if (text::normalize_text(content, normalized, format) && format.converted) {
+    data = normalized;
   }
 
-  return lines;
+  // One vectorized newline scan, then a single copy per line
+  std::vector<std::string_view> views = text::split_lines(data);
+  return std::vector<std::string>(views.begin(), views.end());
 }
 
 } // anonymous namespace
@@ -340,6 +346,17 @@ std::optional<std::vector<std::string>>
 fetch_file_content(GitPlatform platform, const std::string &owner,
                    const std::string &repo, const std::string &sha,
                    const std::string &path, const std::string &token) {
+  auto content = fetch_file_bytes(platform, owner, repo, sha, path, token);
+  if (!content) {
+    return std::nullopt;
+  }
+  return split_lines(*content);
+}
+
+std::optional<std::string>
+fetch_file_bytes(GitPlatform platform, const std::string &owner,
+                 const std::string &repo, const std::string &sha,
+                 const std::string &path, const std::string &token) {
   std::string url;
 
   if (platform == GitPlatform::GitHub) {
@@ -421,11 +438,10 @@ fetch_file_content(GitPlatform platform, const std::string &owner,
       return std::nullopt;
     }
 
-    // Split content into lines
-    return split_lines(decoded_content);
+    return decoded_content;
   } else if (platform == GitPlatform::GitLab) {
     // GitLab returns raw file content directly
-    return split_lines(response);
+    return response;
   }
 
   return std::nullopt;
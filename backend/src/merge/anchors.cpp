@@ -0,0 +1,84 @@
+/**
+ * @file anchors.cpp
+ * @brief Implementation of three-way anchor detection
+ */
+
+#include "wizardmerge/merge/anchors.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace wizardmerge {
+namespace merge {
+
+namespace {
+
+constexpr size_t NO_INDEX = SIZE_MAX;
+
+/**
+ * @brief Longest subsequence of anchors increasing in @p key.
+ */
+template <typename Key>
+std::vector<Anchor> increasing_chain(const std::vector<Anchor> &anchors,
+                                     Key key) {
+  std::vector<size_t> tails; // Index of the smallest tail per chain length
+  std::vector<size_t> prev(anchors.size(), NO_INDEX);
+
+  for (size_t i = 0; i < anchors.size(); ++i) {
+    size_t k = key(anchors[i]);
+    auto it = std::lower_bound(tails.begin(), tails.end(), k,
+                               [&](size_t index, size_t value) {
+                                 return key(anchors[index]) < value;
+                               });
+    if (it != tails.begin()) {
+      prev[i] = *(it - 1);
+    }
+    if (it == tails.end()) {
+      tails.push_back(i);
+    } else {
+      *it = i;
+    }
+  }
+
+  std::vector<Anchor> chain;
+  for (size_t i = tails.empty() ? NO_INDEX : tails.back(); i != NO_INDEX;
+       i = prev[i]) {
+    chain.push_back(anchors[i]);
+  }
+  std::reverse(chain.begin(), chain.end());
+  return chain;
+}
+
+} // namespace
+
+std::vector<Anchor> find_anchors(const std::vector<LineId> &base,
+                                 const std::vector<LineId> &ours,
+                                 const std::vector<LineId> &theirs,
+                                 size_t id_count) {
+  const std::vector<LineId> *ids[3] = {&base, &ours, &theirs};
+
+  // Per line ID and side: occurrence count and last position
+  std::vector<uint32_t> counts(id_count * 3, 0);
+  std::vector<size_t> positions(id_count * 3, 0);
+  for (int side = 0; side < 3; ++side) {
+    for (size_t i = 0; i < ids[side]->size(); ++i) {
+      size_t slot = (*ids[side])[i] * 3 + side;
+      ++counts[slot];
+      positions[slot] = i;
+    }
+  }
+
+  std::vector<Anchor> candidates;
+  for (size_t i = 0; i < base.size(); ++i) {
+    size_t slot = base[i] * 3;
+    if (counts[slot] == 1 && counts[slot + 1] == 1 && counts[slot + 2] == 1) {
+      candidates.push_back({i, positions[slot + 1], positions[slot + 2]});
+    }
+  }
+
+  auto chain = increasing_chain(candidates,
+                                [](const Anchor &a) { return a.ours; });
+  return increasing_chain(chain, [](const Anchor &a) { return a.theirs; });
+}
+
+} // namespace merge
+} // namespace wizardmerge
@@ -0,0 +1,114 @@
+/**
+ * @file batch_merge.cpp
+ * @brief Implementation of the batch merge
+ */
+
+#include "wizardmerge/merge/batch_merge.h"
+#include <algorithm>
+#include <atomic>
+#include <memory_resource>
+#include <numeric>
+
+namespace wizardmerge {
+namespace merge {
+
+void merge_batch(const std::vector<MergeJob> &jobs,
+                 const MergeCallback &on_result, ThreadPool &pool) {
+  // Longest jobs first; line counts are a good enough proxy for cost
+  std::vector<size_t> sizes(jobs.size());
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    sizes[i] = jobs[i].base.size() + jobs[i].ours.size() +
+               jobs[i].theirs.size();
+  }
+  std::vector<size_t> order(jobs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+  // Tasks take the next job in order rather than a fixed one: the pool
+  // runs its own queue newest first, which would undo the ordering
+  std::atomic<size_t> next(0);
+  pool.parallel_for(jobs.size(), [&](size_t) {
+    size_t index = order[next.fetch_add(1)];
+    const MergeJob &job = jobs[index];
+
+    // A job asking for threads of its own gets them from the batch's pool
+    const MergeOptions *options = &job.options;
+    MergeOptions pooled;
+    if (job.options.threads != 1 && !job.options.pool) {
+      pooled = job.options;
+      pooled.pool = &pool;
+      options = &pooled;
+    }
+
+    // The result lives only until it is delivered
+    std::pmr::monotonic_buffer_resource arena;
+    MergeResult result =
+        three_way_merge(job.base, job.ours, job.theirs, *options, &arena);
+    on_result(index, result);
+  });
+}
+
+void merge_batch(const std::vector<MergeJob> &jobs,
+                 const MergeCallback &on_result, size_t threads) {
+  ThreadPool pool(std::min(resolve_thread_count(threads),
+                           std::max<size_t>(jobs.size(), 1)));
+  merge_batch(jobs, on_result, pool);
+}
+
+bool is_deleted_file(std::optional<std::string_view> base,
+                     std::optional<std::string_view> ours,
+                     std::optional<std::string_view> theirs) {
+  if (!base || (ours && theirs)) {
+    return false;
+  }
+  return (!ours || *ours == *base) && (!theirs || *theirs == *base);
+}
+
+MergeJob NormalizedFile::job(const MergeOptions &options) const {
+  MergeJob job;
+  job.base = base.lines();
+  job.ours = ours.lines();
+  job.theirs = theirs.lines();
+  job.options = options;
+  return job;
+}
+
+NormalizedFile normalize_file(text::TextBuffer base, text::TextBuffer ours,
+                              text::TextBuffer theirs) {
+  NormalizedFile file;
+  file.base = std::move(base);
+  file.ours = std::move(ours);
+  file.theirs = std::move(theirs);
+
+  // Content that is not text keeps the default format, which restores
+  // it unchanged
+  text::TextFormat base_format;
+  text::TextFormat their_format;
+  file.base.normalize(base_format);
+  if (!file.ours.normalize(file.format)) {
+    file.format = text::TextFormat();
+  }
+  if (!file.theirs.normalize(their_format)) {
+    their_format = text::TextFormat();
+  }
+  if (file.ours.data().empty()) {
+    file.format = their_format;
+  }
+  return file;
+}
+
+std::string restore_merged(const MergeResult &result,
+                           const text::TextFormat &format) {
+  std::string merged;
+  for (const auto &line : result.merged_lines) {
+    merged.append(line.content);
+    merged.push_back('\n');
+  }
+  std::string stored;
+  text::restore_text(merged, format, stored);
+  return stored;
+}
+
+} // namespace merge
+} // namespace wizardmerge
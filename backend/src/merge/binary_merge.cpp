@@ -0,0 +1,127 @@
+/**
+ * @file binary_merge.cpp
+ * @brief Implementation of the whole-file binary merge
+ */
+
+#include "wizardmerge/merge/binary_merge.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace wizardmerge {
+namespace merge {
+
+namespace {
+
+/**
+ * @brief One version of a file with its content hash.
+ */
+template <typename Content> struct HashedContent {
+  const Content &content;
+  uint64_t hash;
+};
+
+uint64_t content_hash(std::string_view content) {
+  return text::hash_bytes(content);
+}
+
+/**
+ * @brief Hash of the lines and their count, one line hash at a time.
+ */
+uint64_t content_hash(const std::vector<std::string_view> &lines) {
+  uint64_t hash = lines.size();
+  for (std::string_view line : lines) {
+    hash = (hash ^ text::hash_bytes(line)) * 0x9E3779B97F4A7C15ULL;
+  }
+  return hash;
+}
+
+bool same_bytes(std::string_view a, std::string_view b) {
+  return text::bytes_equal(a, b);
+}
+
+bool same_bytes(const std::vector<std::string_view> &a,
+                const std::vector<std::string_view> &b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(), text::bytes_equal);
+}
+
+template <typename Content>
+bool same_content(const HashedContent<Content> &a,
+                  const HashedContent<Content> &b) {
+  return a.hash == b.hash && same_bytes(a.content, b.content);
+}
+
+template <typename Content>
+BinaryResolution merge_contents(const Content &base, const Content &ours,
+                                const Content &theirs) {
+  HashedContent<Content> hashed_base{base, content_hash(base)};
+  HashedContent<Content> hashed_ours{ours, content_hash(ours)};
+  HashedContent<Content> hashed_theirs{theirs, content_hash(theirs)};
+
+  if (same_content(hashed_ours, hashed_theirs) ||
+      same_content(hashed_base, hashed_theirs)) {
+    return BinaryResolution::OURS;
+  }
+  if (same_content(hashed_base, hashed_ours)) {
+    return BinaryResolution::THEIRS;
+  }
+  return BinaryResolution::CONFLICT;
+}
+
+bool lines_look_binary(const std::vector<std::string_view> &lines,
+                       size_t scan_bytes) {
+  for (std::string_view line : lines) {
+    if (scan_bytes == 0) {
+      break;
+    }
+    if (text::looks_binary(line, scan_bytes)) {
+      return true;
+    }
+    scan_bytes -= std::min(scan_bytes, line.size() + 1);
+  }
+  return false;
+}
+
+} // namespace
+
+bool is_binary_merge(std::string_view base, std::string_view ours,
+                     std::string_view theirs, size_t scan_bytes) {
+  return text::looks_binary(base, scan_bytes) ||
+         text::looks_binary(ours, scan_bytes) ||
+         text::looks_binary(theirs, scan_bytes);
+}
+
+bool is_binary_merge(const std::vector<std::string_view> &base,
+                     const std::vector<std::string_view> &ours,
+                     const std::vector<std::string_view> &theirs,
+                     size_t scan_bytes) {
+  return lines_look_binary(base, scan_bytes) ||
+         lines_look_binary(ours, scan_bytes) ||
+         lines_look_binary(theirs, scan_bytes);
+}
+
+BinaryResolution merge_binary(std::string_view base, std::string_view ours,
+                              std::string_view theirs) {
+  return merge_contents(base, ours, theirs);
+}
+
+BinaryResolution merge_binary(const std::vector<std::string_view> &base,
+                              const std::vector<std::string_view> &ours,
+                              const std::vector<std::string_view> &theirs) {
+  return merge_contents(base, ours, theirs);
+}
+
+std::string binary_resolution_to_string(BinaryResolution resolution) {
+  switch (resolution) {
+  case BinaryResolution::OURS:
+    return "ours";
+  case BinaryResolution::THEIRS:
+    return "theirs";
+  case BinaryResolution::CONFLICT:
+  default:
+    return "conflict";
+  }
+}
+
+} // namespace merge
+} // namespace wizardmerge
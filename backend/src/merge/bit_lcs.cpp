@@ -0,0 +1,267 @@
+/**
+ * @file bit_lcs.cpp
+ * @brief Implementation of the bit-parallel LCS kernel
+ */
+
+#include "wizardmerge/merge/bit_lcs.h"
+#include "wizardmerge/text/text_kernels.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define WIZARDMERGE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace wizardmerge {
+namespace merge {
+
+namespace {
+
+constexpr size_t WORD_BITS = 64;
+
+/**
+ * @brief Per distinct element of the column sequence, the bit vector of
+ *        the columns holding it.
+ */
+class MatchMasks {
+public:
+  MatchMasks(const LineId *columns, size_t m)
+      : words_((m + WORD_BITS - 1) / WORD_BITS) {
+    index_.reserve(m);
+    for (size_t j = 0; j < m; ++j) {
+      auto inserted = index_.emplace(columns[j], index_.size());
+      if (inserted.second) {
+        bits_.resize(bits_.size() + words_, 0);
+      }
+      bits_[inserted.first->second * words_ + j / WORD_BITS] |=
+          uint64_t(1) << (j % WORD_BITS);
+    }
+  }
+
+  size_t words() const { return words_; }
+
+  /**
+   * @brief Mask of an element, or nullptr if no column holds it.
+   */
+  const uint64_t *find(LineId id) const {
+    auto it = index_.find(id);
+    return it == index_.end() ? nullptr : &bits_[it->second * words_];
+  }
+
+private:
+  size_t words_;
+  std::unordered_map<LineId, size_t> index_;
+  std::vector<uint64_t> bits_;
+};
+
+/**
+ * @brief Advances words [from, words) of a row, given the carry into
+ *        word @p from.
+ *
+ * Row update: V' = (V + (V & M)) | (V & ~M), with the addition carried
+ * across words. A zero bit in V marks a column where the LCS grows.
+ */
+void advance_words(uint64_t *v, const uint64_t *match, size_t from,
+                   size_t words, uint64_t carry) {
+  for (size_t w = from; w < words; ++w) {
+    uint64_t x = v[w];
+    uint64_t sum = x + (x & match[w]);
+    uint64_t overflow = sum < x;
+    sum += carry;
+    carry = overflow | (sum < carry);
+    v[w] = sum | (x & ~match[w]);
+  }
+}
+
+void advance_row_scalar(uint64_t *v, const uint64_t *match, size_t words) {
+  advance_words(v, match, 0, words, 0);
+}
+
+#ifdef WIZARDMERGE_X86_KERNELS
+// Lane increments for each 4-bit mask of carries into the lanes
+struct LaneIncrements {
+  alignas(32) uint64_t lanes[16][4];
+
+  constexpr LaneIncrements() : lanes() {
+    for (unsigned mask = 0; mask < 16; ++mask) {
+      for (unsigned lane = 0; lane < 4; ++lane) {
+        lanes[mask][lane] = (mask >> lane) & 1;
+      }
+    }
+  }
+};
+constexpr LaneIncrements LANE_INCREMENTS;
+
+/**
+ * @brief Advances a row four words per step.
+ *
+ * The lanes are added independently; the carries between them are then
+ * resolved from two 4-bit masks, lanes that overflowed (generate) and
+ * lanes of all ones that pass an incoming carry on (propagate), with one
+ * scalar addition as in a carry-lookahead adder. A lane cannot both
+ * overflow and be all ones, so the mask addition is exact.
+ */
+__attribute__((target("avx2"))) void
+advance_row_avx2(uint64_t *v, const uint64_t *match, size_t words) {
+  const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+  const __m256i ones = _mm256_set1_epi64x(-1);
+  unsigned carry = 0;
+  size_t w = 0;
+  for (; w + 4 <= words; w += 4) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(v + w));
+    __m256i m =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(match + w));
+    __m256i sum = _mm256_add_epi64(x, _mm256_and_si256(x, m));
+
+    // Unsigned sum < x through a signed compare with flipped sign bits
+    __m256i overflow = _mm256_cmpgt_epi64(_mm256_xor_si256(x, sign),
+                                          _mm256_xor_si256(sum, sign));
+    __m256i full = _mm256_cmpeq_epi64(sum, ones);
+    unsigned generate = static_cast<unsigned>(
+        _mm256_movemask_pd(_mm256_castsi256_pd(overflow)));
+    unsigned propagate = static_cast<unsigned>(
+        _mm256_movemask_pd(_mm256_castsi256_pd(full)));
+
+    unsigned rippled = ((generate << 1) | carry) + propagate;
+    unsigned carries = (rippled ^ propagate) & 0xF;
+    carry = rippled >> 4;
+    sum = _mm256_add_epi64(
+        sum, _mm256_load_si256(reinterpret_cast<const __m256i *>(
+                 LANE_INCREMENTS.lanes[carries])));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(v + w),
+                        _mm256_or_si256(sum, _mm256_andnot_si256(m, x)));
+  }
+  advance_words(v, match, w, words, carry);
+}
+#endif
+
+using AdvanceRow = void (*)(uint64_t *, const uint64_t *, size_t);
+
+AdvanceRow advance_row() {
+#ifdef WIZARDMERGE_X86_KERNELS
+  if (text::active_simd_level() == text::SimdLevel::AVX2) {
+    return advance_row_avx2;
+  }
+#endif
+  return advance_row_scalar;
+}
+
+/**
+ * @brief Number of zero bits of a row below column @p j: the LCS length
+ *        of the row's prefix of a with b[0, j).
+ */
+size_t zeros_below(const uint64_t *row, size_t j) {
+  size_t zeros = 0;
+  size_t full = j / WORD_BITS;
+  for (size_t w = 0; w < full; ++w) {
+    zeros += WORD_BITS - static_cast<size_t>(__builtin_popcountll(row[w]));
+  }
+  size_t rest = j % WORD_BITS;
+  if (rest > 0) {
+    uint64_t low = ~row[full] & ((uint64_t(1) << rest) - 1);
+    zeros += static_cast<size_t>(__builtin_popcountll(low));
+  }
+  return zeros;
+}
+
+} // namespace
+
+size_t lcs_length(const std::vector<LineId> &a, const std::vector<LineId> &b) {
+  // Columns over the shorter sequence keep the masks small
+  const std::vector<LineId> &rows = a.size() >= b.size() ? a : b;
+  const std::vector<LineId> &columns = a.size() >= b.size() ? b : a;
+  if (columns.empty()) {
+    return 0;
+  }
+
+  MatchMasks masks(columns.data(), columns.size());
+  std::vector<uint64_t> v(masks.words(), ~uint64_t(0));
+  AdvanceRow advance = advance_row();
+  for (LineId id : rows) {
+    if (const uint64_t *match = masks.find(id)) {
+      advance(v.data(), match, v.size());
+    }
+  }
+  return zeros_below(v.data(), columns.size());
+}
+
+size_t lcs_length(const std::vector<std::string_view> &a,
+                  const std::vector<std::string_view> &b) {
+  LineTable table(a.size() + b.size());
+  return lcs_length(table.intern_lines(a), table.intern_lines(b));
+}
+
+void lcs_matches(const LineId *a, size_t n, const LineId *b, size_t m,
+                 std::vector<std::pair<size_t, size_t>> &matches) {
+  if (n == 0 || m == 0) {
+    return;
+  }
+  if (m > n) {
+    std::vector<std::pair<size_t, size_t>> swapped;
+    lcs_matches(b, m, a, n, swapped);
+    for (const auto &match : swapped) {
+      matches.emplace_back(match.second, match.first);
+    }
+    return;
+  }
+
+  // Row i is the DP row after a[0, i); all rows are kept for the walk back
+  MatchMasks masks(b, m);
+  size_t words = masks.words();
+  std::vector<uint64_t> rows((n + 1) * words, ~uint64_t(0));
+  AdvanceRow advance = advance_row();
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t *row = &rows[(i + 1) * words];
+    std::copy_n(row - words, words, row);
+    if (const uint64_t *match = masks.find(a[i])) {
+      advance(row, match, words);
+    }
+  }
+
+  size_t first = matches.size();
+  size_t i = n;
+  size_t j = m;
+  size_t length = zeros_below(&rows[n * words], m);
+  while (length > 0) {
+    if (a[i - 1] == b[j - 1]) {
+      matches.emplace_back(i - 1, j - 1);
+      --i;
+      --j;
+      --length;
+    } else if (zeros_below(&rows[(i - 1) * words], j) == length) {
+      --i;
+    } else {
+      --j;
+    }
+  }
+  std::reverse(matches.begin() + first, matches.end());
+}
+
+std::vector<DiffHunk> bit_lcs_diff(const std::vector<LineId> &base,
+                                   const std::vector<LineId> &other) {
+  std::vector<std::pair<size_t, size_t>> matches;
+  lcs_matches(base.data(), base.size(), other.data(), other.size(), matches);
+
+  std::vector<DiffHunk> hunks;
+  size_t pos_a = 0;
+  size_t pos_b = 0;
+  for (const auto &match : matches) {
+    if (match.first > pos_a || match.second > pos_b) {
+      hunks.push_back(
+          {pos_a, match.first - pos_a, pos_b, match.second - pos_b});
+    }
+    pos_a = match.first + 1;
+    pos_b = match.second + 1;
+  }
+  if (pos_a < base.size() || pos_b < other.size()) {
+    hunks.push_back(
+        {pos_a, base.size() - pos_a, pos_b, other.size() - pos_b});
+  }
+  return hunks;
+}
+
+} // namespace merge
+} // namespace wizardmerge
@@ -0,0 +1,173 @@
+/**
+ * @file conflict_markers.cpp
+ * @brief Implementation of conflict-marker parsing
+ */
+
+#include "wizardmerge/merge/conflict_markers.h"
+#include "wizardmerge/text/text_kernels.h"
+
+namespace wizardmerge {
+namespace merge {
+
+namespace {
+
+/**
+ * @brief Finds the next line starting with a "<<<<<<<" marker.
+ *
+ * @return Offset of the marker, or data.size() if there is none
+ */
+size_t find_conflict_start(std::string_view data, size_t from,
+                           size_t marker_size) {
+  while (true) {
+    size_t hit = text::find_line_start(data, '<', from);
+    if (hit == data.size() ||
+        is_conflict_marker(data.substr(hit), '<', marker_size)) {
+      return hit;
+    }
+    from = hit + 1;
+  }
+}
+
+/**
+ * @brief Text after a marker, without the separating space and a
+ *        trailing carriage return.
+ */
+std::string_view marker_label(std::string_view line, size_t marker_size) {
+  std::string_view label = line.substr(marker_size);
+  if (!label.empty() && label.front() == ' ') {
+    label.remove_prefix(1);
+  }
+  if (!label.empty() && label.back() == '\r') {
+    label.remove_suffix(1);
+  }
+  return label;
+}
+
+/**
+ * @brief Appends lines common to all three versions.
+ */
+void append_stable(std::string_view region, ConflictedFile &file) {
+  if (region.empty()) {
+    return;
+  }
+  // Split straight into ours (as split_lines() does), then copy the views
+  size_t first = file.ours.size();
+  size_t pos = 0;
+  while (pos < region.size()) {
+    size_t end = text::find_byte(region, '\n', pos);
+    file.ours.push_back(region.substr(pos, end - pos));
+    pos = end + 1;
+  }
+  file.base.insert(file.base.end(), file.ours.begin() + first,
+                   file.ours.end());
+  file.theirs.insert(file.theirs.end(), file.ours.begin() + first,
+                     file.ours.end());
+}
+
+} // namespace
+
+bool is_conflict_marker(std::string_view line, char marker_char,
+                        size_t marker_size) {
+  if (line.size() < marker_size) {
+    return false;
+  }
+  for (size_t i = 0; i < marker_size; ++i) {
+    if (line[i] != marker_char) {
+      return false;
+    }
+  }
+  if (line.size() == marker_size) {
+    return true;
+  }
+  char next = line[marker_size];
+  return next == ' ' || next == '\r' || next == '\n';
+}
+
+bool parse_conflict_markers(std::string_view data, ConflictedFile &file,
+                            size_t marker_size) {
+  file = ConflictedFile();
+  enum Section { OURS, BASE, THEIRS };
+
+  size_t stable_begin = 0;
+  size_t file_line = 0;
+  while (true) {
+    size_t start = find_conflict_start(data, stable_begin, marker_size);
+    size_t stable_lines = file.ours.size();
+    append_stable(data.substr(stable_begin, start - stable_begin), file);
+    file_line += file.ours.size() - stable_lines;
+    if (start == data.size()) {
+      return true;
+    }
+
+    // Walk the hunk line by line; hunks are short next to the file
+    MarkerHunk hunk;
+    hunk.file_range.begin = file_line;
+    hunk.our_range.begin = file.ours.size();
+    hunk.base_range.begin = file.base.size();
+    hunk.their_range.begin = file.theirs.size();
+    Section section = OURS;
+    bool closed = false;
+    size_t pos = start;
+    bool first = true;
+    while (!closed) {
+      if (pos >= data.size()) {
+        return false; // Not closed
+      }
+      size_t newline = text::find_byte(data, '\n', pos);
+      std::string_view line = data.substr(pos, newline - pos);
+      pos = newline == data.size() ? newline : newline + 1;
+      ++file_line;
+
+      if (first) {
+        hunk.our_label = marker_label(line, marker_size);
+        first = false;
+      } else if (is_conflict_marker(line, '<', marker_size)) {
+        return false; // Nested
+      } else if (is_conflict_marker(line, '|', marker_size)) {
+        if (section != OURS) {
+          return false;
+        }
+        section = BASE;
+        hunk.has_base = true;
+        hunk.base_label = marker_label(line, marker_size);
+      } else if (is_conflict_marker(line, '=', marker_size)) {
+        if (section == THEIRS) {
+          return false;
+        }
+        section = THEIRS;
+      } else if (is_conflict_marker(line, '>', marker_size)) {
+        if (section != THEIRS) {
+          return false;
+        }
+        hunk.their_label = marker_label(line, marker_size);
+        closed = true;
+      } else if (section == OURS) {
+        file.ours.push_back(line);
+      } else if (section == BASE) {
+        file.base.push_back(line);
+      } else {
+        file.theirs.push_back(line);
+      }
+    }
+
+    hunk.file_range.end = file_line;
+    hunk.our_range.end = file.ours.size();
+    hunk.base_range.end = file.base.size();
+    hunk.their_range.end = file.theirs.size();
+    file.hunks.push_back(hunk);
+    stable_begin = pos;
+  }
+}
+
+std::string conflict_marker(char marker_char, std::string_view label,
+                            size_t marker_size) {
+  std::string line(marker_size, marker_char);
+  if (!label.empty()) {
+    line += ' ';
+    line += label;
+  }
+  return line;
+}
+
+} // namespace merge
+} // namespace wizardmerge
@@ -0,0 +1,746 @@
+/**
+ * @file diff.cpp
+ * @brief Implementation of line-level diff algorithms
+ */
+
+#include "wizardmerge/merge/diff.h"
+#include "wizardmerge/merge/bit_lcs.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace wizardmerge {
+namespace merge {
+
+namespace {
+
+using Sequence = std::vector<LineId>;
+
+/**
+ * @brief A run of matching lines: a[x, x + length) == b[y, y + length).
+ */
+struct Snake {
+  size_t x;
+  size_t y;
+  size_t length;
+};
+
+/**
+ * @brief Converts an ordered list of matching runs into diff hunks.
+ */
+std::vector<DiffHunk> snakes_to_hunks(const std::vector<Snake> &snakes,
+                                      size_t n, size_t m) {
+  std::vector<DiffHunk> hunks;
+  size_t pos_a = 0;
+  size_t pos_b = 0;
+
+  for (const auto &snake : snakes) {
+    if (snake.x > pos_a || snake.y > pos_b) {
+      hunks.push_back({pos_a, snake.x - pos_a, pos_b, snake.y - pos_b});
+    }
+    pos_a = snake.x + snake.length;
+    pos_b = snake.y + snake.length;
+  }
+
+  if (pos_a < n || pos_b < m) {
+    hunks.push_back({pos_a, n - pos_a, pos_b, m - pos_b});
+  }
+
+  return hunks;
+}
+
+/**
+ * @brief Greedy Myers search over a[a_lo, a_hi) and b[b_lo, b_hi).
+ *
+ * Records the furthest-reaching D-paths for every edit distance so the
+ * optimal path can be recovered by walking the trace backwards. Matching
+ * runs are appended to @p snakes in ascending order.
+ *
+ * @return false, leaving @p snakes untouched, if the trace would grow
+ *         past @p memory_budget bytes
+ */
+template <typename Equal>
+bool myers_search(size_t a_lo, size_t a_hi, size_t b_lo, size_t b_hi,
+                  const Equal &equal, size_t memory_budget,
+                  std::vector<Snake> &snakes) {
+  const long n = static_cast<long>(a_hi - a_lo);
+  const long m = static_cast<long>(b_hi - b_lo);
+  const long max_d = n + m;
+  const long offset = max_d + 1;
+
+  std::vector<long> v(2 * static_cast<size_t>(max_d) + 3, 0);
+  // trace[d] holds v[-d..d] after round d
+  std::vector<std::vector<long>> trace;
+  size_t trace_bytes = 0;
+
+  long final_d = 0;
+  for (long d = 0; d <= max_d; ++d) {
+    trace_bytes += (2 * static_cast<size_t>(d) + 1) * sizeof(long);
+    if (trace_bytes > memory_budget) {
+      return false;
+    }
+    bool done = false;
+    for (long k = -d; k <= d; k += 2) {
+      long x;
+      if (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) {
+        x = v[offset + k + 1];
+      } else {
+        x = v[offset + k - 1] + 1;
+      }
+      long y = x - k;
+      while (x < n && y < m && equal(a_lo + x, b_lo + y)) {
+        ++x;
+        ++y;
+      }
+      v[offset + k] = x;
+      if (x >= n && y >= m) {
+        done = true;
+      }
+    }
+    trace.emplace_back(v.begin() + (offset - d), v.begin() + (offset + d + 1));
+    if (done) {
+      final_d = d;
+      break;
+    }
+  }
+
+  // Walk back from (n, m) collecting the diagonals of the optimal path
+  std::vector<Snake> reversed;
+  long x = n;
+  long y = m;
+  for (long d = final_d; d > 0; --d) {
+    const auto &prev = trace[d - 1];
+    auto prev_v = [&](long k) { return prev[k + d - 1]; };
+
+    long k = x - y;
+    bool down = (k == -d || (k != d && prev_v(k - 1) < prev_v(k + 1)));
+    long prev_k = down ? k + 1 : k - 1;
+    long prev_x = prev_v(prev_k);
+    long prev_y = prev_x - prev_k;
+    long mid_x = down ? prev_x : prev_x + 1;
+
+    if (x > mid_x) {
+      reversed.push_back({a_lo + static_cast<size_t>(mid_x),
+                          b_lo + static_cast<size_t>(mid_x - k),
+                          static_cast<size_t>(x - mid_x)});
+    }
+    x = prev_x;
+    y = prev_y;
+  }
+  if (x > 0) {
+    reversed.push_back({a_lo, b_lo, static_cast<size_t>(x)});
+  }
+
+  snakes.insert(snakes.end(), reversed.rbegin(), reversed.rend());
+  return true;
+}
+
+/**
+ * @brief Half-open line ranges a[a_lo, a_hi) and b[b_lo, b_hi).
+ */
+struct Range {
+  size_t a_lo;
+  size_t a_hi;
+  size_t b_lo;
+  size_t b_hi;
+};
+
+/**
+ * @brief Pending unit of work for the recursive diff drivers.
+ *
+ * Items are processed in stack order, so a range's pieces are pushed in
+ * reverse to keep the emitted snakes ascending.
+ */
+struct WorkItem {
+  Range range;
+  bool is_snake;
+  Snake snake;
+};
+
+WorkItem range_item(size_t a_lo, size_t a_hi, size_t b_lo, size_t b_hi) {
+  return {{a_lo, a_hi, b_lo, b_hi}, false, {0, 0, 0}};
+}
+
+WorkItem snake_item(size_t x, size_t y, size_t length) {
+  return {{0, 0, 0, 0}, true, {x, y, length}};
+}
+
+/**
+ * @brief Runs a divide-and-conquer diff without recursion.
+ *
+ * Every range first loses its common prefix and suffix. The remaining
+ * middle is handed to @p split, which either pushes sub-ranges and anchor
+ * snakes onto the work stack or resolves the range directly.
+ */
+template <typename Split>
+std::vector<Snake> run_diff(const Sequence &a, const Sequence &b,
+                            Split &split) {
+  std::vector<Snake> snakes;
+  std::vector<WorkItem> stack;
+  stack.push_back(range_item(0, a.size(), 0, b.size()));
+
+  while (!stack.empty()) {
+    WorkItem item = stack.back();
+    stack.pop_back();
+    if (item.is_snake) {
+      if (item.snake.length > 0) {
+        snakes.push_back(item.snake);
+      }
+      continue;
+    }
+
+    Range r = item.range;
+    size_t prefix = 0;
+    while (r.a_lo + prefix < r.a_hi && r.b_lo + prefix < r.b_hi &&
+           a[r.a_lo + prefix] == b[r.b_lo + prefix]) {
+      ++prefix;
+    }
+    if (prefix > 0) {
+      snakes.push_back({r.a_lo, r.b_lo, prefix});
+      r.a_lo += prefix;
+      r.b_lo += prefix;
+    }
+
+    size_t suffix = 0;
+    while (r.a_hi - suffix > r.a_lo && r.b_hi - suffix > r.b_lo &&
+           a[r.a_hi - 1 - suffix] == b[r.b_hi - 1 - suffix]) {
+      ++suffix;
+    }
+    if (suffix > 0) {
+      r.a_hi -= suffix;
+      r.b_hi -= suffix;
+      stack.push_back(snake_item(r.a_hi, r.b_hi, suffix));
+    }
+
+    // Pure insertions or deletions need no further alignment
+    if (r.a_lo == r.a_hi || r.b_lo == r.b_hi) {
+      continue;
+    }
+
+    split(r, stack, snakes);
+  }
+
+  return snakes;
+}
+
+/**
+ * @brief Aligns a hunk-sized range with the bit-parallel LCS kernel.
+ *
+ * @return false, leaving @p snakes untouched, if the range is larger than
+ *         BIT_LCS_MAX_CELLS
+ */
+bool bit_lcs_range(const Sequence &a, const Sequence &b, const Range &r,
+                   std::vector<Snake> &snakes) {
+  size_t n = r.a_hi - r.a_lo;
+  size_t m = r.b_hi - r.b_lo;
+  if (n * m > BIT_LCS_MAX_CELLS) {
+    return false;
+  }
+
+  std::vector<std::pair<size_t, size_t>> matches;
+  lcs_matches(a.data() + r.a_lo, n, b.data() + r.b_lo, m, matches);
+  size_t first = snakes.size();
+  for (const auto &match : matches) {
+    size_t x = r.a_lo + match.first;
+    size_t y = r.b_lo + match.second;
+    if (snakes.size() > first) {
+      Snake &last = snakes.back();
+      if (last.x + last.length == x && last.y + last.length == y) {
+        ++last.length;
+        continue;
+      }
+    }
+    snakes.push_back({x, y, 1});
+  }
+  return true;
+}
+
+/**
+ * @brief Splits a range in two at the middle of an optimal edit path.
+ *
+ * Runs the greedy search from both ends of the range at once until the
+ * forward and backward frontiers overlap (the linear-space refinement in
+ * Myers' paper). Only two diagonal vectors are kept, so memory is
+ * O(N + M) however long the edit script is. Ranges small enough for the
+ * bit-parallel kernel (bounded memory too) are resolved with it.
+ */
+struct BisectSplit {
+  const Sequence &a;
+  const Sequence &b;
+
+  void operator()(const Range &r, std::vector<WorkItem> &stack,
+                  std::vector<Snake> &snakes) const {
+    if (bit_lcs_range(a, b, r, snakes)) {
+      return;
+    }
+    const long n = static_cast<long>(r.a_hi - r.a_lo);
+    const long m = static_cast<long>(r.b_hi - r.b_lo);
+    const long max_d = (n + m + 1) / 2;
+    const long offset = max_d;
+    const long length = 2 * max_d + 2;
+    const long delta = n - m;
+    // With an odd delta the paths meet while extending forwards
+    const bool odd = delta % 2 != 0;
+
+    // Furthest x reached on each diagonal; backward x counts from the end
+    std::vector<long> forward(static_cast<size_t>(length), -1);
+    std::vector<long> backward(static_cast<size_t>(length), -1);
+    forward[offset + 1] = 0;
+    backward[offset + 1] = 0;
+
+    auto a_at = [&](long x) { return a[r.a_lo + static_cast<size_t>(x)]; };
+    auto b_at = [&](long y) { return b[r.b_lo + static_cast<size_t>(y)]; };
+
+    // Diagonals that ran off the edit graph are skipped from then on
+    long k1_start = 0;
+    long k1_end = 0;
+    long k2_start = 0;
+    long k2_end = 0;
+
+    for (long d = 0; d < max_d; ++d) {
+      for (long k1 = -d + k1_start; k1 <= d - k1_end; k1 += 2) {
+        long k1_offset = offset + k1;
+        long x1 = (k1 == -d || (k1 != d && forward[k1_offset - 1] <
+                                               forward[k1_offset + 1]))
+                      ? forward[k1_offset + 1]
+                      : forward[k1_offset - 1] + 1;
+        long y1 = x1 - k1;
+        while (x1 < n && y1 < m && a_at(x1) == b_at(y1)) {
+          ++x1;
+          ++y1;
+        }
+        forward[k1_offset] = x1;
+        if (x1 > n) {
+          k1_end += 2;
+        } else if (y1 > m) {
+          k1_start += 2;
+        } else if (odd) {
+          long k2_offset = offset + delta - k1;
+          if (k2_offset >= 0 && k2_offset < length &&
+              backward[k2_offset] != -1 && x1 >= n - backward[k2_offset]) {
+            split(r, x1, y1, stack);
+            return;
+          }
+        }
+      }
+
+      for (long k2 = -d + k2_start; k2 <= d - k2_end; k2 += 2) {
+        long k2_offset = offset + k2;
+        long x2 = (k2 == -d || (k2 != d && backward[k2_offset - 1] <
+                                               backward[k2_offset + 1]))
+                      ? backward[k2_offset + 1]
+                      : backward[k2_offset - 1] + 1;
+        long y2 = x2 - k2;
+        while (x2 < n && y2 < m && a_at(n - x2 - 1) == b_at(m - y2 - 1)) {
+          ++x2;
+          ++y2;
+        }
+        backward[k2_offset] = x2;
+        if (x2 > n) {
+          k2_end += 2;
+        } else if (y2 > m) {
+          k2_start += 2;
+        } else if (!odd) {
+          long k1_offset = offset + delta - k2;
+          if (k1_offset >= 0 && k1_offset < length &&
+              forward[k1_offset] != -1) {
+            long x1 = forward[k1_offset];
+            long y1 = offset + x1 - k1_offset;
+            if (x1 >= n - x2) {
+              split(r, x1, y1, stack);
+              return;
+            }
+          }
+        }
+      }
+    }
+    // No common line: the whole range is one hunk
+  }
+
+  /**
+   * @brief Queues the two halves of @p r around the point (x, y).
+   */
+  static void split(const Range &r, long x, long y,
+                    std::vector<WorkItem> &stack) {
+    size_t a_mid = r.a_lo + static_cast<size_t>(x);
+    size_t b_mid = r.b_lo + static_cast<size_t>(y);
+    // A split at a corner would requeue the same range
+    if ((a_mid == r.a_lo && b_mid == r.b_lo) ||
+        (a_mid == r.a_hi && b_mid == r.b_hi)) {
+      return;
+    }
+    stack.push_back(range_item(a_mid, r.a_hi, b_mid, r.b_hi));
+    stack.push_back(range_item(r.a_lo, a_mid, r.b_lo, b_mid));
+  }
+};
+
+/**
+ * @brief Resolves a range directly: with the bit-parallel kernel when it
+ *        is small enough, with Myers' algorithm otherwise.
+ *
+ * A search whose trace would exceed the memory budget is abandoned and
+ * the range bisected instead; the halves come back through this split.
+ */
+struct MyersSplit {
+  const Sequence &a;
+  const Sequence &b;
+  size_t memory_budget;
+
+  void operator()(const Range &r, std::vector<WorkItem> &stack,
+                  std::vector<Snake> &snakes) const {
+    if (bit_lcs_range(a, b, r, snakes)) {
+      return;
+    }
+    auto equal = [this](size_t i, size_t j) { return a[i] == b[j]; };
+    if (!myers_search(r.a_lo, r.a_hi, r.b_lo, r.b_hi, equal, memory_budget,
+                      snakes)) {
+      BisectSplit{a, b}(r, stack, snakes);
+    }
+  }
+};
+
+/**
+ * @brief Number of distinct IDs that can appear in a or b.
+ */
+size_t id_bound(const Sequence &a, const Sequence &b) {
+  LineId max_id = 0;
+  for (LineId id : a) {
+    max_id = std::max(max_id, id);
+  }
+  for (LineId id : b) {
+    max_id = std::max(max_id, id);
+  }
+  return static_cast<size_t>(max_id) + 1;
+}
+
+/**
+ * @brief Splits a range at the longest increasing run of unique lines.
+ *
+ * Occurrence counts live in a scratch array indexed by line ID that is
+ * allocated once per diff and cleared after each range.
+ */
+class PatienceSplit {
+public:
+  PatienceSplit(const Sequence &a, const Sequence &b, size_t memory_budget)
+      : a_(a), b_(b), memory_budget_(memory_budget),
+        entries_(id_bound(a, b)) {}
+
+  void operator()(const Range &r, std::vector<WorkItem> &stack,
+                  std::vector<Snake> &snakes) {
+    for (size_t i = r.a_lo; i < r.a_hi; ++i) {
+      Entry &entry = entries_[a_[i]];
+      ++entry.count_a;
+      entry.pos_a = i;
+    }
+    for (size_t j = r.b_lo; j < r.b_hi; ++j) {
+      Entry &entry = entries_[b_[j]];
+      ++entry.count_b;
+      entry.pos_b = j;
+    }
+
+    // Unique common lines in base order
+    std::vector<std::pair<size_t, size_t>> uniques;
+    for (size_t i = r.a_lo; i < r.a_hi; ++i) {
+      const Entry &entry = entries_[a_[i]];
+      if (entry.count_a == 1 && entry.count_b == 1) {
+        uniques.emplace_back(i, entry.pos_b);
+      }
+    }
+
+    for (size_t i = r.a_lo; i < r.a_hi; ++i) {
+      entries_[a_[i]] = Entry();
+    }
+    for (size_t j = r.b_lo; j < r.b_hi; ++j) {
+      entries_[b_[j]] = Entry();
+    }
+
+    // Longest increasing subsequence of their positions in other
+    std::vector<size_t> tails;
+    std::vector<size_t> previous(uniques.size(), SIZE_MAX);
+    for (size_t k = 0; k < uniques.size(); ++k) {
+      auto it = std::lower_bound(tails.begin(), tails.end(), k,
+                                 [&](size_t t, size_t value) {
+                                   return uniques[t].second <
+                                          uniques[value].second;
+                                 });
+      if (it != tails.begin()) {
+        previous[k] = *(it - 1);
+      }
+      if (it == tails.end()) {
+        tails.push_back(k);
+      } else {
+        *it = k;
+      }
+    }
+
+    if (tails.empty()) {
+      MyersSplit{a_, b_, memory_budget_}(r, stack, snakes);
+      return;
+    }
+
+    std::vector<size_t> anchors;
+    for (size_t k = tails.back(); k != SIZE_MAX; k = previous[k]) {
+      anchors.push_back(k);
+    }
+
+    // anchors is in descending order: push the gaps from the end backwards
+    size_t a_hi = r.a_hi;
+    size_t b_hi = r.b_hi;
+    for (size_t k : anchors) {
+      size_t ai = uniques[k].first;
+      size_t bj = uniques[k].second;
+      stack.push_back(range_item(ai + 1, a_hi, bj + 1, b_hi));
+      stack.push_back(snake_item(ai, bj, 1));
+      a_hi = ai;
+      b_hi = bj;
+    }
+    stack.push_back(range_item(r.a_lo, a_hi, r.b_lo, b_hi));
+  }
+
+private:
+  struct Entry {
+    size_t count_a = 0;
+    size_t count_b = 0;
+    size_t pos_a = 0;
+    size_t pos_b = 0;
+  };
+
+  const Sequence &a_;
+  const Sequence &b_;
+  size_t memory_budget_;
+  std::vector<Entry> entries_;
+};
+
+/**
+ * @brief Splits a range at the common region with the rarest anchor line.
+ *
+ * Occurrence chains live in scratch arrays indexed by line ID (records)
+ * and by base position (next), both allocated once per diff.
+ */
+class HistogramSplit {
+public:
+  HistogramSplit(const Sequence &a, const Sequence &b, size_t memory_budget)
+      : a_(a), b_(b), memory_budget_(memory_budget), records_(id_bound(a, b)),
+        next_(a.size(), SIZE_MAX) {}
+
+  void operator()(const Range &r, std::vector<WorkItem> &stack,
+                  std::vector<Snake> &snakes) {
+    for (size_t i = r.a_lo; i < r.a_hi; ++i) {
+      Record &record = records_[a_[i]];
+      next_[i] = record.count > 0 ? record.head : SIZE_MAX;
+      record.head = i;
+      ++record.count;
+    }
+
+    size_t best_count = HISTOGRAM_MAX_CHAIN + 1;
+    size_t best_len = 0;
+    size_t best_a = 0;
+    size_t best_b = 0;
+
+    bool any_common = false;
+    size_t j = r.b_lo;
+    while (j < r.b_hi) {
+      size_t b_next = j + 1;
+      const Record &record = records_[b_[j]];
+      any_common = any_common || record.count > 0;
+      if (record.count > 0 && record.count <= HISTOGRAM_MAX_CHAIN &&
+          record.count <= best_count) {
+        for (size_t i = record.head; i != SIZE_MAX; i = next_[i]) {
+          size_t as = i;
+          size_t bs = j;
+          size_t rc = record.count;
+          while (as > r.a_lo && bs > r.b_lo && a_[as - 1] == b_[bs - 1]) {
+            --as;
+            --bs;
+            rc = std::min(rc, records_[a_[as]].count);
+          }
+          size_t ae = i + 1;
+          size_t be = j + 1;
+          while (ae < r.a_hi && be < r.b_hi && a_[ae] == b_[be]) {
+            rc = std::min(rc, records_[a_[ae]].count);
+            ++ae;
+            ++be;
+          }
+          if (b_next < be) {
+            b_next = be;
+          }
+          if (ae - as > best_len || rc < best_count) {
+            best_len = ae - as;
+            best_count = rc;
+            best_a = as;
+            best_b = bs;
+          }
+        }
+      }
+      j = b_next;
+    }
+
+    for (size_t i = r.a_lo; i < r.a_hi; ++i) {
+      records_[a_[i]] = Record();
+    }
+
+    // No common line at all (a rewrite): the whole range is one hunk
+    if (!any_common) {
+      return;
+    }
+    if (best_len == 0) {
+      MyersSplit{a_, b_, memory_budget_}(r, stack, snakes);
+      return;
+    }
+
+    stack.push_back(
+        range_item(best_a + best_len, r.a_hi, best_b + best_len, r.b_hi));
+    stack.push_back(snake_item(best_a, best_b, best_len));
+    stack.push_back(range_item(r.a_lo, best_a, r.b_lo, best_b));
+  }
+
+private:
+  struct Record {
+    size_t head = 0;  // Most recent occurrence in a
+    size_t count = 0; // Occurrences in a within the current range
+  };
+
+  const Sequence &a_;
+  const Sequence &b_;
+  size_t memory_budget_;
+  std::vector<Record> records_;
+  std::vector<size_t> next_; // Previous occurrence of the same line
+};
+
+/**
+ * @brief Interns two string sequences into one table and diffs the IDs.
+ */
+template <typename Diff>
+std::vector<DiffHunk> diff_strings(const std::vector<std::string> &base,
+                                   const std::vector<std::string> &other,
+                                   const Diff &diff) {
+  LineTable table(base.size() + other.size());
+  return diff(table.intern_lines(base), table.intern_lines(other));
+}
+
+/**
+ * @brief Runs the divide-and-conquer driver with a split that falls back
+ *        to Myers under a trace memory budget.
+ */
+template <typename Split>
+std::vector<DiffHunk> diff_ids(const Sequence &a, const Sequence &b,
+                               size_t memory_budget) {
+  Split split{a, b, memory_budget};
+  return snakes_to_hunks(run_diff(a, b, split), a.size(), b.size());
+}
+
+} // anonymous namespace
+
+std::vector<DiffHunk> myers_diff(const std::vector<LineId> &base,
+                                 const std::vector<LineId> &other) {
+  return diff_ids<MyersSplit>(base, other, DIFF_MEMORY_BUDGET);
+}
+
+std::vector<DiffHunk> myers_linear_diff(const std::vector<LineId> &base,
+                                        const std::vector<LineId> &other) {
+  BisectSplit split{base, other};
+  return snakes_to_hunks(run_diff(base, other, split), base.size(),
+                         other.size());
+}
+
+std::vector<DiffHunk> patience_diff(const std::vector<LineId> &base,
+                                    const std::vector<LineId> &other) {
+  return diff_ids<PatienceSplit>(base, other, DIFF_MEMORY_BUDGET);
+}
+
+std::vector<DiffHunk> histogram_diff(const std::vector<LineId> &base,
+                                     const std::vector<LineId> &other) {
+  return diff_ids<HistogramSplit>(base, other, DIFF_MEMORY_BUDGET);
+}
+
+std::vector<DiffHunk> compute_diff(const std::vector<LineId> &base,
+                                   const std::vector<LineId> &other,
+                                   DiffAlgorithm algorithm,
+                                   size_t memory_budget) {
+  switch (algorithm) {
+  case DiffAlgorithm::MYERS:
+    return diff_ids<MyersSplit>(base, other, memory_budget);
+  case DiffAlgorithm::PATIENCE:
+    return diff_ids<PatienceSplit>(base, other, memory_budget);
+  case DiffAlgorithm::HISTOGRAM:
+    return diff_ids<HistogramSplit>(base, other, memory_budget);
+  case DiffAlgorithm::AUTO:
+  default:
+    if (std::max(base.size(), other.size()) >= HISTOGRAM_AUTO_THRESHOLD) {
+      return diff_ids<HistogramSplit>(base, other, memory_budget);
+    }
+    return diff_ids<MyersSplit>(base, other, memory_budget);
+  }
+}
+
+std::vector<DiffHunk> myers_diff(const std::vector<std::string> &base,
+                                 const std::vector<std::string> &other) {
+  return diff_strings(base, other, [](const Sequence &a, const Sequence &b) {
+    return myers_diff(a, b);
+  });
+}
+
+std::vector<DiffHunk>
+myers_linear_diff(const std::vector<std::string> &base,
+                  const std::vector<std::string> &other) {
+  return diff_strings(base, other, [](const Sequence &a, const Sequence &b) {
+    return myers_linear_diff(a, b);
+  });
+}
+
+std::vector<DiffHunk> patience_diff(const std::vector<std::string> &base,
+                                    const std::vector<std::string> &other) {
+  return diff_strings(base, other, [](const Sequence &a, const Sequence &b) {
+    return patience_diff(a, b);
+  });
+}
+
+std::vector<DiffHunk> histogram_diff(const std::vector<std::string> &base,
+                                     const std::vector<std::string> &other) {
+  return diff_strings(base, other, [](const Sequence &a, const Sequence &b) {
+    return histogram_diff(a, b);
+  });
+}
+
+std::vector<DiffHunk> compute_diff(const std::vector<std::string> &base,
+                                   const std::vector<std::string> &other,
+                                   DiffAlgorithm algorithm,
+                                   size_t memory_budget) {
+  return diff_strings(
+      base, other,
+      [algorithm, memory_budget](const Sequence &a, const Sequence &b) {
+        return compute_diff(a, b, algorithm, memory_budget);
+      });
+}
+
+std::string diff_algorithm_to_string(DiffAlgorithm algorithm) {
+  switch (algorithm) {
+  case DiffAlgorithm::AUTO:
+    return "auto";
+  case DiffAlgorithm::MYERS:
+    return "myers";
+  case DiffAlgorithm::PATIENCE:
+    return "patience";
+  case DiffAlgorithm::HISTOGRAM:
+    return "histogram";
+  default:
+    return "unknown";
+  }
+}
+
+bool parse_diff_algorithm(const std::string &name, DiffAlgorithm &algorithm) {
+  if (name == "auto") {
+    algorithm = DiffAlgorithm::AUTO;
+  } else if (name == "myers") {
+    algorithm = DiffAlgorithm::MYERS;
+  } else if (name == "patience") {
+    algorithm = DiffAlgorithm::PATIENCE;
+  } else if (name == "histogram") {
+    algorithm = DiffAlgorithm::HISTOGRAM;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+} // namespace merge
+} // namespace wizardmerge
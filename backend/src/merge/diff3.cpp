@@ -0,0 +1,129 @@
+/**
+ * @file diff3.cpp
+ * @brief Implementation of the diff3 region walk
+ */
+
+#include "wizardmerge/merge/diff3.h"
+#include <algorithm>
+
+namespace wizardmerge {
+namespace merge {
+
+namespace {
+
+/**
+ * @brief Index range [begin, end) within one sequence.
+ */
+struct Span {
+  size_t begin;
+  size_t end;
+};
+
+/**
+ * @brief Maps a base range to the corresponding range of a derived version.
+ *
+ * @param hunks All hunks of the base→version diff
+ * @param first Index of the first hunk inside the region
+ * @param last One past the last hunk inside the region
+ * @param lo Region start in base
+ * @param hi Region end in base
+ * @param delta Offset (version index - base index) before the region
+ */
+Span map_region(const std::vector<DiffHunk> &hunks, size_t first, size_t last,
+                size_t lo, size_t hi, long delta) {
+  if (first == last) {
+    return {static_cast<size_t>(static_cast<long>(lo) + delta),
+            static_cast<size_t>(static_cast<long>(hi) + delta)};
+  }
+  const DiffHunk &head = hunks[first];
+  const DiffHunk &tail = hunks[last - 1];
+  return {head.other_start - (head.base_start - lo),
+          tail.other_end() + (hi - tail.base_end())};
+}
+
+bool ranges_equal(const std::vector<LineId> &a, Span a_span,
+                  const std::vector<LineId> &b, Span b_span) {
+  if (a_span.end - a_span.begin != b_span.end - b_span.begin) {
+    return false;
+  }
+  return std::equal(a.begin() + a_span.begin, a.begin() + a_span.end,
+                    b.begin() + b_span.begin);
+}
+
+} // namespace
+
+std::vector<Diff3Region>
+diff3_regions(const std::vector<LineId> &our_ids,
+              const std::vector<LineId> &their_ids,
+              const std::vector<DiffHunk> &our_hunks,
+              const std::vector<DiffHunk> &their_hunks) {
+  std::vector<Diff3Region> regions;
+  size_t oi = 0;
+  size_t ti = 0;
+  long our_delta = 0;
+  long their_delta = 0;
+
+  while (oi < our_hunks.size() || ti < their_hunks.size()) {
+    // Start the region at whichever hunk comes first in base
+    bool take_ours =
+        ti >= their_hunks.size() ||
+        (oi < our_hunks.size() &&
+         our_hunks[oi].base_start <= their_hunks[ti].base_start);
+    size_t lo = take_ours ? our_hunks[oi].base_start
+                          : their_hunks[ti].base_start;
+    size_t hi = take_ours ? our_hunks[oi].base_end()
+                          : their_hunks[ti].base_end();
+    size_t o_first = oi;
+    size_t t_first = ti;
+    if (take_ours) {
+      ++oi;
+    } else {
+      ++ti;
+    }
+
+    // Absorb every hunk of either script that overlaps the region
+    bool grew = true;
+    while (grew) {
+      grew = false;
+      if (oi < our_hunks.size() && (our_hunks[oi].base_start < hi ||
+                                    our_hunks[oi].base_start == lo)) {
+        hi = std::max(hi, our_hunks[oi].base_end());
+        ++oi;
+        grew = true;
+      }
+      if (ti < their_hunks.size() && (their_hunks[ti].base_start < hi ||
+                                      their_hunks[ti].base_start == lo)) {
+        hi = std::max(hi, their_hunks[ti].base_end());
+        ++ti;
+        grew = true;
+      }
+    }
+
+    Span our_span = map_region(our_hunks, o_first, oi, lo, hi, our_delta);
+    Span their_span =
+        map_region(their_hunks, t_first, ti, lo, hi, their_delta);
+    bool ours_changed = oi > o_first;
+    bool theirs_changed = ti > t_first;
+
+    Diff3Region::Kind kind;
+    if (!theirs_changed) {
+      kind = Diff3Region::OURS;
+    } else if (!ours_changed) {
+      kind = Diff3Region::THEIRS;
+    } else if (ranges_equal(our_ids, our_span, their_ids, their_span)) {
+      kind = Diff3Region::SAME;
+    } else {
+      kind = Diff3Region::CONFLICT;
+    }
+    regions.push_back({kind, lo, hi, our_span.begin, our_span.end,
+                       their_span.begin, their_span.end});
+
+    our_delta = static_cast<long>(our_span.end) - static_cast<long>(hi);
+    their_delta = static_cast<long>(their_span.end) - static_cast<long>(hi);
+  }
+
+  return regions;
+}
+
+} // namespace merge
+} // namespace wizardmerge
@@ -0,0 +1,159 @@
+/**
+ * @file line_table.cpp
+ * @brief Implementation of the line interning table
+ */
+
+#include "wizardmerge/merge/line_table.h"
+#include "wizardmerge/text/text_kernels.h"
+
+namespace wizardmerge {
+namespace merge {
+
+uint64_t hash_line(std::string_view line) { return text::hash_bytes(line); }
+
+std::string_view normalize_line(std::string_view line,
+                                const CompareOptions &compare,
+                                std::string &scratch) {
+  if (compare.exact()) {
+    return line;
+  }
+  if (compare.ignore_eol && !line.empty() && line.back() == '\r') {
+    line.remove_suffix(1);
+  }
+
+  scratch.clear();
+  bool in_space = false;
+  for (char c : line) {
+    if (text::is_whitespace(c) &&
+        (compare.ignore_all_space || compare.ignore_space_change)) {
+      in_space = true;
+      continue;
+    }
+    // A run of whitespace between other characters becomes one space
+    if (in_space && compare.ignore_space_change &&
+        !compare.ignore_all_space) {
+      scratch.push_back(' ');
+    }
+    in_space = false;
+    if (compare.ignore_case && c >= 'A' && c <= 'Z') {
+      c = static_cast<char>(c - 'A' + 'a');
+    }
+    scratch.push_back(c);
+  }
+  return scratch;
+}
+
+bool lines_equivalent(std::string_view a, std::string_view b,
+                      const CompareOptions &compare) {
+  if (compare.exact()) {
+    return text::bytes_equal(a, b);
+  }
+  std::string scratch_a;
+  std::string scratch_b;
+  return text::bytes_equal(normalize_line(a, compare, scratch_a),
+                           normalize_line(b, compare, scratch_b));
+}
+
+bool parse_ignore_option(const std::string &name, CompareOptions &compare) {
+  if (name == "all-space") {
+    compare.ignore_all_space = true;
+  } else if (name == "space-change") {
+    compare.ignore_space_change = true;
+  } else if (name == "eol") {
+    compare.ignore_eol = true;
+  } else if (name == "case") {
+    compare.ignore_case = true;
+  } else if (name == "blank-lines") {
+    compare.ignore_blank_lines = true;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+LineTable::LineTable(size_t expected_lines)
+    : LineTable(expected_lines, CompareOptions()) {}
+
+LineTable::LineTable(size_t expected_lines, const CompareOptions &compare)
+    : compare_(compare) {
+  size_t capacity = 16;
+  while (capacity < expected_lines * 2) {
+    capacity <<= 1;
+  }
+  slots_.assign(capacity, EMPTY_SLOT);
+  mask_ = capacity - 1;
+  texts_.reserve(expected_lines);
+  hashes_.reserve(expected_lines);
+}
+
+std::string_view LineTable::key(LineId id) const {
+  if (compare_.exact()) {
+    return texts_[id];
+  }
+  size_t begin = id == 0 ? 0 : key_ends_[id - 1];
+  return std::string_view(keys_).substr(begin, key_ends_[id] - begin);
+}
+
+LineId LineTable::intern(std::string_view line) {
+  std::string_view normalized = normalize_line(line, compare_, scratch_);
+  uint64_t h = hash_line(normalized);
+  size_t slot = static_cast<size_t>(h) & mask_;
+
+  while (slots_[slot] != EMPTY_SLOT) {
+    LineId id = slots_[slot];
+    // Verify on hash match so collisions never merge distinct lines
+    if (hashes_[id] == h && text::bytes_equal(key(id), normalized)) {
+      return id;
+    }
+    slot = (slot + 1) & mask_;
+  }
+
+  LineId id = static_cast<LineId>(texts_.size());
+  slots_[slot] = id;
+  texts_.push_back(line);
+  hashes_.push_back(h);
+  if (!compare_.exact()) {
+    keys_.append(normalized);
+    key_ends_.push_back(keys_.size());
+  }
+
+  if (texts_.size() * 2 > slots_.size()) {
+    grow();
+  }
+  return id;
+}
+
+std::vector<LineId>
+LineTable::intern_lines(const std::vector<std::string> &lines) {
+  std::vector<LineId> ids;
+  ids.reserve(lines.size());
+  for (const auto &line : lines) {
+    ids.push_back(intern(line));
+  }
+  return ids;
+}
+
+std::vector<LineId>
+LineTable::intern_lines(const std::vector<std::string_view> &lines) {
+  std::vector<LineId> ids;
+  ids.reserve(lines.size());
+  for (std::string_view line : lines) {
+    ids.push_back(intern(line));
+  }
+  return ids;
+}
+
+void LineTable::grow() {
+  slots_.assign(slots_.size() * 2, EMPTY_SLOT);
+  mask_ = slots_.size() - 1;
+  for (LineId id = 0; id < texts_.size(); ++id) {
+    size_t slot = static_cast<size_t>(hashes_[id]) & mask_;
+    while (slots_[slot] != EMPTY_SLOT) {
+      slot = (slot + 1) & mask_;
+    }
+    slots_[slot] = id;
+  }
+}
+
+} // namespace merge
+} // namespace wizardmerge
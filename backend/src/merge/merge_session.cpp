@@ -0,0 +1,269 @@
+/**
+ * @file merge_session.cpp
+ * @brief Implementation of the incremental merge session
+ */
+
+#include "wizardmerge/merge/merge_session.h"
+#include "wizardmerge/merge/anchors.h"
+#include "wizardmerge/merge/line_table.h"
+#include "wizardmerge/merge/thread_pool.h"
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <string_view>
+
+namespace wizardmerge {
+namespace merge {
+
+namespace {
+
+std::vector<std::string_view> views(const std::vector<std::string> &lines,
+                                    LineRange range) {
+  return std::vector<std::string_view>(lines.begin() + range.begin,
+                                       lines.begin() + range.end);
+}
+
+LineRange offset_range(LineRange range, size_t offset) {
+  return {range.begin + offset, range.end + offset};
+}
+
+// Unsigned wrap-around makes negative deltas work too
+size_t shift(size_t value, std::ptrdiff_t delta) {
+  return value + static_cast<size_t>(delta);
+}
+
+/**
+ * @brief Replaces lines [range.begin, range.end) of @p text.
+ *
+ * @return Change in the number of lines
+ */
+std::ptrdiff_t splice(std::vector<std::string> &text, LineRange range,
+                      const std::vector<std::string> &lines) {
+  size_t old_size = range.end - range.begin;
+  size_t common = std::min(old_size, lines.size());
+  std::copy(lines.begin(), lines.begin() + common,
+            text.begin() + range.begin);
+  if (lines.size() > old_size) {
+    text.insert(text.begin() + range.end, lines.begin() + common,
+                lines.end());
+  } else {
+    text.erase(text.begin() + range.begin + common,
+               text.begin() + range.end);
+  }
+  return static_cast<std::ptrdiff_t>(lines.size()) -
+         static_cast<std::ptrdiff_t>(old_size);
+}
+
+} // namespace
+
+MergeSession::MergeSession(std::vector<std::string> base,
+                           std::vector<std::string> ours,
+                           std::vector<std::string> theirs,
+                           const MergeOptions &options)
+    : base_(std::move(base)), ours_(std::move(ours)),
+      theirs_(std::move(theirs)), options_(options), remerged_lines_(0) {
+  Chunk whole;
+  whole.base = {0, base_.size()};
+  whole.ours = {0, ours_.size()};
+  whole.theirs = {0, theirs_.size()};
+  chunks_ = build_chunks(whole);
+
+  if (options_.threads != 1 && chunks_.size() > 1) {
+    std::optional<ThreadPool> own_pool;
+    ThreadPool &pool =
+        options_.pool ? *options_.pool : own_pool.emplace(options_.threads);
+    pool.parallel_for(chunks_.size(),
+                      [this](size_t i) { merge_chunk(chunks_[i]); });
+  } else {
+    for (auto &chunk : chunks_) {
+      merge_chunk(chunk);
+    }
+  }
+  remerged_lines_ = base_.size() + ours_.size() + theirs_.size();
+}
+
+bool MergeSession::apply_edit(EditTarget target, size_t begin, size_t end,
+                              const std::vector<std::string> &lines) {
+  if (begin > end) {
+    return false;
+  }
+
+  if (target == EditTarget::RESULT) {
+    // Find the conflict shown at exactly these lines
+    size_t offset = 0;
+    for (size_t k = 0; k < chunks_.size(); ++k) {
+      const Chunk &chunk = chunks_[k];
+      size_t size = chunk.result.merged_lines.size();
+      if (begin >= offset + size) {
+        offset += size;
+        continue;
+      }
+      // end_line is inclusive, end is one past the last line
+      for (const auto &conflict : chunk.result.conflicts) {
+        if (conflict.start_line + offset != begin ||
+            conflict.end_line + 1 + offset != end) {
+          continue;
+        }
+        // Both sides make the same change, which merges cleanly
+        LineRange ours = offset_range(conflict.our_range, chunk.ours.begin);
+        LineRange theirs =
+            offset_range(conflict.their_range, chunk.theirs.begin);
+        std::ptrdiff_t ours_delta = splice(ours_, ours, lines);
+        std::ptrdiff_t theirs_delta = splice(theirs_, theirs, lines);
+        remerge(k, k, ours_delta, theirs_delta);
+        return true;
+      }
+      return false;
+    }
+    return false;
+  }
+
+  bool is_ours = target == EditTarget::OURS;
+  std::vector<std::string> &text = is_ours ? ours_ : theirs_;
+  LineRange Chunk::*side = is_ours ? &Chunk::ours : &Chunk::theirs;
+  if (end > text.size()) {
+    return false;
+  }
+
+  // An edit starting at a chunk boundary may change the anchor line or
+  // belong to the chunk before it, so that chunk is merged again too
+  size_t first = chunk_at(side, begin > 0 ? begin - 1 : 0);
+  size_t last = chunk_at(side, end > begin ? end - 1 : begin);
+  std::ptrdiff_t delta = splice(text, {begin, end}, lines);
+  remerge(first, last, is_ours ? delta : 0, is_ours ? 0 : delta);
+  return true;
+}
+
+MergeResult
+MergeSession::result(const MergeResult::allocator_type &alloc) const {
+  MergeResult merged(alloc);
+  for (const Chunk &chunk : chunks_) {
+    size_t offset = merged.merged_lines.size();
+    for (const auto &line : chunk.result.merged_lines) {
+      merged.merged_lines.push_back(line);
+    }
+    for (const auto &source : chunk.result.conflicts) {
+      Conflict &conflict = merged.conflicts.emplace_back(source);
+      conflict.start_line += offset;
+      conflict.end_line += offset;
+      conflict.base_range = offset_range(conflict.base_range, chunk.base.begin);
+      conflict.our_range = offset_range(conflict.our_range, chunk.ours.begin);
+      conflict.their_range =
+          offset_range(conflict.their_range, chunk.theirs.begin);
+      if (conflict.analysis >= AnalysisLevel::CONTEXT) {
+        // Lines inserted or removed above the chunk since its analysis
+        size_t moved = chunk.ours.begin - chunk.analyzed_ours_begin;
+        conflict.context.start_line += moved;
+        conflict.context.end_line += moved;
+      }
+    }
+  }
+  return merged;
+}
+
+std::vector<MergeSession::Chunk>
+MergeSession::build_chunks(const Chunk &span) const {
+  std::vector<std::string_view> base = views(base_, span.base);
+  std::vector<std::string_view> ours = views(ours_, span.ours);
+  std::vector<std::string_view> theirs = views(theirs_, span.theirs);
+
+  LineTable table(base.size() + ours.size() + theirs.size());
+  std::vector<LineId> base_ids = table.intern_lines(base);
+  std::vector<LineId> our_ids = table.intern_lines(ours);
+  std::vector<LineId> their_ids = table.intern_lines(theirs);
+
+  // Cut before anchors, at least SESSION_CHUNK_LINES base lines apart
+  std::vector<Chunk> chunks;
+  Chunk current;
+  current.base.begin = span.base.begin;
+  current.ours.begin = span.ours.begin;
+  current.theirs.begin = span.theirs.begin;
+  for (const Anchor &anchor :
+       find_anchors(base_ids, our_ids, their_ids, table.size())) {
+    size_t cut = span.base.begin + anchor.base;
+    if (cut - current.base.begin < SESSION_CHUNK_LINES) {
+      continue;
+    }
+    current.base.end = cut;
+    current.ours.end = span.ours.begin + anchor.ours;
+    current.theirs.end = span.theirs.begin + anchor.theirs;
+    chunks.push_back(std::move(current));
+
+    current = Chunk();
+    current.base.begin = chunks.back().base.end;
+    current.ours.begin = chunks.back().ours.end;
+    current.theirs.begin = chunks.back().theirs.end;
+  }
+  current.base.end = span.base.end;
+  current.ours.end = span.ours.end;
+  current.theirs.end = span.theirs.end;
+  chunks.push_back(std::move(current));
+  return chunks;
+}
+
+void MergeSession::merge_chunk(Chunk &chunk) const {
+  MergeOptions options = options_;
+  options.threads = 1;
+  options.analysis = AnalysisLevel::NONE;
+  chunk.result =
+      three_way_merge(views(base_, chunk.base), views(ours_, chunk.ours),
+                      views(theirs_, chunk.theirs), options);
+
+  // Analyze against the whole file, so that function, class and import
+  // context outside the chunk is found
+  for (auto &conflict : chunk.result.conflicts) {
+    LineRange base = conflict.base_range;
+    LineRange ours = conflict.our_range;
+    LineRange theirs = conflict.their_range;
+    conflict.base_range = offset_range(base, chunk.base.begin);
+    conflict.our_range = offset_range(ours, chunk.ours.begin);
+    conflict.their_range = offset_range(theirs, chunk.theirs.begin);
+    analyze_conflict(conflict, base_, ours_, theirs_, options_.analysis);
+    conflict.base_range = base;
+    conflict.our_range = ours;
+    conflict.their_range = theirs;
+  }
+  chunk.analyzed_ours_begin = chunk.ours.begin;
+}
+
+void MergeSession::remerge(size_t first, size_t last,
+                           std::ptrdiff_t ours_delta,
+                           std::ptrdiff_t theirs_delta) {
+  Chunk span;
+  span.base = {chunks_[first].base.begin, chunks_[last].base.end};
+  span.ours = {chunks_[first].ours.begin,
+               shift(chunks_[last].ours.end, ours_delta)};
+  span.theirs = {chunks_[first].theirs.begin,
+                 shift(chunks_[last].theirs.end, theirs_delta)};
+
+  for (size_t k = last + 1; k < chunks_.size(); ++k) {
+    chunks_[k].ours = {shift(chunks_[k].ours.begin, ours_delta),
+                       shift(chunks_[k].ours.end, ours_delta)};
+    chunks_[k].theirs = {shift(chunks_[k].theirs.begin, theirs_delta),
+                         shift(chunks_[k].theirs.end, theirs_delta)};
+  }
+
+  std::vector<Chunk> rebuilt = build_chunks(span);
+  for (auto &chunk : rebuilt) {
+    merge_chunk(chunk);
+  }
+  remerged_lines_ = (span.base.end - span.base.begin) +
+                    (span.ours.end - span.ours.begin) +
+                    (span.theirs.end - span.theirs.begin);
+
+  chunks_.erase(chunks_.begin() + first, chunks_.begin() + last + 1);
+  chunks_.insert(chunks_.begin() + first,
+                 std::make_move_iterator(rebuilt.begin()),
+                 std::make_move_iterator(rebuilt.end()));
+}
+
+size_t MergeSession::chunk_at(LineRange Chunk::*side, size_t line) const {
+  auto it = std::upper_bound(chunks_.begin(), chunks_.end(), line,
+                             [side](size_t value, const Chunk &chunk) {
+                               return value < (chunk.*side).begin;
+                             });
+  return it == chunks_.begin() ? 0 : it - chunks_.begin() - 1;
+}
+
+} // namespace merge
+} // namespace wizardmerge
@@ -0,0 +1,222 @@
+/**
+ * @file moves.cpp
+ * @brief Implementation of moved-block detection
+ */
+
+#include "wizardmerge/merge/moves.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+namespace wizardmerge {
+namespace merge {
+
+namespace {
+
+// Hits verified per shingle, so repetitive content stays linear
+constexpr size_t MAX_MOVE_CANDIDATES = 16;
+
+constexpr uint64_t ROLLING_BASE = 0x100000001B3ULL;
+
+/**
+ * @brief Polynomial hash of the k IDs starting at @p ids.
+ */
+uint64_t shingle_hash(const LineId *ids, size_t k) {
+  uint64_t hash = 0;
+  for (size_t i = 0; i < k; ++i) {
+    hash = hash * ROLLING_BASE + ids[i] + 1;
+  }
+  return hash;
+}
+
+/**
+ * @brief Hash of k consecutive IDs, rolled forward one ID at a time.
+ */
+class RollingHash {
+public:
+  RollingHash(const LineId *ids, size_t k) : ids_(ids), k_(k), top_(1) {
+    for (size_t i = 1; i < k; ++i) {
+      top_ *= ROLLING_BASE;
+    }
+  }
+
+  /**
+   * @brief Starts over at the shingle beginning at @p pos.
+   */
+  void reset(size_t pos) {
+    pos_ = pos;
+    hash_ = shingle_hash(ids_ + pos, k_);
+  }
+
+  /**
+   * @brief Moves to the next shingle; the ID after the current one must
+   *        exist.
+   */
+  void roll() {
+    hash_ = (hash_ - (ids_[pos_] + uint64_t(1)) * top_) * ROLLING_BASE +
+            ids_[pos_ + k_] + 1;
+    ++pos_;
+  }
+
+  uint64_t hash() const { return hash_; }
+
+private:
+  const LineId *ids_;
+  size_t k_;
+  uint64_t top_; // ROLLING_BASE^(k-1), the weight of the outgoing ID
+  size_t pos_ = 0;
+  uint64_t hash_ = 0;
+};
+
+/**
+ * @brief Base shingles inside deletions, chained per hash.
+ */
+class ShingleIndex {
+public:
+  ShingleIndex(const std::vector<LineId> &base_ids,
+               const std::vector<DiffHunk> &hunks, size_t k) {
+    RollingHash rolling(base_ids.data(), k);
+    for (const auto &hunk : hunks) {
+      if (hunk.base_count < k) {
+        continue;
+      }
+      rolling.reset(hunk.base_start);
+      for (size_t i = hunk.base_start; i + k <= hunk.base_end(); ++i) {
+        if (i > hunk.base_start) {
+          rolling.roll();
+        }
+        size_t added = entries_.size();
+        entries_.push_back({i, hunk.base_end(), NONE});
+        // Chains stay in base order: append behind the last entry
+        auto chain = chains_.emplace(rolling.hash(), Chain{added, added});
+        if (!chain.second) {
+          entries_[chain.first->second.last].next = added;
+          chain.first->second.last = added;
+        }
+      }
+    }
+  }
+
+  static constexpr size_t NONE = SIZE_MAX;
+
+  struct Entry {
+    size_t base;
+    size_t deletion_end; // End of the deletion holding the shingle
+    size_t next;
+  };
+
+  size_t first(uint64_t hash) const {
+    auto it = chains_.find(hash);
+    return it == chains_.end() ? NONE : it->second.first;
+  }
+
+  const Entry &entry(size_t index) const { return entries_[index]; }
+
+private:
+  struct Chain {
+    size_t first;
+    size_t last;
+  };
+
+  std::unordered_map<uint64_t, Chain> chains_;
+  std::vector<Entry> entries_;
+};
+
+/**
+ * @brief Slides every pure insertion and pure deletion down for as long
+ *        as the edit script stays equivalent.
+ *
+ * A block inserted next to a copy of its own last line can be placed one
+ * line up or down; the diff may pick either, cutting the block at the
+ * wrong line. Sliding down ends blocks at their last repeated line (a
+ * closing brace, typically) on both sides.
+ */
+std::vector<DiffHunk> slide_down(const std::vector<LineId> &base_ids,
+                                 const std::vector<LineId> &other_ids,
+                                 std::vector<DiffHunk> hunks) {
+  for (size_t h = 0; h < hunks.size(); ++h) {
+    DiffHunk &hunk = hunks[h];
+    // Unchanged lines up to the next hunk
+    size_t base_limit =
+        h + 1 < hunks.size() ? hunks[h + 1].base_start : base_ids.size();
+    size_t other_limit =
+        h + 1 < hunks.size() ? hunks[h + 1].other_start : other_ids.size();
+    if (hunk.base_count == 0) {
+      while (hunk.other_end() < other_limit &&
+             other_ids[hunk.other_start] == other_ids[hunk.other_end()]) {
+        ++hunk.base_start;
+        ++hunk.other_start;
+      }
+    } else if (hunk.other_count == 0) {
+      while (hunk.base_end() < base_limit &&
+             base_ids[hunk.base_start] == base_ids[hunk.base_end()]) {
+        ++hunk.base_start;
+        ++hunk.other_start;
+      }
+    }
+  }
+  return hunks;
+}
+
+} // namespace
+
+std::vector<BlockMove> find_moves(const std::vector<LineId> &base_ids,
+                                  const std::vector<LineId> &other_ids,
+                                  const std::vector<DiffHunk> &hunks,
+                                  size_t min_lines) {
+  std::vector<BlockMove> moves;
+  const size_t k = std::max<size_t>(min_lines, 1);
+  const std::vector<DiffHunk> slid = slide_down(base_ids, other_ids, hunks);
+  ShingleIndex index(base_ids, slid, k);
+  std::vector<bool> moved(base_ids.size(), false);
+
+  RollingHash rolling(other_ids.data(), k);
+  for (const auto &hunk : slid) {
+    size_t j = hunk.other_start;
+    if (j + k <= hunk.other_end()) {
+      rolling.reset(j);
+    }
+    while (j + k <= hunk.other_end()) {
+      uint64_t hash = rolling.hash();
+      size_t best_base = 0;
+      size_t best_size = 0;
+      size_t candidates = 0;
+      for (size_t e = index.first(hash);
+           e != ShingleIndex::NONE && candidates < MAX_MOVE_CANDIDATES;
+           e = index.entry(e).next, ++candidates) {
+        const auto &entry = index.entry(e);
+        size_t size = 0;
+        while (entry.base + size < entry.deletion_end &&
+               j + size < hunk.other_end() &&
+               base_ids[entry.base + size] == other_ids[j + size] &&
+               !moved[entry.base + size]) {
+          ++size;
+        }
+        if (size >= k && size > best_size) {
+          best_base = entry.base;
+          best_size = size;
+        }
+      }
+
+      if (best_size == 0) {
+        if (j + k < hunk.other_end()) {
+          rolling.roll();
+        }
+        ++j;
+        continue;
+      }
+      moves.push_back({best_base, best_base + best_size, j});
+      for (size_t i = best_base; i < best_base + best_size; ++i) {
+        moved[i] = true;
+      }
+      j += best_size;
+      if (j + k <= hunk.other_end()) {
+        rolling.reset(j);
+      }
+    }
+  }
+  return moves;
+}
+
+} // namespace merge
+} // namespace wizardmerge
@@ -0,0 +1,450 @@
+/**
+ * @file nway_merge.cpp
+ * @brief Implementation of the N-way merge
+ */
+
+#include "wizardmerge/merge/nway_merge.h"
+#include "wizardmerge/merge/conflict_markers.h"
+#include "wizardmerge/merge/line_table.h"
+#include "wizardmerge/merge/merge_policy.h"
+#include "wizardmerge/merge/thread_pool.h"
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+
+namespace wizardmerge {
+namespace merge {
+
+namespace {
+
+/**
+ * @brief Index range [begin, end) within one sequence.
+ */
+struct Span {
+  size_t begin;
+  size_t end;
+};
+
+/**
+ * @brief Range of a region in a branch that changed it.
+ */
+struct BranchSpan {
+  size_t branch;
+  Span span;
+};
+
+/**
+ * @brief A base range changed by at least one branch.
+ */
+struct NWayRegion {
+  size_t base_begin;
+  size_t base_end;
+  // Branches with hunks in the region, ascending
+  std::vector<BranchSpan> changes;
+  bool conflict;
+};
+
+/**
+ * @brief Next unconsumed hunk of a branch; the heap yields the hunk
+ *        earliest in base first.
+ */
+struct Cursor {
+  size_t base_start;
+  size_t branch;
+
+  bool operator>(const Cursor &other) const {
+    return base_start != other.base_start ? base_start > other.base_start
+                                          : branch > other.branch;
+  }
+};
+
+/**
+ * @brief Maps a base range to the corresponding range of a branch that
+ *        has hunks [first, last) inside it (see diff3_regions()).
+ */
+Span map_region(const std::vector<DiffHunk> &hunks, size_t first, size_t last,
+                size_t lo, size_t hi) {
+  const DiffHunk &head = hunks[first];
+  const DiffHunk &tail = hunks[last - 1];
+  return {head.other_start - (head.base_start - lo),
+          tail.other_end() + (hi - tail.base_end())};
+}
+
+bool ranges_equal(const std::vector<LineId> &a, Span a_span,
+                  const std::vector<LineId> &b, Span b_span) {
+  if (a_span.end - a_span.begin != b_span.end - b_span.begin) {
+    return false;
+  }
+  return std::equal(a.begin() + a_span.begin, a.begin() + a_span.end,
+                    b.begin() + b_span.begin);
+}
+
+/**
+ * @brief Groups the changes of a region by content.
+ *
+ * @return Indices into @p changes, one group per distinct change, in order
+ *         of their first branch
+ */
+std::vector<std::vector<size_t>>
+group_changes(const std::vector<BranchSpan> &changes,
+              const std::vector<std::vector<LineId>> &ids) {
+  std::vector<std::vector<size_t>> groups;
+  for (size_t i = 0; i < changes.size(); ++i) {
+    const BranchSpan &change = changes[i];
+    auto same = std::find_if(groups.begin(), groups.end(), [&](const auto &g) {
+      const BranchSpan &head = changes[g.front()];
+      return ranges_equal(ids[head.branch], head.span, ids[change.branch],
+                          change.span);
+    });
+    if (same != groups.end()) {
+      same->push_back(i);
+    } else {
+      groups.push_back({i});
+    }
+  }
+  return groups;
+}
+
+/**
+ * @brief Aligns the edit scripts of all branches into regions.
+ *
+ * The heap holds one cursor per branch with hunks left, so every hunk is
+ * pushed and popped once.
+ */
+std::vector<NWayRegion>
+nway_regions(const std::vector<std::vector<LineId>> &ids,
+             const std::vector<std::vector<DiffHunk>> &hunks) {
+  const size_t count = hunks.size();
+  std::vector<size_t> next(count, 0);
+  std::vector<size_t> first(count, 0);
+  std::vector<size_t> touched_in(count, SIZE_MAX);
+  std::priority_queue<Cursor, std::vector<Cursor>, std::greater<Cursor>> heap;
+  for (size_t b = 0; b < count; ++b) {
+    if (!hunks[b].empty()) {
+      heap.push({hunks[b][0].base_start, b});
+    }
+  }
+
+  std::vector<NWayRegion> regions;
+  std::vector<size_t> touched;
+  while (!heap.empty()) {
+    // Start the region at the hunk earliest in base, then absorb every
+    // hunk of any branch that overlaps it or inserts at its start
+    size_t lo = heap.top().base_start;
+    size_t hi = lo;
+    touched.clear();
+    while (!heap.empty() &&
+           (heap.top().base_start < hi || heap.top().base_start == lo)) {
+      size_t b = heap.top().branch;
+      heap.pop();
+      if (touched_in[b] != regions.size()) {
+        touched_in[b] = regions.size();
+        first[b] = next[b];
+        touched.push_back(b);
+      }
+      hi = std::max(hi, hunks[b][next[b]].base_end());
+      if (++next[b] < hunks[b].size()) {
+        heap.push({hunks[b][next[b]].base_start, b});
+      }
+    }
+
+    NWayRegion region{lo, hi, {}, false};
+    std::sort(touched.begin(), touched.end());
+    for (size_t b : touched) {
+      region.changes.push_back(
+          {b, map_region(hunks[b], first[b], next[b], lo, hi)});
+    }
+    region.conflict = group_changes(region.changes, ids).size() > 1;
+    regions.push_back(std::move(region));
+  }
+  return regions;
+}
+
+/**
+ * @brief Merges conflicts separated by at most CONFLICT_MERGE_GAP
+ *        unchanged lines into one.
+ *
+ * A branch that changed only one of the two keeps the unchanged lines on
+ * the other side of the gap, at its offset there.
+ */
+void merge_close_conflicts(std::vector<NWayRegion> &regions) {
+  size_t out = 0;
+  for (size_t i = 0; i < regions.size(); ++i) {
+    NWayRegion &cur = regions[i];
+    if (out > 0 && cur.conflict) {
+      NWayRegion &prev = regions[out - 1];
+      if (prev.conflict &&
+          cur.base_begin - prev.base_end <= CONFLICT_MERGE_GAP) {
+        std::vector<BranchSpan> changes;
+        size_t p = 0;
+        size_t c = 0;
+        while (p < prev.changes.size() || c < cur.changes.size()) {
+          bool in_prev = p < prev.changes.size() &&
+                         (c == cur.changes.size() ||
+                          prev.changes[p].branch <= cur.changes[c].branch);
+          bool in_cur = c < cur.changes.size() &&
+                        (p == prev.changes.size() ||
+                         cur.changes[c].branch <= prev.changes[p].branch);
+          size_t branch =
+              in_prev ? prev.changes[p].branch : cur.changes[c].branch;
+          Span span;
+          span.begin = in_prev ? prev.changes[p].span.begin
+                               : prev.base_begin + cur.changes[c].span.begin -
+                                     cur.base_begin;
+          span.end = in_cur ? cur.changes[c].span.end
+                            : cur.base_end + prev.changes[p].span.end -
+                                  prev.base_end;
+          changes.push_back({branch, span});
+          p += in_prev;
+          c += in_cur;
+        }
+        prev.base_end = cur.base_end;
+        prev.changes = std::move(changes);
+        continue;
+      }
+    }
+    if (out != i) {
+      regions[out] = std::move(cur);
+    }
+    ++out;
+  }
+  regions.resize(out);
+}
+
+void append_lines(std::vector<Line> &out,
+                  const std::vector<std::string_view> &src, Span span,
+                  Line::Origin origin) {
+  for (size_t i = span.begin; i < span.end; ++i) {
+    out.emplace_back(src[i], origin);
+  }
+}
+
+Line::Origin branch_origin(size_t branch) {
+  return branch == 0 ? Line::OURS : Line::THEIRS;
+}
+
+std::string side_label(const std::vector<size_t> &branches,
+                       const std::vector<std::string> &names) {
+  std::string label;
+  for (size_t b : branches) {
+    if (!label.empty()) {
+      label += ", ";
+    }
+    label += b < names.size() && !names[b].empty()
+                 ? names[b]
+                 : "branch " + std::to_string(b);
+  }
+  return label;
+}
+
+} // namespace
+
+NWayMergeResult
+nway_merge(const std::vector<std::string_view> &base,
+           const std::vector<std::vector<std::string_view>> &branches,
+           const std::vector<std::string> &names,
+           const MergeOptions &options) {
+  NWayMergeResult result;
+  if (branches.empty()) {
+    append_lines(result.merged_lines, base, {0, base.size()}, Line::BASE);
+    return result;
+  }
+  const size_t count = branches.size();
+
+  // Lines all versions share at both ends are stable without being diffed.
+  // Each diff strips its own common prefix, then suffix; the minimum over
+  // the branches is part of all of them, as in three_way_merge.
+  const EquivalentLines comparator(options.compare);
+  size_t prefix = 0;
+  size_t suffix = 0;
+  if (!comparator.ignores_blank_lines()) {
+    prefix = base.size();
+    suffix = base.size();
+    for (const auto &branch : branches) {
+      CommonEnds ends = common_ends(base, branch, comparator);
+      prefix = std::min(prefix, ends.prefix);
+      suffix = std::min(suffix, ends.suffix);
+    }
+  }
+
+  // Intern the base once and every branch against it
+  size_t middle = base.size() - prefix - suffix;
+  for (const auto &branch : branches) {
+    middle += branch.size() - prefix - suffix;
+  }
+  LineTable table(middle, options.compare);
+  auto intern_middle = [&](const std::vector<std::string_view> &lines) {
+    std::vector<LineId> ids;
+    ids.reserve(lines.size() - prefix - suffix);
+    for (size_t i = prefix; i < lines.size() - suffix; ++i) {
+      ids.push_back(table.intern(lines[i]));
+    }
+    return ids;
+  };
+  const std::vector<LineId> base_ids = intern_middle(base);
+  std::vector<std::vector<LineId>> ids;
+  ids.reserve(count);
+  for (const auto &branch : branches) {
+    ids.push_back(intern_middle(branch));
+  }
+
+  // AUTO picks by the size of the whole files, as without the trimming
+  std::vector<std::vector<DiffHunk>> hunks(count);
+  auto diff_branch = [&](size_t b) {
+    DiffAlgorithm algorithm = options.algorithm;
+    if (algorithm == DiffAlgorithm::AUTO) {
+      algorithm = std::max(base.size(), branches[b].size()) >=
+                          HISTOGRAM_AUTO_THRESHOLD
+                      ? DiffAlgorithm::HISTOGRAM
+                      : DiffAlgorithm::MYERS;
+    }
+    hunks[b] = compute_diff(base_ids, ids[b], algorithm,
+                            options.diff_memory_budget);
+  };
+  if (count > 1 && options.threads != 1 &&
+      (options.pool ? options.pool->size()
+                    : resolve_thread_count(options.threads)) > 1 &&
+      middle >= PARALLEL_PARTITION_LINES) {
+    std::optional<ThreadPool> own_pool;
+    ThreadPool &pool =
+        options.pool ? *options.pool : own_pool.emplace(options.threads);
+    pool.parallel_for(count, diff_branch);
+  } else {
+    for (size_t b = 0; b < count; ++b) {
+      diff_branch(b);
+    }
+  }
+
+  auto regions = nway_regions(ids, hunks);
+  merge_close_conflicts(regions);
+
+  // Unchanged lines come from the first branch; regions are in trimmed
+  // coordinates, lines in whole-file ones
+  const auto &first = branches[0];
+  auto lines_of = [&](Span span) -> Span {
+    return {span.begin + prefix, span.end + prefix};
+  };
+  size_t first_pos = 0;
+  long first_delta = 0;
+  for (const auto &region : regions) {
+    Span first_span{
+        static_cast<size_t>(static_cast<long>(region.base_begin) + first_delta),
+        static_cast<size_t>(static_cast<long>(region.base_end) + first_delta)};
+    if (region.changes.front().branch == 0) {
+      first_span = region.changes.front().span;
+    }
+    first_delta = static_cast<long>(first_span.end) -
+                  static_cast<long>(region.base_end);
+
+    // Stable lines before the region
+    append_lines(result.merged_lines, first,
+                 {first_pos, lines_of(first_span).begin}, Line::BASE);
+    first_pos = lines_of(first_span).end;
+
+    auto groups = group_changes(region.changes, ids);
+    if (groups.size() == 1) {
+      // One change, from one branch or several alike
+      const BranchSpan &change = region.changes[groups[0].front()];
+      append_lines(result.merged_lines, branches[change.branch],
+                   lines_of(change.span),
+                   groups[0].size() == 1 ? branch_origin(change.branch)
+                                         : Line::MERGED);
+      continue;
+    }
+
+    // Branches changed the region differently - conflict. Lines all sides
+    // agree on at its edges stay outside the markers.
+    Span base_span = lines_of({region.base_begin, region.base_end});
+    std::vector<BranchSpan> sides;
+    for (const auto &group : groups) {
+      sides.push_back(region.changes[group.front()]);
+    }
+    size_t common_prefix = 0;
+    size_t common_suffix = 0;
+    if (!options.show_base) {
+      size_t common = SIZE_MAX;
+      for (const auto &side : sides) {
+        common = std::min(common, side.span.end - side.span.begin);
+      }
+      auto same_at = [&](auto position) {
+        const BranchSpan &head = sides.front();
+        LineId id = ids[head.branch][position(head.span)];
+        return std::all_of(sides.begin() + 1, sides.end(), [&](const auto &s) {
+          return ids[s.branch][position(s.span)] == id;
+        });
+      };
+      while (common_prefix < common && same_at([&](Span span) {
+               return span.begin + common_prefix;
+             })) {
+        ++common_prefix;
+      }
+      while (common_suffix < common - common_prefix && same_at([&](Span span) {
+               return span.end - 1 - common_suffix;
+             })) {
+        ++common_suffix;
+      }
+    }
+    const BranchSpan &head = sides.front();
+    Span head_lines = lines_of(head.span);
+    append_lines(result.merged_lines, branches[head.branch],
+                 {head_lines.begin, head_lines.begin + common_prefix},
+                 Line::MERGED);
+
+    NWayConflict conflict;
+    conflict.start_line = result.merged_lines.size();
+    conflict.base_range = {base_span.begin, base_span.end};
+    append_lines(conflict.base_lines, base, base_span, Line::BASE);
+    for (size_t s = 0; s < sides.size(); ++s) {
+      NWaySide side;
+      for (size_t i : groups[s]) {
+        side.branches.push_back(region.changes[i].branch);
+      }
+      Span span = lines_of(sides[s].span);
+      span = {span.begin + common_prefix, span.end - common_suffix};
+      side.range = {span.begin, span.end};
+      append_lines(side.lines, branches[sides[s].branch], span,
+                   branch_origin(sides[s].branch));
+      conflict.sides.push_back(std::move(side));
+    }
+
+    // Add conflict markers
+    const size_t side_count = conflict.sides.size();
+    for (size_t s = 0; s < side_count; ++s) {
+      const NWaySide &side = conflict.sides[s];
+      std::string label = side_label(side.branches, names);
+      if (s == 0) {
+        result.merged_lines.emplace_back("<<<<<<< " + label, Line::MERGED);
+      } else {
+        result.merged_lines.emplace_back(
+            side_count > 2 ? "======= " + label : "=======", Line::MERGED);
+      }
+      result.merged_lines.insert(result.merged_lines.end(),
+                                 side.lines.begin(), side.lines.end());
+      if (s == 0 && options.show_base) {
+        result.merged_lines.emplace_back(
+            conflict_marker('|', options.base_label), Line::MERGED);
+        result.merged_lines.insert(result.merged_lines.end(),
+                                   conflict.base_lines.begin(),
+                                   conflict.base_lines.end());
+      }
+      if (s + 1 == side_count) {
+        result.merged_lines.emplace_back(">>>>>>> " + label, Line::MERGED);
+      }
+    }
+
+    conflict.end_line = result.merged_lines.size() - 1;
+    result.conflicts.push_back(std::move(conflict));
+    append_lines(result.merged_lines, branches[head.branch],
+                 {head_lines.end - common_suffix, head_lines.end},
+                 Line::MERGED);
+  }
+
+  // Stable lines after the last region
+  append_lines(result.merged_lines, first, {first_pos, first.size()},
+               Line::BASE);
+  return result;
+}
+
+} // namespace merge
+} // namespace wizardmerge
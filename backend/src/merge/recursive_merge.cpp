@@ -0,0 +1,257 @@
+/**
+ * @file recursive_merge.cpp
+ * @brief Implementation of the recursive merge strategy
+ */
+
+#include "wizardmerge/merge/recursive_merge.h"
+#include "wizardmerge/merge/conflict_markers.h"
+#include "wizardmerge/merge/diff3.h"
+#include "wizardmerge/merge/line_table.h"
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace wizardmerge {
+namespace merge {
+
+namespace {
+
+/**
+ * @brief Finds the merge bases of two revisions of a parent graph.
+ */
+std::vector<size_t>
+find_merge_bases(const std::vector<std::vector<size_t>> &parents, size_t a,
+                 size_t b) {
+  enum : unsigned char { OF_A = 1, OF_B = 2, COMMON = 3, REDUNDANT = 4 };
+  std::vector<unsigned char> marks(parents.size(), 0);
+  std::vector<size_t> stack;
+  auto mark_ancestors = [&](unsigned char bit) {
+    while (!stack.empty()) {
+      size_t revision = stack.back();
+      stack.pop_back();
+      if (marks[revision] & bit) {
+        continue;
+      }
+      marks[revision] |= bit;
+      stack.insert(stack.end(), parents[revision].begin(),
+                   parents[revision].end());
+    }
+  };
+  stack.push_back(a);
+  mark_ancestors(OF_A);
+  stack.push_back(b);
+  mark_ancestors(OF_B);
+
+  // Ancestors of a common ancestor are common ancestors, but not bases
+  for (size_t r = 0; r < parents.size(); ++r) {
+    if (marks[r] == COMMON) {
+      stack.insert(stack.end(), parents[r].begin(), parents[r].end());
+    }
+  }
+  mark_ancestors(REDUNDANT);
+
+  std::vector<size_t> bases;
+  for (size_t r = 0; r < parents.size(); ++r) {
+    if (marks[r] == COMMON) {
+      bases.push_back(r);
+    }
+  }
+  return bases;
+}
+
+/**
+ * @brief State shared by one recursive merge: the history extended by
+ *        the virtual ancestors, one line table and the diffs computed so
+ *        far.
+ */
+class RecursiveMerger {
+public:
+  RecursiveMerger(const std::vector<Revision> &history,
+                  const MergeOptions &options)
+      : history_(history), options_(options), table_(0, options.compare),
+        ids_(history.size()), interned_(history.size(), false),
+        empty_(SIZE_MAX) {
+    parents_.reserve(history.size());
+    for (const auto &revision : history) {
+      parents_.push_back(revision.parents);
+    }
+  }
+
+  /**
+   * @brief Lines of a revision, virtual ones included.
+   */
+  const std::vector<std::string_view> &lines(size_t revision) const {
+    if (revision < history_.size()) {
+      return history_[revision].lines;
+    }
+    return virtual_lines_[revision - history_.size()];
+  }
+
+  /**
+   * @brief Returns the ancestor to merge two revisions against: their
+   *        merge base, or their merge bases merged into a virtual one.
+   *
+   * @param depth Recursion level of the merges this builds, from 1
+   */
+  size_t ancestor(size_t a, size_t b, size_t depth) {
+    std::vector<size_t> bases = find_merge_bases(parents_, a, b);
+    if (bases.empty()) {
+      return empty_revision();
+    }
+    size_t merged = bases[0];
+    for (size_t i = 1; i < bases.size(); ++i) {
+      merged = merge_virtual(merged, bases[i], depth);
+    }
+    return merged;
+  }
+
+private:
+  /**
+   * @brief Merges two revisions into a new virtual revision.
+   *
+   * Conflicts are kept with both sides between markers; every line takes
+   * the ID of the line it was copied from.
+   */
+  size_t merge_virtual(size_t a, size_t b, size_t depth) {
+    size_t base = ancestor(a, b, depth + 1);
+    const auto &a_hunks = diff(base, a);
+    const auto &b_hunks = diff(base, b);
+    const auto &a_ids = ids(a);
+    const auto &b_ids = ids(b);
+    const auto &a_lines = lines(a);
+    const auto &b_lines = lines(b);
+
+    std::vector<std::string_view> merged;
+    std::vector<LineId> merged_ids;
+    auto copy = [&](const std::vector<std::string_view> &src,
+                    const std::vector<LineId> &src_ids, size_t begin,
+                    size_t end) {
+      merged.insert(merged.end(), src.begin() + begin, src.begin() + end);
+      merged_ids.insert(merged_ids.end(), src_ids.begin() + begin,
+                        src_ids.begin() + end);
+    };
+    size_t marker_size = CONFLICT_MARKER_SIZE + 2 * depth;
+    auto marker = [&](char marker_char, size_t revision) {
+      std::string line(marker_size, marker_char);
+      if (revision != SIZE_MAX) {
+        line += " revision " + std::to_string(revision);
+      }
+      markers_.push_back(std::move(line));
+      merged.push_back(markers_.back());
+      merged_ids.push_back(table_.intern(markers_.back()));
+    };
+
+    size_t pos = 0;
+    for (const auto &region :
+         diff3_regions(a_ids, b_ids, a_hunks, b_hunks)) {
+      copy(a_lines, a_ids, pos, region.ours_begin);
+      pos = region.ours_end;
+      if (region.kind == Diff3Region::THEIRS) {
+        copy(b_lines, b_ids, region.theirs_begin, region.theirs_end);
+      } else if (region.kind != Diff3Region::CONFLICT) {
+        copy(a_lines, a_ids, region.ours_begin, region.ours_end);
+      } else {
+        marker('<', a);
+        copy(a_lines, a_ids, region.ours_begin, region.ours_end);
+        marker('=', SIZE_MAX);
+        copy(b_lines, b_ids, region.theirs_begin, region.theirs_end);
+        marker('>', b);
+      }
+    }
+    copy(a_lines, a_ids, pos, a_lines.size());
+    return add_revision(std::move(merged), std::move(merged_ids), {a, b});
+  }
+
+  /**
+   * @brief The empty file, ancestor of revisions without common history.
+   */
+  size_t empty_revision() {
+    if (empty_ == SIZE_MAX) {
+      empty_ = add_revision({}, {}, {});
+    }
+    return empty_;
+  }
+
+  size_t add_revision(std::vector<std::string_view> lines,
+                      std::vector<LineId> line_ids,
+                      std::vector<size_t> parents) {
+    virtual_lines_.push_back(std::move(lines));
+    ids_.push_back(std::move(line_ids));
+    interned_.push_back(true);
+    parents_.push_back(std::move(parents));
+    return parents_.size() - 1;
+  }
+
+  /**
+   * @brief Line IDs of a revision, interned on first use.
+   */
+  const std::vector<LineId> &ids(size_t revision) {
+    if (!interned_[revision]) {
+      ids_[revision] = table_.intern_lines(lines(revision));
+      interned_[revision] = true;
+    }
+    return ids_[revision];
+  }
+
+  /**
+   * @brief Diff of one revision against another, computed on first use.
+   */
+  const std::vector<DiffHunk> &diff(size_t from, size_t to) {
+    auto found = diffs_.find({from, to});
+    if (found != diffs_.end()) {
+      return found->second;
+    }
+    const auto &from_ids = ids(from);
+    const auto &to_ids = ids(to);
+    DiffAlgorithm algorithm = options_.algorithm;
+    if (algorithm == DiffAlgorithm::AUTO) {
+      algorithm =
+          std::max(from_ids.size(), to_ids.size()) >= HISTOGRAM_AUTO_THRESHOLD
+              ? DiffAlgorithm::HISTOGRAM
+              : DiffAlgorithm::MYERS;
+    }
+    return diffs_
+        .emplace(std::make_pair(from, to),
+                 compute_diff(from_ids, to_ids, algorithm,
+                              options_.diff_memory_budget))
+        .first->second;
+  }
+
+  const std::vector<Revision> &history_;
+  const MergeOptions &options_;
+  LineTable table_;
+  // Indexed by revision; deques keep references valid while the
+  // recursion appends virtual revisions
+  std::vector<std::vector<size_t>> parents_;
+  std::deque<std::vector<LineId>> ids_;
+  std::deque<bool> interned_;
+  std::deque<std::vector<std::string_view>> virtual_lines_;
+  std::deque<std::string> markers_;
+  std::map<std::pair<size_t, size_t>, std::vector<DiffHunk>> diffs_;
+  size_t empty_;
+};
+
+} // namespace
+
+std::vector<size_t> merge_bases(const std::vector<Revision> &history,
+                                size_t a, size_t b) {
+  std::vector<std::vector<size_t>> parents;
+  parents.reserve(history.size());
+  for (const auto &revision : history) {
+    parents.push_back(revision.parents);
+  }
+  return find_merge_bases(parents, a, b);
+}
+
+MergeResult recursive_merge(const std::vector<Revision> &history, size_t ours,
+                            size_t theirs, const MergeOptions &options) {
+  RecursiveMerger merger(history, options);
+  size_t base = merger.ancestor(ours, theirs, 1);
+  return three_way_merge(merger.lines(base), history[ours].lines,
+                         history[theirs].lines, options);
+}
+
+} // namespace merge
+} // namespace wizardmerge
@@ -0,0 +1,165 @@
+/**
+ * @file refine.cpp
+ * @brief Implementation of token-level conflict refinement
+ */
+
+#include "wizardmerge/merge/refine.h"
+#include "wizardmerge/merge/diff.h"
+#include "wizardmerge/merge/diff3.h"
+#include "wizardmerge/merge/line_table.h"
+
+namespace wizardmerge {
+namespace merge {
+
+namespace {
+
+// Token standing for the end of a line (lines never contain '\n')
+constexpr std::string_view LINE_BREAK = "\n";
+
+bool is_word_byte(unsigned char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c >= 0x80;
+}
+
+bool is_space_byte(unsigned char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * @brief Tokens of one side of a hunk and where each came from.
+ */
+struct TokenizedSide {
+  std::vector<std::string_view> tokens;
+  std::vector<TokenSpan> positions;
+};
+
+TokenizedSide tokenize_side(const std::vector<std::string_view> &lines) {
+  TokenizedSide side;
+  for (size_t i = 0; i < lines.size(); ++i) {
+    for (std::string_view token : tokenize(lines[i])) {
+      size_t begin = static_cast<size_t>(token.data() - lines[i].data());
+      side.tokens.push_back(token);
+      side.positions.push_back({i, begin, begin + token.size()});
+    }
+    side.tokens.push_back(LINE_BREAK);
+    side.positions.push_back({i, lines[i].size(), lines[i].size()});
+  }
+  return side;
+}
+
+/**
+ * @brief Converts the changed tokens of @p side into per-line spans.
+ *
+ * Adjacent tokens on the same line are joined into one span.
+ */
+void collect_spans(const TokenizedSide &side,
+                   const std::vector<DiffHunk> &hunks,
+                   std::vector<TokenSpan> &spans) {
+  for (const auto &hunk : hunks) {
+    for (size_t k = hunk.other_start; k < hunk.other_end(); ++k) {
+      if (side.tokens[k] == LINE_BREAK) {
+        continue;
+      }
+      const TokenSpan &pos = side.positions[k];
+      if (!spans.empty() && spans.back().line == pos.line &&
+          spans.back().end == pos.begin) {
+        spans.back().end = pos.end;
+      } else {
+        spans.push_back(pos);
+      }
+    }
+  }
+}
+
+} // namespace
+
+std::vector<std::string_view> tokenize(std::string_view line) {
+  std::vector<std::string_view> tokens;
+  size_t i = 0;
+  while (i < line.size()) {
+    unsigned char c = static_cast<unsigned char>(line[i]);
+    size_t end = i + 1;
+    if (is_word_byte(c)) {
+      while (end < line.size() &&
+             is_word_byte(static_cast<unsigned char>(line[end]))) {
+        ++end;
+      }
+    } else if (is_space_byte(c)) {
+      while (end < line.size() &&
+             is_space_byte(static_cast<unsigned char>(line[end]))) {
+        ++end;
+      }
+    }
+    tokens.push_back(line.substr(i, end - i));
+    i = end;
+  }
+  return tokens;
+}
+
+Refinement refine_conflict(const std::vector<std::string_view> &base,
+                           const std::vector<std::string_view> &ours,
+                           const std::vector<std::string_view> &theirs) {
+  Refinement refinement;
+  TokenizedSide base_side = tokenize_side(base);
+  TokenizedSide our_side = tokenize_side(ours);
+  TokenizedSide their_side = tokenize_side(theirs);
+  if (base_side.tokens.size() > REFINE_MAX_TOKENS ||
+      our_side.tokens.size() > REFINE_MAX_TOKENS ||
+      their_side.tokens.size() > REFINE_MAX_TOKENS) {
+    return refinement;
+  }
+
+  LineTable table(base_side.tokens.size() + our_side.tokens.size() +
+                  their_side.tokens.size());
+  auto base_ids = table.intern_lines(base_side.tokens);
+  auto our_ids = table.intern_lines(our_side.tokens);
+  auto their_ids = table.intern_lines(their_side.tokens);
+
+  auto our_hunks = myers_linear_diff(base_ids, our_ids);
+  auto their_hunks = myers_linear_diff(base_ids, their_ids);
+  collect_spans(our_side, our_hunks, refinement.our_changes);
+  collect_spans(their_side, their_hunks, refinement.their_changes);
+
+  auto regions = diff3_regions(our_ids, their_ids, our_hunks, their_hunks);
+  for (const auto &region : regions) {
+    if (region.kind == Diff3Region::CONFLICT) {
+      return refinement;
+    }
+  }
+
+  // No token region conflicts: rebuild the hunk line by line
+  std::string current;
+  auto emit = [&](const TokenizedSide &side, size_t begin, size_t end) {
+    for (size_t k = begin; k < end; ++k) {
+      if (side.tokens[k] == LINE_BREAK) {
+        refinement.merged_lines.push_back(std::move(current));
+        current.clear();
+      } else {
+        current.append(side.tokens[k]);
+      }
+    }
+  };
+
+  size_t base_pos = 0;
+  for (const auto &region : regions) {
+    emit(base_side, base_pos, region.base_begin);
+    if (region.kind == Diff3Region::THEIRS) {
+      emit(their_side, region.theirs_begin, region.theirs_end);
+    } else {
+      emit(our_side, region.ours_begin, region.ours_end);
+    }
+    base_pos = region.base_end;
+  }
+  emit(base_side, base_pos, base_side.tokens.size());
+  if (!current.empty()) {
+    refinement.merged_lines.push_back(std::move(current));
+  }
+
+  refinement.resolved = true;
+  refinement.our_changes.clear();
+  refinement.their_changes.clear();
+  return refinement;
+}
+
+} // namespace merge
+} // namespace wizardmerge
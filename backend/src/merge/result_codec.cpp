@@ -0,0 +1,590 @@
+/**
+ * @file result_codec.cpp
+ * @brief Implementation of the binary MergeResult encoding
+ */
+
+#include "wizardmerge/merge/result_codec.h"
+#include <cstring>
+
+namespace wizardmerge {
+namespace merge {
+
+namespace {
+
+constexpr char RESULT_MAGIC[4] = {'W', 'Z', 'M', 'R'};
+
+// Magic and version, then the u64 header fields
+constexpr size_t HEADER_BYTES = 8 + 5 * 8;
+constexpr size_t RECORD_BYTES = CONFLICT_RECORD_FIELDS * 8;
+constexpr size_t SPAN_BYTES = 3 * 8;
+
+// Conflict record fields; runs take two, (first, count)
+enum Field : size_t {
+  START_LINE = 0,
+  END_LINE = 1,
+  BASE_RANGE = 2,
+  OUR_RANGE = 4,
+  THEIR_RANGE = 6,
+  ANALYSIS = 8,
+  BASE_LINES = 9,
+  OUR_LINES = 11,
+  THEIR_LINES = 13,
+  OUR_CHANGES = 15,
+  THEIR_CHANGES = 17,
+  CONTEXT_START = 19,
+  CONTEXT_END = 20,
+  FUNCTION_NAME = 21, // String index
+  CLASS_NAME = 22,    // String index
+  SURROUNDING = 23,
+  IMPORTS = 25,
+  METADATA = 27, // Key, value, key, value, ...
+  RISK_OURS = 29,
+  RISK_THEIRS = 36,
+  RISK_BOTH = 43
+};
+
+// Fields of a risk record, relative to its first field
+enum RiskField : size_t {
+  RISK_LEVEL = 0,
+  RISK_CONFIDENCE = 1, // Bits of the double
+  RISK_FLAGS = 2,
+  RISK_FACTORS = 3,
+  RISK_RECOMMENDATIONS = 5
+};
+
+static_assert(RISK_BOTH + 7 == CONFLICT_RECORD_FIELDS,
+              "conflict record layout out of sync");
+
+// Bits of the RISK_FLAGS field
+constexpr uint64_t SYNTAX_CHANGES = 1;
+constexpr uint64_t LOGIC_CHANGES = 2;
+constexpr uint64_t API_CHANGES = 4;
+constexpr uint64_t MULTIPLE_FUNCTIONS = 8;
+constexpr uint64_t CRITICAL_SECTION = 16;
+
+uint64_t load64(const unsigned char *p) {
+  uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  value = __builtin_bswap64(value);
+#endif
+  return value;
+}
+
+void store64(unsigned char *p, uint64_t value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  value = __builtin_bswap64(value);
+#endif
+  std::memcpy(p, &value, sizeof(value));
+}
+
+size_t pad8(size_t bytes) { return (bytes + 7) & ~size_t(7); }
+
+/**
+ * @brief Sizes of the variable sections, as counted before encoding.
+ */
+struct Counts {
+  size_t strings = 0;
+  size_t bytes = 0;
+  size_t spans = 0;
+
+  void add(std::string_view s) {
+    ++strings;
+    bytes += s.size();
+  }
+
+  template <typename Strings> void add_all(const Strings &strings) {
+    for (const auto &s : strings) {
+      add(s);
+    }
+  }
+
+  void add_lines(const std::pmr::vector<Line> &lines) {
+    for (const auto &line : lines) {
+      add(line.content);
+    }
+  }
+
+  void add_risk(const analysis::RiskAssessment &risk) {
+    add_all(risk.risk_factors);
+    add_all(risk.recommendations);
+  }
+
+  void add_conflict(const Conflict &conflict) {
+    add_lines(conflict.base_lines);
+    add_lines(conflict.our_lines);
+    add_lines(conflict.their_lines);
+    spans += conflict.our_changes.size() + conflict.their_changes.size();
+    add(conflict.context.function_name);
+    add(conflict.context.class_name);
+    add_all(conflict.context.surrounding_lines);
+    add_all(conflict.context.imports);
+    for (const auto &entry : conflict.context.metadata) {
+      add(entry.first);
+      add(entry.second);
+    }
+    add_risk(conflict.risk_ours);
+    add_risk(conflict.risk_theirs);
+    add_risk(conflict.risk_both);
+  }
+};
+
+/**
+ * @brief Appends strings and spans to the preallocated tables.
+ */
+class Writer {
+public:
+  Writer(unsigned char *offsets, unsigned char *spans, unsigned char *origins,
+         char *blob)
+      : offsets_(offsets), spans_(spans), origins_(origins), blob_(blob) {
+    store64(offsets_, 0);
+  }
+
+  size_t add(std::string_view s, Line::Origin origin = Line::BASE) {
+    if (!s.empty()) {
+      std::memcpy(blob_ + bytes_, s.data(), s.size());
+      bytes_ += s.size();
+    }
+    store64(offsets_ + 8 * (strings_ + 1), bytes_);
+    origins_[strings_] = static_cast<unsigned char>(origin);
+    return strings_++;
+  }
+
+  size_t strings() const { return strings_; }
+
+  /**
+   * @brief Writes the (first, count) run of the strings added by @p add_run.
+   */
+  template <typename AddRun>
+  void run(unsigned char *record, size_t field, AddRun add_run) {
+    size_t first = strings_;
+    add_run();
+    store64(record + 8 * field, first);
+    store64(record + 8 * (field + 1), strings_ - first);
+  }
+
+  void lines(unsigned char *record, size_t field,
+             const std::pmr::vector<Line> &lines) {
+    run(record, field, [&] {
+      for (const auto &line : lines) {
+        add(line.content, line.origin);
+      }
+    });
+  }
+
+  template <typename Strings>
+  void strings(unsigned char *record, size_t field, const Strings &strings) {
+    run(record, field, [&] {
+      for (const auto &s : strings) {
+        add(s);
+      }
+    });
+  }
+
+  void changes(unsigned char *record, size_t field,
+               const std::pmr::vector<TokenSpan> &changes) {
+    store64(record + 8 * field, spans_written_);
+    store64(record + 8 * (field + 1), changes.size());
+    for (const auto &span : changes) {
+      unsigned char *p = spans_ + SPAN_BYTES * spans_written_++;
+      store64(p, span.line);
+      store64(p + 8, span.begin);
+      store64(p + 16, span.end);
+    }
+  }
+
+private:
+  unsigned char *offsets_;
+  unsigned char *spans_;
+  unsigned char *origins_;
+  char *blob_;
+  size_t strings_ = 0;
+  size_t bytes_ = 0;
+  size_t spans_written_ = 0;
+};
+
+void write_risk(Writer &writer, unsigned char *record, size_t field,
+                const analysis::RiskAssessment &risk) {
+  uint64_t confidence;
+  std::memcpy(&confidence, &risk.confidence_score, sizeof(confidence));
+  const uint64_t none = 0;
+  uint64_t flags =
+      (risk.has_syntax_changes ? SYNTAX_CHANGES : none) |
+      (risk.has_logic_changes ? LOGIC_CHANGES : none) |
+      (risk.has_api_changes ? API_CHANGES : none) |
+      (risk.affects_multiple_functions ? MULTIPLE_FUNCTIONS : none) |
+      (risk.affects_critical_section ? CRITICAL_SECTION : none);
+  store64(record + 8 * (field + RISK_LEVEL), static_cast<uint64_t>(risk.level));
+  store64(record + 8 * (field + RISK_CONFIDENCE), confidence);
+  store64(record + 8 * (field + RISK_FLAGS), flags);
+  writer.strings(record, field + RISK_FACTORS, risk.risk_factors);
+  writer.strings(record, field + RISK_RECOMMENDATIONS, risk.recommendations);
+}
+
+void write_conflict(Writer &writer, unsigned char *record,
+                    const Conflict &conflict) {
+  store64(record + 8 * START_LINE, conflict.start_line);
+  store64(record + 8 * END_LINE, conflict.end_line);
+  store64(record + 8 * BASE_RANGE, conflict.base_range.begin);
+  store64(record + 8 * (BASE_RANGE + 1), conflict.base_range.end);
+  store64(record + 8 * OUR_RANGE, conflict.our_range.begin);
+  store64(record + 8 * (OUR_RANGE + 1), conflict.our_range.end);
+  store64(record + 8 * THEIR_RANGE, conflict.their_range.begin);
+  store64(record + 8 * (THEIR_RANGE + 1), conflict.their_range.end);
+  store64(record + 8 * ANALYSIS, static_cast<uint64_t>(conflict.analysis));
+
+  writer.lines(record, BASE_LINES, conflict.base_lines);
+  writer.lines(record, OUR_LINES, conflict.our_lines);
+  writer.lines(record, THEIR_LINES, conflict.their_lines);
+  writer.changes(record, OUR_CHANGES, conflict.our_changes);
+  writer.changes(record, THEIR_CHANGES, conflict.their_changes);
+
+  const auto &context = conflict.context;
+  store64(record + 8 * CONTEXT_START, context.start_line);
+  store64(record + 8 * CONTEXT_END, context.end_line);
+  store64(record + 8 * FUNCTION_NAME, writer.add(context.function_name));
+  store64(record + 8 * CLASS_NAME, writer.add(context.class_name));
+  writer.strings(record, SURROUNDING, context.surrounding_lines);
+  writer.strings(record, IMPORTS, context.imports);
+  writer.run(record, METADATA, [&] {
+    for (const auto &entry : context.metadata) {
+      writer.add(entry.first);
+      writer.add(entry.second);
+    }
+  });
+
+  write_risk(writer, record, RISK_OURS, conflict.risk_ours);
+  write_risk(writer, record, RISK_THEIRS, conflict.risk_theirs);
+  write_risk(writer, record, RISK_BOTH, conflict.risk_both);
+}
+
+/**
+ * @brief Whether a (first, count) run lies inside a table of @p size.
+ */
+bool run_fits(uint64_t first, uint64_t count, uint64_t size) {
+  return first <= size && count <= size - first;
+}
+
+bool valid_record(const unsigned char *record, uint64_t strings,
+                  uint64_t spans) {
+  auto field = [&](size_t index) { return load64(record + 8 * index); };
+  auto string_run = [&](size_t index) {
+    return run_fits(field(index), field(index + 1), strings);
+  };
+
+  if (field(ANALYSIS) > static_cast<uint64_t>(AnalysisLevel::FULL)) {
+    return false;
+  }
+  if (!string_run(BASE_LINES) || !string_run(OUR_LINES) ||
+      !string_run(THEIR_LINES) || !string_run(SURROUNDING) ||
+      !string_run(IMPORTS) || !string_run(METADATA) ||
+      field(METADATA + 1) % 2 != 0) {
+    return false;
+  }
+  if (!run_fits(field(OUR_CHANGES), field(OUR_CHANGES + 1), spans) ||
+      !run_fits(field(THEIR_CHANGES), field(THEIR_CHANGES + 1), spans)) {
+    return false;
+  }
+  if (field(FUNCTION_NAME) >= strings || field(CLASS_NAME) >= strings) {
+    return false;
+  }
+  for (size_t risk : {RISK_OURS, RISK_THEIRS, RISK_BOTH}) {
+    if (field(risk + RISK_LEVEL) >
+            static_cast<uint64_t>(analysis::RiskLevel::CRITICAL) ||
+        !string_run(risk + RISK_FACTORS) ||
+        !string_run(risk + RISK_RECOMMENDATIONS)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename Strings>
+void decode_strings(const LineRun &run, Strings &strings) {
+  strings.clear();
+  strings.reserve(run.size());
+  for (size_t i = 0; i < run.size(); ++i) {
+    strings.emplace_back(run[i]);
+  }
+}
+
+void decode_lines(const LineRun &run, std::pmr::vector<Line> &lines) {
+  lines.clear();
+  lines.reserve(run.size());
+  for (size_t i = 0; i < run.size(); ++i) {
+    lines.emplace_back(run[i], run.origin(i));
+  }
+}
+
+} // namespace
+
+void encode_merge_result(const MergeResult &result, std::string &out) {
+  Counts counts;
+  for (const auto &line : result.merged_lines) {
+    counts.add(line.content);
+  }
+  for (const auto &conflict : result.conflicts) {
+    counts.add_conflict(conflict);
+  }
+
+  const size_t offsets_pos = HEADER_BYTES;
+  const size_t conflicts_pos = offsets_pos + 8 * (counts.strings + 1);
+  const size_t spans_pos =
+      conflicts_pos + RECORD_BYTES * result.conflicts.size();
+  const size_t origins_pos = spans_pos + SPAN_BYTES * counts.spans;
+  const size_t blob_pos = origins_pos + pad8(counts.strings);
+  const size_t total = blob_pos + pad8(counts.bytes);
+
+  // Zero-filled, so the padding is deterministic
+  out.assign(total, '\0');
+  auto *data = reinterpret_cast<unsigned char *>(&out[0]);
+
+  std::memcpy(data, RESULT_MAGIC, sizeof(RESULT_MAGIC));
+  uint32_t version = RESULT_FORMAT_VERSION;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  version = __builtin_bswap32(version);
+#endif
+  std::memcpy(data + 4, &version, sizeof(version));
+  store64(data + 8, total);
+  store64(data + 16, result.merged_lines.size());
+  store64(data + 24, result.conflicts.size());
+  store64(data + 32, counts.strings);
+  store64(data + 40, counts.spans);
+
+  Writer writer(data + offsets_pos, data + spans_pos, data + origins_pos,
+                &out[blob_pos]);
+  for (const auto &line : result.merged_lines) {
+    writer.add(line.content, line.origin);
+  }
+  for (size_t i = 0; i < result.conflicts.size(); ++i) {
+    write_conflict(writer, data + conflicts_pos + RECORD_BYTES * i,
+                   result.conflicts[i]);
+  }
+}
+
+std::string encode_merge_result(const MergeResult &result) {
+  std::string out;
+  encode_merge_result(result, out);
+  return out;
+}
+
+std::string_view LineRun::operator[](size_t i) const {
+  return view_->string(first_ + i);
+}
+
+Line::Origin LineRun::origin(size_t i) const {
+  return view_->origin(first_ + i);
+}
+
+uint64_t ConflictView::field(size_t index) const {
+  return load64(record_ + 8 * index);
+}
+
+LineRun ConflictView::run(size_t index) const {
+  return LineRun(view_, field(index), field(index + 1));
+}
+
+size_t ConflictView::start_line() const { return field(START_LINE); }
+size_t ConflictView::end_line() const { return field(END_LINE); }
+
+LineRange ConflictView::base_range() const {
+  return {field(BASE_RANGE), field(BASE_RANGE + 1)};
+}
+
+LineRange ConflictView::our_range() const {
+  return {field(OUR_RANGE), field(OUR_RANGE + 1)};
+}
+
+LineRange ConflictView::their_range() const {
+  return {field(THEIR_RANGE), field(THEIR_RANGE + 1)};
+}
+
+AnalysisLevel ConflictView::analysis() const {
+  return static_cast<AnalysisLevel>(field(ANALYSIS));
+}
+
+LineRun ConflictView::base_lines() const { return run(BASE_LINES); }
+LineRun ConflictView::our_lines() const { return run(OUR_LINES); }
+LineRun ConflictView::their_lines() const { return run(THEIR_LINES); }
+
+size_t ConflictView::our_change_count() const {
+  return field(OUR_CHANGES + 1);
+}
+
+TokenSpan ConflictView::our_change(size_t i) const {
+  return view_->span(field(OUR_CHANGES) + i);
+}
+
+size_t ConflictView::their_change_count() const {
+  return field(THEIR_CHANGES + 1);
+}
+
+TokenSpan ConflictView::their_change(size_t i) const {
+  return view_->span(field(THEIR_CHANGES) + i);
+}
+
+void ConflictView::decode(Conflict &conflict) const {
+  conflict.start_line = start_line();
+  conflict.end_line = end_line();
+  conflict.base_range = base_range();
+  conflict.our_range = our_range();
+  conflict.their_range = their_range();
+  conflict.analysis = analysis();
+
+  decode_lines(base_lines(), conflict.base_lines);
+  decode_lines(our_lines(), conflict.our_lines);
+  decode_lines(their_lines(), conflict.their_lines);
+  conflict.our_changes.clear();
+  for (size_t i = 0; i < our_change_count(); ++i) {
+    conflict.our_changes.push_back(our_change(i));
+  }
+  conflict.their_changes.clear();
+  for (size_t i = 0; i < their_change_count(); ++i) {
+    conflict.their_changes.push_back(their_change(i));
+  }
+
+  auto &context = conflict.context;
+  context.start_line = field(CONTEXT_START);
+  context.end_line = field(CONTEXT_END);
+  context.function_name.assign(view_->string(field(FUNCTION_NAME)));
+  context.class_name.assign(view_->string(field(CLASS_NAME)));
+  decode_strings(run(SURROUNDING), context.surrounding_lines);
+  decode_strings(run(IMPORTS), context.imports);
+  context.metadata.clear();
+  LineRun metadata = run(METADATA);
+  for (size_t i = 0; i + 1 < metadata.size(); i += 2) {
+    context.metadata.emplace(metadata[i], metadata[i + 1]);
+  }
+
+  const std::pair<size_t, analysis::RiskAssessment *> risks[] = {
+      {RISK_OURS, &conflict.risk_ours},
+      {RISK_THEIRS, &conflict.risk_theirs},
+      {RISK_BOTH, &conflict.risk_both}};
+  for (const auto &entry : risks) {
+    size_t base = entry.first;
+    analysis::RiskAssessment &risk = *entry.second;
+    risk.level = static_cast<analysis::RiskLevel>(field(base + RISK_LEVEL));
+    uint64_t confidence = field(base + RISK_CONFIDENCE);
+    std::memcpy(&risk.confidence_score, &confidence, sizeof(confidence));
+    uint64_t flags = field(base + RISK_FLAGS);
+    risk.has_syntax_changes = flags & SYNTAX_CHANGES;
+    risk.has_logic_changes = flags & LOGIC_CHANGES;
+    risk.has_api_changes = flags & API_CHANGES;
+    risk.affects_multiple_functions = flags & MULTIPLE_FUNCTIONS;
+    risk.affects_critical_section = flags & CRITICAL_SECTION;
+    decode_strings(run(base + RISK_FACTORS), risk.risk_factors);
+    decode_strings(run(base + RISK_RECOMMENDATIONS), risk.recommendations);
+  }
+}
+
+bool MergeResultView::open(std::string_view data) {
+  *this = MergeResultView();
+  const auto *bytes = reinterpret_cast<const unsigned char *>(data.data());
+  const uint64_t size = data.size();
+
+  if (size < HEADER_BYTES ||
+      std::memcmp(bytes, RESULT_MAGIC, sizeof(RESULT_MAGIC)) != 0) {
+    return false;
+  }
+  uint32_t version;
+  std::memcpy(&version, bytes + 4, sizeof(version));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  version = __builtin_bswap32(version);
+#endif
+  if (version != RESULT_FORMAT_VERSION || load64(bytes + 8) != size) {
+    return false;
+  }
+
+  const uint64_t lines = load64(bytes + 16);
+  const uint64_t conflicts = load64(bytes + 24);
+  const uint64_t strings = load64(bytes + 32);
+  const uint64_t spans = load64(bytes + 40);
+  // Bounding every count by the buffer first keeps the sums below exact
+  if (strings >= size / 8 || lines > strings ||
+      conflicts > size / RECORD_BYTES || spans > size / SPAN_BYTES) {
+    return false;
+  }
+
+  const uint64_t offsets_pos = HEADER_BYTES;
+  const uint64_t conflicts_pos = offsets_pos + 8 * (strings + 1);
+  const uint64_t spans_pos = conflicts_pos + RECORD_BYTES * conflicts;
+  const uint64_t origins_pos = spans_pos + SPAN_BYTES * spans;
+  const uint64_t blob_pos = origins_pos + pad8(strings);
+  if (blob_pos > size) {
+    return false;
+  }
+
+  // Offsets must rise from 0 to the end of the blob
+  uint64_t previous = 0;
+  if (load64(bytes + offsets_pos) != 0) {
+    return false;
+  }
+  for (uint64_t i = 1; i <= strings; ++i) {
+    uint64_t offset = load64(bytes + offsets_pos + 8 * i);
+    if (offset < previous) {
+      return false;
+    }
+    previous = offset;
+  }
+  if (previous > size - blob_pos || blob_pos + pad8(previous) != size) {
+    return false;
+  }
+
+  for (uint64_t i = 0; i < strings; ++i) {
+    if (bytes[origins_pos + i] > Line::MERGED) {
+      return false;
+    }
+  }
+  for (uint64_t i = 0; i < conflicts; ++i) {
+    if (!valid_record(bytes + conflicts_pos + RECORD_BYTES * i, strings,
+                      spans)) {
+      return false;
+    }
+  }
+
+  line_count_ = lines;
+  conflict_count_ = conflicts;
+  offsets_ = bytes + offsets_pos;
+  conflicts_ = bytes + conflicts_pos;
+  spans_ = bytes + spans_pos;
+  origins_ = bytes + origins_pos;
+  blob_ = data.data() + blob_pos;
+  return true;
+}
+
+std::string_view MergeResultView::string(size_t i) const {
+  uint64_t begin = load64(offsets_ + 8 * i);
+  uint64_t end = load64(offsets_ + 8 * (i + 1));
+  return std::string_view(blob_ + begin, end - begin);
+}
+
+TokenSpan MergeResultView::span(size_t i) const {
+  const unsigned char *p = spans_ + SPAN_BYTES * i;
+  return {load64(p), load64(p + 8), load64(p + 16)};
+}
+
+ConflictView MergeResultView::conflict(size_t i) const {
+  return ConflictView(this, conflicts_ + RECORD_BYTES * i);
+}
+
+void MergeResultView::decode(MergeResult &result) const {
+  decode_lines(lines(), result.merged_lines);
+  result.conflicts.clear();
+  result.conflicts.reserve(conflict_count_);
+  for (size_t i = 0; i < conflict_count_; ++i) {
+    result.conflicts.emplace_back();
+    conflict(i).decode(result.conflicts.back());
+  }
+}
+
+bool decode_merge_result(std::string_view data, MergeResult &result) {
+  MergeResultView view;
+  if (!view.open(data)) {
+    return false;
+  }
+  view.decode(result);
+  return true;
+}
+
+} // namespace merge
+} // namespace wizardmerge
@@ -0,0 +1,189 @@
+/**
+ * @file streaming_merge.cpp
+ * @brief Implementation of the bounded-memory streaming merge
+ */
+
+#include "wizardmerge/merge/streaming_merge.h"
+#include "wizardmerge/merge/anchors.h"
+#include "wizardmerge/merge/merge_policy.h"
+#include <algorithm>
+#include <deque>
+#include <memory_resource>
+#include <optional>
+#include <string>
+
+namespace wizardmerge {
+namespace merge {
+
+namespace {
+
+/**
+ * @brief Read-ahead buffer of lines from one input stream.
+ */
+class Window {
+public:
+  explicit Window(std::istream &in) : in_(in), eof_(false) {}
+
+  /**
+   * @brief Reads lines until the window holds @p target or the stream ends.
+   */
+  void fill(size_t target) {
+    std::string line;
+    while (lines_.size() < target && !eof_) {
+      if (std::getline(in_, line)) {
+        lines_.push_back(std::move(line));
+      } else {
+        eof_ = true;
+      }
+    }
+  }
+
+  /**
+   * @brief Drops the first @p count lines.
+   */
+  void consume(size_t count) {
+    lines_.erase(lines_.begin(), lines_.begin() + count);
+  }
+
+  /**
+   * @brief Views of the first @p count lines.
+   */
+  std::vector<std::string_view> views(size_t count) const {
+    return std::vector<std::string_view>(lines_.begin(),
+                                         lines_.begin() + count);
+  }
+
+  const std::string &operator[](size_t index) const { return lines_[index]; }
+  size_t size() const { return lines_.size(); }
+  bool at_eof() const { return eof_; }
+
+private:
+  std::istream &in_;
+  std::deque<std::string> lines_;
+  bool eof_;
+};
+
+/**
+ * @brief Finds the furthest line that can be used to cut all three windows.
+ *
+ * The sync point is the last anchor of the windows (see find_anchors).
+ */
+std::optional<Anchor> find_sync_point(const Window &base, const Window &ours,
+                                      const Window &theirs) {
+  const Window *windows[3] = {&base, &ours, &theirs};
+  LineTable table(base.size() + ours.size() + theirs.size());
+  std::vector<LineId> ids[3];
+  for (int side = 0; side < 3; ++side) {
+    ids[side] = table.intern_lines(windows[side]->views(windows[side]->size()));
+  }
+
+  auto chain = find_anchors(ids[0], ids[1], ids[2], table.size());
+  if (chain.empty()) {
+    return std::nullopt;
+  }
+  return chain.back();
+}
+
+/**
+ * @brief Merges one chunk straight into the sink.
+ */
+void merge_chunk(const std::vector<std::string_view> &base,
+                 const std::vector<std::string_view> &ours,
+                 const std::vector<std::string_view> &theirs,
+                 const MergeOptions &options, MergeSink &sink,
+                 StreamingStats &stats) {
+  if (base.empty() && ours.empty() && theirs.empty()) {
+    return;
+  }
+
+  // The chunk's conflicts live only until they are forwarded
+  std::pmr::monotonic_buffer_resource arena;
+  StreamSink chunk_sink(sink, stats.lines_written, &arena);
+  if (is_text_merge(options)) {
+    merge_with_policy<TextStreamPolicy>(base, ours, theirs, options,
+                                        chunk_sink);
+  } else if (options.compare.exact() && !options.compare.ignore_blank_lines) {
+    merge_with_policy<ExactStreamPolicy>(base, ours, theirs, options,
+                                         chunk_sink);
+  } else {
+    merge_with_policy<EquivalentStreamPolicy>(base, ours, theirs, options,
+                                              chunk_sink);
+  }
+
+  stats.lines_written = chunk_sink.line_count();
+  stats.conflicts += chunk_sink.conflicts_forwarded();
+  ++stats.chunks;
+}
+
+} // namespace
+
+StreamingStats streaming_three_way_merge(std::istream &base,
+                                         std::istream &ours,
+                                         std::istream &theirs,
+                                         MergeSink &sink,
+                                         const StreamingOptions &options) {
+  StreamingStats stats;
+  Window base_window(base);
+  Window our_window(ours);
+  Window their_window(theirs);
+
+  size_t initial = std::max<size_t>(options.window_lines, 1);
+  size_t limit = std::max(options.max_window_lines, initial);
+  size_t target = initial;
+
+  while (true) {
+    base_window.fill(target);
+    our_window.fill(target);
+    their_window.fill(target);
+    stats.peak_window_lines =
+        std::max({stats.peak_window_lines, base_window.size(),
+                  our_window.size(), their_window.size()});
+
+    bool all_eof = base_window.at_eof() && our_window.at_eof() &&
+                   their_window.at_eof();
+
+    if (!all_eof) {
+      auto anchor = find_sync_point(base_window, our_window, their_window);
+      if (anchor) {
+        merge_chunk(base_window.views(anchor->base),
+                    our_window.views(anchor->ours),
+                    their_window.views(anchor->theirs), options.merge, sink,
+                    stats);
+
+        // The sync point itself is unchanged on both sides
+        sink.write_line(base_window[anchor->base], Line::BASE);
+        ++stats.lines_written;
+
+        base_window.consume(anchor->base + 1);
+        our_window.consume(anchor->ours + 1);
+        their_window.consume(anchor->theirs + 1);
+        target = initial;
+        continue;
+      }
+
+      // No sync point yet: the current hunk is larger than the window
+      if (target < limit) {
+        target = std::min(target * 2, limit);
+        continue;
+      }
+    }
+
+    // Inputs exhausted, or no sync point within the largest window
+    merge_chunk(base_window.views(base_window.size()),
+                our_window.views(our_window.size()),
+                their_window.views(their_window.size()), options.merge, sink,
+                stats);
+    base_window.consume(base_window.size());
+    our_window.consume(our_window.size());
+    their_window.consume(their_window.size());
+
+    if (all_eof) {
+      break;
+    }
+  }
+
+  return stats;
+}
+
+} // namespace merge
+} // namespace wizardmerge
@@ -0,0 +1,175 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Implementation of the work-stealing thread pool
+ */
+
+#include "wizardmerge/merge/thread_pool.h"
+#include <exception>
+
+namespace wizardmerge {
+namespace merge {
+
+namespace {
+
+// Pool and queue index of the worker running on this thread, if any
+thread_local const ThreadPool *current_pool = nullptr;
+thread_local size_t current_queue = 0;
+
+} // namespace
+
+size_t resolve_thread_count(size_t threads) {
+  if (threads == 0) {
+    threads = std::thread::hardware_concurrency();
+  }
+  return threads == 0 ? 1 : threads;
+}
+
+ThreadPool::ThreadPool(size_t threads)
+    : next_queue_(0), queued_(0), stopping_(false) {
+  size_t workers = resolve_thread_count(threads) - 1;
+  for (size_t i = 0; i < workers; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  for (size_t i = 0; i < workers; ++i) {
+    workers_.emplace_back([this, i] { worker_loop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::run_batch(size_t count,
+                           const std::function<void(size_t)> &body) {
+  std::exception_ptr error;
+
+  if (workers_.empty() || count <= 1) {
+    for (size_t i = 0; i < count; ++i) {
+      try {
+        body(i);
+      } catch (...) {
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return;
+  }
+
+  std::atomic<size_t> remaining(count);
+  std::mutex error_mutex;
+
+  for (size_t i = 0; i < count; ++i) {
+    push([&, i] {
+      try {
+        body(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+      // Nothing of the batch may be touched after the last decrement:
+      // the waiting thread returns and destroys it
+      if (remaining.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_cv_.notify_all();
+      }
+    });
+  }
+
+  // Help with queued work (ours or anyone's) until the batch is done
+  std::function<void()> task;
+  while (remaining.load() > 0) {
+    if (pop(task)) {
+      task();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [&] { return remaining.load() == 0 || queued_ > 0; });
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void ThreadPool::push(std::function<void()> task) {
+  size_t index = current_pool == this
+                     ? current_queue
+                     : next_queue_.fetch_add(1) % queues_.size();
+  {
+    std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+    queues_[index]->tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++queued_;
+  }
+  work_cv_.notify_one();
+  done_cv_.notify_all();
+}
+
+bool ThreadPool::pop(std::function<void()> &task) {
+  size_t count = queues_.size();
+  bool is_worker = current_pool == this;
+  size_t self = is_worker ? current_queue : 0;
+
+  for (size_t k = 0; k < count; ++k) {
+    size_t index = (self + k) % count;
+    Queue &queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+      continue;
+    }
+    // Newest task from our own deque, oldest when stealing
+    if (is_worker && k == 0) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    } else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    std::lock_guard<std::mutex> count_lock(mutex_);
+    --queued_;
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::worker_loop(size_t index) {
+  current_pool = this;
+  current_queue = index;
+
+  std::function<void()> task;
+  while (true) {
+    if (pop(task)) {
+      task();
+      task = nullptr;
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    work_cv_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+    if (stopping_ && queued_ == 0) {
+      return;
+    }
+  }
+}
+
+ThreadPool &shared_thread_pool() {
+  static ThreadPool pool;
+  return pool;
+}
+
+} // namespace merge
+} // namespace wizardmerge
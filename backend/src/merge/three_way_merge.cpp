@@ -6,105 +6,885 @@
 #include "wizardmerge/merge/three_way_merge.h"
 #include "wizardmerge/analysis/context_analyzer.h"
 #include "wizardmerge/analysis/risk_analyzer.h"
+#include "wizardmerge/merge/anchors.h"
+#include "wizardmerge/merge/conflict_markers.h"
+#include "wizardmerge/merge/diff.h"
+#include "wizardmerge/merge/diff3.h"
+#include "wizardmerge/merge/line_table.h"
+#include "wizardmerge/merge/merge_policy.h"
+#include "wizardmerge/merge/moves.h"
+#include "wizardmerge/merge/thread_pool.h"
+#include "wizardmerge/text/text_buffer.h"
+#include "wizardmerge/text/text_kernels.h"
 #include <algorithm>
+#include <optional>
 
 namespace wizardmerge {
 namespace merge {
 
 namespace {
 
+// Lines of context captured around each conflict (analyze_context default)
+constexpr size_t CONTEXT_WINDOW = 5;
+
+/**
+ * @brief Line range [begin, end) within one version of the file.
+ */
+struct Span {
+  size_t begin;
+  size_t end;
+};
+
+void append_lines(std::pmr::vector<Line> &out,
+                  const std::vector<std::string_view> &src, Span span,
+                  Line::Origin origin) {
+  for (size_t i = span.begin; i < span.end; ++i) {
+    out.emplace_back(src[i], origin);
+  }
+}
+
+template <typename Lines>
+std::vector<std::string_view> slice(const Lines &src, Span span) {
+  return std::vector<std::string_view>(src.begin() + span.begin,
+                                       src.begin() + span.end);
+}
+
+/**
+ * @brief Ranges of one region in the three versions.
+ */
+struct RegionSpans {
+  Span base;
+  Span ours;
+  Span theirs;
+};
+
+/**
+ * @brief Merges conflicts separated by at most CONFLICT_MERGE_GAP
+ *        unchanged lines into one.
+ *
+ * The unchanged lines between two merged conflicts become part of all
+ * three sides of the combined conflict.
+ */
+void merge_close_conflicts(std::vector<Diff3Region> &regions) {
+  size_t out = 0;
+  for (size_t i = 0; i < regions.size(); ++i) {
+    if (out > 0 && regions[i].kind == Diff3Region::CONFLICT) {
+      Diff3Region &prev = regions[out - 1];
+      if (prev.kind == Diff3Region::CONFLICT &&
+          regions[i].base_begin - prev.base_end <= CONFLICT_MERGE_GAP) {
+        prev.base_end = regions[i].base_end;
+        prev.ours_end = regions[i].ours_end;
+        prev.theirs_end = regions[i].theirs_end;
+        continue;
+      }
+    }
+    regions[out++] = regions[i];
+  }
+  regions.resize(out);
+}
+
+/**
+ * @brief Picks the concrete algorithm DiffAlgorithm::AUTO would use on the
+ *        whole inputs, so that trimming the common ends and partitioning
+ *        do not change it.
+ */
+DiffAlgorithm resolve_algorithm(DiffAlgorithm algorithm, size_t base_size,
+                                size_t other_size) {
+  if (algorithm != DiffAlgorithm::AUTO) {
+    return algorithm;
+  }
+  return std::max(base_size, other_size) >= HISTOGRAM_AUTO_THRESHOLD
+             ? DiffAlgorithm::HISTOGRAM
+             : DiffAlgorithm::MYERS;
+}
+
+/**
+ * @brief Diffs base against ours and theirs partition by partition.
+ *
+ * Anchors are unchanged on both sides, so the hunks of the partitions
+ * between them concatenate into a valid edit script for the whole file.
+ */
+void partitioned_diff(const std::vector<LineId> &base_ids,
+                      const std::vector<LineId> &our_ids,
+                      const std::vector<LineId> &their_ids, size_t id_count,
+                      DiffAlgorithm our_algorithm,
+                      DiffAlgorithm their_algorithm, size_t memory_budget,
+                      ThreadPool &pool,
+                      std::vector<DiffHunk> &our_hunks,
+                      std::vector<DiffHunk> &their_hunks) {
+  std::vector<RegionSpans> partitions;
+  size_t base_pos = 0;
+  size_t our_pos = 0;
+  size_t their_pos = 0;
+  for (const Anchor &anchor :
+       find_anchors(base_ids, our_ids, their_ids, id_count)) {
+    if (anchor.base - base_pos >= PARALLEL_PARTITION_LINES) {
+      partitions.push_back({{base_pos, anchor.base},
+                            {our_pos, anchor.ours},
+                            {their_pos, anchor.theirs}});
+      base_pos = anchor.base + 1;
+      our_pos = anchor.ours + 1;
+      their_pos = anchor.theirs + 1;
+    }
+  }
+  partitions.push_back({{base_pos, base_ids.size()},
+                        {our_pos, our_ids.size()},
+                        {their_pos, their_ids.size()}});
+
+  // One task per partition and side
+  std::vector<std::vector<DiffHunk>> pieces(partitions.size() * 2);
+  pool.parallel_for(pieces.size(), [&](size_t task) {
+    const RegionSpans &part = partitions[task / 2];
+    bool theirs = task % 2 == 1;
+    const std::vector<LineId> &other_ids = theirs ? their_ids : our_ids;
+    Span other = theirs ? part.theirs : part.ours;
+
+    std::vector<LineId> base_part(base_ids.begin() + part.base.begin,
+                                  base_ids.begin() + part.base.end);
+    std::vector<LineId> other_part(other_ids.begin() + other.begin,
+                                   other_ids.begin() + other.end);
+    pieces[task] =
+        compute_diff(base_part, other_part,
+                     theirs ? their_algorithm : our_algorithm, memory_budget);
+    for (auto &hunk : pieces[task]) {
+      hunk.base_start += part.base.begin;
+      hunk.other_start += other.begin;
+    }
+  });
+
+  for (size_t task = 0; task < pieces.size(); ++task) {
+    auto &hunks = task % 2 == 1 ? their_hunks : our_hunks;
+    hunks.insert(hunks.end(), pieces[task].begin(), pieces[task].end());
+  }
+}
+
+/**
+ * @brief Lines that can be emitted as stable without diffing them.
+ *
+ * Each diff strips its own common prefix and suffix before searching
+ * (see run_diff in diff.cpp). The minimum over the two sides is part of
+ * both, so removing it up front leaves their hunks unchanged. Blank
+ * lines the diff skips (compare.ignore_blank_lines) shift what it strips,
+ * so nothing is trimmed then.
+ */
+template <typename Comparator>
+CommonEnds common_ends(const std::vector<std::string_view> &base,
+                       const std::vector<std::string_view> &ours,
+                       const std::vector<std::string_view> &theirs,
+                       const Comparator &comparator) {
+  if (comparator.ignores_blank_lines()) {
+    return {};
+  }
+  CommonEnds our_ends = common_ends(base, ours, comparator);
+  CommonEnds their_ends = common_ends(base, theirs, comparator);
+  return {std::min(our_ends.prefix, their_ends.prefix),
+          std::min(our_ends.suffix, their_ends.suffix)};
+}
+
+/**
+ * @brief The lines of one version that are diffed: their IDs, and their
+ *        positions in the version.
+ */
+struct DiffedLines {
+  std::vector<LineId> ids;
+  // Position of each ID; empty when the lines are contiguous from offset
+  std::vector<size_t> positions;
+  size_t offset = 0;
+  size_t end = 0;
+
+  /**
+   * @brief Maps a range of IDs back to the lines of the version. Skipped
+   *        lines before a range stay outside it.
+   */
+  Span to_lines(size_t begin, size_t end_id) const {
+    if (positions.empty()) {
+      return {offset + begin, offset + end_id};
+    }
+    size_t first = begin < positions.size() ? positions[begin] : end;
+    return {first, end_id > begin ? positions[end_id - 1] + 1 : first};
+  }
+};
+
+/**
+ * @brief Interns the lines of a version between the common ends, leaving
+ *        out blank lines under compare.ignore_blank_lines.
+ */
+template <typename Comparator>
+DiffedLines intern_diffed(LineTable &table,
+                          const std::vector<std::string_view> &lines,
+                          const CommonEnds &ends,
+                          const Comparator &comparator) {
+  DiffedLines diffed;
+  diffed.offset = ends.prefix;
+  diffed.end = lines.size() - ends.suffix;
+  if (!comparator.ignores_blank_lines()) {
+    diffed.ids = table.intern_lines(slice(lines, {diffed.offset, diffed.end}));
+    return diffed;
+  }
+  for (size_t i = diffed.offset; i < diffed.end; ++i) {
+    if (!text::is_blank(lines[i])) {
+      diffed.ids.push_back(table.intern(lines[i]));
+      diffed.positions.push_back(i);
+    }
+  }
+  return diffed;
+}
+
+/**
+ * @brief Shared implementation of the analyze_conflict overloads.
+ */
+template <typename Lines>
+void analyze_conflict_impl(Conflict &conflict, const Lines &base,
+                           const Lines &ours, const Lines &theirs,
+                           AnalysisLevel level) {
+  auto alloc = conflict.get_allocator();
+  Span base_span{conflict.base_range.begin, conflict.base_range.end};
+  Span our_span{conflict.our_range.begin, conflict.our_range.end};
+  Span their_span{conflict.their_range.begin, conflict.their_range.end};
+
+  if (level >= AnalysisLevel::CONTEXT &&
+      conflict.analysis < AnalysisLevel::CONTEXT) {
+    // Perform context analysis using ours version as context
+    // (could also use base or theirs, but ours is typically most relevant)
+    size_t context_end =
+        our_span.end > our_span.begin ? our_span.end - 1 : our_span.begin;
+    conflict.context = analysis::analyze_context(
+        ours, our_span.begin, context_end, CONTEXT_WINDOW, alloc);
+    conflict.analysis = AnalysisLevel::CONTEXT;
+  }
+
+  if (level >= AnalysisLevel::FULL &&
+      conflict.analysis < AnalysisLevel::FULL) {
+    // Perform risk analysis for different resolution strategies
+    std::vector<std::string_view> base_vec = slice(base, base_span);
+    std::vector<std::string_view> ours_vec = slice(ours, our_span);
+    std::vector<std::string_view> theirs_vec = slice(theirs, their_span);
+
+    conflict.risk_ours =
+        analysis::analyze_risk_ours(base_vec, ours_vec, theirs_vec, alloc);
+    conflict.risk_theirs =
+        analysis::analyze_risk_theirs(base_vec, ours_vec, theirs_vec, alloc);
+    conflict.risk_both =
+        analysis::analyze_risk_both(base_vec, ours_vec, theirs_vec, alloc);
+    conflict.analysis = AnalysisLevel::FULL;
+  }
+}
+
+/**
+ * @brief Analyzes the conflicts from index @p first on up to @p level, in
+ *        parallel when a pool is given.
+ */
+void analyze_conflicts(std::pmr::vector<Conflict> &all, size_t first,
+                       const std::vector<std::string_view> &base,
+                       const std::vector<std::string_view> &ours,
+                       const std::vector<std::string_view> &theirs,
+                       AnalysisLevel level, ThreadPool *pool) {
+  Conflict *conflicts = all.data() + first;
+  size_t count = all.size() - first;
+  if (level == AnalysisLevel::NONE) {
+    return;
+  }
+  if (pool == nullptr || count < 2) {
+    for (size_t i = 0; i < count; ++i) {
+      analyze_conflict(conflicts[i], base, ours, theirs, level);
+    }
+    return;
+  }
+
+  std::pmr::memory_resource *heap = std::pmr::new_delete_resource();
+  if (all.get_allocator().resource()->is_equal(*heap)) {
+    pool->parallel_for(count, [&](size_t i) {
+      analyze_conflict(conflicts[i], base, ours, theirs, level);
+    });
+    return;
+  }
+
+  // Other resources (e.g. a request arena) need not be thread-safe:
+  // analyze on the heap, then copy into the result serially
+  std::vector<Conflict> scratch;
+  scratch.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    Conflict &copy = scratch.emplace_back(Conflict::allocator_type(heap));
+    copy.base_range = conflicts[i].base_range;
+    copy.our_range = conflicts[i].our_range;
+    copy.their_range = conflicts[i].their_range;
+  }
+  pool->parallel_for(count, [&](size_t i) {
+    analyze_conflict(scratch[i], base, ours, theirs, level);
+  });
+  for (size_t i = 0; i < count; ++i) {
+    conflicts[i].context = std::move(scratch[i].context);
+    conflicts[i].risk_ours = std::move(scratch[i].risk_ours);
+    conflicts[i].risk_theirs = std::move(scratch[i].risk_theirs);
+    conflicts[i].risk_both = std::move(scratch[i].risk_both);
+    conflicts[i].analysis = scratch[i].analysis;
+  }
+}
+
+/**
+ * @brief Lines of one version replaced by lines of another, to carry
+ *        edits along with a moved block.
+ */
+struct Substitution {
+  Span lines; // Replaced lines of the version
+  const std::vector<std::string_view> *source;
+  Span source_lines;
+  // Where the replacement starts in the rewritten version
+  size_t rewritten_begin = 0;
+
+  size_t rewritten_end() const {
+    return rewritten_begin + source_lines.end - source_lines.begin;
+  }
+};
+
+bool overlaps(Span a, Span b) {
+  return (a.begin < b.end && b.begin < a.end) || a.begin == b.begin;
+}
+
+/**
+ * @brief Finds the lines a diff aligns with base range [begin, end).
+ *
+ * @param hunks Diff of base against the version
+ * @param other Receives the range in the version
+ * @param edited Set if a hunk lies inside the range
+ * @return false if a hunk straddles a bound of the range
+ */
+bool align_range(const std::vector<DiffHunk> &hunks, size_t begin,
+                 size_t end, Span &other, bool &edited) {
+  // Positions aligned with each other right after the last hunk seen
+  size_t base_mark = 0;
+  size_t other_mark = 0;
+  size_t h = 0;
+  for (; h < hunks.size() && hunks[h].base_end() <= begin; ++h) {
+    base_mark = hunks[h].base_end();
+    other_mark = hunks[h].other_end();
+  }
+  other.begin = begin - base_mark + other_mark;
+  edited = false;
+  for (; h < hunks.size() && hunks[h].base_start < end; ++h) {
+    if (hunks[h].base_start < begin || hunks[h].base_end() > end) {
+      return false;
+    }
+    base_mark = hunks[h].base_end();
+    other_mark = hunks[h].other_end();
+    edited = true;
+  }
+  other.end = end - base_mark + other_mark;
+  return true;
+}
+
+/**
+ * @brief Ours and theirs with the edits to moved blocks carried along.
+ *
+ * When one side moved a block the other side edited, the mover's copy at
+ * the new place is replaced by the edited block, and the edited block at
+ * the old place by the base block. Merging the rewritten versions then
+ * applies the edits once, at the new place, and the old place merges as
+ * a plain deletion.
+ */
+struct CarriedMoves {
+  std::vector<std::string_view> ours;
+  std::vector<std::string_view> theirs;
+  std::vector<Substitution> our_substitutions;
+  std::vector<Substitution> their_substitutions;
+};
+
+std::vector<std::string_view>
+apply_substitutions(const std::vector<std::string_view> &lines,
+                    std::vector<Substitution> &substitutions) {
+  std::sort(substitutions.begin(), substitutions.end(),
+            [](const Substitution &a, const Substitution &b) {
+              return a.lines.begin < b.lines.begin;
+            });
+  std::vector<std::string_view> rewritten;
+  rewritten.reserve(lines.size());
+  size_t pos = 0;
+  for (auto &sub : substitutions) {
+    rewritten.insert(rewritten.end(), lines.begin() + pos,
+                     lines.begin() + sub.lines.begin);
+    sub.rewritten_begin = rewritten.size();
+    rewritten.insert(rewritten.end(),
+                     sub.source->begin() + sub.source_lines.begin,
+                     sub.source->begin() + sub.source_lines.end);
+    pos = sub.lines.end;
+  }
+  rewritten.insert(rewritten.end(), lines.begin() + pos, lines.end());
+  return rewritten;
+}
+
+/**
+ * @brief Maps a position of a rewritten version back to the version.
+ *        Positions inside a replacement go to its start, or its end for
+ *        the end of a range.
+ */
+size_t original_position(size_t pos,
+                         const std::vector<Substitution> &substitutions,
+                         bool range_end) {
+  size_t original = pos;
+  for (const auto &sub : substitutions) {
+    if (pos >= sub.rewritten_end()) {
+      original = pos - sub.rewritten_end() + sub.lines.end;
+    } else if (pos > sub.rewritten_begin) {
+      return range_end ? sub.lines.end : sub.lines.begin;
+    } else {
+      break;
+    }
+  }
+  return original;
+}
+
+void map_range(LineRange &range,
+               const std::vector<Substitution> &substitutions) {
+  range.begin = original_position(range.begin, substitutions, false);
+  range.end = original_position(range.end, substitutions, true);
+}
+
 /**
- * @brief Check if two lines are effectively equal (ignoring whitespace).
+ * @brief Detects the blocks each side moved and, where the other side
+ *        edited them, prepares the rewritten versions.
+ *
+ * @return true if there is an edit to carry
  */
-bool lines_equal_ignore_whitespace(const std::string &a, const std::string &b) {
-  auto trim = [](const std::string &s) {
-    size_t start = s.find_first_not_of(" \t\n\r");
-    size_t end = s.find_last_not_of(" \t\n\r");
-    if (start == std::string::npos)
-      return std::string();
-    return s.substr(start, end - start + 1);
+bool carry_moves(const std::vector<std::string_view> &base,
+                 const std::vector<std::string_view> &ours,
+                 const std::vector<std::string_view> &theirs,
+                 const DiffedLines &base_lines, const DiffedLines &our_lines,
+                 const DiffedLines &their_lines,
+                 const std::vector<DiffHunk> &our_hunks,
+                 const std::vector<DiffHunk> &their_hunks,
+                 CarriedMoves &carried) {
+  struct Side {
+    const std::vector<std::string_view> &lines;
+    const DiffedLines &diffed;
+    const std::vector<DiffHunk> &hunks;
+    std::vector<Substitution> &substitutions;
+    std::vector<BlockMove> moves;
   };
-  return trim(a) == trim(b);
+  Side our_side{ours, our_lines, our_hunks, carried.our_substitutions,
+                find_moves(base_lines.ids, our_lines.ids, our_hunks)};
+  Side their_side{theirs, their_lines, their_hunks,
+                  carried.their_substitutions,
+                  find_moves(base_lines.ids, their_lines.ids, their_hunks)};
+
+  auto is_free = [](const std::vector<Substitution> &taken, Span lines) {
+    return std::none_of(taken.begin(), taken.end(),
+                        [&](const Substitution &sub) {
+                          return overlaps(sub.lines, lines);
+                        });
+  };
+
+  for (int mover = 0; mover < 2; ++mover) {
+    Side &moved = mover == 0 ? our_side : their_side;
+    Side &other = mover == 0 ? their_side : our_side;
+    for (const BlockMove &move : moved.moves) {
+      // A block both sides moved merges as it is
+      bool moved_twice = std::any_of(
+          other.moves.begin(), other.moves.end(), [&](const BlockMove &m) {
+            return m.base_begin < move.base_end && move.base_begin < m.base_end;
+          });
+      if (moved_twice) {
+        continue;
+      }
+      // Only edits that keep some of the block are carried; a block the
+      // other side deleted stays at its new place
+      Span edited_ids;
+      bool edited = false;
+      if (!align_range(other.hunks, move.base_begin, move.base_end,
+                       edited_ids, edited) ||
+          !edited || edited_ids.begin == edited_ids.end) {
+        continue;
+      }
+      Span destination = moved.diffed.to_lines(
+          move.other_begin, move.other_begin + move.size());
+      Span edited_block =
+          other.diffed.to_lines(edited_ids.begin, edited_ids.end);
+      if (!is_free(moved.substitutions, destination) ||
+          !is_free(other.substitutions, edited_block)) {
+        continue;
+      }
+      moved.substitutions.push_back({destination, &other.lines, edited_block});
+      other.substitutions.push_back(
+          {edited_block, &base,
+           base_lines.to_lines(move.base_begin, move.base_end)});
+    }
+  }
+  if (carried.our_substitutions.empty() &&
+      carried.their_substitutions.empty()) {
+    return false;
+  }
+  carried.ours = apply_substitutions(ours, carried.our_substitutions);
+  carried.theirs = apply_substitutions(theirs, carried.their_substitutions);
+  return true;
 }
 
-} // namespace
+/**
+ * @brief The labelled marker lines of a merge's conflicts.
+ */
+struct ConflictMarkers {
+  explicit ConflictMarkers(const MergeOptions &options)
+      : ours(conflict_marker('<', options.our_label)),
+        base(conflict_marker('|', options.base_label)),
+        theirs(conflict_marker('>', options.their_label)) {}
 
-MergeResult three_way_merge(const std::vector<std::string> &base,
-                            const std::vector<std::string> &ours,
-                            const std::vector<std::string> &theirs) {
-  MergeResult result;
+  std::string ours;
+  std::string base;
+  std::string theirs;
+};
+
+/**
+ * @brief Writes the lines of a span of one version to a sink.
+ */
+template <typename Sink>
+inline void write_span(Sink &sink, const std::vector<std::string_view> &lines,
+                       Span span, Line::Origin origin) {
+  sink.write_lines(lines, span.begin, span.end, origin);
+}
+
+/**
+ * @brief The merge pipeline, specialized for a policy (see
+ *        merge_with_policy).
+ *
+ * @param analyze_conflicts_now Whether to analyze the conflicts; false
+ *                              when the caller maps them first
+ */
+template <typename Policy>
+void merge_impl(const std::vector<std::string_view> &base,
+                const std::vector<std::string_view> &ours,
+                const std::vector<std::string_view> &theirs,
+                const MergeOptions &options,
+                typename Policy::sink_type &sink,
+                bool analyze_conflicts_now) {
+  // diff3: align the base→ours and base→theirs edit scripts. Regions where
+  // neither side changed are stable and copied from ours (equal to base,
+  // or equivalent under options.compare); regions where the hunks of the
+  // two scripts overlap are resolved or reported together. Lines all three
+  // share at both ends are stable without being diffed, so only the middle
+  // is interned into one table and diffed on IDs.
+  using Comparator = typename Policy::comparator_type;
+  using Analysis = typename Policy::analysis_type;
+  const Comparator comparator(options.compare);
+  const ConflictMarkers markers(options);
+  CommonEnds ends = common_ends(base, ours, theirs, comparator);
+  if (options.detect_moves) {
+    // Moved blocks are found with their insertions slid down (see
+    // find_moves), which may reach into the common suffix
+    ends.suffix = 0;
+  }
+  LineTable table(base.size() + ours.size() + theirs.size() -
+                      3 * (ends.prefix + ends.suffix),
+                  comparator.options());
+  const DiffedLines base_lines = intern_diffed(table, base, ends, comparator);
+  const DiffedLines our_lines = intern_diffed(table, ours, ends, comparator);
+  const DiffedLines their_lines =
+      intern_diffed(table, theirs, ends, comparator);
+  const auto &base_ids = base_lines.ids;
+  const auto &our_ids = our_lines.ids;
+  const auto &their_ids = their_lines.ids;
+
+  // AUTO picks by the size of the whole files, as without the trimming
+  const DiffAlgorithm algorithm = Policy::diff_type::algorithm(options);
+  DiffAlgorithm our_algorithm =
+      resolve_algorithm(algorithm, base.size(), ours.size());
+  DiffAlgorithm their_algorithm =
+      resolve_algorithm(algorithm, base.size(), theirs.size());
+
+  // Parallel mode: a pool of our own is only started once there is enough
+  // work, and never when the caller supplies one
+  std::optional<ThreadPool> own_pool;
+  ThreadPool *pool = nullptr;
+  bool parallel = options.threads != 1 &&
+                  (options.pool ? options.pool->size()
+                                : resolve_thread_count(options.threads)) > 1;
+  auto start_pool = [&]() {
+    if (!pool) {
+      pool = options.pool ? options.pool : &own_pool.emplace(options.threads);
+    }
+  };
+
+  std::vector<DiffHunk> our_hunks;
+  std::vector<DiffHunk> their_hunks;
+  if (parallel &&
+      std::max({base_ids.size(), our_ids.size(), their_ids.size()}) >=
+          PARALLEL_PARTITION_LINES) {
+    start_pool();
+    partitioned_diff(base_ids, our_ids, their_ids, table.size(),
+                     our_algorithm, their_algorithm,
+                     options.diff_memory_budget, *pool, our_hunks,
+                     their_hunks);
+  } else {
+    our_hunks = compute_diff(base_ids, our_ids, our_algorithm,
+                             options.diff_memory_budget);
+    their_hunks = compute_diff(base_ids, their_ids, their_algorithm,
+                               options.diff_memory_budget);
+  }
 
-  // Simple line-by-line comparison for initial implementation
-  // This is a placeholder - full algorithm will use dependency analysis
+  // Analysis of the conflicts written from here on, on the pool if there
+  // is work for it; compiled out when the policy disables it
+  const size_t first_conflict = sink.conflicts().size();
+  auto analyze = [&]() {
+    if constexpr (Analysis::enabled) {
+      AnalysisLevel level = Analysis::level(options);
+      if (!analyze_conflicts_now || level == AnalysisLevel::NONE) {
+        return;
+      }
+      if (parallel && sink.conflicts().size() - first_conflict > 1) {
+        start_pool();
+      }
+      analyze_conflicts(sink.conflicts(), first_conflict, base, ours, theirs,
+                        level, pool);
+    }
+  };
 
-  size_t max_len = std::max({base.size(), ours.size(), theirs.size()});
+  if (options.detect_moves) {
+    CarriedMoves carried;
+    if (carry_moves(base, ours, theirs, base_lines, our_lines, their_lines,
+                    our_hunks, their_hunks, carried)) {
+      MergeOptions rewritten_options = options;
+      rewritten_options.detect_moves = false;
+      merge_impl<Policy>(base, carried.ours, carried.theirs,
+                         rewritten_options, sink, false);
+      auto &conflicts = sink.conflicts();
+      for (size_t i = first_conflict; i < conflicts.size(); ++i) {
+        map_range(conflicts[i].our_range, carried.our_substitutions);
+        map_range(conflicts[i].their_range, carried.their_substitutions);
+      }
+      analyze();
+      return;
+    }
+  }
 
-  for (size_t i = 0; i < max_len; ++i) {
-    std::string base_line = (i < base.size()) ? base[i] : "";
-    std::string our_line = (i < ours.size()) ? ours[i] : "";
-    std::string their_line = (i < theirs.size()) ? theirs[i] : "";
+  auto regions = diff3_regions(our_ids, their_ids, our_hunks, their_hunks);
+  merge_close_conflicts(regions);
 
-    // Case 1: All three are the same - use as-is
-    if (base_line == our_line && base_line == their_line) {
-      result.merged_lines.push_back({base_line, Line::BASE});
+  // Compares lines of ours and theirs within a conflict
+  auto same_at = [&](size_t our_line, size_t their_line) {
+    if (comparator.ignores_blank_lines()) {
+      return comparator.equal(ours[our_line], theirs[their_line]);
     }
-    // Case 2: Base == Ours, but Theirs changed - use theirs
-    else if (base_line == our_line && base_line != their_line) {
-      result.merged_lines.push_back({their_line, Line::THEIRS});
+    return our_ids[our_line - our_lines.offset] ==
+           their_ids[their_line - their_lines.offset];
+  };
+
+  size_t our_pos = 0;
+  for (const auto &region : regions) {
+    Span base_span = base_lines.to_lines(region.base_begin, region.base_end);
+    Span our_span = our_lines.to_lines(region.ours_begin, region.ours_end);
+    Span their_span =
+        their_lines.to_lines(region.theirs_begin, region.theirs_end);
+
+    // Stable lines before the region
+    write_span(sink, ours, {our_pos, our_span.begin}, Line::BASE);
+    our_pos = our_span.end;
+
+    if (region.kind == Diff3Region::OURS) {
+      // Only ours changed - use ours
+      write_span(sink, ours, our_span, Line::OURS);
+      continue;
     }
-    // Case 3: Base == Theirs, but Ours changed - use ours
-    else if (base_line == their_line && base_line != our_line) {
-      result.merged_lines.push_back({our_line, Line::OURS});
+    if (region.kind == Diff3Region::THEIRS) {
+      // Only theirs changed - use theirs
+      write_span(sink, theirs, their_span, Line::THEIRS);
+      continue;
     }
-    // Case 4: Ours == Theirs, but different from Base - use the common change
-    else if (our_line == their_line && our_line != base_line) {
-      result.merged_lines.push_back({our_line, Line::MERGED});
+    if (region.kind == Diff3Region::SAME) {
+      // Both sides made the same change - use the common change
+      write_span(sink, ours, our_span, Line::MERGED);
+      continue;
     }
-    // Case 5: All different - conflict
-    else {
-      Conflict conflict;
-      conflict.start_line = result.merged_lines.size();
-      conflict.base_lines.push_back({base_line, Line::BASE});
-      conflict.our_lines.push_back({our_line, Line::OURS});
-      conflict.their_lines.push_back({their_line, Line::THEIRS});
-      conflict.end_line = result.merged_lines.size();
 
-      // Perform context analysis using ours version as context
-      // (could also use base or theirs, but ours is typically most relevant)
-      conflict.context = analysis::analyze_context(ours, i, i);
+    // Both sides changed the region differently - conflict. Lines both
+    // sides agree on at its edges stay outside the markers.
+    size_t prefix = 0;
+    size_t suffix = 0;
+    if (!options.show_base) {
+      size_t common = std::min(our_span.end - our_span.begin,
+                               their_span.end - their_span.begin);
+      while (prefix < common && same_at(our_span.begin + prefix,
+                                        their_span.begin + prefix)) {
+        ++prefix;
+      }
+      while (suffix < common - prefix &&
+             same_at(our_span.end - 1 - suffix,
+                     their_span.end - 1 - suffix)) {
+        ++suffix;
+      }
+    }
+    write_span(sink, ours, {our_span.begin, our_span.begin + prefix},
+               Line::MERGED);
+    Span common_suffix{our_span.end - suffix, our_span.end};
+    our_span = {our_span.begin + prefix, our_span.end - suffix};
+    their_span = {their_span.begin + prefix, their_span.end - suffix};
 
-      // Perform risk analysis for different resolution strategies
-      std::vector<std::string> base_vec = {base_line};
-      std::vector<std::string> ours_vec = {our_line};
-      std::vector<std::string> theirs_vec = {their_line};
+    // The rest conflicts unless the edits turn out not to overlap token
+    // by token
+    Refinement refinement;
+    if (options.refine_conflicts) {
+      refinement = refine_conflict(slice(base, base_span),
+                                   slice(ours, our_span),
+                                   slice(theirs, their_span));
+      if (refinement.resolved) {
+        for (const auto &line : refinement.merged_lines) {
+          sink.write_line(line, Line::MERGED);
+        }
+        write_span(sink, ours, common_suffix, Line::MERGED);
+        continue;
+      }
+    }
 
-      conflict.risk_ours =
-          analysis::analyze_risk_ours(base_vec, ours_vec, theirs_vec);
-      conflict.risk_theirs =
-          analysis::analyze_risk_theirs(base_vec, ours_vec, theirs_vec);
-      conflict.risk_both =
-          analysis::analyze_risk_both(base_vec, ours_vec, theirs_vec);
+    Conflict conflict(sink.allocator());
+    conflict.start_line = sink.line_count();
+    append_lines(conflict.base_lines, base, base_span, Line::BASE);
+    append_lines(conflict.our_lines, ours, our_span, Line::OURS);
+    append_lines(conflict.their_lines, theirs, their_span, Line::THEIRS);
+    conflict.our_changes.assign(refinement.our_changes.begin(),
+                                refinement.our_changes.end());
+    conflict.their_changes.assign(refinement.their_changes.begin(),
+                                  refinement.their_changes.end());
 
-      result.conflicts.push_back(conflict);
+    // Analyzed once all conflicts are known
+    conflict.base_range = {base_span.begin, base_span.end};
+    conflict.our_range = {our_span.begin, our_span.end};
+    conflict.their_range = {their_span.begin, their_span.end};
 
-      // Add conflict markers
-      result.merged_lines.push_back({"<<<<<<< OURS", Line::MERGED});
-      result.merged_lines.push_back({our_line, Line::OURS});
-      result.merged_lines.push_back({"=======", Line::MERGED});
-      result.merged_lines.push_back({their_line, Line::THEIRS});
-      result.merged_lines.push_back({">>>>>>> THEIRS", Line::MERGED});
+    // Add conflict markers
+    sink.write_line(markers.ours, Line::MERGED);
+    write_span(sink, ours, our_span, Line::OURS);
+    if (options.show_base) {
+      sink.write_line(markers.base, Line::MERGED);
+      write_span(sink, base, base_span, Line::BASE);
     }
+    sink.write_line("=======", Line::MERGED);
+    write_span(sink, theirs, their_span, Line::THEIRS);
+    sink.write_line(markers.theirs, Line::MERGED);
+
+    conflict.end_line = sink.line_count() - 1;
+    sink.conflicts().push_back(std::move(conflict));
+    write_span(sink, ours, common_suffix, Line::MERGED);
   }
 
+  // Stable lines after the last region
+  write_span(sink, ours, {our_pos, ours.size()}, Line::BASE);
+
+  analyze();
+}
+
+} // namespace
+
+template <typename Policy>
+void merge_with_policy(const std::vector<std::string_view> &base,
+                       const std::vector<std::string_view> &ours,
+                       const std::vector<std::string_view> &theirs,
+                       const MergeOptions &options,
+                       typename Policy::sink_type &sink) {
+  merge_impl<Policy>(base, ours, theirs, options, sink, true);
+  sink.finish();
+}
+
+template void merge_with_policy<ExactMergePolicy>(
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &, const MergeOptions &,
+    ResultSink &);
+template void merge_with_policy<EquivalentMergePolicy>(
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &, const MergeOptions &,
+    ResultSink &);
+template void merge_with_policy<TextMergePolicy>(
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &, const MergeOptions &,
+    ResultSink &);
+template void merge_with_policy<ExactStreamPolicy>(
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &, const MergeOptions &,
+    StreamSink &);
+template void merge_with_policy<EquivalentStreamPolicy>(
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &, const MergeOptions &,
+    StreamSink &);
+template void merge_with_policy<TextStreamPolicy>(
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &,
+    const std::vector<std::string_view> &, const MergeOptions &,
+    StreamSink &);
+
+MergeResult three_way_merge(const std::vector<std::string> &base,
+                            const std::vector<std::string> &ours,
+                            const std::vector<std::string> &theirs,
+                            const MergeOptions &options,
+                            const MergeResult::allocator_type &alloc) {
+  return three_way_merge(text::to_line_views(base), text::to_line_views(ours),
+                         text::to_line_views(theirs), options, alloc);
+}
+
+MergeResult three_way_merge(const std::vector<std::string_view> &base,
+                            const std::vector<std::string_view> &ours,
+                            const std::vector<std::string_view> &theirs,
+                            const MergeOptions &options,
+                            const MergeResult::allocator_type &alloc) {
+  MergeResult result(alloc);
+  ResultSink sink(result);
+  if (is_text_merge(options)) {
+    merge_with_policy<TextMergePolicy>(base, ours, theirs, options, sink);
+  } else if (options.compare.exact() && !options.compare.ignore_blank_lines) {
+    merge_with_policy<ExactMergePolicy>(base, ours, theirs, options, sink);
+  } else {
+    merge_with_policy<EquivalentMergePolicy>(base, ours, theirs, options,
+                                             sink);
+  }
   return result;
 }
 
+void analyze_conflict(Conflict &conflict,
+                      const std::vector<std::string> &base,
+                      const std::vector<std::string> &ours,
+                      const std::vector<std::string> &theirs,
+                      AnalysisLevel level) {
+  analyze_conflict_impl(conflict, base, ours, theirs, level);
+}
+
+void analyze_conflict(Conflict &conflict,
+                      const std::vector<std::string_view> &base,
+                      const std::vector<std::string_view> &ours,
+                      const std::vector<std::string_view> &theirs,
+                      AnalysisLevel level) {
+  analyze_conflict_impl(conflict, base, ours, theirs, level);
+}
+
+std::string analysis_level_to_string(AnalysisLevel level) {
+  switch (level) {
+  case AnalysisLevel::NONE:
+    return "none";
+  case AnalysisLevel::CONTEXT:
+    return "context";
+  case AnalysisLevel::FULL:
+  default:
+    return "full";
+  }
+}
+
+bool parse_analysis_level(const std::string &name, AnalysisLevel &level) {
+  if (name == "none") {
+    level = AnalysisLevel::NONE;
+  } else if (name == "context") {
+    level = AnalysisLevel::CONTEXT;
+  } else if (name == "full") {
+    level = AnalysisLevel::FULL;
+  } else {
+    return false;
+  }
+  return true;
+}
+
 MergeResult auto_resolve(const MergeResult &result) {
-  MergeResult resolved = result;
+  // Stay in the caller's memory resource instead of copying to the heap
+  MergeResult resolved(result.get_allocator());
+  resolved.merged_lines = result.merged_lines;
 
   // Auto-resolve whitespace-only differences
-  std::vector<Conflict> remaining_conflicts;
-
   for (const auto &conflict : result.conflicts) {
     bool can_resolve = false;
 
@@ -112,8 +892,9 @@ MergeResult auto_resolve(const MergeResult &result) {
     if (conflict.our_lines.size() == conflict.their_lines.size()) {
       can_resolve = true;
       for (size_t i = 0; i < conflict.our_lines.size(); ++i) {
-        if (!lines_equal_ignore_whitespace(conflict.our_lines[i].content,
-                                           conflict.their_lines[i].content)) {
+        if (!text::equal_ignore_surrounding_whitespace(
+                conflict.our_lines[i].content,
+                conflict.their_lines[i].content)) {
           can_resolve = false;
           break;
         }
@@ -121,11 +902,10 @@ MergeResult auto_resolve(const MergeResult &result) {
     }
 
     if (!can_resolve) {
-      remaining_conflicts.push_back(conflict);
+      resolved.conflicts.push_back(conflict);
     }
   }
 
-  resolved.conflicts = remaining_conflicts;
   return resolved;
 }
 
@@ -0,0 +1,295 @@
+/**
+ * @file normalize.cpp
+ * @brief Implementation of encoding and line-ending normalization
+ */
+
+#include "wizardmerge/text/normalize.h"
+#include "wizardmerge/text/text_kernels.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace wizardmerge {
+namespace text {
+
+namespace {
+
+constexpr std::string_view UTF8_BOM = "\xEF\xBB\xBF";
+constexpr std::string_view UTF16LE_BOM = "\xFF\xFE";
+constexpr std::string_view UTF16BE_BOM = "\xFE\xFF";
+
+bool starts_with(std::string_view data, std::string_view prefix) {
+  return data.substr(0, prefix.size()) == prefix;
+}
+
+/**
+ * @brief Detects the encoding from the BOM or, without one, from the NUL
+ *        bytes of the first BINARY_SCAN_BYTES.
+ *
+ * UTF-16 text that is mostly ASCII has a NUL in every other byte; text
+ * with NULs in both positions is left to fail UTF-8 validation.
+ */
+TextEncoding detect_encoding(std::string_view data, bool &bom) {
+  bom = true;
+  if (starts_with(data, UTF8_BOM)) {
+    return TextEncoding::UTF8;
+  }
+  if (starts_with(data, UTF16LE_BOM)) {
+    return TextEncoding::UTF16LE;
+  }
+  if (starts_with(data, UTF16BE_BOM)) {
+    return TextEncoding::UTF16BE;
+  }
+  bom = false;
+
+  size_t n = std::min(data.size(), BINARY_SCAN_BYTES) & ~size_t(1);
+  if (data.size() % 2 != 0 || find_byte(data.substr(0, n), '\0') == n) {
+    return TextEncoding::UTF8;
+  }
+  size_t even = 0;
+  size_t odd = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (data[i] == '\0') {
+      ++(i % 2 == 0 ? even : odd);
+    }
+  }
+  size_t units = n / 2;
+  if (even == 0 && 2 * odd >= units) {
+    return TextEncoding::UTF16LE;
+  }
+  if (odd == 0 && 2 * even >= units) {
+    return TextEncoding::UTF16BE;
+  }
+  return TextEncoding::UTF8;
+}
+
+/**
+ * @brief Ending of the first line of UTF-8 text (LF if there is none).
+ */
+LineEnding first_line_ending(std::string_view data, size_t from) {
+  size_t newline = find_byte(data, '\n', from);
+  return newline < data.size() && newline > from && data[newline - 1] == '\r'
+             ? LineEnding::CRLF
+             : LineEnding::LF;
+}
+
+bool normalize_utf8(std::string_view data, size_t start, std::string &out,
+                    TextFormat &format) {
+  format.line_ending = first_line_ending(data, start);
+  format.converted = start > 0;
+
+  // Text before `flushed` is in out once anything had to be dropped
+  size_t flushed = start;
+  size_t pos = start;
+  while (true) {
+    size_t i = skip_plain_ascii(data, pos);
+    if (i == data.size()) {
+      break;
+    }
+    if (data[i] == '\r') {
+      if (i + 1 < data.size() && data[i + 1] == '\n') {
+        if (flushed == start) {
+          out.reserve(data.size() - start);
+        }
+        format.converted = true;
+        out.append(data, flushed, i - flushed);
+        flushed = i + 1;
+      }
+      pos = i + 1;
+      continue;
+    }
+    size_t length = utf8_sequence_length(data, i);
+    if (length == 0) {
+      return false;
+    }
+    pos = i + length;
+  }
+
+  if (format.converted) {
+    out.append(data, flushed, data.size() - flushed);
+  }
+  return true;
+}
+
+void append_utf8(std::string &out, uint32_t cp) {
+  if (cp < 0x80) {
+    out.push_back(static_cast<char>(cp));
+  } else if (cp < 0x800) {
+    out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x10000) {
+    out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else {
+    out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  }
+}
+
+bool normalize_utf16(std::string_view data, size_t start, std::string &out,
+                     TextFormat &format) {
+  if ((data.size() - start) % 2 != 0) {
+    return false;
+  }
+  const bool big_endian = format.encoding == TextEncoding::UTF16BE;
+  auto unit = [&](size_t i) -> uint32_t {
+    uint32_t first = static_cast<unsigned char>(data[i]);
+    uint32_t second = static_cast<unsigned char>(data[i + 1]);
+    return big_endian ? (first << 8) | second : (second << 8) | first;
+  };
+
+  format.converted = true;
+  out.reserve((data.size() - start) / 2);
+  bool seen_newline = false;
+  for (size_t i = start; i < data.size(); i += 2) {
+    uint32_t cp = unit(i);
+    if (cp == 0) {
+      return false;
+    }
+    if (cp == '\r' && i + 2 < data.size() && unit(i + 2) == '\n') {
+      if (!seen_newline) {
+        format.line_ending = LineEnding::CRLF;
+      }
+      continue;
+    }
+    if (cp == '\n') {
+      seen_newline = true;
+    } else if (cp >= 0xD800 && cp <= 0xDBFF) {
+      uint32_t low = i + 2 < data.size() ? unit(i + 2) : 0;
+      if (low < 0xDC00 || low > 0xDFFF) {
+        return false; // Unpaired high surrogate
+      }
+      cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+      i += 2;
+    } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+      return false; // Unpaired low surrogate
+    }
+    append_utf8(out, cp);
+  }
+  return true;
+}
+
+/**
+ * @brief Decodes a well-formed UTF-8 sequence.
+ */
+uint32_t decode_utf8(std::string_view text, size_t pos, size_t length) {
+  static constexpr unsigned char LEAD_MASK[] = {0, 0x7F, 0x1F, 0x0F, 0x07};
+  uint32_t cp = static_cast<unsigned char>(text[pos]) & LEAD_MASK[length];
+  for (size_t i = 1; i < length; ++i) {
+    cp = (cp << 6) | (static_cast<unsigned char>(text[pos + i]) & 0x3F);
+  }
+  return cp;
+}
+
+} // namespace
+
+bool normalize_text(std::string_view data, std::string &out,
+                    TextFormat &format) {
+  out.clear();
+  format = TextFormat();
+  format.encoding = detect_encoding(data, format.bom);
+  if (format.encoding == TextEncoding::UTF8) {
+    return normalize_utf8(data, format.bom ? UTF8_BOM.size() : 0, out,
+                          format);
+  }
+  return normalize_utf16(data, format.bom ? UTF16LE_BOM.size() : 0, out,
+                         format);
+}
+
+void normalize_lines(std::vector<std::string_view> &lines,
+                     TextFormat &format) {
+  format = TextFormat();
+  if (!lines.empty() && starts_with(lines[0], UTF8_BOM)) {
+    lines[0].remove_prefix(UTF8_BOM.size());
+    format.bom = true;
+    format.converted = true;
+  }
+  for (size_t i = 0; i < lines.size(); ++i) {
+    std::string_view &line = lines[i];
+    if (line.empty() || line.back() != '\r') {
+      continue;
+    }
+    line.remove_suffix(1);
+    if (i == 0) {
+      format.line_ending = LineEnding::CRLF;
+    }
+    format.converted = true;
+  }
+}
+
+void restore_text(std::string_view text, const TextFormat &format,
+                  std::string &out) {
+  out.clear();
+  const bool crlf = format.line_ending == LineEnding::CRLF;
+  if (format.encoding == TextEncoding::UTF8) {
+    if (format.bom) {
+      out.append(UTF8_BOM);
+    }
+    if (!crlf) {
+      out.append(text);
+      return;
+    }
+    out.reserve(out.size() + text.size() + text.size() / 32);
+    size_t pos = 0;
+    while (pos < text.size()) {
+      size_t newline = find_byte(text, '\n', pos);
+      out.append(text, pos, newline - pos);
+      if (newline == text.size()) {
+        break;
+      }
+      out.append("\r\n");
+      pos = newline + 1;
+    }
+    return;
+  }
+
+  const bool big_endian = format.encoding == TextEncoding::UTF16BE;
+  auto put = [&](uint32_t unit) {
+    char high = static_cast<char>(unit >> 8);
+    char low = static_cast<char>(unit & 0xFF);
+    out.push_back(big_endian ? high : low);
+    out.push_back(big_endian ? low : high);
+  };
+  out.reserve(2 * text.size() + 2);
+  if (format.bom) {
+    put(0xFEFF);
+  }
+  for (size_t i = 0; i < text.size();) {
+    size_t length = text[i] == '\0' ? 1 : utf8_sequence_length(text, i);
+    uint32_t cp = 0xFFFD;
+    if (length == 0) {
+      length = 1;
+    } else {
+      cp = decode_utf8(text, i, length);
+    }
+    i += length;
+
+    if (cp == '\n' && crlf) {
+      put('\r');
+    }
+    if (cp >= 0x10000) {
+      put(0xD800 + ((cp - 0x10000) >> 10));
+      put(0xDC00 + ((cp - 0x10000) & 0x3FF));
+    } else {
+      put(cp);
+    }
+  }
+}
+
+const char *text_encoding_to_string(TextEncoding encoding) {
+  switch (encoding) {
+  case TextEncoding::UTF8:
+    return "utf-8";
+  case TextEncoding::UTF16LE:
+    return "utf-16le";
+  case TextEncoding::UTF16BE:
+    return "utf-16be";
+  default:
+    return "unknown";
+  }
+}
+
+} // namespace text
+} // namespace wizardmerge
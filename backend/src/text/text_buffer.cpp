@@ -0,0 +1,168 @@
+/**
+ * @file text_buffer.cpp
+ * @brief Implementation of the zero-copy file representation
+ */
+
+#include "wizardmerge/text/text_buffer.h"
+#include "wizardmerge/text/text_kernels.h"
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define WIZARDMERGE_HAVE_MMAP 1
+#endif
+
+namespace wizardmerge {
+namespace text {
+
+TextBuffer::TextBuffer()
+    : data_(nullptr), size_(0), mapping_(nullptr) {}
+
+TextBuffer::~TextBuffer() { release(); }
+
+TextBuffer::TextBuffer(TextBuffer &&other) noexcept
+    : data_(nullptr), size_(0), mapping_(nullptr) {
+  *this = std::move(other);
+}
+
+TextBuffer &TextBuffer::operator=(TextBuffer &&other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+  release();
+
+  bool owned = other.mapping_ == nullptr && other.data_ != nullptr;
+  owned_ = std::move(other.owned_);
+  // A moved std::string may relocate small-string storage, so owned
+  // content is re-pointed rather than copied over
+  data_ = owned ? owned_.data() : other.data_;
+  size_ = other.size_;
+  mapping_ = other.mapping_;
+  offsets_ = std::move(other.offsets_);
+
+  other.data_ = nullptr;
+  other.size_ = 0;
+  other.mapping_ = nullptr;
+  other.offsets_.clear();
+  return *this;
+}
+
+void TextBuffer::release() {
+#ifdef WIZARDMERGE_HAVE_MMAP
+  if (mapping_ != nullptr) {
+    munmap(mapping_, size_);
+  }
+#endif
+  mapping_ = nullptr;
+  data_ = nullptr;
+  size_ = 0;
+  owned_.clear();
+  offsets_.clear();
+}
+
+std::optional<TextBuffer> TextBuffer::from_file(const std::string &path) {
+#ifdef WIZARDMERGE_HAVE_MMAP
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return std::nullopt;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return std::nullopt;
+  }
+
+  // Empty files cannot be mapped; they are simply an empty buffer
+  if (st.st_size == 0) {
+    close(fd);
+    return from_string(std::string());
+  }
+
+  size_t size = static_cast<size_t>(st.st_size);
+  void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return std::nullopt;
+  }
+  madvise(mapping, size, MADV_SEQUENTIAL);
+
+  TextBuffer buffer;
+  buffer.mapping_ = mapping;
+  buffer.data_ = static_cast<const char *>(mapping);
+  buffer.size_ = size;
+  buffer.index_lines();
+  return buffer;
+#else
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+  std::string content((std::istreambuf_iterator<char>(file)),
+                      std::istreambuf_iterator<char>());
+  return from_string(std::move(content));
+#endif
+}
+
+TextBuffer TextBuffer::from_string(std::string content) {
+  TextBuffer buffer;
+  buffer.owned_ = std::move(content);
+  buffer.data_ = buffer.owned_.data();
+  buffer.size_ = buffer.owned_.size();
+  buffer.index_lines();
+  return buffer;
+}
+
+bool TextBuffer::normalize(TextFormat &format) {
+  std::string normalized;
+  if (!normalize_text(data(), normalized, format)) {
+    return false;
+  }
+  if (format.converted) {
+    *this = from_string(std::move(normalized));
+  }
+  return true;
+}
+
+void TextBuffer::index_lines() {
+  offsets_.clear();
+  std::string_view content = data();
+  if (content.empty()) {
+    return;
+  }
+
+  // Lines average well over 8 bytes; this avoids most regrowth
+  offsets_.reserve(content.size() / 32 + 2);
+  offsets_.push_back(0);
+  size_t pos = 0;
+  while (pos < content.size()) {
+    size_t nl = find_byte(content, '\n', pos);
+    pos = nl + 1;
+    offsets_.push_back(pos);
+  }
+  // Without a trailing newline the sentinel sits one past the end, as if
+  // the newline were there, so line() can always drop one byte
+}
+
+std::vector<std::string_view> TextBuffer::lines() const {
+  std::vector<std::string_view> result;
+  size_t count = line_count();
+  result.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    result.push_back(line(i));
+  }
+  return result;
+}
+
+std::vector<std::string_view>
+to_line_views(const std::vector<std::string> &lines) {
+  return std::vector<std::string_view>(lines.begin(), lines.end());
+}
+
+} // namespace text
+} // namespace wizardmerge
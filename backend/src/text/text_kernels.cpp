@@ -0,0 +1,830 @@
+/**
+ * @file text_kernels.cpp
+ * @brief Implementation of the vectorized text kernels
+ */
+
+#include "wizardmerge/text/text_kernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define WIZARDMERGE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace wizardmerge {
+namespace text {
+
+namespace {
+
+constexpr uint64_t SECRET0 = 0xa0761d6478bd642fULL;
+constexpr uint64_t SECRET1 = 0xe7037ed1a0b428dbULL;
+constexpr uint64_t SECRET2 = 0x8ebc6af09c88c6e3ULL;
+constexpr uint64_t SECRET3 = 0x589965cc75374cc3ULL;
+constexpr uint64_t PRIME32 = 0x9E3779B1ULL;
+
+// Per-lane keys for the long-input stripe accumulator
+alignas(32) constexpr uint64_t STRIPE_KEY[4] = {
+    0xbe4ba423396cfeb8ULL, 0x1cad21f72c81017cULL, 0xdb979083e96dd4deULL,
+    0x1f67b3b7a4a44072ULL};
+
+// Stripes accumulated between two scrambles of the accumulators
+constexpr size_t STRIPES_PER_BLOCK = 16;
+constexpr size_t STRIPE_SIZE = 32;
+
+// Inputs longer than this use the stripe accumulator
+constexpr size_t SHORT_HASH_LIMIT = 128;
+
+/**
+ * @brief 64x64→128-bit multiply folded back to 64 bits.
+ */
+inline uint64_t mix(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t product = static_cast<__uint128_t>(a) * b;
+  return static_cast<uint64_t>(product) ^
+         static_cast<uint64_t>(product >> 64);
+#else
+  uint64_t a_lo = a & 0xffffffffULL, a_hi = a >> 32;
+  uint64_t b_lo = b & 0xffffffffULL, b_hi = b >> 32;
+  uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo;
+  uint64_t lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+  uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffffULL) + lo_hi;
+  uint64_t lo = (cross << 32) | (lo_lo & 0xffffffffULL);
+  uint64_t hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+  return lo ^ hi;
+#endif
+}
+
+inline uint64_t read64(const char *p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t read32(const char *p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+/**
+ * @brief Multiply-mix hash for inputs up to a few dozen bytes.
+ */
+uint64_t hash_short(const char *p, size_t len) {
+  uint64_t seed = mix(SECRET0, SECRET1);
+  uint64_t a;
+  uint64_t b;
+
+  if (len <= 16) {
+    if (len >= 4) {
+      size_t mid = (len >> 3) << 2;
+      a = (read32(p) << 32) | read32(p + mid);
+      b = (read32(p + len - 4) << 32) | read32(p + len - 4 - mid);
+    } else if (len > 0) {
+      a = (static_cast<uint64_t>(static_cast<unsigned char>(p[0])) << 16) |
+          (static_cast<uint64_t>(static_cast<unsigned char>(p[len >> 1]))
+           << 8) |
+          static_cast<unsigned char>(p[len - 1]);
+      b = 0;
+    } else {
+      a = 0;
+      b = 0;
+    }
+  } else {
+    size_t remaining = len;
+    if (remaining > 48) {
+      uint64_t lane1 = seed;
+      uint64_t lane2 = seed;
+      do {
+        seed = mix(read64(p) ^ SECRET1, read64(p + 8) ^ seed);
+        lane1 = mix(read64(p + 16) ^ SECRET2, read64(p + 24) ^ lane1);
+        lane2 = mix(read64(p + 32) ^ SECRET3, read64(p + 40) ^ lane2);
+        p += 48;
+        remaining -= 48;
+      } while (remaining > 48);
+      seed ^= lane1 ^ lane2;
+    }
+    while (remaining > 16) {
+      seed = mix(read64(p) ^ SECRET1, read64(p + 8) ^ seed);
+      p += 16;
+      remaining -= 16;
+    }
+    a = read64(p + remaining - 16);
+    b = read64(p + remaining - 8);
+  }
+
+  return mix(SECRET1 ^ len, mix(a ^ SECRET1, b ^ seed));
+}
+
+// ---------------------------------------------------------------------------
+// Scalar kernels
+// ---------------------------------------------------------------------------
+
+size_t find_byte_scalar(const char *p, size_t n, char byte) {
+  const void *hit = std::memchr(p, byte, n);
+  return hit ? static_cast<size_t>(static_cast<const char *>(hit) - p) : n;
+}
+
+/**
+ * @param line_start Whether p[0] starts a line (p[-1] is not read)
+ */
+size_t find_line_start_scalar(const char *p, size_t n, char byte,
+                              bool line_start) {
+  size_t i = 0;
+  while (i < n) {
+    i += find_byte_scalar(p + i, n - i, byte);
+    if (i == n || (i == 0 ? line_start : p[i - 1] == '\n')) {
+      return i;
+    }
+    ++i;
+  }
+  return n;
+}
+
+bool equal_scalar(const char *a, const char *b, size_t n) {
+  return n == 0 || std::memcmp(a, b, n) == 0;
+}
+
+/**
+ * @brief Whitespace-skipping comparison from positions i and j onwards.
+ */
+bool equal_ignore_ws_tail(const char *a, size_t na, size_t i, const char *b,
+                          size_t nb, size_t j) {
+  while (true) {
+    while (i < na && is_whitespace(a[i])) {
+      ++i;
+    }
+    while (j < nb && is_whitespace(b[j])) {
+      ++j;
+    }
+    if (i == na || j == nb) {
+      return i == na && j == nb;
+    }
+    if (a[i] != b[j]) {
+      return false;
+    }
+    ++i;
+    ++j;
+  }
+}
+
+bool equal_ignore_ws_scalar(const char *a, size_t na, const char *b,
+                            size_t nb) {
+  return equal_ignore_ws_tail(a, na, 0, b, nb, 0);
+}
+
+/**
+ * @brief Position of the first NUL or non-ASCII byte, or n if none.
+ */
+size_t skip_ascii_scalar(const char *p, size_t n) {
+  constexpr uint64_t ONES = 0x0101010101010101ULL;
+  constexpr uint64_t HIGH = 0x8080808080808080ULL;
+  size_t i = 0;
+  // A word without a zero byte or a high bit is plain ASCII
+  for (; i + 8 <= n; i += 8) {
+    uint64_t v = read64(p + i);
+    if (((v | ((v - ONES) & ~v)) & HIGH) != 0) {
+      break;
+    }
+  }
+  for (; i < n; ++i) {
+    unsigned char c = static_cast<unsigned char>(p[i]);
+    if (c == 0 || c >= 0x80) {
+      return i;
+    }
+  }
+  return n;
+}
+
+/**
+ * @brief Position of the first NUL, carriage return or non-ASCII byte, or
+ *        n if none.
+ */
+size_t skip_plain_ascii_scalar(const char *p, size_t n) {
+  constexpr uint64_t ONES = 0x0101010101010101ULL;
+  constexpr uint64_t HIGH = 0x8080808080808080ULL;
+  constexpr uint64_t CRS = 0x0d0d0d0d0d0d0d0dULL;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t v = read64(p + i);
+    uint64_t cr = v ^ CRS;
+    if (((v | ((v - ONES) & ~v) | ((cr - ONES) & ~cr)) & HIGH) != 0) {
+      break;
+    }
+  }
+  for (; i < n; ++i) {
+    unsigned char c = static_cast<unsigned char>(p[i]);
+    if (c == 0 || c == '\r' || c >= 0x80) {
+      return i;
+    }
+  }
+  return n;
+}
+
+/**
+ * @brief Length of the UTF-8 sequence at bytes[i], checked within [i, n).
+ *
+ * @param truncated Set if the sequence is well-formed as far as it goes
+ *                  but cut off by n
+ * @return 1 to 4, or 0 for a NUL, a stray continuation, an invalid lead
+ *         byte or a malformed or truncated sequence
+ */
+size_t utf8_sequence(const unsigned char *bytes, size_t i, size_t n,
+                     bool &truncated) {
+  truncated = false;
+  // Sequence length and the valid range of its second byte
+  unsigned char lead = bytes[i];
+  size_t length = 0;
+  unsigned char low = 0x80;
+  unsigned char high = 0xBF;
+  if (lead != 0 && lead < 0x80) {
+    return 1;
+  } else if (lead >= 0xC2 && lead <= 0xDF) {
+    length = 2;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    length = 3;
+    low = lead == 0xE0 ? 0xA0 : 0x80; // Overlong
+    high = lead == 0xED ? 0x9F : 0xBF; // Surrogates
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    length = 4;
+    low = lead == 0xF0 ? 0x90 : 0x80; // Overlong
+    high = lead == 0xF4 ? 0x8F : 0xBF; // Past U+10FFFF
+  } else {
+    return 0; // NUL, stray continuation or invalid lead byte
+  }
+
+  for (size_t c = 1; c < length; ++c) {
+    if (i + c == n) {
+      truncated = true;
+      return 0;
+    }
+    unsigned char byte = bytes[i + c];
+    if (byte < (c == 1 ? low : 0x80) || byte > (c == 1 ? high : 0xBF)) {
+      return 0;
+    }
+  }
+  return length;
+}
+
+void accumulate_scalar(uint64_t *acc, const char *p, size_t stripes) {
+  for (size_t s = 0; s < stripes; ++s, p += STRIPE_SIZE) {
+    for (size_t lane = 0; lane < 4; ++lane) {
+      uint64_t data_key = read64(p + 8 * lane) ^ STRIPE_KEY[lane];
+      acc[lane] += (data_key & 0xffffffffULL) * (data_key >> 32);
+      acc[lane] += read64(p + 8 * (lane ^ 1));
+    }
+  }
+}
+
+#ifdef WIZARDMERGE_X86_KERNELS
+
+// ---------------------------------------------------------------------------
+// SSE4.2 kernels (16 bytes per step)
+// ---------------------------------------------------------------------------
+
+__attribute__((target("sse4.2"))) size_t find_byte_sse42(const char *p,
+                                                          size_t n,
+                                                          char byte) {
+  const __m128i needle = _mm_set1_epi8(byte);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+    unsigned mask =
+        static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+    if (mask != 0) {
+      return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+  }
+  return i + find_byte_scalar(p + i, n - i, byte);
+}
+
+__attribute__((target("sse4.2"))) size_t
+find_line_start_sse42(const char *p, size_t n, char byte, bool line_start) {
+  if (n == 0 || (line_start && p[0] == byte)) {
+    return 0;
+  }
+  const __m128i needle = _mm_set1_epi8(byte);
+  const __m128i newline = _mm_set1_epi8('\n');
+  size_t i = 1;
+  // Each byte is tested together with the byte before it
+  for (; i + 16 <= n; i += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+    __m128i prev =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i - 1));
+    unsigned mask =
+        static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle))) &
+        static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(prev, newline)));
+    if (mask != 0) {
+      return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+  }
+  return i + find_line_start_scalar(p + i, n - i, byte, p[i - 1] == '\n');
+}
+
+__attribute__((target("sse4.2"))) bool equal_sse42(const char *a,
+                                                   const char *b, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xffff) {
+      return false;
+    }
+  }
+  return equal_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("sse4.2"))) inline unsigned
+whitespace_mask_sse42(__m128i chunk) {
+  // PCMPESTRM matches every byte against the whitespace set at once
+  const __m128i set = _mm_setr_epi8(' ', '\t', '\n', '\r', 0, 0, 0, 0, 0, 0,
+                                    0, 0, 0, 0, 0, 0);
+  __m128i mask = _mm_cmpestrm(set, 4, chunk, 16,
+                              _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY |
+                                  _SIDD_BIT_MASK);
+  return static_cast<unsigned>(_mm_cvtsi128_si32(mask)) & 0xffffu;
+}
+
+__attribute__((target("sse4.2"))) bool
+equal_ignore_ws_sse42(const char *a, size_t na, const char *b, size_t nb) {
+  size_t i = 0;
+  size_t j = 0;
+  while (i + 16 <= na && j + 16 <= nb) {
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + j));
+    unsigned ws_a = whitespace_mask_sse42(va);
+    unsigned ws_b = whitespace_mask_sse42(vb);
+    unsigned diff =
+        ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) &
+        0xffffu;
+    if ((ws_a | ws_b) == 0) {
+      if (diff != 0) {
+        return false;
+      }
+      i += 16;
+      j += 16;
+      continue;
+    }
+    // Compare up to the first whitespace byte, then skip whitespace runs
+    unsigned first_ws = static_cast<unsigned>(__builtin_ctz(ws_a | ws_b));
+    if ((diff & ((1u << first_ws) - 1)) != 0) {
+      return false;
+    }
+    i += first_ws;
+    j += first_ws;
+    while (i < na && is_whitespace(a[i])) {
+      ++i;
+    }
+    while (j < nb && is_whitespace(b[j])) {
+      ++j;
+    }
+  }
+  return equal_ignore_ws_tail(a, na, i, b, nb, j);
+}
+
+__attribute__((target("sse4.2"))) size_t skip_ascii_sse42(const char *p,
+                                                           size_t n) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+    // High bits of the bytes themselves, plus the NUL bytes
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_or_si128(chunk, _mm_cmpeq_epi8(chunk, zero))));
+    if (mask != 0) {
+      return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+  }
+  return i + skip_ascii_scalar(p + i, n - i);
+}
+
+__attribute__((target("sse4.2"))) size_t
+skip_plain_ascii_sse42(const char *p, size_t n) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i cr = _mm_set1_epi8('\r');
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+    __m128i stops = _mm_or_si128(_mm_cmpeq_epi8(chunk, zero),
+                                 _mm_cmpeq_epi8(chunk, cr));
+    unsigned mask = static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_or_si128(chunk, stops)));
+    if (mask != 0) {
+      return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+  }
+  return i + skip_plain_ascii_scalar(p + i, n - i);
+}
+
+__attribute__((target("sse4.2"))) void
+accumulate_sse42(uint64_t *acc, const char *p, size_t stripes) {
+  __m128i acc_lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(acc));
+  __m128i acc_hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(acc + 2));
+  const __m128i key_lo =
+      _mm_load_si128(reinterpret_cast<const __m128i *>(STRIPE_KEY));
+  const __m128i key_hi =
+      _mm_load_si128(reinterpret_cast<const __m128i *>(STRIPE_KEY + 2));
+  for (size_t s = 0; s < stripes; ++s, p += STRIPE_SIZE) {
+    __m128i data_lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i data_hi =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16));
+    __m128i dk_lo = _mm_xor_si128(data_lo, key_lo);
+    __m128i dk_hi = _mm_xor_si128(data_hi, key_hi);
+    __m128i prod_lo = _mm_mul_epu32(dk_lo, _mm_srli_epi64(dk_lo, 32));
+    __m128i prod_hi = _mm_mul_epu32(dk_hi, _mm_srli_epi64(dk_hi, 32));
+    __m128i swap_lo = _mm_shuffle_epi32(data_lo, _MM_SHUFFLE(1, 0, 3, 2));
+    __m128i swap_hi = _mm_shuffle_epi32(data_hi, _MM_SHUFFLE(1, 0, 3, 2));
+    acc_lo = _mm_add_epi64(acc_lo, _mm_add_epi64(prod_lo, swap_lo));
+    acc_hi = _mm_add_epi64(acc_hi, _mm_add_epi64(prod_hi, swap_hi));
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(acc), acc_lo);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(acc + 2), acc_hi);
+}
+
+// ---------------------------------------------------------------------------
+// AVX2 kernels (32 bytes per step)
+// ---------------------------------------------------------------------------
+
+__attribute__((target("avx2"))) size_t find_byte_avx2(const char *p, size_t n,
+                                                       char byte) {
+  const __m256i needle = _mm256_set1_epi8(byte);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+    unsigned mask = static_cast<unsigned>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+    if (mask != 0) {
+      return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+  }
+  return i + find_byte_scalar(p + i, n - i, byte);
+}
+
+__attribute__((target("avx2"))) size_t
+find_line_start_avx2(const char *p, size_t n, char byte, bool line_start) {
+  if (n == 0 || (line_start && p[0] == byte)) {
+    return 0;
+  }
+  const __m256i needle = _mm256_set1_epi8(byte);
+  const __m256i newline = _mm256_set1_epi8('\n');
+  size_t i = 1;
+  for (; i + 32 <= n; i += 32) {
+    __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+    __m256i prev =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i - 1));
+    unsigned mask =
+        static_cast<unsigned>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle))) &
+        static_cast<unsigned>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(prev, newline)));
+    if (mask != 0) {
+      return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+  }
+  return i + find_line_start_scalar(p + i, n - i, byte, p[i - 1] == '\n');
+}
+
+__attribute__((target("avx2"))) bool equal_avx2(const char *a, const char *b,
+                                                size_t n) {
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+    if (static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(va, vb))) != 0xffffffffu) {
+      return false;
+    }
+  }
+  return equal_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2"))) inline unsigned
+whitespace_mask_avx2(__m256i chunk) {
+  __m256i ws = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+                      _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))),
+      _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')),
+                      _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r'))));
+  return static_cast<unsigned>(_mm256_movemask_epi8(ws));
+}
+
+__attribute__((target("avx2"))) bool
+equal_ignore_ws_avx2(const char *a, size_t na, const char *b, size_t nb) {
+  size_t i = 0;
+  size_t j = 0;
+  while (i + 32 <= na && j + 32 <= nb) {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + j));
+    unsigned ws_a = whitespace_mask_avx2(va);
+    unsigned ws_b = whitespace_mask_avx2(vb);
+    unsigned diff = ~static_cast<unsigned>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+    if ((ws_a | ws_b) == 0) {
+      if (diff != 0) {
+        return false;
+      }
+      i += 32;
+      j += 32;
+      continue;
+    }
+    unsigned first_ws = static_cast<unsigned>(__builtin_ctz(ws_a | ws_b));
+    if (first_ws > 0 && (diff << (32 - first_ws)) != 0) {
+      return false;
+    }
+    i += first_ws;
+    j += first_ws;
+    while (i < na && is_whitespace(a[i])) {
+      ++i;
+    }
+    while (j < nb && is_whitespace(b[j])) {
+      ++j;
+    }
+  }
+  return equal_ignore_ws_tail(a, na, i, b, nb, j);
+}
+
+__attribute__((target("avx2"))) size_t skip_ascii_avx2(const char *p,
+                                                        size_t n) {
+  const __m256i zero = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_or_si256(chunk, _mm256_cmpeq_epi8(chunk, zero))));
+    if (mask != 0) {
+      return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+  }
+  return i + skip_ascii_scalar(p + i, n - i);
+}
+
+__attribute__((target("avx2"))) size_t
+skip_plain_ascii_avx2(const char *p, size_t n) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i cr = _mm256_set1_epi8('\r');
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+    __m256i stops = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, zero),
+                                    _mm256_cmpeq_epi8(chunk, cr));
+    unsigned mask = static_cast<unsigned>(
+        _mm256_movemask_epi8(_mm256_or_si256(chunk, stops)));
+    if (mask != 0) {
+      return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+  }
+  return i + skip_plain_ascii_scalar(p + i, n - i);
+}
+
+__attribute__((target("avx2"))) void accumulate_avx2(uint64_t *acc,
+                                                     const char *p,
+                                                     size_t stripes) {
+  __m256i accumulator =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc));
+  const __m256i key =
+      _mm256_load_si256(reinterpret_cast<const __m256i *>(STRIPE_KEY));
+  for (size_t s = 0; s < stripes; ++s, p += STRIPE_SIZE) {
+    __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    __m256i data_key = _mm256_xor_si256(data, key);
+    __m256i product =
+        _mm256_mul_epu32(data_key, _mm256_srli_epi64(data_key, 32));
+    __m256i swapped = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+    accumulator =
+        _mm256_add_epi64(accumulator, _mm256_add_epi64(product, swapped));
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc), accumulator);
+}
+
+#endif // WIZARDMERGE_X86_KERNELS
+
+/**
+ * @brief Function table for one instruction set.
+ */
+struct Kernels {
+  SimdLevel level;
+  size_t (*find_byte)(const char *, size_t, char);
+  size_t (*find_line_start)(const char *, size_t, char, bool);
+  bool (*equal)(const char *, const char *, size_t);
+  bool (*equal_ignore_ws)(const char *, size_t, const char *, size_t);
+  void (*accumulate)(uint64_t *, const char *, size_t);
+  size_t (*skip_ascii)(const char *, size_t);
+  size_t (*skip_plain_ascii)(const char *, size_t);
+};
+
+constexpr Kernels SCALAR_KERNELS = {SimdLevel::SCALAR, find_byte_scalar,
+                                    find_line_start_scalar, equal_scalar,
+                                    equal_ignore_ws_scalar, accumulate_scalar,
+                                    skip_ascii_scalar,
+                                    skip_plain_ascii_scalar};
+
+#ifdef WIZARDMERGE_X86_KERNELS
+constexpr Kernels SSE42_KERNELS = {SimdLevel::SSE42, find_byte_sse42,
+                                   find_line_start_sse42, equal_sse42,
+                                   equal_ignore_ws_sse42, accumulate_sse42,
+                                   skip_ascii_sse42, skip_plain_ascii_sse42};
+
+constexpr Kernels AVX2_KERNELS = {SimdLevel::AVX2, find_byte_avx2,
+                                  find_line_start_avx2, equal_avx2,
+                                  equal_ignore_ws_avx2, accumulate_avx2,
+                                  skip_ascii_avx2, skip_plain_ascii_avx2};
+#endif
+
+const Kernels *kernels_for(SimdLevel level) {
+#ifdef WIZARDMERGE_X86_KERNELS
+  switch (level) {
+  case SimdLevel::AVX2:
+    return &AVX2_KERNELS;
+  case SimdLevel::SSE42:
+    return &SSE42_KERNELS;
+  default:
+    break;
+  }
+#else
+  (void)level;
+#endif
+  return &SCALAR_KERNELS;
+}
+
+std::atomic<const Kernels *> &active_kernels() {
+  static std::atomic<const Kernels *> active{kernels_for(detect_simd_level())};
+  return active;
+}
+
+inline const Kernels &kernels() {
+  return *active_kernels().load(std::memory_order_relaxed);
+}
+
+} // anonymous namespace
+
+SimdLevel detect_simd_level() {
+#ifdef WIZARDMERGE_X86_KERNELS
+  static const SimdLevel detected = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+      return SimdLevel::SSE42;
+    }
+    return SimdLevel::SCALAR;
+  }();
+  return detected;
+#else
+  return SimdLevel::SCALAR;
+#endif
+}
+
+SimdLevel active_simd_level() { return kernels().level; }
+
+SimdLevel set_simd_level(SimdLevel level) {
+  SimdLevel supported = detect_simd_level();
+  if (static_cast<int>(level) > static_cast<int>(supported)) {
+    level = supported;
+  }
+  active_kernels().store(kernels_for(level), std::memory_order_relaxed);
+  return level;
+}
+
+const char *simd_level_to_string(SimdLevel level) {
+  switch (level) {
+  case SimdLevel::SCALAR:
+    return "scalar";
+  case SimdLevel::SSE42:
+    return "sse4.2";
+  case SimdLevel::AVX2:
+    return "avx2";
+  default:
+    return "unknown";
+  }
+}
+
+size_t find_byte(std::string_view data, char byte, size_t from) {
+  if (from >= data.size()) {
+    return data.size();
+  }
+  return from +
+         kernels().find_byte(data.data() + from, data.size() - from, byte);
+}
+
+size_t find_line_start(std::string_view data, char byte, size_t from) {
+  if (from >= data.size()) {
+    return data.size();
+  }
+  bool line_start = from == 0 || data[from - 1] == '\n';
+  return from + kernels().find_line_start(data.data() + from,
+                                          data.size() - from, byte,
+                                          line_start);
+}
+
+std::vector<std::string_view> split_lines(std::string_view data) {
+  std::vector<std::string_view> lines;
+  const Kernels &k = kernels();
+  size_t pos = 0;
+  while (pos < data.size()) {
+    size_t end = pos + k.find_byte(data.data() + pos, data.size() - pos, '\n');
+    lines.push_back(data.substr(pos, end - pos));
+    pos = end + 1;
+  }
+  return lines;
+}
+
+uint64_t hash_bytes(std::string_view data) {
+  const size_t len = data.size();
+  if (len <= SHORT_HASH_LIMIT) {
+    return hash_short(data.data(), len);
+  }
+
+  const Kernels &k = kernels();
+  uint64_t acc[4] = {SECRET0, SECRET1, SECRET2, SECRET3};
+  const size_t stripes = len / STRIPE_SIZE;
+  for (size_t done = 0; done < stripes;) {
+    size_t block = std::min(STRIPES_PER_BLOCK, stripes - done);
+    k.accumulate(acc, data.data() + done * STRIPE_SIZE, block);
+    done += block;
+    // Scramble so high bits keep feeding back into the 32x32 products
+    for (uint64_t &lane : acc) {
+      lane ^= lane >> 47;
+      lane ^= SECRET3;
+      lane *= PRIME32;
+    }
+  }
+
+  size_t tail = stripes * STRIPE_SIZE;
+  uint64_t h = mix(acc[0] ^ SECRET1, acc[1] ^ (len * PRIME32));
+  h = mix(acc[2] ^ SECRET2, acc[3] ^ h);
+  return mix(h ^ hash_short(data.data() + tail, len - tail), SECRET3 ^ len);
+}
+
+bool bytes_equal(std::string_view a, std::string_view b) {
+  return a.size() == b.size() && kernels().equal(a.data(), b.data(), a.size());
+}
+
+bool looks_binary(std::string_view data, size_t scan_bytes) {
+  const size_t n = std::min(data.size(), scan_bytes);
+  const bool cut = data.size() > scan_bytes;
+  const auto *bytes = reinterpret_cast<const unsigned char *>(data.data());
+  const Kernels &k = kernels();
+
+  size_t i = 0;
+  while (true) {
+    i += k.skip_ascii(data.data() + i, n - i);
+    if (i == n) {
+      return false;
+    }
+    bool truncated = false;
+    size_t length = utf8_sequence(bytes, i, n, truncated);
+    if (length == 0) {
+      return !(truncated && cut);
+    }
+    i += length;
+  }
+}
+
+size_t skip_plain_ascii(std::string_view data, size_t from) {
+  if (from >= data.size()) {
+    return data.size();
+  }
+  return from +
+         kernels().skip_plain_ascii(data.data() + from, data.size() - from);
+}
+
+size_t utf8_sequence_length(std::string_view data, size_t pos) {
+  bool truncated = false;
+  return utf8_sequence(reinterpret_cast<const unsigned char *>(data.data()),
+                       pos, data.size(), truncated);
+}
+
+std::string_view trim_whitespace(std::string_view data) {
+  size_t start = 0;
+  size_t end = data.size();
+  while (start < end && is_whitespace(data[start])) {
+    ++start;
+  }
+  while (end > start && is_whitespace(data[end - 1])) {
+    --end;
+  }
+  return data.substr(start, end - start);
+}
+
+bool is_blank(std::string_view data) {
+  return trim_whitespace(data).empty();
+}
+
+bool equal_ignore_surrounding_whitespace(std::string_view a,
+                                         std::string_view b) {
+  return bytes_equal(trim_whitespace(a), trim_whitespace(b));
+}
+
+bool equal_ignore_all_whitespace(std::string_view a, std::string_view b) {
+  return kernels().equal_ignore_ws(a.data(), a.size(), b.data(), b.size());
+}
+
+} // namespace text
+} // namespace wizardmerge
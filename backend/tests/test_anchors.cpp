@@ -0,0 +1,72 @@
+/**
+ * @file test_anchors.cpp
+ * @brief Unit tests for three-way anchor detection
+ */
+
+#include "wizardmerge/merge/anchors.h"
+#include <gtest/gtest.h>
+
+using namespace wizardmerge::merge;
+
+namespace {
+
+std::vector<Anchor> anchors_of(const std::vector<std::string> &base,
+                               const std::vector<std::string> &ours,
+                               const std::vector<std::string> &theirs) {
+  LineTable table;
+  auto base_ids = table.intern_lines(base);
+  auto our_ids = table.intern_lines(ours);
+  auto their_ids = table.intern_lines(theirs);
+  return find_anchors(base_ids, our_ids, their_ids, table.size());
+}
+
+} // namespace
+
+/**
+ * Test only lines unique in all three versions become anchors
+ */
+TEST(AnchorsTest, RequiresUniqueLines) {
+  std::vector<std::string> base = {"a", "}", "b", "}", "c"};
+  std::vector<std::string> ours = {"a", "}", "b", "}", "x", "c"};
+  std::vector<std::string> theirs = {"a", "}", "c", "b"};
+
+  auto anchors = anchors_of(base, ours, theirs);
+
+  // "}" repeats, and "b" and "c" swapped in theirs so only one survives
+  ASSERT_EQ(anchors.size(), 2);
+  EXPECT_EQ(anchors[0].base, 0);
+  EXPECT_EQ(anchors[0].ours, 0);
+  EXPECT_EQ(anchors[0].theirs, 0);
+  EXPECT_EQ(anchors[1].base, 4);
+  EXPECT_EQ(anchors[1].ours, 5);
+  EXPECT_EQ(anchors[1].theirs, 2);
+}
+
+/**
+ * Test anchors are strictly increasing in every version
+ */
+TEST(AnchorsTest, IncreasingInAllVersions) {
+  std::vector<std::string> base, ours, theirs;
+  for (int i = 0; i < 50; ++i) {
+    base.push_back("line " + std::to_string(i));
+  }
+  ours = base;
+  theirs = base;
+  std::swap(ours[10], ours[30]);
+  std::swap(theirs[20], theirs[40]);
+  ours.insert(ours.begin() + 5, "inserted");
+
+  auto anchors = anchors_of(base, ours, theirs);
+
+  // Each swapped pair drops out of the chain
+  ASSERT_EQ(anchors.size(), 46);
+  for (size_t i = 1; i < anchors.size(); ++i) {
+    EXPECT_LT(anchors[i - 1].base, anchors[i].base);
+    EXPECT_LT(anchors[i - 1].ours, anchors[i].ours);
+    EXPECT_LT(anchors[i - 1].theirs, anchors[i].theirs);
+  }
+  for (const auto &anchor : anchors) {
+    EXPECT_EQ(base[anchor.base], ours[anchor.ours]);
+    EXPECT_EQ(base[anchor.base], theirs[anchor.theirs]);
+  }
+}
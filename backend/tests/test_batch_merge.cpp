@@ -0,0 +1,202 @@
+/**
+ * @file test_batch_merge.cpp
+ * @brief Unit tests for the batch merge
+ */
+
+#include "wizardmerge/merge/batch_merge.h"
+#include <gtest/gtest.h>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+using namespace wizardmerge::merge;
+
+namespace {
+
+/**
+ * Builds a job of @p lines lines; both sides edit line 0, so it conflicts
+ */
+MergeJob make_job(std::vector<std::string> &storage, size_t lines) {
+  storage.push_back("ours");
+  storage.push_back("theirs");
+  for (size_t i = 0; i < lines; ++i) {
+    storage.push_back("line " + std::to_string(i));
+  }
+  size_t first = storage.size() - lines;
+
+  MergeJob job;
+  for (size_t i = 0; i < lines; ++i) {
+    std::string_view line = storage[first + i];
+    job.base.push_back(line);
+    job.ours.push_back(i == 0 ? std::string_view(storage[first - 2]) : line);
+    job.theirs.push_back(i == 0 ? std::string_view(storage[first - 1])
+                                : line);
+  }
+  return job;
+}
+
+} // namespace
+
+/**
+ * Test every job is merged once and matches a plain three-way merge
+ */
+TEST(BatchMergeTest, MergesEveryJob) {
+  std::vector<std::string> storage;
+  storage.reserve(100000);
+  std::vector<MergeJob> jobs;
+  for (size_t i = 0; i < 50; ++i) {
+    jobs.push_back(make_job(storage, 1 + i * 37 % 200));
+  }
+
+  std::mutex mutex;
+  std::vector<int> delivered(jobs.size(), 0);
+  std::vector<size_t> merged_sizes(jobs.size(), 0);
+  merge_batch(
+      jobs,
+      [&](size_t index, MergeResult &result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++delivered[index];
+        merged_sizes[index] = result.merged_lines.size();
+        EXPECT_EQ(result.conflicts.size(), 1);
+      },
+      4);
+
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    EXPECT_EQ(delivered[i], 1);
+    auto expected = three_way_merge(jobs[i].base, jobs[i].ours,
+                                    jobs[i].theirs, jobs[i].options);
+    EXPECT_EQ(merged_sizes[i], expected.merged_lines.size());
+  }
+}
+
+/**
+ * Test jobs asking for threads run them on the batch's pool
+ */
+TEST(BatchMergeTest, ParallelJobsShareThePool) {
+  std::vector<std::string> storage;
+  storage.reserve(40000);
+  std::vector<MergeJob> jobs;
+  for (size_t i = 0; i < 4; ++i) {
+    jobs.push_back(make_job(storage, 2 * PARALLEL_PARTITION_LINES + i));
+    jobs.back().options.threads = 0;
+  }
+
+  ThreadPool pool(4);
+  std::mutex mutex;
+  std::vector<size_t> merged_sizes(jobs.size(), 0);
+  merge_batch(
+      jobs,
+      [&](size_t index, MergeResult &result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        merged_sizes[index] = result.merged_lines.size();
+        EXPECT_EQ(result.conflicts.size(), 1);
+      },
+      pool);
+
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    auto expected = three_way_merge(jobs[i].base, jobs[i].ours,
+                                    jobs[i].theirs);
+    EXPECT_EQ(merged_sizes[i], expected.merged_lines.size());
+  }
+}
+
+/**
+ * Test the largest jobs are merged first
+ */
+TEST(BatchMergeTest, LargestJobsFirst) {
+  std::vector<std::string> storage;
+  storage.reserve(1000);
+  std::vector<MergeJob> jobs;
+  for (size_t lines : {3, 50, 10, 200, 10}) {
+    jobs.push_back(make_job(storage, lines));
+  }
+
+  std::vector<size_t> order;
+  merge_batch(
+      jobs, [&](size_t index, MergeResult &) { order.push_back(index); }, 1);
+
+  EXPECT_EQ(order, (std::vector<size_t>{3, 1, 2, 4, 0}));
+}
+
+/**
+ * Test an exception reaches the caller after the other jobs ran
+ */
+TEST(BatchMergeTest, PropagatesExceptions) {
+  std::vector<std::string> storage;
+  storage.reserve(100);
+  std::vector<MergeJob> jobs;
+  for (size_t i = 0; i < 4; ++i) {
+    jobs.push_back(make_job(storage, 5));
+  }
+
+  std::atomic<int> calls(0);
+  auto fail_second = [&](size_t index, MergeResult &) {
+    ++calls;
+    if (index == 1) {
+      throw std::runtime_error("write failed");
+    }
+  };
+  EXPECT_THROW(merge_batch(jobs, fail_second, 2), std::runtime_error);
+  EXPECT_EQ(calls.load(), 4);
+}
+
+/**
+ * Test an empty batch returns at once
+ */
+TEST(BatchMergeTest, EmptyBatch) {
+  bool called = false;
+  merge_batch({}, [&](size_t, MergeResult &) { called = true; });
+  EXPECT_FALSE(called);
+}
+
+/**
+ * Test deletion is decided by which trees have a file, not its content
+ */
+TEST(BatchMergeTest, DetectsDeletedFiles) {
+  // Removed on one side and unchanged, or removed on both
+  EXPECT_TRUE(is_deleted_file("a\n", std::nullopt, "a\n"));
+  EXPECT_TRUE(is_deleted_file("a\n", "a\n", std::nullopt));
+  EXPECT_TRUE(is_deleted_file("a\n", std::nullopt, std::nullopt));
+  EXPECT_TRUE(is_deleted_file("", std::nullopt, ""));
+
+  // Removed on one side and changed on the other
+  EXPECT_FALSE(is_deleted_file("a\n", std::nullopt, "b\n"));
+  EXPECT_FALSE(is_deleted_file("a\n", "", std::nullopt));
+
+  // Emptied on both sides, or added empty
+  EXPECT_FALSE(is_deleted_file("a\n", "", ""));
+  EXPECT_FALSE(is_deleted_file(std::nullopt, "", std::nullopt));
+  EXPECT_FALSE(is_deleted_file(std::nullopt, std::nullopt, ""));
+  EXPECT_FALSE(is_deleted_file(std::nullopt, "", ""));
+}
+
+/**
+ * Test versions differing only in line endings and a BOM merge cleanly,
+ * and the result is restored in our format
+ */
+TEST(BatchMergeTest, MergesNormalizedFiles) {
+  using wizardmerge::text::LineEnding;
+  using wizardmerge::text::TextBuffer;
+
+  std::vector<NormalizedFile> files;
+  files.push_back(normalize_file(TextBuffer::from_string("a\r\nb\r\nc\r\n"),
+                                 TextBuffer::from_string("a\r\nB\r\nc\r\n"),
+                                 TextBuffer::from_string("a\nb\nC\n")));
+  // Added file: written in their format
+  files.push_back(normalize_file(TextBuffer(), TextBuffer(),
+                                 TextBuffer::from_string("\xEF\xBB\xBFx\n")));
+  EXPECT_EQ(files[0].format.line_ending, LineEnding::CRLF);
+  EXPECT_TRUE(files[1].format.bom);
+
+  std::vector<MergeJob> jobs;
+  for (const auto &file : files) {
+    jobs.push_back(file.job());
+  }
+  std::vector<std::string> merged(files.size());
+  merge_batch(jobs, [&](size_t index, MergeResult &result) {
+    EXPECT_FALSE(result.has_conflicts());
+    merged[index] = restore_merged(result, files[index].format);
+  });
+  EXPECT_EQ(merged[0], "a\r\nB\r\nC\r\n");
+  EXPECT_EQ(merged[1], "\xEF\xBB\xBFx\n");
+}
@@ -0,0 +1,59 @@
+/**
+ * @file test_binary_merge.cpp
+ * @brief Unit tests for the whole-file binary merge
+ */
+
+#include "wizardmerge/merge/binary_merge.h"
+#include <gtest/gtest.h>
+
+using namespace wizardmerge::merge;
+
+/**
+ * Test the unchanged side gives way and different changes conflict
+ */
+TEST(BinaryMergeTest, TakesTheChangedSide) {
+  std::string base("\x89PNG\0base", 9);
+  std::string ours("\x89PNG\0ours", 9);
+  std::string theirs("\x89PNG\0theirs", 11);
+
+  EXPECT_EQ(merge_binary(base, base, base), BinaryResolution::OURS);
+  EXPECT_EQ(merge_binary(base, ours, base), BinaryResolution::OURS);
+  EXPECT_EQ(merge_binary(base, base, theirs), BinaryResolution::THEIRS);
+  EXPECT_EQ(merge_binary(base, ours, ours), BinaryResolution::OURS);
+  EXPECT_EQ(merge_binary(base, ours, theirs), BinaryResolution::CONFLICT);
+  EXPECT_EQ(binary_resolution_to_string(BinaryResolution::CONFLICT),
+            "conflict");
+}
+
+/**
+ * Test detection over whole files and over lines
+ */
+TEST(BinaryMergeTest, DetectsBinaryVersions) {
+  std::string text = "int main() {}\n";
+  std::string binary("\x7f" "ELF\0\0\0", 7);
+
+  EXPECT_FALSE(is_binary_merge(text, text, text));
+  EXPECT_TRUE(is_binary_merge(text, text, binary));
+  EXPECT_TRUE(is_binary_merge(binary, text, text));
+
+  std::vector<std::string_view> lines = {"first", "second"};
+  std::vector<std::string_view> with_nul = {"first",
+                                            std::string_view("a\0b", 3)};
+  EXPECT_FALSE(is_binary_merge(lines, lines, lines));
+  EXPECT_TRUE(is_binary_merge(lines, with_nul, lines));
+  // The NUL lies past the scanned prefix ("first\n" is 6 bytes)
+  EXPECT_FALSE(is_binary_merge(lines, with_nul, lines, 7));
+}
+
+/**
+ * Test the line overload compares whole line sequences
+ */
+TEST(BinaryMergeTest, MergesLines) {
+  std::vector<std::string_view> base = {"a", "b"};
+  std::vector<std::string_view> split = {"a", "", "b"};
+  std::vector<std::string_view> joined = {"ab"};
+
+  EXPECT_EQ(merge_binary(base, base, split), BinaryResolution::THEIRS);
+  EXPECT_EQ(merge_binary(base, joined, base), BinaryResolution::OURS);
+  EXPECT_EQ(merge_binary(base, joined, split), BinaryResolution::CONFLICT);
+}
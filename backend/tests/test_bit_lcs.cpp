@@ -0,0 +1,149 @@
+/**
+ * @file test_bit_lcs.cpp
+ * @brief Unit tests for the bit-parallel LCS kernel
+ */
+
+#include "wizardmerge/merge/bit_lcs.h"
+#include "wizardmerge/text/text_kernels.h"
+#include <gtest/gtest.h>
+
+using namespace wizardmerge::merge;
+using namespace wizardmerge::text;
+
+namespace {
+
+/**
+ * Runs a check once per instruction set supported by this CPU
+ */
+template <typename Check> void for_each_simd_level(const Check &check) {
+  SimdLevel original = active_simd_level();
+  for (auto level : {SimdLevel::SCALAR, SimdLevel::AVX2}) {
+    if (set_simd_level(level) == level) {
+      SCOPED_TRACE(simd_level_to_string(level));
+      check();
+    }
+  }
+  set_simd_level(original);
+}
+
+/**
+ * Pseudo-random IDs over a small alphabet, for long edit scripts
+ */
+std::vector<LineId> random_ids(size_t length, LineId alphabet,
+                               unsigned &seed) {
+  std::vector<LineId> ids;
+  for (size_t i = 0; i < length; ++i) {
+    seed = seed * 1103515245 + 12345;
+    ids.push_back((seed >> 16) % alphabet);
+  }
+  return ids;
+}
+
+/**
+ * Textbook O(N * M) dynamic program
+ */
+size_t reference_lcs(const std::vector<LineId> &a,
+                     const std::vector<LineId> &b) {
+  std::vector<size_t> prev(b.size() + 1, 0), row(b.size() + 1, 0);
+  for (size_t i = 1; i <= a.size(); ++i) {
+    for (size_t j = 1; j <= b.size(); ++j) {
+      row[j] = a[i - 1] == b[j - 1] ? prev[j - 1] + 1
+                                    : std::max(prev[j], row[j - 1]);
+    }
+    std::swap(prev, row);
+  }
+  return prev[b.size()];
+}
+
+} // namespace
+
+/**
+ * Test the length matches the reference on one- and multi-word rows
+ */
+TEST(BitLcsTest, LengthMatchesReference) {
+  for_each_simd_level([] {
+    unsigned seed = 42;
+    for (size_t m : {1, 5, 63, 64, 65, 130, 257, 300, 700}) {
+      for (LineId alphabet : {2, 4, 50}) {
+        auto a = random_ids(m / 2 + 17, alphabet, seed);
+        auto b = random_ids(m, alphabet, seed);
+        EXPECT_EQ(lcs_length(a, b), reference_lcs(a, b))
+            << "m=" << m << " alphabet=" << alphabet;
+      }
+    }
+  });
+}
+
+/**
+ * Test carries ripple across whole words of ones
+ */
+TEST(BitLcsTest, CarryAcrossWords) {
+  for_each_simd_level([] {
+    // One matching column at the very start, then 600 columns of another
+    // element: the carry out of word 0 has to run through all the others
+    std::vector<LineId> b(601, 2);
+    b[0] = 1;
+    std::vector<LineId> a = {1, 2, 2, 1, 2};
+    EXPECT_EQ(lcs_length(a, b), reference_lcs(a, b));
+    EXPECT_EQ(lcs_length(b, a), reference_lcs(a, b));
+  });
+}
+
+/**
+ * Test the matches form a longest common subsequence
+ */
+TEST(BitLcsTest, MatchesAreCommonSubsequence) {
+  unsigned seed = 7;
+  for (int round = 0; round < 20; ++round) {
+    auto a = random_ids(40 + round * 13, 5, seed);
+    auto b = random_ids(90 - round * 2, 5, seed);
+
+    std::vector<std::pair<size_t, size_t>> matches;
+    lcs_matches(a.data(), a.size(), b.data(), b.size(), matches);
+    EXPECT_EQ(matches.size(), reference_lcs(a, b));
+    for (size_t k = 0; k < matches.size(); ++k) {
+      EXPECT_EQ(a[matches[k].first], b[matches[k].second]);
+      if (k > 0) {
+        EXPECT_LT(matches[k - 1].first, matches[k].first);
+        EXPECT_LT(matches[k - 1].second, matches[k].second);
+      }
+    }
+  }
+}
+
+/**
+ * Test the diff is minimal and transforms base into other
+ */
+TEST(BitLcsTest, DiffIsMinimal) {
+  unsigned seed = 99;
+  auto a = random_ids(120, 4, seed);
+  auto b = random_ids(150, 4, seed);
+  auto hunks = bit_lcs_diff(a, b);
+
+  std::vector<LineId> out;
+  size_t pos = 0;
+  size_t edits = 0;
+  for (const auto &hunk : hunks) {
+    out.insert(out.end(), a.begin() + pos, a.begin() + hunk.base_start);
+    out.insert(out.end(), b.begin() + hunk.other_start,
+               b.begin() + hunk.other_end());
+    pos = hunk.base_end();
+    edits += hunk.base_count + hunk.other_count;
+  }
+  out.insert(out.end(), a.begin() + pos, a.end());
+  EXPECT_EQ(out, b);
+  EXPECT_EQ(edits, a.size() + b.size() - 2 * reference_lcs(a, b));
+
+  EXPECT_TRUE(bit_lcs_diff(a, a).empty());
+  EXPECT_EQ(bit_lcs_diff({}, b).size(), 1);
+}
+
+/**
+ * Test the string overload compares line content
+ */
+TEST(BitLcsTest, StringLines) {
+  std::vector<std::string_view> a = {"x", "a", "b", "c", "y"};
+  std::vector<std::string_view> b = {"a", "z", "b", "c"};
+  EXPECT_EQ(lcs_length(a, b), 3);
+  EXPECT_EQ(lcs_length(a, {}), 0);
+}
@@ -0,0 +1,172 @@
+/**
+ * @file test_conflict_markers.cpp
+ * @brief Unit tests for conflict-marker parsing
+ */
+
+#include "wizardmerge/merge/conflict_markers.h"
+#include <gtest/gtest.h>
+
+using namespace wizardmerge::merge;
+
+namespace {
+
+std::vector<std::string> to_strings(const std::vector<std::string_view> &v) {
+  return std::vector<std::string>(v.begin(), v.end());
+}
+
+} // namespace
+
+/**
+ * Test a git-style conflict rebuilds ours and theirs over an empty base
+ */
+TEST(ConflictMarkersTest, ParsesMergeStyle) {
+  std::string data = "a\n"
+                     "<<<<<<< HEAD\n"
+                     "ours\n"
+                     "=======\n"
+                     "theirs 1\n"
+                     "theirs 2\n"
+                     ">>>>>>> feature\n"
+                     "b\n";
+  ConflictedFile file;
+  ASSERT_TRUE(parse_conflict_markers(data, file));
+
+  using Lines = std::vector<std::string>;
+  EXPECT_EQ(to_strings(file.ours), (Lines{"a", "ours", "b"}));
+  EXPECT_EQ(to_strings(file.theirs),
+            (Lines{"a", "theirs 1", "theirs 2", "b"}));
+  EXPECT_EQ(to_strings(file.base), (Lines{"a", "b"}));
+
+  ASSERT_EQ(file.hunks.size(), 1u);
+  const MarkerHunk &hunk = file.hunks[0];
+  EXPECT_FALSE(hunk.has_base);
+  EXPECT_EQ(hunk.our_label, "HEAD");
+  EXPECT_EQ(hunk.their_label, "feature");
+  EXPECT_EQ(hunk.file_range.begin, 1u);
+  EXPECT_EQ(hunk.file_range.end, 7u);
+  EXPECT_EQ(hunk.our_range.begin, 1u);
+  EXPECT_EQ(hunk.our_range.end, 2u);
+  EXPECT_EQ(hunk.their_range.end, 3u);
+  EXPECT_EQ(hunk.base_range.begin, hunk.base_range.end);
+}
+
+/**
+ * Test diff3-style base sections, CRLF markers and a missing final newline
+ */
+TEST(ConflictMarkersTest, ParsesDiff3Style) {
+  std::string data = "<<<<<<< ours\r\n"
+                     "x = 2;\r\n"
+                     "||||||| base\r\n"
+                     "x = 1;\r\n"
+                     "=======\r\n"
+                     "x = 1;\r\n"
+                     ">>>>>>> theirs\r\n"
+                     "end";
+  ConflictedFile file;
+  ASSERT_TRUE(parse_conflict_markers(data, file));
+  ASSERT_EQ(file.hunks.size(), 1u);
+  EXPECT_TRUE(file.hunks[0].has_base);
+  EXPECT_EQ(file.hunks[0].base_label, "base");
+  EXPECT_EQ(file.hunks[0].their_label, "theirs");
+  ASSERT_EQ(file.base.size(), 2u);
+  EXPECT_EQ(file.base[0], "x = 1;\r");
+  EXPECT_EQ(file.base[1], "end");
+
+  // Only ours changed the line, so the re-merge resolves it
+  MergeResult result = three_way_merge(file.base, file.ours, file.theirs);
+  EXPECT_FALSE(result.has_conflicts());
+  ASSERT_EQ(result.merged_lines.size(), 2u);
+  EXPECT_EQ(result.merged_lines[0].content, "x = 2;\r");
+}
+
+/**
+ * Test marker look-alikes are content
+ */
+TEST(ConflictMarkersTest, IgnoresNonMarkers) {
+  std::string data = "std::cout << x <<<<<<< y;\n"
+                     "<<<<<<<< longer\n"
+                     "<<<<<<<x\n"
+                     " <<<<<<< indented\n"
+                     "=======\n";
+  ConflictedFile file;
+  ASSERT_TRUE(parse_conflict_markers(data, file));
+  EXPECT_FALSE(file.has_conflicts());
+  EXPECT_EQ(file.ours.size(), 5u);
+  EXPECT_EQ(to_strings(file.base), to_strings(file.ours));
+  EXPECT_EQ(to_strings(file.theirs), to_strings(file.ours));
+
+  EXPECT_TRUE(is_conflict_marker(">>>>>>>", '>'));
+  EXPECT_TRUE(is_conflict_marker("|||||||||", '|', 9));
+  EXPECT_FALSE(is_conflict_marker("======", '='));
+}
+
+/**
+ * Test several hunks keep the stable lines between them
+ */
+TEST(ConflictMarkersTest, ParsesSeveralHunks) {
+  std::string data;
+  for (int i = 0; i < 3; ++i) {
+    data += "line " + std::to_string(i) + "\n";
+    data += "<<<<<<< HEAD\nours\n=======\ntheirs\n>>>>>>> other\n";
+  }
+  ConflictedFile file;
+  ASSERT_TRUE(parse_conflict_markers(data, file));
+  ASSERT_EQ(file.hunks.size(), 3u);
+  EXPECT_EQ(file.hunks[2].file_range.begin, 13u);
+  EXPECT_EQ(file.ours.size(), 6u);
+  EXPECT_EQ(file.ours[4], "line 2");
+
+  // One stable line apart, the re-merge reports them as one conflict
+  MergeResult result = three_way_merge(file.base, file.ours, file.theirs);
+  ASSERT_EQ(result.conflicts.size(), 1u);
+  EXPECT_EQ(result.conflicts[0].our_lines.size(), 5u);
+}
+
+/**
+ * Test malformed conflicts are rejected
+ */
+TEST(ConflictMarkersTest, RejectsMalformedConflicts) {
+  ConflictedFile file;
+  EXPECT_FALSE(parse_conflict_markers("<<<<<<< HEAD\nours\n", file));
+  EXPECT_FALSE(parse_conflict_markers("<<<<<<< HEAD\n=======\n", file));
+  EXPECT_FALSE(
+      parse_conflict_markers("<<<<<<< HEAD\n>>>>>>> other\n", file));
+  EXPECT_FALSE(parse_conflict_markers(
+      "<<<<<<< a\n<<<<<<< b\n=======\n>>>>>>> c\n", file));
+  EXPECT_FALSE(parse_conflict_markers(
+      "<<<<<<< a\n=======\n||||||| b\n>>>>>>> c\n", file));
+}
+
+/**
+ * Test conflicts left by a re-merge can carry the parsed labels
+ */
+TEST(ConflictMarkersTest, RemergeKeepsLabels) {
+  ConflictedFile file;
+  ASSERT_TRUE(parse_conflict_markers(
+      "<<<<<<< HEAD\nours\n||||||| merged common ancestors\nbase\n"
+      "=======\ntheirs\n>>>>>>> feature/x\n",
+      file));
+  ASSERT_EQ(file.hunks.size(), 1u);
+
+  MergeOptions options;
+  options.analysis = AnalysisLevel::NONE;
+  options.show_base = true;
+  options.our_label = std::string(file.hunks[0].our_label);
+  options.base_label = std::string(file.hunks[0].base_label);
+  options.their_label = std::string(file.hunks[0].their_label);
+  MergeResult result =
+      three_way_merge(file.base, file.ours, file.theirs, options);
+
+  std::vector<std::string> lines;
+  for (const auto &line : result.merged_lines) {
+    lines.emplace_back(line.content);
+  }
+  EXPECT_EQ(lines, (std::vector<std::string>{
+                       "<<<<<<< HEAD", "ours",
+                       "||||||| merged common ancestors", "base", "=======",
+                       "theirs", ">>>>>>> feature/x"}));
+
+  EXPECT_EQ(conflict_marker('<', "HEAD"), "<<<<<<< HEAD");
+  EXPECT_EQ(conflict_marker('>', ""), ">>>>>>>");
+  EXPECT_EQ(conflict_marker('|', "BASE", 9), "||||||||| BASE");
+}
@@ -0,0 +1,259 @@
+/**
+ * @file test_diff.cpp
+ * @brief Unit tests for line diff algorithms
+ */
+
+#include "wizardmerge/merge/diff.h"
+#include <gtest/gtest.h>
+
+using namespace wizardmerge::merge;
+
+/**
+ * Test identical inputs produce no hunks
+ */
+TEST(MyersDiffTest, IdenticalInputs) {
+  std::vector<std::string> a = {"a", "b", "c"};
+
+  EXPECT_TRUE(myers_diff(a, a).empty());
+}
+
+/**
+ * Test insertion at the top is a single hunk
+ */
+TEST(MyersDiffTest, InsertionAtTop) {
+  std::vector<std::string> a = {"a", "b", "c"};
+  std::vector<std::string> b = {"new", "a", "b", "c"};
+
+  auto hunks = myers_diff(a, b);
+
+  ASSERT_EQ(hunks.size(), 1);
+  EXPECT_EQ(hunks[0].base_start, 0);
+  EXPECT_EQ(hunks[0].base_count, 0);
+  EXPECT_EQ(hunks[0].other_start, 0);
+  EXPECT_EQ(hunks[0].other_count, 1);
+}
+
+/**
+ * Test deletion and replacement in the middle
+ */
+TEST(MyersDiffTest, DeletionAndReplacement) {
+  std::vector<std::string> a = {"a", "b", "c", "d", "e"};
+  std::vector<std::string> b = {"a", "c", "x", "e"};
+
+  auto hunks = myers_diff(a, b);
+
+  ASSERT_EQ(hunks.size(), 2);
+  EXPECT_EQ(hunks[0].base_start, 1);
+  EXPECT_EQ(hunks[0].base_count, 1);
+  EXPECT_EQ(hunks[0].other_count, 0);
+  EXPECT_EQ(hunks[1].base_start, 3);
+  EXPECT_EQ(hunks[1].base_count, 1);
+  EXPECT_EQ(hunks[1].other_start, 2);
+  EXPECT_EQ(hunks[1].other_count, 1);
+}
+
+/**
+ * Test diff against empty sequences
+ */
+TEST(MyersDiffTest, EmptySequences) {
+  std::vector<std::string> empty;
+  std::vector<std::string> a = {"a", "b"};
+
+  auto added = myers_diff(empty, a);
+  ASSERT_EQ(added.size(), 1);
+  EXPECT_EQ(added[0].other_count, 2);
+
+  auto removed = myers_diff(a, empty);
+  ASSERT_EQ(removed.size(), 1);
+  EXPECT_EQ(removed[0].base_count, 2);
+
+  EXPECT_TRUE(myers_diff(empty, empty).empty());
+}
+
+/**
+ * Test the edit script is minimal
+ */
+TEST(MyersDiffTest, MinimalEditScript) {
+  std::vector<std::string> a = {"a", "b", "c", "a", "b", "b", "a"};
+  std::vector<std::string> b = {"c", "b", "a", "b", "a", "c"};
+
+  size_t edits = 0;
+  for (const auto &hunk : myers_diff(a, b)) {
+    edits += hunk.base_count + hunk.other_count;
+  }
+
+  // Classic example from Myers' paper: D = 5
+  EXPECT_EQ(edits, 5);
+}
+
+namespace {
+
+/**
+ * Applies hunks to base and returns the reconstructed sequence
+ */
+std::vector<std::string> apply_hunks(const std::vector<std::string> &base,
+                                     const std::vector<std::string> &other,
+                                     const std::vector<DiffHunk> &hunks) {
+  std::vector<std::string> out;
+  size_t pos = 0;
+  for (const auto &hunk : hunks) {
+    out.insert(out.end(), base.begin() + pos, base.begin() + hunk.base_start);
+    out.insert(out.end(), other.begin() + hunk.other_start,
+               other.begin() + hunk.other_end());
+    pos = hunk.base_end();
+  }
+  out.insert(out.end(), base.begin() + pos, base.end());
+  return out;
+}
+
+} // namespace
+
+/**
+ * Test patience and histogram produce valid edit scripts
+ */
+TEST(DiffAlgorithmTest, ScriptsReconstructOther) {
+  std::vector<std::string> a = {"int f() {", "  return 1;", "}", "",
+                                "int g() {", "  return 2;", "}"};
+  std::vector<std::string> b = {"int g() {", "  return 2;", "}", "",
+                                "int f() {", "  return 3;", "}", ""};
+
+  for (auto algorithm : {DiffAlgorithm::MYERS, DiffAlgorithm::PATIENCE,
+                         DiffAlgorithm::HISTOGRAM, DiffAlgorithm::AUTO}) {
+    auto hunks = compute_diff(a, b, algorithm);
+    EXPECT_EQ(apply_hunks(a, b, hunks), b)
+        << diff_algorithm_to_string(algorithm);
+  }
+}
+
+/**
+ * Test the linear-space search finds scripts as short as Myers' and valid
+ */
+TEST(DiffAlgorithmTest, LinearMyersIsMinimal) {
+  std::vector<std::string> a = {"a", "b", "c", "a", "b", "b", "a"};
+  std::vector<std::string> b = {"c", "b", "a", "b", "a", "c"};
+
+  auto count_edits = [](const std::vector<DiffHunk> &hunks) {
+    size_t edits = 0;
+    for (const auto &hunk : hunks) {
+      edits += hunk.base_count + hunk.other_count;
+    }
+    return edits;
+  };
+
+  EXPECT_EQ(count_edits(myers_linear_diff(a, b)), 5);
+  EXPECT_EQ(apply_hunks(a, b, myers_linear_diff(a, b)), b);
+
+  // Pseudo-random inputs over a small alphabet give long edit scripts
+  unsigned seed = 12345;
+  auto next = [&seed]() {
+    seed = seed * 1103515245 + 12345;
+    return std::string(1, static_cast<char>('a' + (seed >> 16) % 4));
+  };
+  for (int round = 0; round < 20; ++round) {
+    std::vector<std::string> x, y;
+    for (int i = 0; i < 30 + round; ++i) {
+      x.push_back(next());
+    }
+    for (int i = 0; i < 25 + 2 * round; ++i) {
+      y.push_back(next());
+    }
+    auto hunks = myers_linear_diff(x, y);
+    EXPECT_EQ(apply_hunks(x, y, hunks), y);
+    EXPECT_EQ(count_edits(hunks), count_edits(myers_diff(x, y)));
+  }
+  EXPECT_TRUE(myers_linear_diff(a, a).empty());
+  EXPECT_EQ(count_edits(myers_linear_diff({}, b)), b.size());
+}
+
+/**
+ * Test a search over the memory budget is split in linear space and stays
+ * minimal
+ */
+TEST(DiffAlgorithmTest, MemoryBudgetFallsBackToLinearSpace) {
+  // Too large for the bit-parallel kernel, with scattered edits
+  std::vector<std::string> a, b;
+  for (int i = 0; i < 3000; ++i) {
+    a.push_back("line " + std::to_string(i % 500));
+    if (i % 7 == 0) {
+      b.push_back("changed " + std::to_string(i));
+    } else if (i % 11 != 0) {
+      b.push_back(a.back());
+    }
+  }
+
+  auto count_edits = [](const std::vector<DiffHunk> &hunks) {
+    size_t edits = 0;
+    for (const auto &hunk : hunks) {
+      edits += hunk.base_count + hunk.other_count;
+    }
+    return edits;
+  };
+
+  auto unbounded = compute_diff(a, b, DiffAlgorithm::MYERS, SIZE_MAX);
+  for (size_t budget : {size_t(0), size_t(4096), DIFF_MEMORY_BUDGET}) {
+    auto hunks = compute_diff(a, b, DiffAlgorithm::MYERS, budget);
+    EXPECT_EQ(apply_hunks(a, b, hunks), b) << budget;
+    EXPECT_EQ(count_edits(hunks), count_edits(unbounded)) << budget;
+  }
+}
+
+/**
+ * Test a rewrite with no common line is one hunk without a quadratic search
+ */
+TEST(DiffAlgorithmTest, RewriteIsOneHunk) {
+  std::vector<std::string> a, b;
+  for (int i = 0; i < 200000; ++i) {
+    a.push_back("old " + std::to_string(i));
+    b.push_back("new " + std::to_string(i));
+  }
+
+  auto hunks = compute_diff(a, b, DiffAlgorithm::AUTO, 0);
+
+  ASSERT_EQ(hunks.size(), 1);
+  EXPECT_EQ(hunks[0].base_count, a.size());
+  EXPECT_EQ(hunks[0].other_count, b.size());
+}
+
+/**
+ * Test patience anchors on unique lines instead of repeated braces
+ */
+TEST(DiffAlgorithmTest, PatienceIgnoresRepeatedLines) {
+  std::vector<std::string> a = {"void a() {", "  x();", "}", "void b() {",
+                                "  y();", "}"};
+  std::vector<std::string> b = {"void a() {", "  x();", "}", "void c() {",
+                                "  z();", "}", "void b() {", "  y();", "}"};
+
+  auto hunks = patience_diff(a, b);
+
+  // The new function is inserted as one block between a() and b()
+  ASSERT_EQ(hunks.size(), 1);
+  EXPECT_EQ(hunks[0].base_count, 0);
+  EXPECT_EQ(hunks[0].other_count, 3);
+  EXPECT_EQ(b[hunks[0].other_start], "void c() {");
+}
+
+/**
+ * Test histogram diff on inputs with no common lines
+ */
+TEST(DiffAlgorithmTest, HistogramDisjointInputs) {
+  std::vector<std::string> a = {"a", "b"};
+  std::vector<std::string> b = {"c", "d", "e"};
+
+  auto hunks = histogram_diff(a, b);
+
+  ASSERT_EQ(hunks.size(), 1);
+  EXPECT_EQ(hunks[0].base_count, 2);
+  EXPECT_EQ(hunks[0].other_count, 3);
+}
+
+/**
+ * Test algorithm name round-trip
+ */
+TEST(DiffAlgorithmTest, ParseAlgorithmNames) {
+  DiffAlgorithm algorithm;
+  ASSERT_TRUE(parse_diff_algorithm("histogram", algorithm));
+  EXPECT_EQ(algorithm, DiffAlgorithm::HISTOGRAM);
+  ASSERT_TRUE(parse_diff_algorithm("patience", algorithm));
+  EXPECT_EQ(diff_algorithm_to_string(algorithm), "patience");
+  EXPECT_FALSE(parse_diff_algorithm("bogus", algorithm));
+}
@@ -0,0 +1,66 @@
+/**
+ * @file test_diff3.cpp
+ * @brief Unit tests for the diff3 region walk
+ */
+
+#include "wizardmerge/merge/diff3.h"
+#include <gtest/gtest.h>
+
+using namespace wizardmerge::merge;
+
+namespace {
+
+std::vector<Diff3Region> regions_of(const std::vector<std::string> &base,
+                                    const std::vector<std::string> &ours,
+                                    const std::vector<std::string> &theirs) {
+  LineTable table;
+  auto base_ids = table.intern_lines(base);
+  auto our_ids = table.intern_lines(ours);
+  auto their_ids = table.intern_lines(theirs);
+  return diff3_regions(our_ids, their_ids, myers_diff(base_ids, our_ids),
+                       myers_diff(base_ids, their_ids));
+}
+
+} // namespace
+
+/**
+ * Test each kind of region is classified
+ */
+TEST(Diff3Test, ClassifiesRegions) {
+  std::vector<std::string> base = {"a", "b", "c", "d", "e", "f", "g", "h"};
+  std::vector<std::string> ours = {"a", "B", "c", "D", "e", "F1", "g", "h"};
+  std::vector<std::string> theirs = {"a", "b", "c", "D", "e", "F2", "g", "H"};
+
+  auto regions = regions_of(base, ours, theirs);
+
+  ASSERT_EQ(regions.size(), 4);
+  EXPECT_EQ(regions[0].kind, Diff3Region::OURS);
+  EXPECT_EQ(regions[0].base_begin, 1);
+  EXPECT_EQ(regions[1].kind, Diff3Region::SAME);
+  EXPECT_EQ(regions[1].base_begin, 3);
+  EXPECT_EQ(regions[2].kind, Diff3Region::CONFLICT);
+  EXPECT_EQ(regions[2].base_begin, 5);
+  EXPECT_EQ(regions[2].ours_begin, 5);
+  EXPECT_EQ(regions[2].theirs_end, 6);
+  EXPECT_EQ(regions[3].kind, Diff3Region::THEIRS);
+  EXPECT_EQ(regions[3].base_begin, 7);
+}
+
+/**
+ * Test insertions at the same base position share a region
+ */
+TEST(Diff3Test, InsertionsAtSamePositionConflict) {
+  std::vector<std::string> base = {"a", "b"};
+  std::vector<std::string> ours = {"a", "x", "b"};
+  std::vector<std::string> theirs = {"a", "y", "b", "tail"};
+
+  auto regions = regions_of(base, ours, theirs);
+
+  ASSERT_EQ(regions.size(), 2);
+  EXPECT_EQ(regions[0].kind, Diff3Region::CONFLICT);
+  EXPECT_EQ(regions[0].base_begin, 1);
+  EXPECT_EQ(regions[0].base_end, 1);
+  EXPECT_EQ(regions[1].kind, Diff3Region::THEIRS);
+  EXPECT_EQ(regions[1].theirs_begin, 3);
+  EXPECT_EQ(regions[1].theirs_end, 4);
+}
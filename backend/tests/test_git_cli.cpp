@@ -221,3 +221,39 @@ TEST_F(GitCLITest, AddEmptyFileList) {
   GitResult result = add_files(repo_path, {});
   EXPECT_TRUE(result.success);
 }
+
+/**
+ * Test listing the files a merge left conflicted
+ */
+TEST_F(GitCLITest, ListConflictedFiles) {
+  std::string repo_path = test_dir + "/test_repo";
+  init_repo(repo_path);
+  auto git = [&](const std::string &cmd) {
+    system(("git -C \"" + repo_path + "\" " + cmd + " > /dev/null 2>&1")
+               .c_str());
+  };
+
+  create_file(repo_path + "/test.txt", "base\n");
+  create_file(repo_path + "/other.txt", "other\n");
+  git("add .");
+  git("commit -m \"Initial commit\"");
+  auto main_branch = get_current_branch(repo_path);
+  ASSERT_TRUE(main_branch.has_value());
+
+  auto files = list_conflicted_files(repo_path);
+  ASSERT_TRUE(files.has_value());
+  EXPECT_TRUE(files->empty());
+
+  git("checkout -b side");
+  create_file(repo_path + "/test.txt", "theirs\n");
+  git("commit -am \"Side change\"");
+  git("checkout " + main_branch.value());
+  create_file(repo_path + "/test.txt", "ours\n");
+  git("commit -am \"Main change\"");
+  git("merge side");
+
+  files = list_conflicted_files(repo_path);
+  ASSERT_TRUE(files.has_value());
+  ASSERT_EQ(files->size(), 1u);
+  EXPECT_EQ((*files)[0], "test.txt");
+}
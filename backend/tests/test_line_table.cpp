@@ -0,0 +1,115 @@
+/**
+ * @file test_line_table.cpp
+ * @brief Unit tests for the line interning table
+ */
+
+#include "wizardmerge/merge/line_table.h"
+#include <gtest/gtest.h>
+
+using namespace wizardmerge::merge;
+
+/**
+ * Test equal lines share an ID and distinct lines do not
+ */
+TEST(LineTableTest, InternAssignsDenseIds) {
+  std::vector<std::string> lines = {"a", "b", "a", "", "b", ""};
+  LineTable table;
+
+  auto ids = table.intern_lines(lines);
+
+  ASSERT_EQ(ids.size(), 6);
+  EXPECT_EQ(ids[0], 0);
+  EXPECT_EQ(ids[1], 1);
+  EXPECT_EQ(ids[2], 0);
+  EXPECT_EQ(ids[3], 2);
+  EXPECT_EQ(ids[4], 1);
+  EXPECT_EQ(ids[5], 2);
+  EXPECT_EQ(table.size(), 3);
+  EXPECT_EQ(table.text(1), "b");
+}
+
+/**
+ * Test the table grows past its initial capacity
+ */
+TEST(LineTableTest, GrowsBeyondInitialCapacity) {
+  std::vector<std::string> lines;
+  for (int i = 0; i < 5000; ++i) {
+    lines.push_back("line " + std::to_string(i % 2500));
+  }
+  LineTable table(4);
+
+  auto ids = table.intern_lines(lines);
+
+  EXPECT_EQ(table.size(), 2500);
+  for (size_t i = 0; i < 2500; ++i) {
+    EXPECT_EQ(ids[i], ids[i + 2500]);
+    EXPECT_EQ(table.text(ids[i]), lines[i]);
+  }
+}
+
+/**
+ * Test hashing depends on every byte, including long lines
+ */
+TEST(LineTableTest, HashCoversAllBytes) {
+  std::string line(100, 'x');
+  uint64_t base_hash = hash_line(line);
+
+  for (size_t i = 0; i < line.size(); ++i) {
+    std::string changed = line;
+    changed[i] = 'y';
+    EXPECT_NE(hash_line(changed), base_hash) << "position " << i;
+  }
+  EXPECT_EQ(hash_line(line), base_hash);
+  EXPECT_NE(hash_line("ab"), hash_line("ba"));
+}
+
+/**
+ * Test each comparison option's equivalence
+ */
+TEST(LineTableTest, ComparisonOptions) {
+  CompareOptions all_space;
+  all_space.ignore_all_space = true;
+  EXPECT_TRUE(lines_equivalent("f(a, b);", "f(a,b) ;\t", all_space));
+  EXPECT_FALSE(lines_equivalent("f(a, b);", "f(a, c);", all_space));
+
+  CompareOptions space_change;
+  space_change.ignore_space_change = true;
+  EXPECT_TRUE(lines_equivalent("  int  x;", "\tint x;  ", space_change));
+  EXPECT_FALSE(lines_equivalent("int x;", "intx;", space_change));
+  EXPECT_FALSE(lines_equivalent("x", "  x", space_change));
+
+  CompareOptions eol;
+  eol.ignore_eol = true;
+  EXPECT_TRUE(lines_equivalent("x\r", "x", eol));
+  EXPECT_FALSE(lines_equivalent("x ", "x", eol));
+
+  CompareOptions ignore_case;
+  ignore_case.ignore_case = true;
+  EXPECT_TRUE(lines_equivalent("SELECT id", "select ID", ignore_case));
+
+  CompareOptions parsed;
+  EXPECT_TRUE(parse_ignore_option("blank-lines", parsed));
+  EXPECT_TRUE(parsed.ignore_blank_lines);
+  EXPECT_TRUE(parsed.exact());
+  EXPECT_FALSE(parse_ignore_option("tabs", parsed));
+}
+
+/**
+ * Test equivalent lines share an ID and keep the first text seen
+ */
+TEST(LineTableTest, InternsUnderComparison) {
+  CompareOptions compare;
+  compare.ignore_space_change = true;
+  compare.ignore_case = true;
+  LineTable table(0, compare);
+  std::vector<std::string> lines = {"Return  x;", "return x;  ", "return y;",
+                                    "RETURN X;"};
+
+  auto ids = table.intern_lines(lines);
+
+  EXPECT_EQ(ids[0], ids[1]);
+  EXPECT_EQ(ids[0], ids[3]);
+  EXPECT_NE(ids[0], ids[2]);
+  EXPECT_EQ(table.size(), 2);
+  EXPECT_EQ(table.text(ids[1]), "Return  x;");
+}
@@ -0,0 +1,143 @@
+/**
+ * @file test_merge_policy.cpp
+ * @brief Unit tests for the policy-specialized merge pipeline
+ */
+
+#include "wizardmerge/merge/merge_policy.h"
+#include <gtest/gtest.h>
+
+using namespace wizardmerge::merge;
+
+namespace {
+
+/**
+ * @brief Sink recording the lines and conflict positions it receives.
+ */
+class RecordingSink : public MergeSink {
+public:
+  void write_line(std::string_view content, Line::Origin) override {
+    lines.emplace_back(content);
+  }
+  void write_conflict(const Conflict &conflict) override {
+    starts.push_back(conflict.start_line);
+    analyses.push_back(conflict.analysis);
+  }
+
+  std::vector<std::string> lines;
+  std::vector<size_t> starts;
+  std::vector<AnalysisLevel> analyses;
+};
+
+const std::vector<std::string_view> BASE = {"int f() {", "  return 1;", "}",
+                                            "int g();"};
+const std::vector<std::string_view> OURS = {"int f() {", "  return 2;", "}",
+                                            "int g();"};
+const std::vector<std::string_view> THEIRS = {"int f() {", "  return 3;",
+                                              "}", "int  g();"};
+
+} // namespace
+
+/**
+ * Test the policies produce the same lines as three_way_merge
+ */
+TEST(MergePolicyTest, MatchesThreeWayMerge) {
+  MergeOptions options;
+  MergeResult expected = three_way_merge(BASE, OURS, THEIRS, options);
+
+  MergeResult exact;
+  ResultSink exact_sink(exact);
+  merge_with_policy<ExactMergePolicy>(BASE, OURS, THEIRS, options,
+                                      exact_sink);
+  MergeResult text;
+  ResultSink text_sink(text);
+  merge_with_policy<TextMergePolicy>(BASE, OURS, THEIRS, options, text_sink);
+
+  for (const MergeResult *result : {&exact, &text}) {
+    ASSERT_EQ(result->merged_lines.size(), expected.merged_lines.size());
+    for (size_t i = 0; i < expected.merged_lines.size(); ++i) {
+      EXPECT_EQ(result->merged_lines[i].content,
+                expected.merged_lines[i].content);
+      EXPECT_EQ(result->merged_lines[i].origin,
+                expected.merged_lines[i].origin);
+    }
+    ASSERT_EQ(result->conflicts.size(), 1);
+  }
+  EXPECT_EQ(exact.conflicts[0].analysis, AnalysisLevel::FULL);
+  // The text policy compiles the analysis out
+  EXPECT_EQ(text.conflicts[0].analysis, AnalysisLevel::NONE);
+}
+
+/**
+ * Test the comparator policy decides how lines compare
+ */
+TEST(MergePolicyTest, ComparatorPolicy) {
+  MergeOptions options;
+  options.compare.ignore_all_space = true;
+
+  MergeResult exact;
+  ResultSink exact_sink(exact);
+  merge_with_policy<ExactMergePolicy>(BASE, OURS, THEIRS, options,
+                                      exact_sink);
+  MergeResult equivalent;
+  ResultSink equivalent_sink(equivalent);
+  merge_with_policy<EquivalentMergePolicy>(BASE, OURS, THEIRS, options,
+                                           equivalent_sink);
+
+  // Only the equivalent policy sees "int  g();" as unchanged
+  EXPECT_EQ(exact.merged_lines.back().content, "int  g();");
+  EXPECT_EQ(equivalent.merged_lines.back().content, "int g();");
+
+  EXPECT_TRUE(ExactLines().equal("a", "a"));
+  EXPECT_FALSE(ExactLines(options.compare).equal("a b", "ab"));
+  EXPECT_TRUE(EquivalentLines(options.compare).equal("a b", "ab"));
+}
+
+/**
+ * Test the stream sink forwards lines at once and analyzed conflicts
+ * with absolute line numbers
+ */
+TEST(MergePolicyTest, StreamSinkForwardsOutput) {
+  RecordingSink recording;
+  StreamSink sink(recording, 10);
+  MergeOptions options;
+  options.analysis = AnalysisLevel::CONTEXT;
+
+  merge_with_policy<ExactStreamPolicy>(BASE, OURS, THEIRS, options, sink);
+
+  EXPECT_EQ(recording.lines.front(), "int f() {");
+  EXPECT_EQ(sink.line_count(), 10 + recording.lines.size());
+  ASSERT_EQ(recording.starts.size(), 1);
+  EXPECT_EQ(recording.starts[0], 11);
+  EXPECT_EQ(recording.analyses[0], AnalysisLevel::CONTEXT);
+  EXPECT_EQ(sink.conflicts_forwarded(), 1);
+  EXPECT_TRUE(sink.conflicts().empty());
+}
+
+/**
+ * Test which options the text policies serve, and that the streaming one
+ * forwards the same lines unanalyzed
+ */
+TEST(MergePolicyTest, TextPolicies) {
+  MergeOptions options;
+  EXPECT_FALSE(is_text_merge(options));
+  options.analysis = AnalysisLevel::NONE;
+  EXPECT_TRUE(is_text_merge(options));
+  options.compare.ignore_case = true;
+  EXPECT_FALSE(is_text_merge(options));
+  options.compare.ignore_case = false;
+  options.algorithm = DiffAlgorithm::MYERS;
+  EXPECT_FALSE(is_text_merge(options));
+
+  MergeOptions full;
+  RecordingSink expected;
+  StreamSink expected_sink(expected, 0);
+  merge_with_policy<ExactStreamPolicy>(BASE, OURS, THEIRS, full,
+                                       expected_sink);
+  RecordingSink text;
+  StreamSink text_sink(text, 0);
+  merge_with_policy<TextStreamPolicy>(BASE, OURS, THEIRS, full, text_sink);
+  EXPECT_EQ(text.lines, expected.lines);
+  EXPECT_EQ(text.starts, expected.starts);
+  ASSERT_EQ(text.analyses.size(), 1);
+  EXPECT_EQ(text.analyses[0], AnalysisLevel::NONE);
+}
@@ -0,0 +1,152 @@
+/**
+ * @file test_merge_session.cpp
+ * @brief Unit tests for the incremental merge session
+ */
+
+#include "wizardmerge/merge/merge_session.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+
+using namespace wizardmerge::merge;
+
+namespace {
+
+std::vector<std::string> make_file(size_t lines) {
+  std::vector<std::string> file;
+  for (size_t i = 0; i < lines; ++i) {
+    file.push_back(i % 50 == 0
+                       ? "int function_" + std::to_string(i) + "(int x) {"
+                       : "  value_" + std::to_string(i) + " += x;");
+  }
+  return file;
+}
+
+/**
+ * Checks the session against a full merge of its current inputs
+ */
+void expect_matches_full_merge(const MergeSession &session) {
+  auto expected =
+      three_way_merge(session.base(), session.ours(), session.theirs());
+  auto actual = session.result();
+
+  ASSERT_EQ(actual.merged_lines.size(), expected.merged_lines.size());
+  for (size_t i = 0; i < expected.merged_lines.size(); ++i) {
+    EXPECT_EQ(actual.merged_lines[i].content,
+              expected.merged_lines[i].content);
+  }
+  ASSERT_EQ(actual.conflicts.size(), expected.conflicts.size());
+  for (size_t i = 0; i < expected.conflicts.size(); ++i) {
+    const Conflict &want = expected.conflicts[i];
+    const Conflict &got = actual.conflicts[i];
+    EXPECT_EQ(got.start_line, want.start_line);
+    EXPECT_EQ(got.our_range.begin, want.our_range.begin);
+    EXPECT_EQ(got.their_range.end, want.their_range.end);
+    EXPECT_EQ(got.context.start_line, want.context.start_line);
+    EXPECT_EQ(got.context.function_name, want.context.function_name);
+    EXPECT_EQ(got.risk_both.risk_factors, want.risk_both.risk_factors);
+  }
+}
+
+} // namespace
+
+/**
+ * Test the initial session result equals a full merge
+ */
+TEST(MergeSessionTest, InitialResultMatchesFullMerge) {
+  auto base = make_file(5000);
+  auto ours = base;
+  auto theirs = base;
+  ours[1203] = "  ours_change();";
+  theirs[1203] = "  theirs_change();";
+  theirs[4001] = "  theirs_only();";
+
+  MergeSession session(base, ours, theirs);
+  EXPECT_GT(session.chunk_count(), 1);
+  expect_matches_full_merge(session);
+  EXPECT_EQ(session.result().conflicts.size(), 1);
+}
+
+/**
+ * Test edits re-merge only nearby chunks and keep the result exact
+ */
+TEST(MergeSessionTest, EditsStayLocal) {
+  auto base = make_file(20000);
+  auto ours = base;
+  auto theirs = base;
+  ours[10007] = "  ours_change();";
+  theirs[10007] = "  theirs_change();";
+
+  MergeSession session(base, ours, theirs);
+  size_t whole = session.remerged_lines();
+
+  // Replace, insert and delete in ours, then edit theirs
+  ASSERT_TRUE(session.apply_edit(EditTarget::OURS, 300, 301, {"  edited;"}));
+  expect_matches_full_merge(session);
+  EXPECT_LT(session.remerged_lines() * 20, whole);
+
+  ASSERT_TRUE(session.apply_edit(EditTarget::OURS, 5000, 5000,
+                                 {"  inserted_1;", "  inserted_2;"}));
+  expect_matches_full_merge(session);
+  EXPECT_LT(session.remerged_lines() * 20, whole);
+
+  ASSERT_TRUE(session.apply_edit(EditTarget::OURS, 15000, 15003, {}));
+  expect_matches_full_merge(session);
+
+  ASSERT_TRUE(session.apply_edit(EditTarget::THEIRS, 12000, 12001,
+                                 {"  theirs_edit;"}));
+  expect_matches_full_merge(session);
+  EXPECT_LT(session.remerged_lines() * 20, whole);
+
+  // The conflict below the insertion keeps its analysis, rebased
+  EXPECT_EQ(session.result().conflicts.size(), 1);
+}
+
+/**
+ * Test a result edit over a conflict resolves it
+ */
+TEST(MergeSessionTest, ResultEditResolvesConflict) {
+  auto base = make_file(3000);
+  auto ours = base;
+  auto theirs = base;
+  ours[700] = "  ours_change();";
+  theirs[700] = "  theirs_change();";
+  ours[2500] = "  ours_other();";
+  theirs[2500] = "  theirs_other();";
+
+  MergeSession session(base, ours, theirs);
+  auto before = session.result();
+  ASSERT_EQ(before.conflicts.size(), 2);
+  size_t begin = before.conflicts[0].start_line;
+  size_t end = before.conflicts[0].end_line + 1;
+
+  // Only whole conflicts can be replaced, markers included
+  EXPECT_FALSE(session.apply_edit(EditTarget::RESULT, begin, end - 1, {}));
+  EXPECT_FALSE(session.apply_edit(EditTarget::RESULT, begin, end + 1, {}));
+  EXPECT_FALSE(session.apply_edit(EditTarget::RESULT, 0, 1, {}));
+  EXPECT_FALSE(session.apply_edit(EditTarget::OURS, 10, 5, {}));
+  EXPECT_FALSE(session.apply_edit(EditTarget::THEIRS, 0, 3001, {}));
+
+  ASSERT_TRUE(session.apply_edit(EditTarget::RESULT, begin, end,
+                                 {"  resolved();"}));
+  auto after = session.result();
+  ASSERT_EQ(after.conflicts.size(), 1);
+  EXPECT_EQ(std::string_view(after.merged_lines[begin].content),
+            "  resolved();");
+  EXPECT_EQ(session.ours()[700], "  resolved();");
+  EXPECT_EQ(session.theirs()[700], "  resolved();");
+  expect_matches_full_merge(session);
+}
+
+/**
+ * Test sessions over empty and tiny inputs
+ */
+TEST(MergeSessionTest, SmallInputs) {
+  MergeSession empty({}, {}, {});
+  EXPECT_EQ(empty.chunk_count(), 1);
+  EXPECT_TRUE(empty.result().merged_lines.empty());
+
+  ASSERT_TRUE(empty.apply_edit(EditTarget::OURS, 0, 0, {"a", "b"}));
+  expect_matches_full_merge(empty);
+  EXPECT_EQ(empty.result().merged_lines.size(), 2);
+}
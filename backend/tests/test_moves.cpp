@@ -0,0 +1,59 @@
+/**
+ * @file test_moves.cpp
+ * @brief Unit tests for moved-block detection
+ */
+
+#include "wizardmerge/merge/moves.h"
+#include <gtest/gtest.h>
+
+using namespace wizardmerge::merge;
+
+/**
+ * Test a block deleted in one place and inserted in another is a move
+ */
+TEST(MovesTest, FindsMovedBlock) {
+  std::vector<LineId> base = {1, 2, 3, 4, 5, 6, 7, 8};
+  std::vector<LineId> other = {1, 5, 6, 7, 8, 2, 3, 4};
+
+  auto moves = find_moves(base, other, myers_diff(base, other));
+
+  ASSERT_EQ(moves.size(), 1);
+  EXPECT_EQ(moves[0].size(), 3);
+  EXPECT_EQ(other[moves[0].other_begin], base[moves[0].base_begin]);
+  for (size_t i = 0; i < moves[0].size(); ++i) {
+    EXPECT_EQ(other[moves[0].other_begin + i], base[moves[0].base_begin + i]);
+  }
+}
+
+/**
+ * Test short blocks and copies of kept lines are not moves
+ */
+TEST(MovesTest, IgnoresShortBlocksAndCopies) {
+  std::vector<LineId> base = {1, 2, 3, 4, 5, 6};
+  std::vector<LineId> swapped = {1, 4, 5, 6, 2, 3};
+  std::vector<LineId> copied = {1, 2, 3, 4, 5, 6, 1, 2, 3};
+
+  // The diff keeps 4 5 6 and moves 2 3, one line short of a move
+  EXPECT_TRUE(find_moves(base, swapped, myers_diff(base, swapped)).empty());
+  auto swaps = find_moves(base, swapped, myers_diff(base, swapped), 2);
+  ASSERT_EQ(swaps.size(), 1);
+  EXPECT_EQ(swaps[0].base_begin, 1);
+  EXPECT_EQ(swaps[0].other_begin, 4);
+
+  EXPECT_TRUE(find_moves(base, copied, myers_diff(base, copied)).empty());
+}
+
+/**
+ * Test every base line moves at most once
+ */
+TEST(MovesTest, BaseLinesMoveOnce) {
+  std::vector<LineId> base = {1, 2, 3, 9, 9, 9, 9};
+  std::vector<LineId> other = {9, 9, 9, 9, 1, 2, 3, 1, 2, 3};
+  std::vector<DiffHunk> hunks = {{0, 3, 0, 0}, {7, 0, 4, 6}};
+
+  auto moves = find_moves(base, other, hunks);
+
+  ASSERT_EQ(moves.size(), 1);
+  EXPECT_EQ(moves[0].base_begin, 0);
+  EXPECT_EQ(moves[0].other_begin, 4);
+}
@@ -0,0 +1,176 @@
+/**
+ * @file test_normalize.cpp
+ * @brief Unit tests for encoding and line-ending normalization
+ */
+
+#include "wizardmerge/text/normalize.h"
+#include <gtest/gtest.h>
+
+using namespace wizardmerge::text;
+
+namespace {
+
+/**
+ * Encodes ASCII text as UTF-16 in the given byte order
+ */
+std::string utf16(std::string_view ascii, bool big_endian) {
+  std::string out;
+  for (char c : ascii) {
+    out.push_back(big_endian ? '\0' : c);
+    out.push_back(big_endian ? c : '\0');
+  }
+  return out;
+}
+
+/**
+ * Normalizes and restores text, checking the round trip is lossless
+ */
+std::string normalized(const std::string &data, TextFormat &format) {
+  std::string out;
+  EXPECT_TRUE(normalize_text(data, out, format));
+  std::string text = format.converted ? out : data;
+  std::string restored;
+  restore_text(text, format, restored);
+  EXPECT_EQ(restored, data);
+  return text;
+}
+
+} // namespace
+
+/**
+ * Test UTF-8 without carriage returns or BOM is left as is
+ */
+TEST(NormalizeTest, LeavesNormalizedText) {
+  TextFormat format;
+  std::string out;
+  ASSERT_TRUE(normalize_text("caf\xc3\xa9\nline\n", out, format));
+  EXPECT_FALSE(format.converted);
+  EXPECT_TRUE(out.empty());
+  EXPECT_EQ(format.encoding, TextEncoding::UTF8);
+  EXPECT_FALSE(format.bom);
+  EXPECT_EQ(format.line_ending, LineEnding::LF);
+
+  ASSERT_TRUE(normalize_text("", out, format));
+  EXPECT_FALSE(format.converted);
+}
+
+/**
+ * Test CRLF line endings and the UTF-8 BOM are stripped and restored
+ */
+TEST(NormalizeTest, StripsCrlfAndBom) {
+  TextFormat format;
+  std::string long_line(70, 'x');
+  EXPECT_EQ(normalized("a\r\n" + long_line + "\r\n\r\nb", format),
+            "a\n" + long_line + "\n\nb");
+  EXPECT_EQ(format.line_ending, LineEnding::CRLF);
+  EXPECT_FALSE(format.bom);
+
+  EXPECT_EQ(normalized("\xEF\xBB\xBFone\ntwo", format), "one\ntwo");
+  EXPECT_TRUE(format.bom);
+  EXPECT_TRUE(format.converted);
+  EXPECT_EQ(format.line_ending, LineEnding::LF);
+
+  EXPECT_EQ(normalized("\xEF\xBB\xBF\xe2\x82\xac\r\n", format),
+            "\xe2\x82\xac\n");
+  EXPECT_TRUE(format.bom);
+  EXPECT_EQ(format.line_ending, LineEnding::CRLF);
+}
+
+/**
+ * Test lone carriage returns are content, and mixed endings are restored
+ * with the first line's
+ */
+TEST(NormalizeTest, HandlesLoneAndMixedCarriageReturns) {
+  TextFormat format;
+  std::string out;
+  ASSERT_TRUE(normalize_text("a\rb\n", out, format));
+  EXPECT_FALSE(format.converted);
+
+  ASSERT_TRUE(normalize_text("a\nb\r\nc\r", out, format));
+  EXPECT_EQ(out, "a\nb\nc\r");
+  EXPECT_EQ(format.line_ending, LineEnding::LF);
+
+  std::string restored;
+  ASSERT_TRUE(normalize_text("a\r\nb\n", out, format));
+  restore_text(out, format, restored);
+  EXPECT_EQ(restored, "a\r\nb\r\n");
+}
+
+/**
+ * Test UTF-16 in either byte order, with and without a BOM
+ */
+TEST(NormalizeTest, DecodesUtf16) {
+  TextFormat format;
+  for (bool big_endian : {false, true}) {
+    SCOPED_TRACE(big_endian ? "big endian" : "little endian");
+    std::string data = utf16("one\r\ntwo\r\n", big_endian);
+    EXPECT_EQ(normalized(data, format), "one\ntwo\n");
+    EXPECT_EQ(format.encoding, big_endian ? TextEncoding::UTF16BE
+                                          : TextEncoding::UTF16LE);
+    EXPECT_FALSE(format.bom);
+    EXPECT_EQ(format.line_ending, LineEnding::CRLF);
+
+    std::string bom = big_endian ? "\xFE\xFF" : "\xFF\xFE";
+    EXPECT_EQ(normalized(bom + utf16("x\n", big_endian), format), "x\n");
+    EXPECT_TRUE(format.bom);
+    EXPECT_EQ(format.line_ending, LineEnding::LF);
+  }
+
+  // U+20AC and U+1F600 (a surrogate pair)
+  std::string data = std::string("\xFF\xFE\xAC\x20\x3D\xD8\x00\xDE", 8);
+  EXPECT_EQ(normalized(data, format), "\xe2\x82\xac\xf0\x9f\x98\x80");
+  EXPECT_EQ(text_encoding_to_string(format.encoding), std::string("utf-16le"));
+}
+
+/**
+ * Test malformed input is rejected
+ */
+TEST(NormalizeTest, RejectsMalformedInput) {
+  TextFormat format;
+  std::string out;
+  EXPECT_FALSE(normalize_text(std::string("a\0b", 3), out, format));
+  EXPECT_FALSE(normalize_text("caf\xe9\r\n", out, format));
+  EXPECT_FALSE(normalize_text("\xEF\xBB\xBF\xc3", out, format));
+
+  // Unpaired surrogates and odd lengths
+  EXPECT_FALSE(normalize_text(std::string("\xFF\xFE\x3D\xD8", 4), out,
+                              format));
+  EXPECT_FALSE(normalize_text(std::string("\xFF\xFE\x00\xDE\x41\x00", 6),
+                              out, format));
+  EXPECT_FALSE(normalize_text(std::string("\xFF\xFE\x41\x00\x42", 5), out,
+                              format));
+}
+
+/**
+ * Test restoring to UTF-16 replaces malformed UTF-8
+ */
+TEST(NormalizeTest, RestoresMalformedTextAsReplacement) {
+  TextFormat format;
+  format.encoding = TextEncoding::UTF16LE;
+  std::string out;
+  restore_text("A\xff", format, out);
+  EXPECT_EQ(out, std::string("\x41\x00\xFD\xFF", 4));
+}
+
+/**
+ * Test lines that arrive split lose their BOM and carriage returns
+ */
+TEST(NormalizeTest, NormalizesSplitLines) {
+  TextFormat format;
+  std::vector<std::string_view> lines = {"\xEF\xBB\xBF" "a\r", "b\r", "c"};
+  normalize_lines(lines, format);
+  EXPECT_EQ(lines, (std::vector<std::string_view>{"a", "b", "c"}));
+  EXPECT_TRUE(format.bom);
+  EXPECT_TRUE(format.converted);
+  EXPECT_EQ(format.line_ending, LineEnding::CRLF);
+
+  lines = {"a", "b\r"};
+  normalize_lines(lines, format);
+  EXPECT_EQ(lines, (std::vector<std::string_view>{"a", "b"}));
+  EXPECT_FALSE(format.bom);
+  EXPECT_EQ(format.line_ending, LineEnding::LF);
+
+  lines = {};
+  normalize_lines(lines, format);
+  EXPECT_FALSE(format.converted);
+}
@@ -0,0 +1,222 @@
+/**
+ * @file test_nway_merge.cpp
+ * @brief Unit tests for the N-way merge
+ */
+
+#include "wizardmerge/merge/nway_merge.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace wizardmerge::merge;
+
+namespace {
+
+using Lines = std::vector<std::string_view>;
+
+std::vector<std::string> contents(const std::vector<Line> &lines) {
+  std::vector<std::string> out;
+  for (const auto &line : lines) {
+    out.emplace_back(line.content);
+  }
+  return out;
+}
+
+} // namespace
+
+/**
+ * Test edits of three branches to different lines are all applied
+ */
+TEST(NWayMergeTest, AppliesDisjointEdits) {
+  Lines base = {"a", "b", "c", "d", "e", "f", "g"};
+  Lines one = {"A", "b", "c", "d", "e", "f", "g"};
+  Lines two = {"a", "b", "c", "D", "e", "f", "g"};
+  Lines three = {"a", "b", "c", "d", "e", "f", "g", "h"};
+  NWayMergeResult result =
+      nway_merge(base, {one, two, three}, {"one", "two", "three"});
+  EXPECT_FALSE(result.has_conflicts());
+  EXPECT_EQ(contents(result.merged_lines),
+            (std::vector<std::string>{"A", "b", "c", "D", "e", "f", "g",
+                                      "h"}));
+  EXPECT_EQ(result.merged_lines[0].origin, Line::OURS);
+  EXPECT_EQ(result.merged_lines[3].origin, Line::THEIRS);
+  EXPECT_EQ(result.merged_lines[1].origin, Line::BASE);
+}
+
+/**
+ * Test branches making the same change agree instead of conflicting
+ */
+TEST(NWayMergeTest, SameChangeFromSeveralBranches) {
+  Lines base = {"x", "y", "z"};
+  Lines fix = {"x", "Y", "z"};
+  NWayMergeResult result = nway_merge(base, {fix, base, fix, fix}, {});
+  EXPECT_FALSE(result.has_conflicts());
+  ASSERT_EQ(result.merged_lines.size(), 3u);
+  EXPECT_EQ(result.merged_lines[1].content, "Y");
+  EXPECT_EQ(result.merged_lines[1].origin, Line::MERGED);
+}
+
+/**
+ * Test a conflict names the branches on each side and leaves out the
+ * branches that did not touch it
+ */
+TEST(NWayMergeTest, ConflictNamesParticipatingBranches) {
+  Lines base = {"int f() {", "  return 1;", "}", "", "int g();"};
+  Lines two = {"int f() {", "  return 2;", "}", "", "int g();"};
+  Lines three = {"int f() {", "  return 3;", "}", "", "int g();"};
+  Lines other = {"int f() {", "  return 1;", "}", "", "int h();"};
+  NWayMergeResult result = nway_merge(
+      base, {two, other, three, two}, {"release-2", "docs", "release-3",
+                                       "hotfix"});
+  ASSERT_EQ(result.conflicts.size(), 1u);
+  const NWayConflict &conflict = result.conflicts[0];
+  ASSERT_EQ(conflict.sides.size(), 2u);
+  EXPECT_EQ(conflict.sides[0].branches, (std::vector<size_t>{0, 3}));
+  EXPECT_EQ(conflict.sides[1].branches, (std::vector<size_t>{2}));
+  EXPECT_EQ(conflict.base_range.begin, 1u);
+  EXPECT_EQ(conflict.base_range.end, 2u);
+  ASSERT_EQ(conflict.base_lines.size(), 1u);
+  EXPECT_EQ(conflict.base_lines[0].content, "  return 1;");
+  EXPECT_EQ(conflict.sides[1].lines[0].origin, Line::THEIRS);
+
+  EXPECT_EQ(contents(result.merged_lines),
+            (std::vector<std::string>{"int f() {", "<<<<<<< release-2, hotfix",
+                                      "  return 2;", "=======",
+                                      "  return 3;", ">>>>>>> release-3", "}",
+                                      "", "int h();"}));
+  EXPECT_EQ(conflict.start_line, 1u);
+  EXPECT_EQ(conflict.end_line, 5u);
+}
+
+/**
+ * Test more than two sides, with the base section and default names
+ */
+TEST(NWayMergeTest, MarksEverySide) {
+  Lines base = {"a", "b", "c"};
+  Lines one = {"a", "1", "c"};
+  Lines two = {"a", "2", "c"};
+  Lines three = {"a", "3", "c"};
+  MergeOptions options;
+  options.show_base = true;
+  NWayMergeResult result = nway_merge(base, {one, two, three}, {"one"},
+                                      options);
+  ASSERT_EQ(result.conflicts.size(), 1u);
+  EXPECT_EQ(result.conflicts[0].sides.size(), 3u);
+  EXPECT_EQ(contents(result.merged_lines),
+            (std::vector<std::string>{"a", "<<<<<<< one", "1",
+                                      "||||||| BASE", "b",
+                                      "======= branch 1", "2",
+                                      "======= branch 2", "3",
+                                      ">>>>>>> branch 2", "c"}));
+
+  NWayMergeResult none = nway_merge(base, {}, {});
+  EXPECT_EQ(contents(none.merged_lines),
+            (std::vector<std::string>{"a", "b", "c"}));
+}
+
+/**
+ * Test conflicts close together are combined, with the lines of a branch
+ * that changed only one of them
+ */
+TEST(NWayMergeTest, CombinesCloseConflicts) {
+  Lines base = {"0", "1", "2", "3", "4", "5"};
+  Lines one = {"0", "A", "2", "3", "4", "5"};
+  Lines two = {"0", "B", "2", "3", "C", "5"};
+  Lines three = {"0", "1", "2", "3", "D", "5"};
+  NWayMergeResult result = nway_merge(base, {one, two, three}, {});
+  ASSERT_EQ(result.conflicts.size(), 1u);
+  const NWayConflict &conflict = result.conflicts[0];
+  ASSERT_EQ(conflict.sides.size(), 3u);
+  EXPECT_EQ(contents(conflict.sides[0].lines),
+            (std::vector<std::string>{"A", "2", "3", "4"}));
+  EXPECT_EQ(contents(conflict.sides[1].lines),
+            (std::vector<std::string>{"B", "2", "3", "C"}));
+  EXPECT_EQ(contents(conflict.sides[2].lines),
+            (std::vector<std::string>{"1", "2", "3", "D"}));
+  EXPECT_EQ(conflict.sides[2].range.begin, 1u);
+}
+
+/**
+ * Test two branches merge exactly like three_way_merge, serially and on
+ * the pool
+ */
+TEST(NWayMergeTest, MatchesThreeWayMerge) {
+  std::mt19937 rng(7);
+  std::vector<std::string> words = {"a", "b", "c", "d", "e", "f"};
+  auto mutate = [&](const std::vector<std::string> &src) {
+    std::vector<std::string> out;
+    for (const auto &line : src) {
+      switch (rng() % 12) {
+      case 0:
+        break;
+      case 1:
+        out.push_back(words[rng() % words.size()]);
+        break;
+      case 2:
+        out.push_back(line);
+        out.push_back(words[rng() % words.size()]);
+        break;
+      default:
+        out.push_back(line);
+      }
+    }
+    return out;
+  };
+
+  auto check = [](Lines base, Lines ours, Lines theirs,
+                  const MergeOptions &options) {
+    MergeResult expected = three_way_merge(base, ours, theirs, options);
+    NWayMergeResult result =
+        nway_merge(base, {ours, theirs}, {"OURS", "THEIRS"}, options);
+
+    ASSERT_EQ(result.merged_lines.size(), expected.merged_lines.size());
+    for (size_t i = 0; i < result.merged_lines.size(); ++i) {
+      ASSERT_EQ(result.merged_lines[i].content,
+                expected.merged_lines[i].content)
+          << "line " << i;
+      ASSERT_EQ(result.merged_lines[i].origin,
+                expected.merged_lines[i].origin)
+          << "line " << i;
+    }
+    ASSERT_EQ(result.conflicts.size(), expected.conflicts.size());
+    for (size_t i = 0; i < result.conflicts.size(); ++i) {
+      EXPECT_EQ(result.conflicts[i].start_line,
+                expected.conflicts[i].start_line);
+      EXPECT_EQ(result.conflicts[i].end_line, expected.conflicts[i].end_line);
+      EXPECT_EQ(result.conflicts[i].base_range.begin,
+                expected.conflicts[i].base_range.begin);
+    }
+  };
+
+  // Each side trims its own prefix before its suffix, so a line shared by
+  // all three at one end is not necessarily stable
+  MergeOptions plain;
+  plain.analysis = AnalysisLevel::NONE;
+  check({"a", "a"}, {"a"}, {"A", "a"}, plain);
+  check({"a", "a"}, {"A", "a"}, {"a"}, plain);
+  check({"x", "a", "x"}, {"x"}, {"x", "a", "b", "x"}, plain);
+
+  // Lines equivalent under options.compare are shared too
+  MergeOptions loose = plain;
+  loose.compare.ignore_case = true;
+  check({"a", "a", "b"}, {"A", "x", "B"}, {"a", "A", "b", "c"}, loose);
+  check({"a", "a"}, {"A"}, {"b", "a"}, loose);
+
+  for (int round = 0; round < 200; ++round) {
+    size_t size = round < 190 ? 30 : 6000;
+    std::vector<std::string> base_text;
+    for (size_t i = 0; i < size; ++i) {
+      base_text.push_back(size > 30 ? std::to_string(rng() % 1000)
+                                    : words[rng() % words.size()]);
+    }
+    std::vector<std::string> ours_text = mutate(base_text);
+    std::vector<std::string> theirs_text = mutate(base_text);
+
+    MergeOptions options = plain;
+    options.show_base = round % 2 == 1;
+    options.threads = round % 3 == 0 ? 4 : 1;
+    SCOPED_TRACE("round " + std::to_string(round));
+    check(Lines(base_text.begin(), base_text.end()),
+          Lines(ours_text.begin(), ours_text.end()),
+          Lines(theirs_text.begin(), theirs_text.end()), options);
+  }
+}
@@ -0,0 +1,141 @@
+/**
+ * @file test_recursive_merge.cpp
+ * @brief Unit tests for the recursive merge strategy
+ */
+
+#include "wizardmerge/merge/recursive_merge.h"
+#include <gtest/gtest.h>
+
+using namespace wizardmerge::merge;
+
+namespace {
+
+using Lines = std::vector<std::string_view>;
+
+std::vector<std::string> contents(const std::pmr::vector<Line> &lines) {
+  std::vector<std::string> out;
+  for (const auto &line : lines) {
+    out.emplace_back(line.content);
+  }
+  return out;
+}
+
+/**
+ * @brief Criss-cross history: two branches of a root, each merged into
+ *        both ours and theirs.
+ */
+std::vector<Revision> criss_cross(Lines root, Lines left, Lines right,
+                                  Lines ours, Lines theirs) {
+  return {{root, {}},
+          {left, {0}},
+          {right, {0}},
+          {ours, {1, 2}},
+          {theirs, {2, 1}}};
+}
+
+} // namespace
+
+/**
+ * Test merge bases of linear, criss-cross and unrelated histories
+ */
+TEST(RecursiveMergeTest, FindsMergeBases) {
+  std::vector<Revision> history = criss_cross({}, {}, {}, {}, {});
+  history.push_back({{}, {3}}); // Child of ours
+  history.push_back({{}, {}});  // Unrelated root
+
+  EXPECT_EQ(merge_bases(history, 3, 4), (std::vector<size_t>{1, 2}));
+  EXPECT_EQ(merge_bases(history, 5, 4), (std::vector<size_t>{1, 2}));
+  EXPECT_EQ(merge_bases(history, 1, 2), (std::vector<size_t>{0}));
+  EXPECT_EQ(merge_bases(history, 5, 1), (std::vector<size_t>{1}));
+  EXPECT_EQ(merge_bases(history, 3, 3), (std::vector<size_t>{3}));
+  EXPECT_TRUE(merge_bases(history, 6, 3).empty());
+}
+
+/**
+ * Test a criss-cross merge conflicts against either base alone but merges
+ * cleanly against the virtual ancestor
+ */
+TEST(RecursiveMergeTest, AvoidsSpuriousConflicts) {
+  Lines root = {"a", "b", "c"};
+  Lines left = {"a1", "b", "c"};
+  Lines right = {"a", "b", "c2"};
+  Lines ours = {"a1", "b", "c2", "o"};
+  Lines theirs = {"a1", "bT", "c2"};
+  std::vector<Revision> history = criss_cross(root, left, right, ours,
+                                              theirs);
+
+  EXPECT_TRUE(three_way_merge(left, ours, theirs).has_conflicts());
+  EXPECT_TRUE(three_way_merge(right, ours, theirs).has_conflicts());
+
+  MergeResult result = recursive_merge(history, 3, 4);
+  EXPECT_FALSE(result.has_conflicts());
+  EXPECT_EQ(contents(result.merged_lines),
+            (std::vector<std::string>{"a1", "bT", "c2", "o"}));
+}
+
+/**
+ * Test conflicting bases leave longer markers in the virtual ancestor,
+ * which only conflict again where ours and theirs resolved differently
+ */
+TEST(RecursiveMergeTest, KeepsConflictsInVirtualAncestor) {
+  Lines root = {"x = 0;", "a", "b", "c", "d", "y = 0;"};
+  Lines left = {"x = 1;", "a", "b", "c", "d", "y = 0;"};
+  Lines right = {"x = 2;", "a", "b", "c", "d", "y = 0;"};
+  Lines resolved = {"x = 1;", "a", "b", "c", "d", "y = 0;"};
+  Lines edited = {"x = 1;", "a", "b", "c", "d", "y = 5;"};
+  Lines other = {"x = 3;", "a", "b", "c", "d", "y = 0;"};
+
+  // Both resolved the bases' conflict alike; only the edit far from it
+  // is merged in
+  MergeResult same =
+      recursive_merge(criss_cross(root, left, right, resolved, edited), 3, 4);
+  EXPECT_FALSE(same.has_conflicts());
+  EXPECT_EQ(contents(same.merged_lines),
+            (std::vector<std::string>{"x = 1;", "a", "b", "c", "d",
+                                      "y = 5;"}));
+
+  MergeOptions options;
+  options.analysis = AnalysisLevel::NONE;
+  MergeResult differ = recursive_merge(
+      criss_cross(root, left, right, resolved, other), 3, 4, options);
+  ASSERT_EQ(differ.conflicts.size(), 1u);
+  const Conflict &conflict = differ.conflicts[0];
+  EXPECT_EQ(contents(conflict.our_lines), (std::vector<std::string>{"x = 1;"}));
+  EXPECT_EQ(contents(conflict.their_lines),
+            (std::vector<std::string>{"x = 3;"}));
+  EXPECT_EQ(contents(conflict.base_lines),
+            (std::vector<std::string>{"<<<<<<<<< revision 1", "x = 1;",
+                                      "=========", "x = 2;",
+                                      ">>>>>>>>> revision 2"}));
+}
+
+/**
+ * Test more than two merge bases, a single base and unrelated histories
+ */
+TEST(RecursiveMergeTest, HandlesOtherHistories) {
+  Lines root = {"a", "b", "c", "d"};
+  std::vector<Revision> history = {{root, {}},
+                                   {{"A", "b", "c", "d"}, {0}},
+                                   {{"a", "B", "c", "d"}, {0}},
+                                   {{"a", "b", "C", "d"}, {0}},
+                                   {{"A", "B", "C", "d"}, {1, 2, 3}},
+                                   {{"A", "B", "C", "D"}, {3, 2, 1}}};
+  ASSERT_EQ(merge_bases(history, 4, 5).size(), 3u);
+  MergeResult result = recursive_merge(history, 4, 5);
+  EXPECT_FALSE(result.has_conflicts());
+  EXPECT_EQ(contents(result.merged_lines),
+            (std::vector<std::string>{"A", "B", "C", "D"}));
+
+  // One merge base: a plain three-way merge
+  MergeResult single = recursive_merge(history, 1, 2);
+  EXPECT_EQ(contents(single.merged_lines),
+            contents(three_way_merge(root, history[1].lines,
+                                     history[2].lines)
+                         .merged_lines));
+
+  // No common history: merged against an empty file
+  std::vector<Revision> unrelated = {{root, {}}, {root, {}}};
+  MergeResult added = recursive_merge(unrelated, 0, 1);
+  EXPECT_FALSE(added.has_conflicts());
+  EXPECT_EQ(added.merged_lines.size(), root.size());
+}
@@ -0,0 +1,112 @@
+/**
+ * @file test_refine.cpp
+ * @brief Unit tests for token-level conflict refinement
+ */
+
+#include "wizardmerge/merge/refine.h"
+#include "wizardmerge/merge/three_way_merge.h"
+#include <gtest/gtest.h>
+
+using namespace wizardmerge::merge;
+
+/**
+ * Test tokens split words, whitespace and punctuation
+ */
+TEST(RefineTest, Tokenize) {
+  auto tokens = tokenize("  foo_1(bar, \t\"é\");");
+
+  std::vector<std::string_view> expected = {
+      "  ", "foo_1", "(", "bar", ",", " \t", "\"", "é", "\"", ")", ";"};
+  EXPECT_EQ(tokens, expected);
+  EXPECT_TRUE(tokenize("").empty());
+}
+
+/**
+ * Test edits to different tokens of one line are merged
+ */
+TEST(RefineTest, MergesDisjointIntraLineEdits) {
+  std::vector<std::string_view> base = {"call(alpha, beta);"};
+  std::vector<std::string_view> ours = {"call(first, beta);"};
+  std::vector<std::string_view> theirs = {"call(alpha, second);"};
+
+  auto refinement = refine_conflict(base, ours, theirs);
+
+  ASSERT_TRUE(refinement.resolved);
+  ASSERT_EQ(refinement.merged_lines.size(), 1);
+  EXPECT_EQ(refinement.merged_lines[0], "call(first, second);");
+}
+
+/**
+ * Test overlapping edits stay a conflict with the changed tokens reported
+ */
+TEST(RefineTest, ReportsSpansForOverlappingEdits) {
+  std::vector<std::string_view> base = {"int x = 1;", "int y = 2;"};
+  std::vector<std::string_view> ours = {"int x = 10;", "int y = 2;"};
+  std::vector<std::string_view> theirs = {"int x = 20;", "long y = 2;"};
+
+  auto refinement = refine_conflict(base, ours, theirs);
+
+  EXPECT_FALSE(refinement.resolved);
+  ASSERT_EQ(refinement.our_changes.size(), 1);
+  EXPECT_EQ(refinement.our_changes[0].line, 0);
+  EXPECT_EQ(refinement.our_changes[0].begin, 8);
+  EXPECT_EQ(refinement.our_changes[0].end, 10);
+  ASSERT_EQ(refinement.their_changes.size(), 2);
+  EXPECT_EQ(refinement.their_changes[1].line, 1);
+  EXPECT_EQ(refinement.their_changes[1].begin, 0);
+  EXPECT_EQ(refinement.their_changes[1].end, 4);
+}
+
+/**
+ * Test a line split on one side merges with an edit on the other
+ */
+TEST(RefineTest, MergesAcrossLineBreaks) {
+  std::vector<std::string_view> base = {"a = f(x, y);"};
+  std::vector<std::string_view> ours = {"a = f(x,", "      y);"};
+  std::vector<std::string_view> theirs = {"b = f(x, y);"};
+
+  auto refinement = refine_conflict(base, ours, theirs);
+
+  ASSERT_TRUE(refinement.resolved);
+  std::vector<std::string> expected = {"b = f(x,", "      y);"};
+  EXPECT_EQ(refinement.merged_lines, expected);
+}
+
+/**
+ * Test the merge engine applies refinement only when asked to
+ */
+TEST(RefineTest, ThreeWayMergeOption) {
+  std::vector<std::string> base = {"header", "call(alpha, beta);", "x = 1;",
+                                   "footer"};
+  std::vector<std::string> ours = {"header", "call(first, beta);", "x = 2;",
+                                   "footer"};
+  std::vector<std::string> theirs = {"header", "call(alpha, second);",
+                                     "x = 3;", "footer"};
+
+  auto plain = three_way_merge(base, ours, theirs);
+  ASSERT_EQ(plain.conflicts.size(), 1);
+  EXPECT_TRUE(plain.conflicts[0].our_changes.empty());
+
+  MergeOptions options;
+  options.refine_conflicts = true;
+  auto refined = three_way_merge(base, ours, theirs, options);
+
+  // "x = 2" against "x = 3" still conflicts, so the hunk is kept whole
+  ASSERT_EQ(refined.conflicts.size(), 1);
+  const Conflict &conflict = refined.conflicts[0];
+  ASSERT_EQ(conflict.our_changes.size(), 2);
+  EXPECT_EQ(conflict.our_changes[0].line, 0);
+  EXPECT_EQ(conflict.our_lines[1].content.substr(
+                conflict.our_changes[1].begin,
+                conflict.our_changes[1].end - conflict.our_changes[1].begin),
+            "2");
+
+  base.erase(base.begin() + 2);
+  ours.erase(ours.begin() + 2);
+  theirs.erase(theirs.begin() + 2);
+  auto merged = three_way_merge(base, ours, theirs, options);
+  EXPECT_FALSE(merged.has_conflicts());
+  ASSERT_EQ(merged.merged_lines.size(), 3);
+  EXPECT_EQ(merged.merged_lines[1].content, "call(first, second);");
+  EXPECT_EQ(merged.merged_lines[1].origin, Line::MERGED);
+}
@@ -0,0 +1,177 @@
+/**
+ * @file test_result_codec.cpp
+ * @brief Unit tests for the binary MergeResult encoding
+ */
+
+#include "wizardmerge/merge/result_codec.h"
+#include <gtest/gtest.h>
+
+using namespace wizardmerge::merge;
+
+namespace {
+
+MergeResult conflicting_merge() {
+  std::vector<std::string> base = {"class Cache {", "  int get(int key) {",
+                                   "    return table[key];", "  }", "};"};
+  std::vector<std::string> ours = {"class Cache {", "  int get(int key) {",
+                                   "    return table.at(key);", "  }", "};"};
+  std::vector<std::string> theirs = {"class Cache {", "  int get(int key) {",
+                                     "    return lookup(key);", "  }", "};"};
+  MergeOptions options;
+  options.refine_conflicts = true;
+  return three_way_merge(base, ours, theirs, options);
+}
+
+void expect_same_lines(const std::pmr::vector<Line> &a,
+                       const std::pmr::vector<Line> &b) {
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(a[i].content, b[i].content);
+    EXPECT_EQ(a[i].origin, b[i].origin);
+  }
+}
+
+void expect_same_risk(const wizardmerge::analysis::RiskAssessment &a,
+                      const wizardmerge::analysis::RiskAssessment &b) {
+  EXPECT_EQ(a.level, b.level);
+  EXPECT_EQ(a.confidence_score, b.confidence_score);
+  EXPECT_EQ(a.risk_factors, b.risk_factors);
+  EXPECT_EQ(a.recommendations, b.recommendations);
+  EXPECT_EQ(a.has_syntax_changes, b.has_syntax_changes);
+  EXPECT_EQ(a.has_logic_changes, b.has_logic_changes);
+  EXPECT_EQ(a.has_api_changes, b.has_api_changes);
+  EXPECT_EQ(a.affects_multiple_functions, b.affects_multiple_functions);
+  EXPECT_EQ(a.affects_critical_section, b.affects_critical_section);
+}
+
+} // namespace
+
+/**
+ * Test a result with refined, fully analyzed conflicts survives a round trip
+ */
+TEST(ResultCodecTest, RoundTripsAnalyzedConflicts) {
+  MergeResult result = conflicting_merge();
+  ASSERT_TRUE(result.has_conflicts());
+  result.conflicts[0].context.metadata["language"] = "cpp";
+
+  std::string encoded = encode_merge_result(result);
+  EXPECT_EQ(encoded.size() % 8, 0u);
+
+  MergeResult decoded;
+  ASSERT_TRUE(decode_merge_result(encoded, decoded));
+  expect_same_lines(decoded.merged_lines, result.merged_lines);
+  ASSERT_EQ(decoded.conflicts.size(), result.conflicts.size());
+  for (size_t i = 0; i < result.conflicts.size(); ++i) {
+    const Conflict &a = decoded.conflicts[i];
+    const Conflict &b = result.conflicts[i];
+    EXPECT_EQ(a.start_line, b.start_line);
+    EXPECT_EQ(a.end_line, b.end_line);
+    EXPECT_EQ(a.base_range.begin, b.base_range.begin);
+    EXPECT_EQ(a.our_range.end, b.our_range.end);
+    EXPECT_EQ(a.their_range.end, b.their_range.end);
+    EXPECT_EQ(a.analysis, b.analysis);
+    expect_same_lines(a.base_lines, b.base_lines);
+    expect_same_lines(a.our_lines, b.our_lines);
+    expect_same_lines(a.their_lines, b.their_lines);
+    ASSERT_EQ(a.our_changes.size(), b.our_changes.size());
+    for (size_t s = 0; s < a.our_changes.size(); ++s) {
+      EXPECT_EQ(a.our_changes[s].line, b.our_changes[s].line);
+      EXPECT_EQ(a.our_changes[s].begin, b.our_changes[s].begin);
+      EXPECT_EQ(a.our_changes[s].end, b.our_changes[s].end);
+    }
+    EXPECT_EQ(a.their_changes.size(), b.their_changes.size());
+    EXPECT_EQ(a.context.function_name, b.context.function_name);
+    EXPECT_EQ(a.context.class_name, b.context.class_name);
+    EXPECT_EQ(a.context.surrounding_lines, b.context.surrounding_lines);
+    EXPECT_EQ(a.context.imports, b.context.imports);
+    EXPECT_EQ(a.context.metadata, b.context.metadata);
+    expect_same_risk(a.risk_ours, b.risk_ours);
+    expect_same_risk(a.risk_theirs, b.risk_theirs);
+    expect_same_risk(a.risk_both, b.risk_both);
+  }
+
+  // Encoding is deterministic and reuses the output buffer
+  std::string again = "stale";
+  encode_merge_result(decoded, again);
+  EXPECT_EQ(again, encoded);
+}
+
+/**
+ * Test the view reads lines and conflicts in place
+ */
+TEST(ResultCodecTest, ViewReadsInPlace) {
+  MergeResult result = conflicting_merge();
+  std::string encoded = encode_merge_result(result);
+
+  MergeResultView view;
+  ASSERT_TRUE(view.open(encoded));
+  ASSERT_EQ(view.line_count(), result.merged_lines.size());
+  const char *begin = encoded.data();
+  const char *end = begin + encoded.size();
+  for (size_t i = 0; i < view.line_count(); ++i) {
+    EXPECT_EQ(view.line(i), result.merged_lines[i].content);
+    EXPECT_EQ(view.origin(i), result.merged_lines[i].origin);
+    if (!view.line(i).empty()) {
+      EXPECT_GE(view.line(i).data(), begin);
+      EXPECT_LT(view.line(i).data(), end);
+    }
+  }
+
+  ASSERT_EQ(view.conflict_count(), 1u);
+  ConflictView conflict = view.conflict(0);
+  EXPECT_EQ(conflict.start_line(), result.conflicts[0].start_line);
+  EXPECT_EQ(conflict.analysis(), AnalysisLevel::FULL);
+  ASSERT_EQ(conflict.our_lines().size(), 1u);
+  EXPECT_EQ(conflict.our_lines()[0], "    return table.at(key);");
+  EXPECT_EQ(conflict.their_lines()[0], "    return lookup(key);");
+  EXPECT_EQ(conflict.our_lines().origin(0), Line::OURS);
+  EXPECT_EQ(conflict.our_change_count(),
+            result.conflicts[0].our_changes.size());
+}
+
+/**
+ * Test an empty result encodes to the header and offset table alone
+ */
+TEST(ResultCodecTest, EncodesEmptyResult) {
+  std::string encoded = encode_merge_result(MergeResult());
+  EXPECT_EQ(encoded.size(), 56u);
+
+  MergeResultView view;
+  ASSERT_TRUE(view.open(encoded));
+  EXPECT_EQ(view.line_count(), 0u);
+  EXPECT_FALSE(view.has_conflicts());
+}
+
+/**
+ * Test truncated, corrupt and foreign buffers are rejected
+ */
+TEST(ResultCodecTest, RejectsInvalidData) {
+  std::string encoded = encode_merge_result(conflicting_merge());
+  MergeResultView view;
+  MergeResult decoded;
+
+  for (size_t size = 0; size < encoded.size(); ++size) {
+    EXPECT_FALSE(view.open(std::string_view(encoded.data(), size)));
+  }
+  EXPECT_FALSE(decode_merge_result("not a merge result", decoded));
+
+  std::string bad_magic = encoded;
+  bad_magic[0] = 'X';
+  EXPECT_FALSE(view.open(bad_magic));
+
+  std::string bad_version = encoded;
+  bad_version[4] = 2;
+  EXPECT_FALSE(view.open(bad_version));
+
+  // First string offset past the end of the blob
+  std::string bad_offset = encoded;
+  bad_offset[48 + 8 + 7] = char(0x7f);
+  EXPECT_FALSE(view.open(bad_offset));
+
+  // Line count beyond the string table
+  std::string bad_count = encoded;
+  bad_count[16 + 7] = char(0x7f);
+  EXPECT_FALSE(view.open(bad_count));
+
+  EXPECT_TRUE(view.open(encoded));
+}
@@ -0,0 +1,141 @@
+/**
+ * @file test_streaming_merge.cpp
+ * @brief Unit tests for the bounded-memory streaming merge
+ */
+
+#include "wizardmerge/merge/streaming_merge.h"
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace wizardmerge::merge;
+
+namespace {
+
+/**
+ * @brief Sink collecting everything it receives.
+ */
+class CollectingSink : public MergeSink {
+public:
+  void write_line(std::string_view content, Line::Origin) override {
+    lines.emplace_back(content);
+  }
+  void write_conflict(const Conflict &conflict) override {
+    conflicts.push_back({conflict.start_line, conflict.end_line});
+  }
+
+  std::vector<std::string> lines;
+  std::vector<std::pair<size_t, size_t>> conflicts;
+};
+
+std::string join(const std::vector<std::string> &lines) {
+  std::string text;
+  for (const auto &line : lines) {
+    text += line + "\n";
+  }
+  return text;
+}
+
+StreamingStats stream_merge(const std::vector<std::string> &base,
+                            const std::vector<std::string> &ours,
+                            const std::vector<std::string> &theirs,
+                            CollectingSink &sink, size_t window_lines) {
+  std::istringstream base_in(join(base));
+  std::istringstream ours_in(join(ours));
+  std::istringstream theirs_in(join(theirs));
+  StreamingOptions options;
+  options.window_lines = window_lines;
+  return streaming_three_way_merge(base_in, ours_in, theirs_in, sink, options);
+}
+
+} // namespace
+
+/**
+ * Test small windows produce the same output as the in-memory merge
+ */
+TEST(StreamingMergeTest, MatchesInMemoryMerge) {
+  std::vector<std::string> base, ours, theirs;
+  for (int i = 0; i < 500; ++i) {
+    std::string line = "row " + std::to_string(i);
+    base.push_back(line);
+    ours.push_back(i % 37 == 0 ? line + " ours" : line);
+    theirs.push_back(i % 53 == 0 ? line + " theirs" : line);
+    if (i % 91 == 0) {
+      theirs.push_back("inserted after " + std::to_string(i));
+    }
+  }
+
+  auto expected = three_way_merge(base, ours, theirs);
+  CollectingSink sink;
+  auto stats = stream_merge(base, ours, theirs, sink, 16);
+
+  ASSERT_EQ(sink.lines.size(), expected.merged_lines.size());
+  for (size_t i = 0; i < sink.lines.size(); ++i) {
+    EXPECT_EQ(sink.lines[i],
+              std::string_view(expected.merged_lines[i].content));
+  }
+  ASSERT_EQ(sink.conflicts.size(), expected.conflicts.size());
+  for (size_t i = 0; i < sink.conflicts.size(); ++i) {
+    EXPECT_EQ(sink.conflicts[i].first, expected.conflicts[i].start_line);
+    EXPECT_EQ(sink.conflicts[i].second, expected.conflicts[i].end_line);
+  }
+  EXPECT_GT(stats.chunks, 1);
+  EXPECT_LT(stats.peak_window_lines, base.size());
+}
+
+/**
+ * Test conflicts are reported with absolute output line numbers
+ */
+TEST(StreamingMergeTest, ConflictLineNumbersAreAbsolute) {
+  std::vector<std::string> base, ours, theirs;
+  for (int i = 0; i < 100; ++i) {
+    base.push_back("line " + std::to_string(i));
+  }
+  ours = base;
+  theirs = base;
+  ours[80] = "ours edit";
+  theirs[80] = "theirs edit";
+
+  CollectingSink sink;
+  auto stats = stream_merge(base, ours, theirs, sink, 8);
+
+  ASSERT_EQ(sink.conflicts.size(), 1);
+  EXPECT_EQ(stats.conflicts, 1);
+  EXPECT_EQ(sink.lines[sink.conflicts[0].first], "<<<<<<< OURS");
+  EXPECT_EQ(sink.conflicts[0].first, 80);
+  EXPECT_EQ(sink.lines[sink.conflicts[0].second], ">>>>>>> THEIRS");
+  EXPECT_EQ(stats.lines_written, sink.lines.size());
+}
+
+/**
+ * Test a hunk larger than the window grows the window instead of
+ * cutting the hunk
+ */
+TEST(StreamingMergeTest, GrowsWindowForLargeHunks) {
+  std::vector<std::string> base = {"start", "end"};
+  std::vector<std::string> ours = {"start"};
+  for (int i = 0; i < 100; ++i) {
+    ours.push_back("added " + std::to_string(i));
+  }
+  ours.push_back("end");
+  std::vector<std::string> theirs = {"start", "end", "tail"};
+
+  CollectingSink sink;
+  auto stats = stream_merge(base, ours, theirs, sink, 4);
+
+  ASSERT_EQ(sink.lines.size(), 103);
+  EXPECT_TRUE(sink.conflicts.empty());
+  EXPECT_EQ(sink.lines[101], "end");
+  EXPECT_EQ(sink.lines[102], "tail");
+  EXPECT_GE(stats.peak_window_lines, 100);
+}
+
+/**
+ * Test empty inputs produce no output
+ */
+TEST(StreamingMergeTest, EmptyInputs) {
+  CollectingSink sink;
+  auto stats = stream_merge({}, {}, {}, sink, 4);
+
+  EXPECT_TRUE(sink.lines.empty());
+  EXPECT_EQ(stats.chunks, 0);
+}
@@ -0,0 +1,127 @@
+/**
+ * @file test_text_buffer.cpp
+ * @brief Unit tests for the zero-copy file representation
+ */
+
+#include "wizardmerge/merge/three_way_merge.h"
+#include "wizardmerge/text/text_buffer.h"
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+
+using namespace wizardmerge::text;
+using namespace wizardmerge::merge;
+
+namespace {
+
+std::string write_temp_file(const std::string &name,
+                            const std::string &content) {
+  std::string path = ::testing::TempDir() + name;
+  std::ofstream file(path, std::ios::binary);
+  file << content;
+  return path;
+}
+
+} // namespace
+
+/**
+ * Test line splitting matches std::getline
+ */
+TEST(TextBufferTest, SplitsLikeGetline) {
+  auto buffer = TextBuffer::from_string("a\n\nbc\r\nd");
+
+  ASSERT_EQ(buffer.line_count(), 4);
+  EXPECT_EQ(buffer.line(0), "a");
+  EXPECT_EQ(buffer.line(1), "");
+  EXPECT_EQ(buffer.line(2), "bc\r");
+  EXPECT_EQ(buffer.line(3), "d");
+
+  EXPECT_EQ(TextBuffer::from_string("a\nb\n").line_count(), 2);
+  EXPECT_EQ(TextBuffer::from_string("\n").line_count(), 1);
+  EXPECT_EQ(TextBuffer::from_string("").line_count(), 0);
+}
+
+/**
+ * Test views stay valid when the buffer is moved
+ */
+TEST(TextBufferTest, ViewsSurviveMove) {
+  auto buffer = TextBuffer::from_string("short\nlines");
+  TextBuffer moved = std::move(buffer);
+
+  auto lines = moved.lines();
+  ASSERT_EQ(lines.size(), 2);
+  EXPECT_EQ(lines[0], "short");
+  EXPECT_EQ(lines[1], "lines");
+  EXPECT_EQ(lines[0].data(), moved.data().data());
+  EXPECT_EQ(buffer.line_count(), 0);
+}
+
+/**
+ * Test loading a file from disk
+ */
+TEST(TextBufferTest, LoadsFile) {
+  std::string path = write_temp_file("wm_text_buffer.txt", "one\ntwo\n");
+
+  auto buffer = TextBuffer::from_file(path);
+  ASSERT_TRUE(buffer.has_value());
+  ASSERT_EQ(buffer->line_count(), 2);
+  EXPECT_EQ(buffer->line(1), "two");
+
+  std::string empty_path = write_temp_file("wm_text_buffer_empty.txt", "");
+  auto empty = TextBuffer::from_file(empty_path);
+  ASSERT_TRUE(empty.has_value());
+  EXPECT_EQ(empty->line_count(), 0);
+
+  std::remove(path.c_str());
+  std::remove(empty_path.c_str());
+
+  EXPECT_FALSE(TextBuffer::from_file(path).has_value());
+}
+
+/**
+ * Test merging views gives the same result as merging owned lines
+ */
+TEST(TextBufferTest, MergeOverViewsMatchesOwnedLines) {
+  auto base = TextBuffer::from_string("line1\nline2\nline3\n");
+  auto ours = TextBuffer::from_string("line1\nours\nline3\n");
+  auto theirs = TextBuffer::from_string("line1\ntheirs\nline3\nline4\n");
+
+  auto from_views = three_way_merge(base.lines(), ours.lines(), theirs.lines());
+  auto from_owned = three_way_merge(
+      std::vector<std::string>{"line1", "line2", "line3"},
+      std::vector<std::string>{"line1", "ours", "line3"},
+      std::vector<std::string>{"line1", "theirs", "line3", "line4"});
+
+  ASSERT_EQ(from_views.merged_lines.size(), from_owned.merged_lines.size());
+  for (size_t i = 0; i < from_views.merged_lines.size(); ++i) {
+    EXPECT_EQ(from_views.merged_lines[i].content,
+              from_owned.merged_lines[i].content);
+  }
+  ASSERT_EQ(from_views.conflicts.size(), 1);
+  EXPECT_EQ(from_views.conflicts[0].our_lines[0].content, "ours");
+}
+
+/**
+ * Test normalization replaces converted content and keeps the rest
+ */
+TEST(TextBufferTest, Normalizes) {
+  auto plain = TextBuffer::from_string("one\ntwo\n");
+  const char *before = plain.data().data();
+  TextFormat format;
+  ASSERT_TRUE(plain.normalize(format));
+  EXPECT_FALSE(format.converted);
+  EXPECT_EQ(plain.data().data(), before);
+
+  auto crlf = TextBuffer::from_string("\xEF\xBB\xBFone\r\ntwo\r\n");
+  ASSERT_TRUE(crlf.normalize(format));
+  EXPECT_TRUE(format.converted);
+  EXPECT_TRUE(format.bom);
+  EXPECT_EQ(format.line_ending, LineEnding::CRLF);
+  ASSERT_EQ(crlf.line_count(), 2);
+  EXPECT_EQ(crlf.line(0), "one");
+  EXPECT_EQ(crlf.line(1), "two");
+
+  auto binary = TextBuffer::from_string(std::string("a\0b\r\n", 5));
+  EXPECT_FALSE(binary.normalize(format));
+  EXPECT_EQ(binary.data().size(), 5u);
+}
@@ -0,0 +1,211 @@
+/**
+ * @file test_text_kernels.cpp
+ * @brief Unit tests for the vectorized text kernels
+ */
+
+#include "wizardmerge/text/text_kernels.h"
+#include <gtest/gtest.h>
+
+using namespace wizardmerge::text;
+
+namespace {
+
+/**
+ * Runs a check once per instruction set supported by this CPU
+ */
+template <typename Check> void for_each_simd_level(const Check &check) {
+  SimdLevel original = active_simd_level();
+  for (auto level : {SimdLevel::SCALAR, SimdLevel::SSE42, SimdLevel::AVX2}) {
+    if (set_simd_level(level) == level) {
+      SCOPED_TRACE(simd_level_to_string(level));
+      check();
+    }
+  }
+  set_simd_level(original);
+}
+
+} // namespace
+
+/**
+ * Test newline splitting matches std::getline semantics
+ */
+TEST(TextKernelsTest, SplitLines) {
+  for_each_simd_level([] {
+    auto lines = split_lines("alpha\nbeta\r\n\ngamma");
+    ASSERT_EQ(lines.size(), 4);
+    EXPECT_EQ(lines[0], "alpha");
+    EXPECT_EQ(lines[1], "beta\r");
+    EXPECT_EQ(lines[2], "");
+    EXPECT_EQ(lines[3], "gamma");
+
+    EXPECT_EQ(split_lines("one\ntwo\n").size(), 2);
+    EXPECT_TRUE(split_lines("").empty());
+  });
+}
+
+/**
+ * Test byte search across vector-width boundaries
+ */
+TEST(TextKernelsTest, FindByteLongInput) {
+  std::string data(100, 'x');
+  data[70] = '\n';
+  for_each_simd_level([&] {
+    EXPECT_EQ(find_byte(data, '\n'), 70);
+    EXPECT_EQ(find_byte(data, '\n', 71), data.size());
+    EXPECT_EQ(find_byte(data, 'y'), data.size());
+  });
+}
+
+/**
+ * Test line-start search skips the byte mid-line on every instruction set
+ */
+TEST(TextKernelsTest, FindLineStart) {
+  std::string data = "a<b\n<c\n";
+  data += std::string(40, '<') + "\n" + std::string(50, 'x') + "\n<<\n<";
+  for_each_simd_level([&] {
+    EXPECT_EQ(find_line_start(data, '<'), 4);
+    EXPECT_EQ(find_line_start(data, '<', 5), 7);
+    EXPECT_EQ(find_line_start(data, '<', 8), 99);
+    EXPECT_EQ(find_line_start(data, '<', 100), 102);
+    EXPECT_EQ(find_line_start(data, '<', 103), data.size());
+    EXPECT_EQ(find_line_start(data, 'a'), 0);
+    EXPECT_EQ(find_line_start(data, 'b'), data.size());
+  });
+}
+
+/**
+ * Test hashes are identical on every instruction set
+ */
+TEST(TextKernelsTest, HashIsDispatchIndependent) {
+  std::string long_line;
+  for (int i = 0; i < 1000; ++i) {
+    long_line += static_cast<char>('a' + (i * 7) % 26);
+  }
+  SimdLevel original = active_simd_level();
+  set_simd_level(SimdLevel::SCALAR);
+  uint64_t scalar_hash = hash_bytes(long_line);
+  uint64_t scalar_short = hash_bytes("short line");
+  set_simd_level(original);
+
+  for_each_simd_level([&] {
+    EXPECT_EQ(hash_bytes(long_line), scalar_hash);
+    EXPECT_EQ(hash_bytes("short line"), scalar_short);
+
+    std::string changed = long_line;
+    changed[500] = '#';
+    EXPECT_NE(hash_bytes(changed), scalar_hash);
+  });
+}
+
+/**
+ * Test exact equality on long and short inputs
+ */
+TEST(TextKernelsTest, BytesEqual) {
+  std::string a(80, 'q');
+  std::string b = a;
+  b[79] = 'r';
+  for_each_simd_level([&] {
+    EXPECT_TRUE(bytes_equal(a, a));
+    EXPECT_FALSE(bytes_equal(a, b));
+    EXPECT_FALSE(bytes_equal("abc", "abcd"));
+    EXPECT_TRUE(bytes_equal("", ""));
+  });
+}
+
+/**
+ * Test comparison ignoring surrounding whitespace
+ */
+TEST(TextKernelsTest, EqualIgnoreSurroundingWhitespace) {
+  EXPECT_TRUE(equal_ignore_surrounding_whitespace("  x = 1;\t", "x = 1;"));
+  EXPECT_FALSE(equal_ignore_surrounding_whitespace("x = 1;", "x  = 1;"));
+  EXPECT_TRUE(equal_ignore_surrounding_whitespace("   ", ""));
+  EXPECT_EQ(trim_whitespace("\t value \r"), "value");
+  EXPECT_TRUE(is_blank(" \t\r"));
+  EXPECT_FALSE(is_blank(" x "));
+}
+
+/**
+ * Test comparison ignoring all whitespace, including long lines
+ */
+TEST(TextKernelsTest, EqualIgnoreAllWhitespace) {
+  std::string compact;
+  std::string spaced;
+  for (int i = 0; i < 40; ++i) {
+    compact += "token" + std::to_string(i) + ";";
+    spaced += "  token" + std::to_string(i) + " ;\t";
+  }
+  for_each_simd_level([&] {
+    EXPECT_TRUE(equal_ignore_all_whitespace("x = 1;", "x=1;"));
+    EXPECT_TRUE(equal_ignore_all_whitespace(compact, spaced));
+    EXPECT_FALSE(equal_ignore_all_whitespace(compact, spaced + "x"));
+    EXPECT_FALSE(equal_ignore_all_whitespace("abc", "abd"));
+    EXPECT_TRUE(equal_ignore_all_whitespace("  ", ""));
+
+    std::string different = spaced;
+    different[different.size() / 2] = '#';
+    EXPECT_FALSE(equal_ignore_all_whitespace(compact, different));
+  });
+}
+
+/**
+ * Test binary detection: NUL bytes and malformed UTF-8 are binary
+ */
+TEST(TextKernelsTest, LooksBinary) {
+  for_each_simd_level([] {
+    EXPECT_FALSE(looks_binary(""));
+    EXPECT_FALSE(looks_binary("plain ascii text\n"));
+    EXPECT_FALSE(looks_binary("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80"));
+    EXPECT_TRUE(looks_binary(std::string("abc\0def", 7)));
+
+    EXPECT_TRUE(looks_binary("\x80"));             // Stray continuation
+    EXPECT_TRUE(looks_binary("\xc0\xaf"));         // Overlong '/'
+    EXPECT_TRUE(looks_binary("\xe0\x80\xaf"));     // Overlong
+    EXPECT_TRUE(looks_binary("\xed\xa0\x80"));     // Surrogate
+    EXPECT_TRUE(looks_binary("\xf4\x90\x80\x80")); // Past U+10FFFF
+    EXPECT_TRUE(looks_binary("caf\xe9"));          // Latin-1
+    EXPECT_TRUE(looks_binary("\xc3"));             // Truncated at the end
+
+    // Past vector widths, and only within the scan window
+    std::string text(100, 'x');
+    text[70] = '\0';
+    EXPECT_TRUE(looks_binary(text));
+    EXPECT_FALSE(looks_binary(text, 70));
+
+    // A sequence cut off by the scan window is not an error
+    std::string euro = std::string(63, 'x') + "\xe2\x82\xac";
+    EXPECT_FALSE(looks_binary(euro, 64));
+    EXPECT_FALSE(looks_binary(euro, 65));
+    EXPECT_FALSE(looks_binary(euro));
+  });
+}
+
+/**
+ * Test skipping ASCII without carriage returns stops at the first other
+ * byte, and UTF-8 sequence lengths follow the looks_binary() rules
+ */
+TEST(TextKernelsTest, SkipPlainAsciiAndSequenceLength) {
+  for_each_simd_level([] {
+    std::string text(100, 'x');
+    EXPECT_EQ(skip_plain_ascii(text), 100u);
+    EXPECT_EQ(skip_plain_ascii(text, 100), 100u);
+    for (size_t i : {0, 15, 31, 33, 70, 99}) {
+      for (char c : {'\r', '\0', '\x80', '\xff'}) {
+        std::string stop = text;
+        stop[i] = c;
+        EXPECT_EQ(skip_plain_ascii(stop), i);
+        EXPECT_EQ(skip_plain_ascii(stop, i + 1), 100u);
+      }
+    }
+    EXPECT_EQ(skip_plain_ascii("a\tb\nc"), 5u);
+  });
+
+  EXPECT_EQ(utf8_sequence_length("a", 0), 1u);
+  EXPECT_EQ(utf8_sequence_length("x\xc3\xa9", 1), 2u);
+  EXPECT_EQ(utf8_sequence_length("\xe2\x82\xac", 0), 3u);
+  EXPECT_EQ(utf8_sequence_length("\xf0\x9f\x98\x80", 0), 4u);
+  EXPECT_EQ(utf8_sequence_length(std::string_view("\0", 1), 0), 0u);
+  EXPECT_EQ(utf8_sequence_length("\x80", 0), 0u);
+  EXPECT_EQ(utf8_sequence_length("\xc0\xaf", 0), 0u);
+  EXPECT_EQ(utf8_sequence_length("\xed\xa0\x80", 0), 0u);
+  EXPECT_EQ(utf8_sequence_length("\xe2\x82", 0), 0u);
+}
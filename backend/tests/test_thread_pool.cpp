@@ -0,0 +1,97 @@
+/**
+ * @file test_thread_pool.cpp
+ * @brief Unit tests for the work-stealing thread pool
+ */
+
+#include "wizardmerge/merge/thread_pool.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+using namespace wizardmerge::merge;
+
+/**
+ * Test every index runs exactly once
+ */
+TEST(ThreadPoolTest, RunsEveryIndexOnce) {
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.size(), 4);
+
+  std::vector<std::atomic<int>> hits(1000);
+  pool.parallel_for(hits.size(), [&](size_t i) { ++hits[i]; });
+
+  for (const auto &hit : hits) {
+    EXPECT_EQ(hit.load(), 1);
+  }
+}
+
+/**
+ * Test a pool of one thread runs inline
+ */
+TEST(ThreadPoolTest, SingleThreadRunsInline) {
+  ThreadPool pool(1);
+  EXPECT_EQ(pool.size(), 1);
+
+  std::thread::id caller = std::this_thread::get_id();
+  bool all_inline = true;
+  pool.parallel_for(10, [&](size_t) {
+    all_inline = all_inline && std::this_thread::get_id() == caller;
+  });
+  EXPECT_TRUE(all_inline);
+}
+
+/**
+ * Test tasks may start nested batches without deadlocking
+ */
+TEST(ThreadPoolTest, NestedBatches) {
+  ThreadPool pool(3);
+  std::atomic<int> total(0);
+
+  pool.parallel_for(8, [&](size_t) {
+    pool.parallel_for(8, [&](size_t) { ++total; });
+  });
+
+  EXPECT_EQ(total.load(), 64);
+}
+
+/**
+ * Test the first exception is rethrown after the batch finishes
+ */
+TEST(ThreadPoolTest, PropagatesExceptions) {
+  ThreadPool pool(4);
+  std::atomic<int> ran(0);
+
+  EXPECT_THROW(pool.parallel_for(100,
+                                 [&](size_t i) {
+                                   ++ran;
+                                   if (i == 17) {
+                                     throw std::runtime_error("task failed");
+                                   }
+                                 }),
+               std::runtime_error);
+  EXPECT_EQ(ran.load(), 100);
+
+  // The pool stays usable
+  std::atomic<int> after(0);
+  pool.parallel_for(10, [&](size_t) { ++after; });
+  EXPECT_EQ(after.load(), 10);
+}
+
+/**
+ * Test the shared pool is one pool that concurrent callers can use
+ */
+TEST(ThreadPoolTest, SharedPoolServesConcurrentCallers) {
+  ThreadPool &pool = shared_thread_pool();
+  EXPECT_EQ(&pool, &shared_thread_pool());
+
+  std::atomic<int> total(0);
+  std::vector<std::thread> callers;
+  for (int c = 0; c < 4; ++c) {
+    callers.emplace_back([&] {
+      pool.parallel_for(100, [&](size_t) { ++total; });
+    });
+  }
+  for (auto &caller : callers) {
+    caller.join();
+  }
+  EXPECT_EQ(total.load(), 400);
+}
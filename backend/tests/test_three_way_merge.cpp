@@ -4,6 +4,7 @@
  */
 
 #include "wizardmerge/merge/three_way_merge.h"
+#include "wizardmerge/merge/thread_pool.h"
 #include <gtest/gtest.h>
 
 using namespace wizardmerge::merge;
@@ -123,3 +124,475 @@ TEST(ThreeWayMergeTest, OneSideAddsLines) {
   EXPECT_FALSE(result.has_conflicts());
   ASSERT_EQ(result.merged_lines.size(), 2);
 }
+
+/**
+ * Test an insertion at the top does not misalign the rest of the file
+ */
+TEST(ThreeWayMergeTest, InsertionShiftsLines) {
+  std::vector<std::string> base = {"line1", "line2", "line3", "line4"};
+  std::vector<std::string> ours = {"header", "line1", "line2", "line3",
+                                   "line4"};
+  std::vector<std::string> theirs = {"line1", "line2", "line3",
+                                     "line4_changed"};
+
+  auto result = three_way_merge(base, ours, theirs);
+
+  EXPECT_FALSE(result.has_conflicts());
+  ASSERT_EQ(result.merged_lines.size(), 5);
+  EXPECT_EQ(result.merged_lines[0].content, "header");
+  EXPECT_EQ(result.merged_lines[4].content, "line4_changed");
+}
+
+/**
+ * Test a multi-line divergent block becomes a single conflict
+ */
+TEST(ThreeWayMergeTest, OverlappingChangesFormOneConflict) {
+  std::vector<std::string> base = {"a", "b", "c", "d", "e"};
+  std::vector<std::string> ours = {"a", "B1", "C1", "d", "e"};
+  std::vector<std::string> theirs = {"a", "B2", "C2", "D2", "e"};
+
+  auto result = three_way_merge(base, ours, theirs);
+
+  ASSERT_EQ(result.conflicts.size(), 1);
+  const auto &conflict = result.conflicts[0];
+  EXPECT_EQ(conflict.base_lines.size(), 3);
+  EXPECT_EQ(conflict.our_lines.size(), 3);
+  EXPECT_EQ(conflict.their_lines.size(), 3);
+  EXPECT_EQ(result.merged_lines[conflict.start_line].content, "<<<<<<< OURS");
+  EXPECT_EQ(result.merged_lines[conflict.end_line].content, ">>>>>>> THEIRS");
+}
+
+/**
+ * Test deletion on one side and an unrelated edit on the other
+ */
+TEST(ThreeWayMergeTest, DeletionAndEditElsewhere) {
+  std::vector<std::string> base = {"a", "b", "c", "d"};
+  std::vector<std::string> ours = {"a", "c", "d"};
+  std::vector<std::string> theirs = {"a", "b", "c", "d2"};
+
+  auto result = three_way_merge(base, ours, theirs);
+
+  EXPECT_FALSE(result.has_conflicts());
+  ASSERT_EQ(result.merged_lines.size(), 3);
+  EXPECT_EQ(result.merged_lines[0].content, "a");
+  EXPECT_EQ(result.merged_lines[1].content, "c");
+  EXPECT_EQ(result.merged_lines[2].content, "d2");
+}
+
+/**
+ * Test every diff algorithm merges non-overlapping edits cleanly
+ */
+TEST(ThreeWayMergeTest, SelectableAlgorithms) {
+  std::vector<std::string> base = {"{", "a", "}", "{", "b", "}"};
+  std::vector<std::string> ours = {"{", "a2", "}", "{", "b", "}"};
+  std::vector<std::string> theirs = {"{", "a", "}", "{", "b2", "}"};
+
+  for (auto algorithm : {DiffAlgorithm::MYERS, DiffAlgorithm::PATIENCE,
+                         DiffAlgorithm::HISTOGRAM}) {
+    MergeOptions options;
+    options.algorithm = algorithm;
+    auto result = three_way_merge(base, ours, theirs, options);
+
+    EXPECT_FALSE(result.has_conflicts());
+    ASSERT_EQ(result.merged_lines.size(), 6);
+    EXPECT_EQ(result.merged_lines[1].content, "a2");
+    EXPECT_EQ(result.merged_lines[4].content, "b2");
+  }
+}
+
+/**
+ * Test a merge built with an arena allocates its whole result from it
+ */
+TEST(ThreeWayMergeTest, ArenaBackedResult) {
+  std::vector<std::string> base = {"int compute_total(int value) {",
+                                   "  return value + 1; // original",
+                                   "}"};
+  std::vector<std::string> ours = {"int compute_total(int value) {",
+                                   "  return value + 2; // changed by us",
+                                   "}"};
+  std::vector<std::string> theirs = {"int compute_total(int value) {",
+                                     "  return value + 3; // changed by them",
+                                     "}"};
+
+  std::pmr::monotonic_buffer_resource arena;
+  auto result = three_way_merge(base, ours, theirs, MergeOptions(), &arena);
+  result = auto_resolve(result);
+
+  ASSERT_EQ(result.conflicts.size(), 1);
+  const Conflict &conflict = result.conflicts[0];
+  EXPECT_EQ(result.get_allocator().resource(), &arena);
+  EXPECT_EQ(result.merged_lines[0].get_allocator().resource(), &arena);
+  EXPECT_EQ(conflict.our_lines[0].content.get_allocator().resource(), &arena);
+  EXPECT_EQ(conflict.context.get_allocator().resource(), &arena);
+  EXPECT_EQ(conflict.risk_ours.get_allocator().resource(), &arena);
+  EXPECT_EQ(conflict.context.function_name, "compute_total");
+  EXPECT_EQ(conflict.our_lines[0].content,
+            "  return value + 2; // changed by us");
+
+  // Without an allocator the result uses the default resource
+  auto heap_result = three_way_merge(base, ours, theirs);
+  EXPECT_EQ(heap_result.get_allocator().resource(),
+            std::pmr::get_default_resource());
+}
+
+/**
+ * Test code written against std::string lines and std::vector members
+ * still compiles and behaves the same
+ */
+TEST(ThreeWayMergeTest, KeepsStdCallPatterns) {
+  std::vector<std::string> base = {"a", "b", "c"};
+  std::vector<std::string> ours = {"a", "B", "c"};
+  std::vector<std::string> theirs = {"a", "b", "C"};
+
+  std::vector<Line> lines;
+  {
+    std::pmr::monotonic_buffer_resource arena;
+    MergeResult result = three_way_merge(base, ours, theirs, {}, &arena);
+    ASSERT_EQ(result.merged_lines.size(), 3);
+
+    std::string expected = "B";
+    EXPECT_TRUE(result.merged_lines[1].content == expected);
+    EXPECT_TRUE(expected == result.merged_lines[1].content);
+    EXPECT_TRUE(result.merged_lines[0].content != expected);
+    EXPECT_TRUE(result.merged_lines[0].content == "a");
+    EXPECT_TRUE(result.merged_lines[0].content ==
+                result.merged_lines[0].content);
+
+    std::string copied = result.merged_lines[2].content;
+    const std::string &bound = result.merged_lines[2].content;
+    EXPECT_EQ(copied, "C");
+    EXPECT_EQ(bound, "C");
+
+    std::vector<Conflict> conflicts = result.conflicts;
+    EXPECT_TRUE(conflicts.empty());
+
+    // Converted lines outlive the arena
+    lines = result.merged_lines;
+  }
+  ASSERT_EQ(lines.size(), 3);
+  EXPECT_EQ(lines[1].content, std::string("B"));
+
+  MergeResult result;
+  lines[1].content = std::string("B2");
+  result.merged_lines = lines;
+  result.merged_lines.push_back(Line{"d", Line::MERGED});
+  ASSERT_EQ(result.merged_lines.size(), 4);
+  EXPECT_EQ(result.merged_lines[1].content, std::string("B2"));
+  EXPECT_EQ(result.merged_lines[3].content, "d");
+}
+
+/**
+ * Test the parallel merge gives the serial result on a multi-partition file
+ */
+TEST(ThreeWayMergeTest, ParallelMatchesSerial) {
+  std::vector<std::string> base, ours, theirs;
+  for (int i = 0; i < 20000; ++i) {
+    std::string line = i % 50 == 0
+                           ? "int function_" + std::to_string(i) + "(int x) {"
+                           : "  value_" + std::to_string(i) + " += x;";
+    base.push_back(line);
+    ours.push_back(i % 301 == 7 ? line + " // ours" : line);
+    theirs.push_back(i % 301 == 7 || i % 467 == 3 ? line + " // theirs"
+                                                  : line);
+    if (i % 997 == 0) {
+      ours.push_back("  // inserted by us");
+    }
+  }
+
+  auto serial = three_way_merge(base, ours, theirs);
+  MergeOptions options;
+  options.threads = 4;
+  std::pmr::monotonic_buffer_resource arena;
+  auto on_heap = three_way_merge(base, ours, theirs, options);
+  auto in_arena = three_way_merge(base, ours, theirs, options, &arena);
+
+  // A supplied pool is used instead of one started for the merge
+  ThreadPool pool(3);
+  MergeOptions pooled = options;
+  pooled.pool = &pool;
+  auto on_pool = three_way_merge(base, ours, theirs, pooled);
+
+  ASSERT_GT(serial.conflicts.size(), 1);
+  for (const MergeResult *parallel : {&on_heap, &in_arena, &on_pool}) {
+    ASSERT_EQ(parallel->merged_lines.size(), serial.merged_lines.size());
+    for (size_t i = 0; i < serial.merged_lines.size(); ++i) {
+      EXPECT_EQ(parallel->merged_lines[i].content,
+                serial.merged_lines[i].content);
+    }
+    ASSERT_EQ(parallel->conflicts.size(), serial.conflicts.size());
+    for (size_t i = 0; i < serial.conflicts.size(); ++i) {
+      const Conflict &expected = serial.conflicts[i];
+      const Conflict &actual = parallel->conflicts[i];
+      EXPECT_EQ(actual.start_line, expected.start_line);
+      EXPECT_EQ(actual.end_line, expected.end_line);
+      EXPECT_EQ(actual.context.function_name, expected.context.function_name);
+      EXPECT_EQ(actual.risk_ours.level, expected.risk_ours.level);
+      EXPECT_EQ(actual.risk_both.risk_factors,
+                expected.risk_both.risk_factors);
+    }
+  }
+  EXPECT_EQ(in_arena.conflicts[0].context.get_allocator().resource(), &arena);
+}
+
+/**
+ * Test conflicts a few lines apart are reported as one, analyzed once
+ */
+TEST(ThreeWayMergeTest, CloseConflictsAreMerged) {
+  std::vector<std::string> base = {"a", "b", "c", "d", "e", "f", "g", "h",
+                                   "i", "j"};
+  std::vector<std::string> ours = base;
+  std::vector<std::string> theirs = base;
+  ours[1] = "b ours";
+  theirs[1] = "b theirs";
+  ours[4] = "e ours"; // Two unchanged lines after the first conflict
+  theirs[4] = "e theirs";
+  ours[9] = "j ours"; // Four unchanged lines after the second
+  theirs[9] = "j theirs";
+
+  auto result = three_way_merge(base, ours, theirs);
+
+  ASSERT_EQ(result.conflicts.size(), 2);
+  const Conflict &merged = result.conflicts[0];
+  std::vector<std::string> expected_ours = {"b ours", "c", "d", "e ours"};
+  ASSERT_EQ(merged.our_lines.size(), expected_ours.size());
+  for (size_t i = 0; i < expected_ours.size(); ++i) {
+    EXPECT_EQ(std::string_view(merged.our_lines[i].content), expected_ours[i]);
+  }
+  EXPECT_EQ(merged.base_lines.size(), 4);
+  EXPECT_EQ(merged.their_lines[3].content, "e theirs");
+  EXPECT_EQ(result.conflicts[1].our_lines.size(), 1);
+}
+
+/**
+ * Test lines both sides agree on at a conflict's edges stay outside it
+ */
+TEST(ThreeWayMergeTest, CommonConflictEdgesAreTrimmed) {
+  std::vector<std::string> base = {"start", "old", "end"};
+  std::vector<std::string> ours = {"start", "shared", "ours", "tail", "end"};
+  std::vector<std::string> theirs = {"start", "shared", "theirs", "tail",
+                                     "end"};
+
+  auto result = three_way_merge(base, ours, theirs);
+
+  ASSERT_EQ(result.conflicts.size(), 1);
+  std::vector<std::string> expected = {"start",  "shared",  "<<<<<<< OURS",
+                                       "ours",   "=======", "theirs",
+                                       ">>>>>>> THEIRS",    "tail", "end"};
+  ASSERT_EQ(result.merged_lines.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(std::string_view(result.merged_lines[i].content), expected[i]);
+  }
+  const Conflict &conflict = result.conflicts[0];
+  EXPECT_EQ(conflict.start_line, 2);
+  EXPECT_EQ(conflict.end_line, 6);
+  ASSERT_EQ(conflict.our_lines.size(), 1);
+  EXPECT_EQ(conflict.base_lines[0].content, "old");
+}
+
+/**
+ * Test the diff3 conflict style shows the base section untrimmed
+ */
+TEST(ThreeWayMergeTest, ShowBaseMarkers) {
+  std::vector<std::string> base = {"start", "old", "end"};
+  std::vector<std::string> ours = {"start", "shared", "ours", "end"};
+  std::vector<std::string> theirs = {"start", "shared", "theirs", "end"};
+
+  MergeOptions options;
+  options.show_base = true;
+  auto result = three_way_merge(base, ours, theirs, options);
+
+  ASSERT_EQ(result.conflicts.size(), 1);
+  std::vector<std::string> expected = {
+      "start", "<<<<<<< OURS", "shared", "ours",          "||||||| BASE",
+      "old",   "=======",      "shared", "theirs",        ">>>>>>> THEIRS",
+      "end"};
+  ASSERT_EQ(result.merged_lines.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(std::string_view(result.merged_lines[i].content), expected[i]);
+  }
+}
+
+/**
+ * Test that analysis can be deferred and run per conflict on demand
+ */
+TEST(ThreeWayMergeTest, LazyAnalysisMatchesEager) {
+  std::vector<std::string> base = {"class Counter {", "int add(int x) {",
+                                   "  return x;", "}", "};"};
+  std::vector<std::string> ours = {"class Counter {", "int add(int x) {",
+                                   "  return x + 1;", "}", "};"};
+  std::vector<std::string> theirs = {"class Counter {", "int add(int x) {",
+                                     "  return x + 2;", "}", "};"};
+
+  auto eager = three_way_merge(base, ours, theirs);
+  MergeOptions options;
+  options.analysis = AnalysisLevel::NONE;
+  auto lazy = three_way_merge(base, ours, theirs, options);
+
+  ASSERT_EQ(eager.conflicts.size(), 1);
+  ASSERT_EQ(lazy.conflicts.size(), 1);
+  const Conflict &expected = eager.conflicts[0];
+  Conflict &conflict = lazy.conflicts[0];
+  EXPECT_EQ(expected.analysis, AnalysisLevel::FULL);
+  EXPECT_FALSE(expected.context.function_name.empty());
+  EXPECT_EQ(conflict.analysis, AnalysisLevel::NONE);
+  EXPECT_TRUE(conflict.context.function_name.empty());
+
+  analyze_conflict(conflict, base, ours, theirs, AnalysisLevel::CONTEXT);
+  EXPECT_EQ(conflict.analysis, AnalysisLevel::CONTEXT);
+  EXPECT_EQ(conflict.context.function_name, expected.context.function_name);
+  EXPECT_EQ(conflict.context.class_name, expected.context.class_name);
+  EXPECT_TRUE(conflict.risk_ours.risk_factors.empty());
+
+  analyze_conflict(conflict, base, ours, theirs);
+  EXPECT_EQ(conflict.analysis, AnalysisLevel::FULL);
+  EXPECT_EQ(conflict.risk_ours.level, expected.risk_ours.level);
+  EXPECT_EQ(conflict.risk_theirs.level, expected.risk_theirs.level);
+  EXPECT_EQ(conflict.risk_both.risk_factors, expected.risk_both.risk_factors);
+
+  // Memoized: asking again, or for less, leaves the results untouched
+  conflict.context.function_name = "kept";
+  analyze_conflict(conflict, base, ours, theirs, AnalysisLevel::CONTEXT);
+  analyze_conflict(conflict, base, ours, theirs);
+  EXPECT_EQ(std::string_view(conflict.context.function_name), "kept");
+
+  AnalysisLevel level;
+  EXPECT_TRUE(parse_analysis_level("context", level));
+  EXPECT_EQ(level, AnalysisLevel::CONTEXT);
+  EXPECT_FALSE(parse_analysis_level("some", level));
+  EXPECT_EQ(analysis_level_to_string(AnalysisLevel::NONE), "none");
+}
+
+/**
+ * Test lines shared at both ends are kept out of the diff without changing
+ * the result
+ */
+TEST(ThreeWayMergeTest, CommonEndsAreTrimmed) {
+  std::vector<std::string> base;
+  for (int i = 0; i < 5000; ++i) {
+    base.push_back("line " + std::to_string(i));
+  }
+  std::vector<std::string> ours = base;
+  std::vector<std::string> theirs = base;
+  ours[2500] = "ours";
+  theirs[2500] = "theirs";
+  theirs[2510] = "theirs too";
+
+  auto result = three_way_merge(base, ours, theirs);
+
+  ASSERT_EQ(result.conflicts.size(), 1);
+  const Conflict &conflict = result.conflicts[0];
+  EXPECT_EQ(conflict.start_line, 2500);
+  EXPECT_EQ(conflict.base_range.begin, 2500);
+  EXPECT_EQ(conflict.our_range.begin, 2500);
+  EXPECT_EQ(conflict.their_range.end, 2501);
+  EXPECT_EQ(result.merged_lines.size(), 5004);
+  EXPECT_EQ(result.merged_lines[2514].content, "theirs too");
+  EXPECT_EQ(result.merged_lines.back().content, "line 4999");
+
+  // The trimmed lines are only those both diffs would skip: ours inserts
+  // its repeated "c" after base's, clear of theirs' insertion
+  std::vector<std::string> short_base = {"a", "c"};
+  std::vector<std::string> short_ours = {"a", "c", "c"};
+  std::vector<std::string> short_theirs = {"a", "x", "c"};
+  auto merged = three_way_merge(short_base, short_ours, short_theirs);
+  EXPECT_FALSE(merged.has_conflicts());
+  ASSERT_EQ(merged.merged_lines.size(), 4);
+  EXPECT_EQ(merged.merged_lines[1].content, "x");
+}
+
+/**
+ * Test whitespace-only changes are ignored under the comparison options
+ */
+TEST(ThreeWayMergeTest, IgnoresWhitespaceChanges) {
+  std::vector<std::string> base = {"if (x) {", "  run();", "}", "end"};
+  std::vector<std::string> ours = {"if (x) {", "    run();", "}", "end"};
+  std::vector<std::string> theirs = {"if (x) {", "  run(1);", "}", "end"};
+
+  auto strict = three_way_merge(base, ours, theirs);
+  EXPECT_TRUE(strict.has_conflicts());
+
+  // Ours only reindented: theirs' change applies
+  MergeOptions options;
+  options.compare.ignore_space_change = true;
+  auto result = three_way_merge(base, ours, theirs, options);
+  EXPECT_FALSE(result.has_conflicts());
+  EXPECT_EQ(result.merged_lines[1].content, "  run(1);");
+
+  // Theirs only reindented: the region is stable and keeps ours
+  std::vector<std::string> reindented = {"if (x) {", "\trun();", "}", "end"};
+  auto kept = three_way_merge(base, ours, reindented, options);
+  EXPECT_FALSE(kept.has_conflicts());
+  ASSERT_EQ(kept.merged_lines.size(), 4);
+  EXPECT_EQ(kept.merged_lines[1].content, "    run();");
+}
+
+/**
+ * Test blank lines are left out of the diffs and follow ours
+ */
+TEST(ThreeWayMergeTest, IgnoresBlankLines) {
+  std::vector<std::string> base = {"a", "b", "c", "d"};
+  std::vector<std::string> ours = {"a", "", "b", "c", "d"};
+  std::vector<std::string> theirs = {"a", "b", "", "c", "D"};
+
+  MergeOptions options;
+  options.compare.ignore_blank_lines = true;
+  auto result = three_way_merge(base, ours, theirs, options);
+
+  EXPECT_FALSE(result.has_conflicts());
+  std::vector<const char *> expected = {"a", "", "b", "c", "D"};
+  ASSERT_EQ(result.merged_lines.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(result.merged_lines[i].content, expected[i]) << "line " << i;
+  }
+
+  // Conflicts still report ranges in the full versions
+  std::vector<std::string> conflicting = {"a", "b", "", "C", "d"};
+  std::vector<std::string> changed = {"a", "", "b", "X", "d"};
+  auto conflict = three_way_merge(base, changed, conflicting, options);
+  ASSERT_EQ(conflict.conflicts.size(), 1);
+  EXPECT_EQ(conflict.conflicts[0].our_range.begin, 3);
+  EXPECT_EQ(conflict.conflicts[0].their_range.begin, 3);
+  EXPECT_EQ(conflict.conflicts[0].base_range.begin, 2);
+}
+
+/**
+ * Test edits to a block the other side moved follow it
+ */
+TEST(ThreeWayMergeTest, CarriesEditsToMovedBlocks) {
+  std::vector<std::string> base = {"int f() {", "  return 1;", "}",
+                                   "int g() {", "  return 2;", "}",
+                                   "int k() {", "  return 3;", "}"};
+  // Ours moves f to the end, theirs edits it
+  std::vector<std::string> ours = {"int g() {", "  return 2;", "}",
+                                   "int k() {", "  return 3;", "}",
+                                   "int f() {", "  return 1;", "}"};
+  std::vector<std::string> theirs = {"int f() {", "  log();", "  return 10;",
+                                     "}",         "int g() {", "  return 2;",
+                                     "}",         "int k() {", "  return 3;",
+                                     "}"};
+
+  MergeOptions options;
+  auto plain = three_way_merge(base, ours, theirs, options);
+  EXPECT_TRUE(plain.has_conflicts());
+
+  options.detect_moves = true;
+  auto result = three_way_merge(base, ours, theirs, options);
+  EXPECT_FALSE(result.has_conflicts());
+  std::vector<const char *> expected = {
+      "int g() {", "  return 2;", "}",           "int k() {", "  return 3;",
+      "}",         "int f() {",   "  log();", "  return 10;", "}"};
+  ASSERT_EQ(result.merged_lines.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(result.merged_lines[i].content, expected[i]) << "line " << i;
+  }
+
+  // Conflicts elsewhere report ranges in the inputs, not in the versions
+  // rewritten to carry the edits
+  ours[1] = "  return 20;";
+  theirs[5] = "  return 21;";
+  auto conflict = three_way_merge(base, ours, theirs, options);
+  ASSERT_EQ(conflict.conflicts.size(), 1);
+  EXPECT_EQ(conflict.conflicts[0].our_range.begin, 1);
+  EXPECT_EQ(conflict.conflicts[0].their_range.begin, 5);
+  EXPECT_EQ(conflict.conflicts[0].their_range.end, 6);
+}
@@ -1,9 +1,18 @@
 #ifndef FILE_UTILS_H
 #define FILE_UTILS_H
 
+#include <ostream>
 #include <string>
 #include <vector>
 
+/**
+ * @brief How a text file stored its lines
+ */
+struct LineFormat {
+  bool bom = false;  // Started with a UTF-8 byte order mark
+  bool crlf = false; // First line ended with CRLF
+};
+
 /**
  * @brief File utility functions
  */
@@ -11,21 +20,48 @@ class FileUtils {
 public:
   /**
    * @brief Read a file and split into lines
+   *
+   * A UTF-8 byte order mark and the carriage return of CRLF line endings
+   * are stripped, so versions differing only in them compare equal.
    * @param filePath Path to the file
    * @param lines Output vector of lines
+   * @param format Optional output of the stripped format, for writeLines()
    * @return true if successful, false on error
    */
   static bool readLines(const std::string &filePath,
-                        std::vector<std::string> &lines);
+                        std::vector<std::string> &lines,
+                        LineFormat *format = nullptr);
 
   /**
    * @brief Write lines to a file
    * @param filePath Path to the file
    * @param lines Vector of lines to write
+   * @param format Byte order mark and line ending to restore
    * @return true if successful, false on error
    */
   static bool writeLines(const std::string &filePath,
-                         const std::vector<std::string> &lines);
+                         const std::vector<std::string> &lines,
+                         const LineFormat &format = LineFormat());
+
+  /**
+   * @brief Write lines to a stream
+   * @param out Output stream, opened in binary mode
+   * @param lines Vector of lines to write
+   * @param format Byte order mark and line ending to restore
+   * @return true if successful, false on error
+   */
+  static bool writeLines(std::ostream &out,
+                         const std::vector<std::string> &lines,
+                         const LineFormat &format = LineFormat());
+
+  /**
+   * @brief Write bytes to a file unchanged
+   * @param filePath Path to the file
+   * @param content Bytes to write
+   * @return true if successful, false on error
+   */
+  static bool writeFile(const std::string &filePath,
+                        const std::string &content);
 
   /**
    * @brief Check if a file exists
@@ -30,6 +30,21 @@ public:
                     const std::vector<std::string> &theirs,
                     std::vector<std::string> &merged, bool &hasConflicts);
 
+  /**
+   * @brief Perform a three-way merge and fetch the whole result, conflicts
+   *        and analysis included, in the backend's binary result encoding
+   * @param base Base version lines
+   * @param ours Our version lines
+   * @param theirs Their version lines
+   * @param encoded Output encoded merge result
+   * @param hasConflicts Output whether conflicts were detected
+   * @return true if successful, false on error
+   */
+  bool performMergeEncoded(const std::vector<std::string> &base,
+                           const std::vector<std::string> &ours,
+                           const std::vector<std::string> &theirs,
+                           std::string &encoded, bool &hasConflicts);
+
   /**
    * @brief Check if backend is reachable
    * @return true if backend responds, false otherwise
@@ -51,10 +66,11 @@ private:
    * @param endpoint API endpoint (e.g., "/api/merge")
    * @param jsonBody JSON request body
    * @param response Output response string
+   * @param accept Accept header value (default: any)
    * @return true if successful, false on error
    */
   bool post(const std::string &endpoint, const std::string &jsonBody,
-            std::string &response);
+            std::string &response, const std::string &accept = "");
 };
 
 #endif // HTTP_CLIENT_H
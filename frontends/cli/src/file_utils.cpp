@@ -1,38 +1,87 @@
 #include "file_utils.h"
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <sys/stat.h>
 
 bool FileUtils::readLines(const std::string &filePath,
-                          std::vector<std::string> &lines) {
-  std::ifstream file(filePath);
+                          std::vector<std::string> &lines,
+                          LineFormat *format) {
+  std::ifstream file(filePath, std::ios::binary | std::ios::ate);
   if (!file.is_open()) {
     return false;
   }
 
+  // Read the whole file with one call, then split it in a single pass
+  std::streamoff size = file.tellg();
+  if (size < 0) {
+    return false;
+  }
+  std::string content(static_cast<size_t>(size), '\0');
+  file.seekg(0);
+  if (size > 0 && !file.read(&content[0], size)) {
+    return false;
+  }
+  file.close();
+
+  static const char utf8Bom[] = "\xEF\xBB\xBF";
+  LineFormat found;
+  found.bom = content.compare(0, 3, utf8Bom) == 0;
+
   lines.clear();
-  std::string line;
-  while (std::getline(file, line)) {
-    lines.push_back(line);
+  const char *pos = content.data() + (found.bom ? 3 : 0);
+  const char *end = content.data() + content.size();
+  while (pos < end) {
+    const char *newline = static_cast<const char *>(
+        std::memchr(pos, '\n', static_cast<size_t>(end - pos)));
+    const char *lineEnd = newline ? newline : end;
+    bool crlf = newline && lineEnd > pos && lineEnd[-1] == '\r';
+    if (lines.empty()) {
+      found.crlf = crlf;
+    }
+    lines.emplace_back(pos, crlf ? lineEnd - 1 : lineEnd);
+    pos = lineEnd + 1;
   }
 
-  file.close();
+  if (format) {
+    *format = found;
+  }
   return true;
 }
 
 bool FileUtils::writeLines(const std::string &filePath,
-                           const std::vector<std::string> &lines) {
-  std::ofstream file(filePath);
+                           const std::vector<std::string> &lines,
+                           const LineFormat &format) {
+  std::ofstream file(filePath, std::ios::binary);
   if (!file.is_open()) {
     return false;
   }
+  return writeLines(file, lines, format);
+}
 
+bool FileUtils::writeLines(std::ostream &out,
+                           const std::vector<std::string> &lines,
+                           const LineFormat &format) {
+  if (format.bom) {
+    out << "\xEF\xBB\xBF";
+  }
+  const char *newline = format.crlf ? "\r\n" : "\n";
   for (const auto &line : lines) {
-    file << line << "\n";
+    out << line << newline;
   }
+  out.flush();
+  return !out.fail();
+}
 
+bool FileUtils::writeFile(const std::string &filePath,
+                          const std::string &content) {
+  std::ofstream file(filePath, std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  file.write(content.data(), static_cast<std::streamsize>(content.size()));
   file.close();
-  return true;
+  return !file.fail();
 }
 
 bool FileUtils::fileExists(const std::string &filePath) {
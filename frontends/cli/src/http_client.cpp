@@ -10,11 +10,50 @@ static size_t WriteCallback(void *contents, size_t size, size_t nmemb,
   return size * nmemb;
 }
 
+// Build the JSON body of a merge request
+// NOTE: This is a simplified JSON builder for prototype purposes.
+// LIMITATION: Does not escape special characters in strings (quotes,
+// backslashes, etc.)
+// TODO: For production, use a proper JSON library like nlohmann/json or
+// rapidjson This implementation works for simple test cases but will fail
+// with complex content.
+static std::string mergeRequestJson(const std::vector<std::string> &base,
+                                    const std::vector<std::string> &ours,
+                                    const std::vector<std::string> &theirs,
+                                    const std::string &analysis) {
+  std::ostringstream json;
+  json << "{";
+  json << "\"base\":[";
+  for (size_t i = 0; i < base.size(); ++i) {
+    json << "\"" << base[i] << "\""; // WARNING: No escaping!
+    if (i < base.size() - 1)
+      json << ",";
+  }
+  json << "],";
+  json << "\"ours\":[";
+  for (size_t i = 0; i < ours.size(); ++i) {
+    json << "\"" << ours[i] << "\""; // WARNING: No escaping!
+    if (i < ours.size() - 1)
+      json << ",";
+  }
+  json << "],";
+  json << "\"theirs\":[";
+  for (size_t i = 0; i < theirs.size(); ++i) {
+    json << "\"" << theirs[i] << "\""; // WARNING: No escaping!
+    if (i < theirs.size() - 1)
+      json << ",";
+  }
+  json << "],";
+  json << "\"analysis\":\"" << analysis << "\"";
+  json << "}";
+  return json.str();
+}
+
 HttpClient::HttpClient(const std::string &backendUrl)
     : backendUrl_(backendUrl), lastError_("") {}
 
 bool HttpClient::post(const std::string &endpoint, const std::string &jsonBody,
-                      std::string &response) {
+                      std::string &response, const std::string &accept) {
   CURL *curl = curl_easy_init();
   if (!curl) {
     lastError_ = "Failed to initialize CURL";
@@ -31,6 +70,9 @@ bool HttpClient::post(const std::string &endpoint, const std::string &jsonBody,
 
   struct curl_slist *headers = nullptr;
   headers = curl_slist_append(headers, "Content-Type: application/json");
+  if (!accept.empty()) {
+    headers = curl_slist_append(headers, ("Accept: " + accept).c_str());
+  }
   curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
 
   CURLcode res = curl_easy_perform(curl);
@@ -39,6 +81,15 @@ bool HttpClient::post(const std::string &endpoint, const std::string &jsonBody,
   if (!success) {
     lastError_ = std::string("CURL error: ") + curl_easy_strerror(res);
   }
+  if (success && !accept.empty()) {
+    // The backend falls back to JSON (e.g. for binary files)
+    char *contentType = nullptr;
+    curl_easy_getinfo(curl, CURLINFO_CONTENT_TYPE, &contentType);
+    if (!contentType || std::string(contentType).find(accept) != 0) {
+      lastError_ = "Backend did not answer with " + accept;
+      success = false;
+    }
+  }
 
   curl_slist_free_all(headers);
   curl_easy_cleanup(curl);
@@ -51,40 +102,10 @@ bool HttpClient::performMerge(const std::vector<std::string> &base,
                               const std::vector<std::string> &theirs,
                               std::vector<std::string> &merged,
                               bool &hasConflicts) {
-  // Build JSON request
-  // NOTE: This is a simplified JSON builder for prototype purposes.
-  // LIMITATION: Does not escape special characters in strings (quotes,
-  // backslashes, etc.)
-  // TODO: For production, use a proper JSON library like nlohmann/json or
-  // rapidjson This implementation works for simple test cases but will fail
-  // with complex content.
-  std::ostringstream json;
-  json << "{";
-  json << "\"base\":[";
-  for (size_t i = 0; i < base.size(); ++i) {
-    json << "\"" << base[i] << "\""; // WARNING: No escaping!
-    if (i < base.size() - 1)
-      json << ",";
-  }
-  json << "],";
-  json << "\"ours\":[";
-  for (size_t i = 0; i < ours.size(); ++i) {
-    json << "\"" << ours[i] << "\""; // WARNING: No escaping!
-    if (i < ours.size() - 1)
-      json << ",";
-  }
-  json << "],";
-  json << "\"theirs\":[";
-  for (size_t i = 0; i < theirs.size(); ++i) {
-    json << "\"" << theirs[i] << "\""; // WARNING: No escaping!
-    if (i < theirs.size() - 1)
-      json << ",";
-  }
-  json << "]";
-  json << "}";
-
   std::string response;
-  if (!post("/api/merge", json.str(), response)) {
+  // Only the merged text is used
+  if (!post("/api/merge", mergeRequestJson(base, ours, theirs, "none"),
+            response)) {
     return false;
   }
 
@@ -127,6 +148,29 @@ bool HttpClient::performMerge(const std::vector<std::string> &base,
   return true;
 }
 
+bool HttpClient::performMergeEncoded(const std::vector<std::string> &base,
+                                     const std::vector<std::string> &ours,
+                                     const std::vector<std::string> &theirs,
+                                     std::string &encoded,
+                                     bool &hasConflicts) {
+  // Media type of the backend's binary MergeResult encoding
+  if (!post("/api/merge", mergeRequestJson(base, ours, theirs, "full"),
+            encoded, "application/vnd.wizardmerge.merge-result")) {
+    return false;
+  }
+
+  // The conflict count is the little-endian u64 at byte 24 of the header
+  if (encoded.size() < 32 || encoded.compare(0, 4, "WZMR") != 0) {
+    lastError_ = "Malformed merge result from backend";
+    return false;
+  }
+  hasConflicts = false;
+  for (size_t i = 24; i < 32; ++i) {
+    hasConflicts = hasConflicts || encoded[i] != 0;
+  }
+  return true;
+}
+
 bool HttpClient::checkBackend() {
   CURL *curl = curl_easy_init();
   if (!curl) {
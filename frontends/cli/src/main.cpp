@@ -8,6 +8,497 @@
 #include <sstream>
 #include <string>
 
+#ifdef WIZARDMERGE_LOCAL_MERGE
+#include "wizardmerge/git/git_cli.h"
+#include "wizardmerge/merge/batch_merge.h"
+#include "wizardmerge/merge/binary_merge.h"
+#include "wizardmerge/merge/conflict_markers.h"
+#include "wizardmerge/merge/streaming_merge.h"
+#include "wizardmerge/text/text_buffer.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <set>
+
+/**
+ * @brief Input buffer stripping a UTF-8 byte order mark and the carriage
+ *        return of CRLF line endings from a stream, as readLines() does
+ *
+ * The stream is read a chunk at a time, so memory stays bounded.
+ */
+class NormalizingBuffer : public std::streambuf {
+public:
+  explicit NormalizingBuffer(std::istream &in) : in_(in) {}
+
+protected:
+  int_type underflow() override {
+    while (gptr() == egptr()) {
+      if (done_) {
+        return traits_type::eof();
+      }
+      fill();
+    }
+    return traits_type::to_int_type(*gptr());
+  }
+
+private:
+  static constexpr size_t CHUNK = 64 * 1024;
+
+  void fill() {
+    // A carriage return ending the last chunk waits for the next one,
+    // which decides whether it ended a line
+    raw_.assign(carry_ ? 1 : 0, '\r');
+    carry_ = false;
+    size_t held = raw_.size();
+    raw_.resize(held + CHUNK);
+    in_.read(&raw_[held], CHUNK);
+    size_t count = static_cast<size_t>(in_.gcount());
+    raw_.resize(held + count);
+    done_ = count < CHUNK;
+
+    size_t pos = 0;
+    if (first_) {
+      first_ = false;
+      if (raw_.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        pos = 3;
+      }
+    }
+    if (!done_ && raw_.size() > pos && raw_.back() == '\r') {
+      carry_ = true;
+      raw_.pop_back();
+    }
+
+    text_.clear();
+    while (pos < raw_.size()) {
+      size_t cr = raw_.find('\r', pos);
+      if (cr == std::string::npos) {
+        text_.append(raw_, pos, std::string::npos);
+        break;
+      }
+      bool lineEnd = cr + 1 < raw_.size() && raw_[cr + 1] == '\n';
+      text_.append(raw_, pos, lineEnd ? cr - pos : cr + 1 - pos);
+      pos = cr + 1;
+    }
+    setg(&text_[0], &text_[0], &text_[0] + text_.size());
+  }
+
+  std::istream &in_;
+  std::string raw_;
+  std::string text_;
+  bool first_ = true;
+  bool carry_ = false;
+  bool done_ = false;
+};
+
+/**
+ * @brief Format of a file's first line, read without loading the file
+ */
+LineFormat peekLineFormat(const std::string &filePath) {
+  LineFormat format;
+  std::ifstream file(filePath, std::ios::binary);
+  char head[3] = {};
+  file.read(head, 3);
+  format.bom = file.gcount() == 3 && std::memcmp(head, "\xEF\xBB\xBF", 3) == 0;
+  if (!format.bom) {
+    file.clear();
+    file.seekg(0);
+  }
+  char previous = 0;
+  char c = 0;
+  while (file.get(c) && c != '\n') {
+    previous = c;
+  }
+  format.crlf = c == '\n' && previous == '\r';
+  return format;
+}
+
+/**
+ * @brief Streaming merge sink writing merged lines to an output stream
+ *        in the byte order mark and line endings of a format
+ */
+class OutputSink : public wizardmerge::merge::MergeSink {
+public:
+  OutputSink(std::ostream &out, const LineFormat &format)
+      : out_(out), bom_(format.bom), newline_(format.crlf ? "\r\n" : "\n") {}
+
+  void write_line(std::string_view content,
+                  wizardmerge::merge::Line::Origin) override {
+    if (bom_) {
+      out_ << "\xEF\xBB\xBF";
+      bom_ = false;
+    }
+    out_ << content << newline_;
+  }
+
+  void write_conflict(const wizardmerge::merge::Conflict &) override {}
+
+private:
+  std::ostream &out_;
+  bool bom_;
+  const char *newline_;
+};
+
+/**
+ * @brief Merge three files locally with bounded memory
+ * @return CLI exit code
+ */
+int streamMerge(const std::string &baseFile, const std::string &oursFile,
+                const std::string &theirsFile, const std::string &outputFile,
+                bool quiet) {
+  std::ifstream base(baseFile, std::ios::binary);
+  std::ifstream ours(oursFile, std::ios::binary);
+  std::ifstream theirs(theirsFile, std::ios::binary);
+  if (!base.is_open() || !ours.is_open() || !theirs.is_open()) {
+    std::cerr << "Error: Failed to open input files\n";
+    return 4;
+  }
+
+  std::ofstream file;
+  if (!outputFile.empty()) {
+    file.open(outputFile, std::ios::binary);
+    if (!file.is_open()) {
+      std::cerr << "Error: Failed to write output file\n";
+      return 4;
+    }
+  }
+  std::ostream &out = outputFile.empty() ? std::cout : file;
+
+  if (!quiet) {
+    std::cerr << "Performing streaming three-way merge...\n";
+  }
+
+  // Inputs are normalized as they are read, so versions differing only in
+  // a BOM or CRLF line endings do not conflict on every line; the result
+  // gets ours' BOM and line endings back
+  NormalizingBuffer baseBuffer(base);
+  NormalizingBuffer oursBuffer(ours);
+  NormalizingBuffer theirsBuffer(theirs);
+  std::istream baseText(&baseBuffer);
+  std::istream oursText(&oursBuffer);
+  std::istream theirsText(&theirsBuffer);
+
+  // Only the merged text is written, so skip the conflict analysis
+  wizardmerge::merge::StreamingOptions options;
+  options.merge.analysis = wizardmerge::merge::AnalysisLevel::NONE;
+  OutputSink sink(out, peekLineFormat(oursFile));
+  auto stats = wizardmerge::merge::streaming_three_way_merge(
+      baseText, oursText, theirsText, sink, options);
+  out.flush();
+
+  if (base.bad() || ours.bad() || theirs.bad()) {
+    std::cerr << "Error: Failed to read input files\n";
+    return 4;
+  }
+  if (!out) {
+    std::cerr << "Error: Failed to write output\n";
+    return 4;
+  }
+
+  if (!quiet) {
+    std::cerr << "Merge completed. Has conflicts: "
+              << (stats.conflicts > 0 ? "Yes" : "No") << "\n";
+    std::cerr << "Result has " << stats.lines_written << " lines ("
+              << stats.conflicts << " conflicts, peak window "
+              << stats.peak_window_lines << " lines)\n";
+    if (!outputFile.empty()) {
+      std::cerr << "Output written to: " << outputFile << "\n";
+    }
+  }
+
+  return stats.conflicts > 0 ? 5 : 0;
+}
+
+/**
+ * @brief Whether a format stores normalized text unchanged
+ */
+bool isNormalFormat(const wizardmerge::text::TextFormat &format) {
+  return format.encoding == wizardmerge::text::TextEncoding::UTF8 &&
+         !format.bom && format.line_ending == wizardmerge::text::LineEnding::LF;
+}
+
+/**
+ * @brief Write normalized text in the encoding and line endings of a format
+ */
+void writeStored(std::ostream &out, std::string_view text,
+                 const wizardmerge::text::TextFormat &format) {
+  if (isNormalFormat(format)) {
+    out << text;
+    return;
+  }
+  std::string stored;
+  wizardmerge::text::restore_text(text, format, stored);
+  out << stored;
+}
+
+/**
+ * @brief Write merged lines in the encoding and line endings of a format
+ */
+void writeText(std::ostream &out,
+               const wizardmerge::merge::MergeResult &result,
+               const wizardmerge::text::TextFormat &format) {
+  if (isNormalFormat(format)) {
+    for (const auto &line : result.merged_lines) {
+      out << line.content << '\n';
+    }
+    return;
+  }
+  std::string text;
+  for (const auto &line : result.merged_lines) {
+    text.append(line.content);
+    text.push_back('\n');
+  }
+  writeStored(out, text, format);
+}
+
+/**
+ * @brief Re-merge the conflicts git left in a working-tree file
+ *
+ * Base, ours and theirs are rebuilt from the conflict markers (diff3-style
+ * base sections included) and merged again with token-level refinement;
+ * what still conflicts is written back with markers carrying git's labels.
+ * @return CLI exit code
+ */
+int resolveConflictedFile(const std::string &path,
+                          const std::string &outputFile, bool quiet) {
+  namespace merge = wizardmerge::merge;
+  namespace text = wizardmerge::text;
+
+  auto buffer = text::TextBuffer::from_file(path);
+  if (!buffer) {
+    std::cerr << "Error: Failed to read " << path << "\n";
+    return 4;
+  }
+  // Content that is not text is parsed as it is
+  text::TextFormat format;
+  if (!buffer->normalize(format)) {
+    format = text::TextFormat();
+  }
+  merge::ConflictedFile file;
+  if (!merge::parse_conflict_markers(buffer->data(), file)) {
+    std::cerr << "Error: Malformed conflict markers in " << path << "\n";
+    return 4;
+  }
+  if (!file.has_conflicts()) {
+    if (!quiet) {
+      std::cerr << path << ": no conflict markers\n";
+    }
+    return 0;
+  }
+
+  // Only merged text is written, so skip the conflict analysis
+  merge::MergeOptions options;
+  options.refine_conflicts = true;
+  options.analysis = merge::AnalysisLevel::NONE;
+  auto withBase =
+      std::find_if(file.hunks.begin(), file.hunks.end(),
+                   [](const merge::MarkerHunk &hunk) { return hunk.has_base; });
+  options.show_base = withBase != file.hunks.end();
+
+  // Conflicts left are marked with git's labels (git uses the same ones
+  // for every conflict of a file)
+  options.our_label = std::string(file.hunks.front().our_label);
+  options.their_label = std::string(file.hunks.front().their_label);
+  if (options.show_base) {
+    options.base_label = std::string(withBase->base_label);
+  }
+  merge::MergeResult result =
+      merge::three_way_merge(file.base, file.ours, file.theirs, options);
+
+  // The merged lines own their text; unmap before rewriting the file
+  size_t hunks = file.hunks.size();
+  file = merge::ConflictedFile();
+  buffer.reset();
+
+  std::ofstream out(outputFile, std::ios::binary);
+  writeText(out, result, format);
+  if (!out) {
+    std::cerr << "Error: Failed to write " << outputFile << "\n";
+    return 4;
+  }
+
+  if (!quiet) {
+    std::cerr << path << ": " << hunks << " conflicts, "
+              << result.conflicts.size() << " left\n";
+  }
+  return result.has_conflicts() ? 5 : 0;
+}
+
+/**
+ * @brief Collect the relative paths of all regular files under a directory
+ */
+void collectFiles(const std::filesystem::path &root,
+                  std::set<std::string> &files) {
+  if (!std::filesystem::is_directory(root)) {
+    return;
+  }
+  for (const auto &entry :
+       std::filesystem::recursive_directory_iterator(root)) {
+    if (entry.is_regular_file()) {
+      files.insert(
+          std::filesystem::relative(entry.path(), root).generic_string());
+    }
+  }
+}
+
+/**
+ * @brief Merge three directory trees locally, all files in parallel
+ *
+ * A file missing from a tree merges as empty; a file deleted on one side
+ * and left unchanged on the other is not written (see is_deleted_file),
+ * but a file added empty is. Binary files are merged
+ * whole: the changed version is copied, and a file both sides changed is
+ * a conflict that keeps our version (as git does). Text is merged in UTF-8
+ * with LF line endings and written in the encoding, BOM and line endings
+ * of our version (of theirs if we have none).
+ * @return CLI exit code
+ */
+int mergeDirectories(const std::string &baseDir, const std::string &oursDir,
+                     const std::string &theirsDir,
+                     const std::string &outputDir, bool quiet) {
+  namespace fs = std::filesystem;
+
+  std::set<std::string> paths;
+  try {
+    collectFiles(baseDir, paths);
+    collectFiles(oursDir, paths);
+    collectFiles(theirsDir, paths);
+  } catch (const fs::filesystem_error &e) {
+    std::cerr << "Error: Failed to list input directories: " << e.what()
+              << "\n";
+    return 4;
+  }
+
+  // Read and normalize every version up front; the jobs view these
+  // buffers. Content that is not text stays as it is, with the default
+  // format, which restores it unchanged.
+  using wizardmerge::text::TextBuffer;
+  using wizardmerge::text::TextFormat;
+  struct FileVersions {
+    std::string path;
+    TextBuffer base, ours, theirs;
+    TextFormat oursFormat, theirsFormat;
+    bool inOurs;
+  };
+  auto readVersion = [](const fs::path &path, TextBuffer &buffer,
+                        TextFormat &format) {
+    auto loaded = TextBuffer::from_file(path.string());
+    if (!loaded) {
+      return false;
+    }
+    buffer = std::move(*loaded);
+    if (!buffer.normalize(format)) {
+      format = TextFormat();
+    }
+    return true;
+  };
+  std::vector<FileVersions> files;
+  files.reserve(paths.size());
+  for (const auto &path : paths) {
+    FileVersions file;
+    file.path = path;
+    TextFormat baseFormat;
+    bool inBase = readVersion(fs::path(baseDir) / path, file.base, baseFormat);
+    file.inOurs =
+        readVersion(fs::path(oursDir) / path, file.ours, file.oursFormat);
+    bool inTheirs = readVersion(fs::path(theirsDir) / path, file.theirs,
+                                file.theirsFormat);
+    auto present = [](bool in, const TextBuffer &buffer) {
+      return in ? std::optional<std::string_view>(buffer.data())
+                : std::nullopt;
+    };
+    if (wizardmerge::merge::is_deleted_file(present(inBase, file.base),
+                                            present(file.inOurs, file.ours),
+                                            present(inTheirs, file.theirs))) {
+      continue;
+    }
+    files.push_back(std::move(file));
+  }
+
+  if (!quiet) {
+    std::cerr << "Merging " << files.size() << " files...\n";
+  }
+
+  std::atomic<size_t> conflicted(0);
+  std::atomic<bool> writeFailed(false);
+  std::mutex reportMutex;
+  auto writeFile = [&](const FileVersions &file, const auto &write) {
+    fs::path target = fs::path(outputDir) / file.path;
+    std::error_code error;
+    fs::create_directories(target.parent_path(), error);
+    std::ofstream out(target, std::ios::binary);
+    write(out);
+    if (!out) {
+      writeFailed = true;
+      std::lock_guard<std::mutex> lock(reportMutex);
+      std::cerr << "Error: Failed to write " << target.string() << "\n";
+    }
+  };
+
+  // Binary files are resolved whole, without splitting them into lines;
+  // only merged text is written, so skip the conflict analysis
+  using wizardmerge::merge::BinaryResolution;
+  std::vector<wizardmerge::merge::MergeJob> jobs;
+  std::vector<size_t> jobFiles;
+  for (size_t i = 0; i < files.size(); ++i) {
+    const FileVersions &file = files[i];
+    if (wizardmerge::merge::is_binary_merge(
+            file.base.data(), file.ours.data(), file.theirs.data())) {
+      BinaryResolution resolution = wizardmerge::merge::merge_binary(
+          file.base.data(), file.ours.data(), file.theirs.data());
+      bool takeTheirs = resolution == BinaryResolution::THEIRS;
+      const TextBuffer &chosen = takeTheirs ? file.theirs : file.ours;
+      if (resolution == BinaryResolution::CONFLICT) {
+        ++conflicted;
+        if (!quiet) {
+          std::cerr << "Conflict (binary): " << file.path << "\n";
+        }
+      }
+      writeFile(file, [&](std::ostream &out) {
+        writeStored(out, chosen.data(),
+                    takeTheirs ? file.theirsFormat : file.oursFormat);
+      });
+      continue;
+    }
+
+    wizardmerge::merge::MergeJob job;
+    job.base = file.base.lines();
+    job.ours = file.ours.lines();
+    job.theirs = file.theirs.lines();
+    job.options.analysis = wizardmerge::merge::AnalysisLevel::NONE;
+    jobs.push_back(std::move(job));
+    jobFiles.push_back(i);
+  }
+
+  auto writeResult = [&](size_t index,
+                         wizardmerge::merge::MergeResult &result) {
+    const FileVersions &file = files[jobFiles[index]];
+    if (result.has_conflicts()) {
+      ++conflicted;
+      if (!quiet) {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        std::cerr << "Conflict: " << file.path << "\n";
+      }
+    }
+    writeFile(file, [&](std::ostream &out) {
+      writeText(out, result,
+                file.inOurs ? file.oursFormat : file.theirsFormat);
+    });
+  };
+  wizardmerge::merge::merge_batch(jobs, writeResult);
+
+  if (writeFailed) {
+    return 4;
+  }
+  if (!quiet) {
+    std::cerr << "Merged " << files.size() << " files into " << outputDir
+              << " (" << conflicted.load() << " with conflicts)\n";
+  }
+  return conflicted > 0 ? 5 : 0;
+}
+#endif
+
 /**
  * @brief Print usage information
  */
@@ -17,6 +508,9 @@ void printUsage(const char *programName) {
   std::cout << "Usage:\n";
   std::cout << "  " << programName
             << " [OPTIONS] merge --base <file> --ours <file> --theirs <file>\n";
+  std::cout << "  " << programName
+            << " [OPTIONS] merge-dir --base <dir> --ours <dir> --theirs <dir> "
+               "-o <dir>\n";
   std::cout << "  " << programName
             << " [OPTIONS] pr-resolve --url <pr_url> [--token <token>]\n";
   std::cout << "  " << programName << " [OPTIONS] git-resolve [FILE]\n";
@@ -35,8 +529,16 @@ void printUsage(const char *programName) {
   std::cout << "    --ours <file>     Our version file (required)\n";
   std::cout << "    --theirs <file>   Their version file (required)\n";
   std::cout << "    -o, --output <file>  Output file (default: stdout)\n";
-  std::cout << "    --format <format>    Output format: text, json (default: "
-               "text)\n\n";
+  std::cout << "    --format <format>    Output format: text, json, binary "
+               "(default: text)\n";
+  std::cout << "    --stream          Merge locally with bounded memory, "
+               "without the backend\n\n";
+  std::cout << "  merge-dir           Merge three directory trees locally, "
+               "files in parallel\n";
+  std::cout << "    --base <dir>      Base version directory (required)\n";
+  std::cout << "    --ours <dir>      Our version directory (required)\n";
+  std::cout << "    --theirs <dir>    Their version directory (required)\n";
+  std::cout << "    -o, --output <dir>  Output directory (required)\n\n";
   std::cout << "  pr-resolve          Resolve pull request conflicts\n";
   std::cout << "    --url <url>       Pull request URL (required)\n";
   std::cout << "    --token <token>   GitHub API token (optional, can use "
@@ -45,9 +547,11 @@ void printUsage(const char *programName) {
                "(optional)\n";
   std::cout << "    -o, --output <dir>  Output directory for resolved files "
                "(default: stdout)\n\n";
-  std::cout << "  git-resolve         Resolve Git merge conflicts (not yet "
-               "implemented)\n";
-  std::cout << "    [FILE]            Specific file to resolve (optional)\n\n";
+  std::cout << "  git-resolve         Re-merge the conflicts Git left in "
+               "working-tree files locally\n";
+  std::cout << "    [FILE]            Specific file to resolve (default: all "
+               "conflicted files)\n";
+  std::cout << "    -o, --output <file>  Output file (default: FILE itself)\n\n";
   std::cout << "Examples:\n";
   std::cout << "  " << programName
             << " merge --base base.txt --ours ours.txt --theirs theirs.txt\n";
@@ -84,7 +588,9 @@ int main(int argc, char *argv[]) {
   std::string command;
   std::string baseFile, oursFile, theirsFile, outputFile;
   std::string format = "text";
+  bool stream = false;
   std::string prUrl, githubToken, branchName;
+  std::string conflictedFile;
 
   // Check environment variable
   const char *envBackend = std::getenv("WIZARDMERGE_BACKEND");
@@ -121,6 +627,8 @@ int main(int argc, char *argv[]) {
       quiet = true;
     } else if (arg == "merge") {
       command = "merge";
+    } else if (arg == "merge-dir") {
+      command = "merge-dir";
     } else if (arg == "pr-resolve") {
       command = "pr-resolve";
     } else if (arg == "git-resolve") {
@@ -174,6 +682,8 @@ int main(int argc, char *argv[]) {
         std::cerr << "Error: --output requires an argument\n";
         return 2;
       }
+    } else if (arg == "--stream") {
+      stream = true;
     } else if (arg == "--format") {
       if (i + 1 < argc) {
         format = argv[++i];
@@ -181,6 +691,8 @@ int main(int argc, char *argv[]) {
         std::cerr << "Error: --format requires an argument\n";
         return 2;
       }
+    } else if (command == "git-resolve" && arg[0] != '-') {
+      conflictedFile = arg;
     }
   }
 
@@ -214,6 +726,22 @@ int main(int argc, char *argv[]) {
       return 4;
     }
 
+    // Status messages would corrupt a binary result written to stdout
+    if (format == "binary" && outputFile.empty()) {
+      quiet = true;
+      verbose = false;
+    }
+
+    if (stream) {
+#ifdef WIZARDMERGE_LOCAL_MERGE
+      return streamMerge(baseFile, oursFile, theirsFile, outputFile, quiet);
+#else
+      std::cerr << "Error: --stream requires a build linked with the "
+                   "WizardMerge backend library\n";
+      return 2;
+#endif
+    }
+
     if (verbose) {
       std::cout << "Backend URL: " << backendUrl << "\n";
       std::cout << "Base file: " << baseFile << "\n";
@@ -221,13 +749,14 @@ int main(int argc, char *argv[]) {
       std::cout << "Theirs file: " << theirsFile << "\n";
     }
 
-    // Read input files
+    // Read input files; the result is written in the format of ours
     std::vector<std::string> baseLines, oursLines, theirsLines;
+    LineFormat lineFormat;
     if (!FileUtils::readLines(baseFile, baseLines)) {
       std::cerr << "Error: Failed to read base file\n";
       return 4;
     }
-    if (!FileUtils::readLines(oursFile, oursLines)) {
+    if (!FileUtils::readLines(oursFile, oursLines, &lineFormat)) {
       std::cerr << "Error: Failed to read ours file\n";
       return 4;
     }
@@ -261,9 +790,34 @@ int main(int argc, char *argv[]) {
       std::cout << "Performing three-way merge...\n";
     }
 
-    std::vector<std::string> mergedLines;
     bool hasConflicts = false;
 
+    // The whole result, analysis included, in the backend's binary encoding
+    if (format == "binary") {
+      std::string encoded;
+      if (!client.performMergeEncoded(baseLines, oursLines, theirsLines,
+                                      encoded, hasConflicts)) {
+        std::cerr << "Error: Merge failed: " << client.getLastError() << "\n";
+        return 1;
+      }
+      if (outputFile.empty()) {
+        std::cout.write(encoded.data(),
+                        static_cast<std::streamsize>(encoded.size()));
+        std::cout.flush();
+      } else {
+        if (!FileUtils::writeFile(outputFile, encoded)) {
+          std::cerr << "Error: Failed to write output file\n";
+          return 4;
+        }
+        if (!quiet) {
+          std::cout << "Output written to: " << outputFile << "\n";
+        }
+      }
+      return hasConflicts ? 5 : 0;
+    }
+
+    std::vector<std::string> mergedLines;
+
     if (!client.performMerge(baseLines, oursLines, theirsLines, mergedLines,
                              hasConflicts)) {
       std::cerr << "Error: Merge failed: " << client.getLastError() << "\n";
@@ -280,11 +834,9 @@ int main(int argc, char *argv[]) {
     // Write output
     if (outputFile.empty()) {
       // Write to stdout
-      for (const auto &line : mergedLines) {
-        std::cout << line << "\n";
-      }
+      FileUtils::writeLines(std::cout, mergedLines, lineFormat);
     } else {
-      if (!FileUtils::writeLines(outputFile, mergedLines)) {
+      if (!FileUtils::writeLines(outputFile, mergedLines, lineFormat)) {
         std::cerr << "Error: Failed to write output file\n";
         return 4;
       }
@@ -295,6 +847,23 @@ int main(int argc, char *argv[]) {
 
     return hasConflicts ? 5 : 0;
 
+  } else if (command == "merge-dir") {
+    // Validate required arguments
+    if (baseFile.empty() || oursFile.empty() || theirsFile.empty() ||
+        outputFile.empty()) {
+      std::cerr << "Error: merge-dir command requires --base, --ours, "
+                   "--theirs and --output arguments\n";
+      return 2;
+    }
+
+#ifdef WIZARDMERGE_LOCAL_MERGE
+    return mergeDirectories(baseFile, oursFile, theirsFile, outputFile, quiet);
+#else
+    std::cerr << "Error: merge-dir requires a build linked with the "
+                 "WizardMerge backend library\n";
+    return 2;
+#endif
+
   } else if (command == "pr-resolve") {
     // Validate required arguments
     if (prUrl.empty()) {
@@ -412,8 +981,39 @@ int main(int argc, char *argv[]) {
     }
 
   } else if (command == "git-resolve") {
-    std::cerr << "Error: git-resolve command not yet implemented\n";
-    return 1;
+#ifdef WIZARDMERGE_LOCAL_MERGE
+    std::vector<std::string> files;
+    if (!conflictedFile.empty()) {
+      files.push_back(conflictedFile);
+    } else {
+      auto listed = wizardmerge::git::list_conflicted_files("");
+      if (!listed) {
+        std::cerr << "Error: Failed to list conflicted files (not in a Git "
+                     "repository?)\n";
+        return 4;
+      }
+      files = std::move(*listed);
+      if (files.empty() && !quiet) {
+        std::cerr << "No conflicted files\n";
+      }
+    }
+    if (!outputFile.empty() && files.size() != 1) {
+      std::cerr << "Error: --output needs exactly one conflicted file\n";
+      return 2;
+    }
+
+    int exitCode = 0;
+    for (const auto &path : files) {
+      int code = resolveConflictedFile(
+          path, outputFile.empty() ? path : outputFile, quiet);
+      exitCode = std::max(exitCode, code);
+    }
+    return exitCode;
+#else
+    std::cerr << "Error: git-resolve requires a build linked with the "
+                 "WizardMerge backend library\n";
+    return 2;
+#endif
   } else {
     std::cerr << "Error: Unknown command: " << command << "\n";
     return 2;